@@ -5,9 +5,12 @@
 #include "Components/TonemapRenderer.h"
 #include "UiManager.h"
 #include <Turso3D/Core/WorkQueue.h>
+#include <Turso3D/Core/Profiler.h>
 #include <Turso3D/Graphics/FrameBuffer.h>
+#include <Turso3D/Graphics/GpuProfiler.h>
 #include <Turso3D/Graphics/Graphics.h>
 #include <Turso3D/Graphics/RenderBuffer.h>
+#include <Turso3D/Graphics/RenderGraph.h>
 #include <Turso3D/Graphics/ShaderProgram.h>
 #include <Turso3D/Graphics/Texture.h>
 #include <Turso3D/IO/Log.h>
@@ -17,6 +20,7 @@
 #include <Turso3D/Renderer/AnimationState.h>
 #include <Turso3D/Renderer/Camera.h>
 #include <Turso3D/Renderer/DebugRenderer.h>
+#include <Turso3D/Renderer/Imposter.h>
 #include <Turso3D/Renderer/Light.h>
 #include <Turso3D/Renderer/Material.h>
 #include <Turso3D/Renderer/Model.h>
@@ -51,9 +55,12 @@ Application::Application() :
 	workQueue->CreateWorkerThreads(2);
 
 	ResourceCache* cache = ResourceCache::Instance();
+	cache->SetWorkQueue(workQueue.get());
 	cache->AddResourceDir((std::filesystem::current_path() / "Shaders").string());
 	cache->AddResourceDir((std::filesystem::current_path() / "Data").string());
 
+	renderGraph = std::make_unique<RenderGraph>();
+
 	blurRenderer = std::make_unique<BlurRenderer>();
 	bloomRenderer = std::make_unique<BloomRenderer>();
 	aoRenderer = std::make_unique<SSAORenderer>();
@@ -64,6 +71,10 @@ Application::Application() :
 
 Application::~Application()
 {
+	// Finish the asynchronous loads while the work queue running them and the objects their callbacks use still exist
+	ResourceCache* cache = ResourceCache::Instance();
+	cache->CompleteAsyncLoads();
+	cache->SetWorkQueue(nullptr);
 }
 
 bool Application::Initialize()
@@ -75,6 +86,7 @@ bool Application::Initialize()
 
 	// Configure renderer
 	renderer->SetupShadowMaps(DIRECTIONAL_LIGHT_SIZE, LIGHT_ATLAS_SIZE, FORMAT_D32_SFLOAT_PACK32);
+	renderer->SetDepthPrePass(true);
 
 	blurRenderer->Initialize();
 	bloomRenderer->Initialize();
@@ -163,6 +175,9 @@ void Application::OnFramebufferSize(int width, int height)
 			depthFbo[i] = std::make_unique<FrameBuffer>();
 		}
 
+		// Post-processing renders to the color buffer through the first color framebuffer
+		colorFbo[0]->Define(colorBuffer.get(), nullptr);
+
 		Texture* mrt[] = {colorBuffer.get(), normalBuffer.get()};
 		hdrFbo->Define(mrt, 2, depthBuffer.get());
 	}
@@ -171,18 +186,6 @@ void Application::OnFramebufferSize(int width, int height)
 	ldrBuffer->DefineSampler(nearest, clamp, clamp, clamp);
 	ldrFbo->Define(ldrBuffer.get(), depthBuffer.get());
 
-	blurRenderer->UpdateBuffers(sz / 2, ldrBuffer->Format(), IntVector2::ZERO(), 4);
-
-	// Bloom resources
-	if (bloomRenderer) {
-		bloomRenderer->UpdateBuffers(sz, colorBuffer->Format());
-	}
-
-	// SSAO resources
-	if (aoRenderer) {
-		aoRenderer->UpdateBuffers(sz);
-	}
-
 	// UI resources
 	if (uiManager) {
 		uiManager->UpdateBuffers(sz);
@@ -354,6 +357,12 @@ void Application::CreateThousandMushroomScene()
 	std::shared_ptr<Model> mushroomModel = cache->LoadResource<Model>("mushroom.tmf");
 	std::shared_ptr<Material> mushroomMaterial = cache->LoadResource<Material>("mushroom.xml");
 
+	// Distant mushrooms are rendered as instanced imposters
+	std::shared_ptr<Imposter> mushroomImposter = std::make_shared<Imposter>();
+	if (!mushroomImposter->Bake(mushroomModel.get(), {mushroomMaterial})) {
+		mushroomImposter.reset();
+	}
+
 	for (int y = -55; y <= 55; ++y) {
 		for (int x = -55; x <= 55; ++x) {
 			StaticModel* floor = root->CreateChild<StaticModel>();
@@ -374,6 +383,7 @@ void Application::CreateThousandMushroomScene()
 					mushroom->SetScale(0.5f);
 					mushroom->SetModel(mushroomModel);
 					mushroom->SetMaterial(mushroomMaterial);
+					mushroom->SetImposter(mushroomImposter, 100.0f);
 					mushroom->SetCastShadows(true);
 				}
 			}
@@ -497,6 +507,9 @@ void Application::Update(double dt)
 	GLFWwindow* window = static_cast<GLFWwindow*>(Graphics::Window());
 	const float dtf = static_cast<float>(dt);
 
+	// Finish background resource loads within a frame time budget
+	ResourceCache::Instance()->UpdateAsyncLoads();
+
 	// Ui
 	if (uiManager) {
 		uiManager->Update(dt);
@@ -534,6 +547,11 @@ void Application::Update(double dt)
 
 	if (IsKeyPressed(GLFW_KEY_1)) useOcclusion = !useOcclusion;
 	if (IsKeyPressed(GLFW_KEY_2)) renderDebug = !renderDebug;
+	if (IsKeyPressed(GLFW_KEY_3)) renderer->SetDepthPrePass(!renderer->DepthPrePass(), renderer->DepthPrePassMinCoverage());
+	if (IsKeyPressed(GLFW_KEY_4)) GpuProfiler::SetEnabled(!GpuProfiler::IsEnabled());
+	if (IsKeyPressed(GLFW_KEY_P)) LogGpuProfile();
+	if (IsKeyPressed(GLFW_KEY_R)) LogRendererStats();
+	if (IsKeyPressed(GLFW_KEY_F9)) ToggleCpuCapture();
 	if (IsKeyPressed(GLFW_KEY_F)) Graphics::SetFullscreen(!Graphics::IsFullscreen());
 	if (IsKeyPressed(GLFW_KEY_V)) Graphics::SetVSync(!Graphics::VSync());
 
@@ -566,6 +584,9 @@ void Application::Render(double dt)
 {
 	const IntRect viewRect {IntVector2::ZERO(), colorBuffer->Size2D()};
 
+	GpuProfiler::BeginFrame();
+	renderer->AdvanceAnimationTime((float)dt);
+
 	// Collect geometries and lights in frustum.
 	// Also set debug renderer to use the correct camera view.
 	renderer->PrepareView(scene.get(), camera.get(), true, useOcclusion, (float)dt);
@@ -596,28 +617,27 @@ void Application::Render(double dt)
 		Graphics::Blit(depthFbo[0].get(), viewRect, depthFbo[1].get(), viewRect, false, true, FILTER_POINT);
 	}
 
-	Texture* color = colorBuffer.get(); // Resolved HDR color texture
-	//Texture* normal = normalBuffer[0].get(); // Resolved normal texture
-	//Texture* depth = depthStencilBuffer[0].get(); // Resolved Depth texture
+	// Post-processing passes communicate through the render graph, which allocates their intermediate targets
+	renderGraph->Reset();
+	size_t color = renderGraph->ImportTexture("HDR Color", colorBuffer.get(), colorFbo[0].get()); // Resolved HDR color texture
+	size_t normal = renderGraph->ImportTexture("Normal", normalBuffer.get()); // Resolved normal texture
+	size_t depth = renderGraph->ImportTexture("Depth", depthBuffer.get()); // Resolved depth texture
+	size_t ldr = renderGraph->ImportTexture("LDR Color", ldrBuffer.get(), ldrFbo.get());
+	size_t backbuffer = renderGraph->ImportTexture("Backbuffer", nullptr);
 
 	// SSAO
 	if (aoRenderer) {
-		TURSO3D_GRAPHICS_MARKER("SAO");
-		aoRenderer->Render(camera.get(), normalBuffer.get(), depthBuffer.get(), colorFbo[0].get(), viewRect);
+		aoRenderer->AddPasses(*renderGraph, camera.get(), normal, depth, color, viewRect);
 	}
 
 	// HDR Bloom
 	if (bloomRenderer) {
-		TURSO3D_GRAPHICS_MARKER("Bloom");
-		bloomRenderer->Render(color, 0.02f);
-		color = bloomRenderer->GetTexture();
+		color = bloomRenderer->AddPasses(*renderGraph, color, 0.02f);
 	}
 
 	// Tonemap
 	if (tonemapRenderer) {
-		TURSO3D_GRAPHICS_MARKER("Tonemap");
-		Graphics::BindFramebuffer(ldrFbo.get(), nullptr);
-		tonemapRenderer->Render(color);
+		tonemapRenderer->AddPass(*renderGraph, color, ldr);
 	}
 
 	// Optional render of debug geometry
@@ -644,23 +664,83 @@ void Application::Render(double dt)
 			debugRenderer->AddSphere(Sphere(res.position, 0.05f), Color::WHITE(), true);
 		}
 #endif
-		renderer->RenderDebug(debugRenderer.get());
-		debugRenderer->Render();
+		size_t pass = renderGraph->AddPass("Debug Geometry", [this, ldr, viewRect](const RenderGraph& graph) {
+			Graphics::BindFramebuffer(graph.GetFramebuffer(ldr), nullptr);
+			Graphics::SetViewport(viewRect);
+			renderer->RenderDebug(debugRenderer.get());
+			debugRenderer->Render();
+		});
+		renderGraph->Read(pass, depth);
+		renderGraph->Read(pass, ldr);
+		renderGraph->Write(pass, ldr);
 	}
 
 	// Blur scene for UI transparent backgrounds
-	{
-		TURSO3D_GRAPHICS_MARKER("Scene Blur");
-		blurRenderer->Downsample(ldrBuffer.get());
-		blurRenderer->Upsample();
-		Graphics::SetViewport(viewRect);
-	}
+	size_t blurred = blurRenderer->AddPasses(*renderGraph, ldr, viewRect.Size() / 2, ldrBuffer->Format(), IntVector2::ZERO(), 4, BLEND_REPLACE);
 
 	// Compose UI
 	if (uiManager) {
-		Graphics::BindFramebuffer(nullptr, nullptr);
-		uiManager->Compose(ldrBuffer.get(), blurRenderer->GetTexture());
+		size_t pass = renderGraph->AddPass("UI Compose", [this, ldr, blurred, viewRect](const RenderGraph& graph) {
+			Graphics::BindFramebuffer(nullptr, nullptr);
+			Graphics::SetViewport(viewRect);
+			Graphics::SetRenderState(BLEND_REPLACE, CULL_BACK, CMP_ALWAYS, true, false);
+			uiManager->Compose(graph.GetTexture(ldr), graph.GetTexture(blurred));
+		});
+		renderGraph->Read(pass, ldr);
+		renderGraph->Read(pass, blurred);
+		renderGraph->Write(pass, backbuffer);
 	}
 
+	renderGraph->SetOutput(backbuffer);
+	renderGraph->Compile();
+	renderGraph->Execute();
+
+	GpuProfiler::EndFrame();
 	Graphics::Present();
 }
+
+void Application::ToggleCpuCapture()
+{
+	if (!Profiler::IsCapturing()) {
+		Profiler::BeginCapture();
+		LOG_INFO("CPU profiler capture started");
+		return;
+	}
+
+	// Worker threads are idle between frames, so the trace can be exported here
+	Profiler::EndCapture();
+	if (Profiler::SaveChromeTrace("trace.json")) {
+		LOG_INFO("CPU profiler capture saved to trace.json");
+	}
+}
+
+void Application::LogGpuProfile()
+{
+	if (!GpuProfiler::IsEnabled()) {
+		LOG_INFO("GPU profiler is disabled");
+		return;
+	}
+
+	LOG_INFO("GPU frame: {:.3f} ms", GpuProfiler::AverageFrameTime());
+	for (const GpuProfileResult& result : GpuProfiler::Results()) {
+		LOG_INFO("{:>{}}{:s}: {:.3f} ms", "", result.depth * 2, result.name, result.averageTime);
+	}
+}
+
+void Application::LogRendererStats()
+{
+	const RendererStats& stats = renderer->Stats();
+
+	LOG_INFO("Octants: {:d} visible, {:d} occluded", stats.octants, stats.occludedOctants);
+	LOG_INFO("Octree update: {:d} moved, {:d} kept, {:d} reinserted, {:d} animated", stats.updatedDrawables, stats.keptDrawables, stats.reinsertedDrawables, stats.animatedDrawables);
+	if (size_t poseLookups = stats.poseCacheHits + stats.poseCacheMisses) {
+		LOG_INFO("Pose cache: {:d} hits, {:d} misses ({:.1f}% hit rate)", stats.poseCacheHits, stats.poseCacheMisses, 100.0f * stats.poseCacheHits / poseLookups);
+	}
+	LOG_INFO("Drawables: {:d}, lights: {:d} ({:d} culled)", stats.drawables, stats.lights, stats.culledLights);
+	LOG_INFO("Batches: opaque {:d}/{:d}, depth pre-pass {:d}/{:d}, alpha {:d}/{:d}, shadow {:d}/{:d}", stats.opaqueBatches, stats.opaqueDrawBatches, stats.depthPrePassBatches, stats.depthPrePassDrawBatches, stats.alphaBatches, stats.alphaDrawBatches, stats.shadowBatches, stats.shadowDrawBatches);
+	LOG_INFO("Shadow views: {:d} rendered, {:d} skipped", stats.shadowViewsRendered, stats.shadowViewsSkipped);
+	LOG_INFO("Occlusion queries: {:d}", stats.occlusionQueries);
+	LOG_INFO("Draw calls: {:d}, instances: {:d}, triangles: {:d}", stats.drawCalls, stats.instances, stats.triangles);
+	LOG_INFO("Switches: program {:d}, texture {:d}, VAO {:d}", stats.programSwitches, stats.textureSwitches, stats.vaoSwitches);
+	LOG_INFO("PrepareView: {:.3f} ms (octree {:.3f}, collect {:.3f}, sort {:.3f}, shadows {:.3f})", stats.prepareViewTime, stats.octreeUpdateTime, stats.collectTime, stats.sortTime, stats.shadowTime);
+}
@@ -36,6 +36,12 @@ protected:
 	void FixedUpdate(double dt) override;
 
 	void Render(double dt);
+	// Start a CPU profiler capture, or stop it and save it as a Chrome trace.
+	void ToggleCpuCapture();
+	// Log the average GPU time of the profiled passes.
+	void LogGpuProfile();
+	// Log the renderer statistics of the last frame.
+	void LogRendererStats();
 
 private:
 	std::shared_ptr<Turso3D::Camera> camera;
@@ -57,6 +63,9 @@ private:
 	std::unique_ptr<Turso3D::Texture> ldrBuffer;
 	std::unique_ptr<Turso3D::FrameBuffer> ldrFbo;
 
+	// Graph of the post-processing passes, which owns their intermediate targets.
+	std::unique_ptr<Turso3D::RenderGraph> renderGraph;
+
 	std::unique_ptr<BlurRenderer> blurRenderer;
 	std::unique_ptr<BloomRenderer> bloomRenderer;
 	std::unique_ptr<SSAORenderer> aoRenderer;
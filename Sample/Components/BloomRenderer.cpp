@@ -3,6 +3,7 @@
 #include <Turso3D/Graphics/Graphics.h>
 #include <Turso3D/Graphics/ShaderProgram.h>
 #include <Turso3D/Graphics/FrameBuffer.h>
+#include <Turso3D/Graphics/RenderGraph.h>
 #include <Turso3D/Graphics/Texture.h>
 #include <Turso3D/IO/Log.h>
 
@@ -11,8 +12,6 @@ using namespace Turso3D;
 BloomRenderer::BloomRenderer()
 {
 	blurRenderer = std::make_unique<BlurRenderer>();
-	buffer = std::make_unique<Texture>();
-	fbo = std::make_unique<FrameBuffer>();
 }
 
 BloomRenderer::~BloomRenderer()
@@ -29,34 +28,29 @@ void BloomRenderer::Initialize()
 	uIntensity = bloomProgram->Uniform(intensityHash);
 }
 
-void BloomRenderer::UpdateBuffers(const IntVector2& size, ImageFormat format)
+size_t BloomRenderer::AddPasses(RenderGraph& graph, size_t hdrColor, float intensity)
 {
-	Log::Scope logScope {"BloomRenderer::UpdateBuffers"};
+	const RenderTextureDesc& hdrDesc = graph.GetDesc(hdrColor);
 
-	buffer->Define(TARGET_2D, size, format);
-	buffer->DefineSampler(FILTER_BILINEAR, ADDRESS_CLAMP, ADDRESS_CLAMP, ADDRESS_CLAMP);
-	fbo->Define(buffer.get(), nullptr);
-
-	blurRenderer->UpdateBuffers(size / 2, format, IntVector2 {4, 4}, 0);
-}
-
-void BloomRenderer::Render(Texture* hdrColor, float intensity)
-{
-	Graphics::SetRenderState(BLEND_REPLACE, CULL_BACK, CMP_ALWAYS, true, false);
-	blurRenderer->Downsample(hdrColor);
-
-	Graphics::SetRenderState(BLEND_ADD, CULL_BACK, CMP_ALWAYS, true, false);
-	blurRenderer->Upsample();
+	size_t blurred = blurRenderer->AddPasses(graph, hdrColor, hdrDesc.size / 2, hdrDesc.format, IntVector2 {4, 4}, 0);
+	size_t result = graph.CreateTexture("Bloom", RenderTextureDesc {hdrDesc.size, hdrDesc.format, FILTER_BILINEAR});
 
 	// Compose
-	Graphics::BindFramebuffer(fbo.get(), nullptr);
-
-	Graphics::BindProgram(bloomProgram.get());
-	Graphics::SetUniform(uIntensity, intensity);
-	Graphics::BindTexture(0, hdrColor);
-	Graphics::BindTexture(1, blurRenderer->GetTexture());
-
-	Graphics::SetViewport(IntRect {IntVector2::ZERO(), buffer->Size2D()});
-	Graphics::SetRenderState(BLEND_REPLACE, CULL_BACK, CMP_ALWAYS, true, false);
-	Graphics::DrawQuad();
+	size_t pass = graph.AddPass("Bloom Compose", [this, hdrColor, blurred, result, intensity](const RenderGraph& rg) {
+		Graphics::BindFramebuffer(rg.GetFramebuffer(result), nullptr);
+
+		Graphics::BindProgram(bloomProgram.get());
+		Graphics::SetUniform(uIntensity, intensity);
+		Graphics::BindTexture(0, rg.GetTexture(hdrColor));
+		Graphics::BindTexture(1, rg.GetTexture(blurred));
+
+		Graphics::SetViewport(IntRect {IntVector2::ZERO(), rg.GetTexture(result)->Size2D()});
+		Graphics::SetRenderState(BLEND_REPLACE, CULL_BACK, CMP_ALWAYS, true, false);
+		Graphics::DrawQuad();
+	});
+	graph.Read(pass, hdrColor);
+	graph.Read(pass, blurred);
+	graph.Write(pass, result);
+
+	return result;
 }
@@ -14,18 +14,12 @@ public:
 
 	void Initialize();
 
-	void UpdateBuffers(const Turso3D::IntVector2& size, Turso3D::ImageFormat format);
-	void Render(Turso3D::Texture* hdrColor, float intensity = 0.05f);
-
-	Turso3D::FrameBuffer* GetFramebuffer() const { return fbo.get(); }
-	Turso3D::Texture* GetTexture() const { return buffer.get(); }
+	// Add the bloom passes to the render graph. Return the transient resource holding the composed result.
+	size_t AddPasses(Turso3D::RenderGraph& graph, size_t hdrColor, float intensity = 0.05f);
 
 private:
 	std::unique_ptr<BlurRenderer> blurRenderer;
 
 	std::shared_ptr<Turso3D::ShaderProgram> bloomProgram;
 	int uIntensity; // intensity uniform location.
-
-	std::unique_ptr<Turso3D::Texture> buffer;
-	std::unique_ptr<Turso3D::FrameBuffer> fbo;
 };
@@ -2,19 +2,14 @@
 #include <Turso3D/Graphics/Graphics.h>
 #include <Turso3D/Graphics/ShaderProgram.h>
 #include <Turso3D/Graphics/FrameBuffer.h>
+#include <Turso3D/Graphics/RenderGraph.h>
 #include <Turso3D/Graphics/Texture.h>
 #include <Turso3D/Math/IntVector2.h>
 #include <Turso3D/IO/Log.h>
+#include <vector>
 
 using namespace Turso3D;
 
-struct BlurRenderer::MipPass
-{
-	std::unique_ptr<Texture> buffer;
-	std::unique_ptr<FrameBuffer> fbo;
-};
-
-// ==========================================================================================
 BlurRenderer::BlurRenderer()
 {
 }
@@ -40,75 +35,62 @@ void BlurRenderer::Initialize()
 	uAspectRatio = upsampleProgram->Uniform(aspectRatioHash);
 }
 
-void BlurRenderer::Downsample(Texture* srcColor)
-{
-	for (size_t i = 0; i < passes.size(); ++i) {
-		// Bind the program
-		int p = int(bool(i));
-		Graphics::BindProgram(downsampleProgram[p].get());
-
-		// Bind the draw buffer
-		MipPass& mip = passes[i];
-		Graphics::BindFramebuffer(mip.fbo.get(), nullptr);
-
-		// Bind the texture to be sampled
-		Texture* src = (i == 0) ? srcColor : passes[i - 1].buffer.get();
-		Graphics::BindTexture(0, src);
-
-		const IntVector2& src_size = src->Size2D();
-		Graphics::SetViewport(IntRect {IntVector2::ZERO(), mip.buffer->Size2D()});
-		Graphics::SetUniform(uInvSrcSize[p], Vector2 {1.0f / static_cast<float>(src_size.x), 1.0f / static_cast<float>(src_size.y)});
-		Graphics::DrawQuad();
-	}
-}
-
-void BlurRenderer::Upsample(float filterRadius)
+size_t BlurRenderer::AddPasses(RenderGraph& graph, size_t srcColor, const IntVector2& size, ImageFormat format, const IntVector2& minMipSize, int maxMips, BlendMode upsampleBlend, float filterRadius)
 {
-	Graphics::BindProgram(upsampleProgram.get());
-	Graphics::SetUniform(uAspectRatio, aspectRatio);
-	Graphics::SetUniform(uFilterRadius, filterRadius);
-
-	for (size_t i = 0; i < passes.size() - 1; ++i) {
-		size_t ri = passes.size() - (1 + i);
-
-		// Bind the draw buffer
-		MipPass& prev_mip = passes[ri - 1];
-		Graphics::BindFramebuffer(prev_mip.fbo.get(), nullptr);
-
-		// Bind the mip texture to be sampled.
-		MipPass& mip = passes[ri];
-		Graphics::BindTexture(0, mip.buffer.get());
-
-		Graphics::SetViewport(IntRect {IntVector2::ZERO(), prev_mip.buffer->Size2D()});
-		Graphics::DrawQuad();
-	}
-}
-
-void BlurRenderer::UpdateBuffers(const IntVector2& size, ImageFormat format, const IntVector2& minMipSize, int maxMips)
-{
-	aspectRatio = static_cast<float>(size.x) / static_cast<float>(size.y);
-
 	IntVector2 min_size {std::max(minMipSize.x, 1), std::max(minMipSize.y, 1)};
 
-	passes.clear();
+	std::vector<size_t> mips;
 	for (int i = 0, hw = size.x, hh = size.y; (!maxMips || i < maxMips) && hw >= min_size.x && hh >= min_size.y; ++i, hw /= 2, hh /= 2) {
-		MipPass& mip = passes.emplace_back();
+		mips.push_back(graph.CreateTexture("Blur Mip", RenderTextureDesc {IntVector2 {hw, hh}, format, FILTER_BILINEAR}));
+	}
+	if (mips.empty()) {
+		return srcColor;
+	}
 
-		mip.buffer = std::make_unique<Texture>();
-		mip.buffer->Define(TARGET_2D, IntVector2 {hw, hh}, format);
-		mip.buffer->DefineSampler(FILTER_BILINEAR, ADDRESS_CLAMP, ADDRESS_CLAMP, ADDRESS_CLAMP);
+	// Downsample
+	for (size_t i = 0; i < mips.size(); ++i) {
+		size_t src = (i == 0) ? srcColor : mips[i - 1];
+		size_t dst = mips[i];
+		int p = int(bool(i));
 
-		mip.fbo = std::make_unique<FrameBuffer>();
-		mip.fbo->Define(mip.buffer.get(), nullptr);
+		size_t pass = graph.AddPass("Blur Downsample", [this, src, dst, p](const RenderGraph& rg) {
+			Texture* srcTexture = rg.GetTexture(src);
+			const IntVector2& src_size = srcTexture->Size2D();
+
+			Graphics::BindFramebuffer(rg.GetFramebuffer(dst), nullptr);
+			Graphics::BindProgram(downsampleProgram[p].get());
+			Graphics::BindTexture(0, srcTexture);
+
+			Graphics::SetViewport(IntRect {IntVector2::ZERO(), rg.GetTexture(dst)->Size2D()});
+			Graphics::SetUniform(uInvSrcSize[p], Vector2 {1.0f / static_cast<float>(src_size.x), 1.0f / static_cast<float>(src_size.y)});
+			Graphics::SetRenderState(BLEND_REPLACE, CULL_BACK, CMP_ALWAYS, true, false);
+			Graphics::DrawQuad();
+		});
+		graph.Read(pass, src);
+		graph.Write(pass, dst);
 	}
-}
 
-FrameBuffer* BlurRenderer::GetFramebuffer() const
-{
-	return passes[0].fbo.get();
-}
+	// Upsample up to the first mip
+	float aspectRatio = static_cast<float>(size.x) / static_cast<float>(size.y);
+	for (size_t ri = mips.size() - 1; ri > 0; --ri) {
+		size_t src = mips[ri];
+		size_t dst = mips[ri - 1];
+
+		size_t pass = graph.AddPass("Blur Upsample", [this, src, dst, aspectRatio, filterRadius, upsampleBlend](const RenderGraph& rg) {
+			Graphics::BindFramebuffer(rg.GetFramebuffer(dst), nullptr);
+			Graphics::BindProgram(upsampleProgram.get());
+			Graphics::SetUniform(uAspectRatio, aspectRatio);
+			Graphics::SetUniform(uFilterRadius, filterRadius);
+			Graphics::BindTexture(0, rg.GetTexture(src));
+
+			Graphics::SetViewport(IntRect {IntVector2::ZERO(), rg.GetTexture(dst)->Size2D()});
+			Graphics::SetRenderState(upsampleBlend, CULL_BACK, CMP_ALWAYS, true, false);
+			Graphics::DrawQuad();
+		});
+		graph.Read(pass, src);
+		graph.Read(pass, dst);
+		graph.Write(pass, dst);
+	}
 
-Texture* BlurRenderer::GetTexture() const
-{
-	return passes[0].buffer.get();
+	return mips[0];
 }
@@ -2,6 +2,7 @@
 #include <Turso3D/Graphics/Graphics.h>
 #include <Turso3D/Graphics/ShaderProgram.h>
 #include <Turso3D/Graphics/FrameBuffer.h>
+#include <Turso3D/Graphics/RenderGraph.h>
 #include <Turso3D/Graphics/Texture.h>
 #include <Turso3D/Graphics/UniformBuffer.h>
 #include <Turso3D/Renderer/Camera.h>
@@ -13,8 +14,6 @@ SSAORenderer::SSAORenderer()
 {
 	ssaoUniformBuffer = std::make_unique<UniformBuffer>();
 	noiseTexture = std::make_unique<Texture>();
-	resultTexture = std::make_unique<Texture>();
-	resultFbo = std::make_unique<FrameBuffer>();
 }
 
 SSAORenderer::~SSAORenderer()
@@ -37,23 +36,51 @@ void SSAORenderer::Initialize()
 	GenerateNoiseTexture();
 }
 
-void SSAORenderer::UpdateBuffers(const IntVector2& size)
+void SSAORenderer::AddPasses(RenderGraph& graph, Camera* camera, size_t normal, size_t depth, size_t color, const IntRect& viewRect)
 {
-	Log::Scope logScope {"SSAORenderer::UpdateBuffers"};
-	IntVector2 texSize {size.x / 2, size.y / 2};
+	IntVector2 aoSize {viewRect.Width() / 2, viewRect.Height() / 2};
+	size_t ao = graph.CreateTexture("SSAO", RenderTextureDesc {aoSize, FORMAT_RGB8_UNORM_PACK8, FILTER_BILINEAR});
 
-	resultTexture->Define(TARGET_2D, texSize, FORMAT_RGB8_UNORM_PACK8);
-	resultTexture->DefineSampler(FILTER_BILINEAR, ADDRESS_CLAMP, ADDRESS_CLAMP, ADDRESS_CLAMP);
-	resultFbo->Define(resultTexture.get(), nullptr);
+	// SSAO pass
+	size_t aoPass = graph.AddPass("SSAO", [this, camera, normal, depth, ao, aoSize, viewRect](const RenderGraph& rg) {
+		UpdateUniforms(camera, aoSize, viewRect);
 
-	uniformDataDirty = true;
+		Graphics::BindFramebuffer(rg.GetFramebuffer(ao), nullptr);
+		Graphics::BindProgram(ssaoProgram.get());
+		Graphics::SetViewport(IntRect {IntVector2::ZERO(), aoSize});
+
+		Graphics::BindTexture(0, rg.GetTexture(depth));
+		Graphics::BindTexture(1, rg.GetTexture(normal));
+		Graphics::BindTexture(2, noiseTexture.get());
+
+		Graphics::BindUniformBuffer(UB_CUSTOM, ssaoUniformBuffer.get());
+
+		Graphics::SetRenderState(BLEND_REPLACE, CULL_BACK, CMP_ALWAYS, true, false);
+		Graphics::DrawQuad();
+	});
+	graph.Read(aoPass, depth);
+	graph.Read(aoPass, normal);
+	graph.Write(aoPass, ao);
+
+	// Blur pass
+	size_t blurPass = graph.AddPass("SSAO Blur", [this, color, ao, aoSize, viewRect](const RenderGraph& rg) {
+		Graphics::BindFramebuffer(rg.GetFramebuffer(color), nullptr);
+		Graphics::BindProgram(blurProgram.get());
+		Graphics::SetViewport(viewRect);
+
+		Graphics::BindTexture(0, rg.GetTexture(ao));
+		Graphics::SetUniform(uBlurInvSize, Vector2 {1.0f / static_cast<float>(aoSize.x), 1.0f / static_cast<float>(aoSize.y)});
+
+		Graphics::SetRenderState(BLEND_SUBTRACT, CULL_BACK, CMP_ALWAYS, true, false);
+		Graphics::DrawQuad();
+	});
+	graph.Read(blurPass, ao);
+	graph.Read(blurPass, color);
+	graph.Write(blurPass, color);
 }
 
-void SSAORenderer::Render(Camera* camera, Texture* normal, Texture* depth, FrameBuffer* dst, const IntRect& viewRect)
+void SSAORenderer::UpdateUniforms(Camera* camera, const IntVector2& aoSize, const IntRect& viewRect)
 {
-	const IntVector2& result_sz = resultTexture->Size2D();
-
-	// Update uniforms
 	Vector3 near, far;
 	camera->FrustumSize(near, far);
 	Vector4 frustumSize {far.x, far.y, far.z, (float)viewRect.Height() / (float)viewRect.Width()};
@@ -72,43 +99,26 @@ void SSAORenderer::Render(Camera* camera, Texture* normal, Texture* depth, Frame
 		uniformDataDirty = true;
 	}
 
-	if (uniformDataDirty) {
-		const IntVector2& noise_sz = noiseTexture->Size2D();
+	const IntVector2& noise_sz = noiseTexture->Size2D();
+	Vector2 noiseInvSize {
+		static_cast<float>(aoSize.x) / static_cast<float>(noise_sz.x),
+		static_cast<float>(aoSize.y) / static_cast<float>(noise_sz.y)
+	};
+	if (noiseInvSize != uniformData.noiseInvSize) {
+		uniformData.noiseInvSize = noiseInvSize;
+		uniformDataDirty = true;
+	}
 
-		uniformData.noiseInvSize = Vector2 {
-			static_cast<float>(result_sz.x) / static_cast<float>(noise_sz.x),
-			static_cast<float>(result_sz.y) / static_cast<float>(noise_sz.y)
-		};
-		uniformData.screenInvSize = Vector2 {1.0f / viewRect.Width(), 1.0f / viewRect.Height()};
+	Vector2 screenInvSize {1.0f / viewRect.Width(), 1.0f / viewRect.Height()};
+	if (screenInvSize != uniformData.screenInvSize) {
+		uniformData.screenInvSize = screenInvSize;
+		uniformDataDirty = true;
+	}
 
+	if (uniformDataDirty) {
 		ssaoUniformBuffer->SetData(0, sizeof(UniformDataBlock), &uniformData, false);
 		uniformDataDirty = false;
 	}
-
-	// SSAO pass
-	Graphics::BindFramebuffer(resultFbo.get(), nullptr);
-	Graphics::BindProgram(ssaoProgram.get());
-	Graphics::SetViewport(IntRect {IntVector2::ZERO(), resultTexture->Size2D()});
-
-	Graphics::BindTexture(0, depth);
-	Graphics::BindTexture(1, normal);
-	Graphics::BindTexture(2, noiseTexture.get());
-
-	Graphics::BindUniformBuffer(UB_CUSTOM, ssaoUniformBuffer.get());
-
-	Graphics::SetRenderState(BLEND_REPLACE, CULL_BACK, CMP_ALWAYS, true, false);
-	Graphics::DrawQuad();
-
-	// Blur pass
-	Graphics::BindFramebuffer(dst, nullptr);
-	Graphics::BindProgram(blurProgram.get());
-	Graphics::SetViewport(viewRect);
-
-	Graphics::BindTexture(0, resultTexture.get());
-	Graphics::SetUniform(uBlurInvSize, Vector2 {1.0f / static_cast<float>(result_sz.x), 1.0f / static_cast<float>(result_sz.y)});
-
-	Graphics::SetRenderState(BLEND_SUBTRACT, CULL_BACK, CMP_ALWAYS, true, false);
-	Graphics::DrawQuad();
 }
 
 void SSAORenderer::GenerateNoiseTexture()
@@ -23,14 +23,12 @@ public:
 
 	void Initialize();
 
-	void UpdateBuffers(const Turso3D::IntVector2& size);
-	void Render(Turso3D::Camera* camera, Turso3D::Texture* normal, Turso3D::Texture* depth, Turso3D::FrameBuffer* dst, const Turso3D::IntRect& viewRect);
-
-	Turso3D::FrameBuffer* GetResultFramebuffer() const { return resultFbo.get(); }
-	Turso3D::Texture* GetResultTexture() const { return resultTexture.get(); }
+	// Add the half resolution AO pass and the blur pass, which darkens the color resource, to the render graph.
+	void AddPasses(Turso3D::RenderGraph& graph, Turso3D::Camera* camera, size_t normal, size_t depth, size_t color, const Turso3D::IntRect& viewRect);
 
 private:
 	void GenerateNoiseTexture();
+	void UpdateUniforms(Turso3D::Camera* camera, const Turso3D::IntVector2& aoSize, const Turso3D::IntRect& viewRect);
 
 private:
 	std::shared_ptr<Turso3D::ShaderProgram> ssaoProgram;
@@ -43,6 +41,4 @@ private:
 	int uBlurInvSize;
 
 	std::unique_ptr<Turso3D::Texture> noiseTexture;
-	std::unique_ptr<Turso3D::Texture> resultTexture;
-	std::unique_ptr<Turso3D::FrameBuffer> resultFbo;
 };
@@ -2,6 +2,7 @@
 #include <Turso3D/Graphics/Graphics.h>
 #include <Turso3D/Graphics/ShaderProgram.h>
 #include <Turso3D/Graphics/FrameBuffer.h>
+#include <Turso3D/Graphics/RenderGraph.h>
 #include <Turso3D/Graphics/Texture.h>
 #include <Turso3D/IO/Log.h>
 
@@ -24,13 +25,21 @@ void TonemapRenderer::Initialize()
 	uExposure = program->Uniform(exposureHash);
 }
 
-void TonemapRenderer::Render(Texture* hdrColor)
+void TonemapRenderer::AddPass(RenderGraph& graph, size_t hdrColor, size_t dst)
 {
-	Graphics::BindProgram(program.get());
+	size_t pass = graph.AddPass("Tonemap", [this, hdrColor, dst](const RenderGraph& rg) {
+		Graphics::BindFramebuffer(rg.GetFramebuffer(dst), nullptr);
+		Graphics::SetViewport(IntRect {IntVector2::ZERO(), rg.GetDesc(dst).size});
+		Graphics::SetRenderState(BLEND_REPLACE, CULL_BACK, CMP_ALWAYS, true, false);
 
-	// TODO: exposure based on eye-adaptation formula
-	Graphics::SetUniform(uExposure, 1.0f);
-	Graphics::BindTexture(0, hdrColor);
+		Graphics::BindProgram(program.get());
 
-	Graphics::DrawQuad();
+		// TODO: exposure based on eye-adaptation formula
+		Graphics::SetUniform(uExposure, 1.0f);
+		Graphics::BindTexture(0, rg.GetTexture(hdrColor));
+
+		Graphics::DrawQuad();
+	});
+	graph.Read(pass, hdrColor);
+	graph.Write(pass, dst);
 }
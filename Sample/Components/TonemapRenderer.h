@@ -11,8 +11,8 @@ public:
 
 	void Initialize();
 
-	// Render tonemap to the currently bound framebuffer.
-	void Render(Turso3D::Texture* hdrColor);
+	// Add the tonemap pass to the render graph, rendering hdrColor to dst.
+	void AddPass(Turso3D::RenderGraph& graph, size_t hdrColor, size_t dst);
 
 private:
 	// Tonemap shader program
@@ -0,0 +1,226 @@
+#include "Tests.h"
+#include <Turso3D/Core/WorkQueue.h>
+#include <Turso3D/Math/Ray.h>
+#include <Turso3D/Renderer/Octree.h>
+#include <fmt/format.h>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+	using namespace Turso3D;
+
+	constexpr size_t NUM_DRAWABLES = 150000;
+	constexpr size_t NUM_VOLUMES = 500;
+	constexpr size_t NUM_VOLUME_ROUNDS = 4;
+	constexpr size_t NUM_RAYS = 20000;
+	constexpr size_t NUM_ALL_HITS_RAYS = 2000;
+	constexpr size_t NUM_UPDATES = 20;
+	constexpr size_t NUM_MOVING_DRAWABLES = 50000;
+	constexpr unsigned short NUM_MOVING_FRAMES = 300;
+
+	// Drawable with a fixed world bounding box.
+	class BoxDrawable : public Drawable
+	{
+	public:
+		// Set the world bounding box and mark it dirty.
+		void SetBox(const BoundingBox& box_)
+		{
+			box = box_;
+			SetFlag(FLAG_BOUNDING_BOX_DIRTY, true);
+		}
+
+		// Recalculate the world space bounding box.
+		void OnWorldBoundingBoxUpdate() const override { worldBoundingBox = box; }
+
+		// World bounding box.
+		BoundingBox box;
+		// Movement per frame.
+		Vector3 velocity;
+	};
+
+	template <typename Func>
+	double Measure(Func func)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		func();
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// Move half of the drawables at a constant velocity and time the octree update with the given fattened bounds settings.
+	void BenchmarkFatBounds(float speed, float margin, float lookaheadFrames)
+	{
+		std::mt19937 rng(42);
+		std::uniform_real_distribution<float> position(-900.0f, 900.0f);
+		std::uniform_real_distribution<float> size(0.5f, 4.0f);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+		std::vector<std::unique_ptr<BoxDrawable>> drawables;
+		WorkQueue workQueue;
+		Octree octree(&workQueue);
+		octree.Resize(BoundingBox(-1000.0f, 1000.0f), 8);
+		octree.SetFatBounds(margin, lookaheadFrames);
+
+		for (size_t i = 0; i < NUM_MOVING_DRAWABLES; ++i) {
+			std::unique_ptr<BoxDrawable> drawable = std::make_unique<BoxDrawable>();
+			Vector3 center(position(rng), position(rng) * 0.05f, position(rng));
+			Vector3 halfSize(size(rng), size(rng), size(rng));
+			drawable->SetBox(BoundingBox(center - halfSize, center + halfSize));
+			drawable->velocity = Vector3(unit(rng), 0.0f, unit(rng)) * speed;
+			drawable->SetFlag(Drawable::FLAG_GEOMETRY, true);
+			octree.QueueUpdate(drawable.get());
+			drawables.push_back(std::move(drawable));
+		}
+		octree.Update(1);
+		octree.FinishUpdate();
+
+		size_t numReinserted = 0;
+		double updateTime = Measure([&]() {
+			for (unsigned short frame = 2; frame < NUM_MOVING_FRAMES; ++frame) {
+				for (size_t i = 0; i < NUM_MOVING_DRAWABLES; i += 2) {
+					BoxDrawable* drawable = drawables[i].get();
+					drawable->SetBox(BoundingBox(drawable->box.min + drawable->velocity, drawable->box.max + drawable->velocity));
+					octree.QueueUpdate(drawable);
+				}
+				octree.Update(frame);
+				octree.FinishUpdate();
+				numReinserted += octree.Stats().reinsertedDrawables;
+			}
+		});
+
+		// Fattened bounds place drawables in larger octants, which may make the queries slower
+		std::vector<Drawable*> result;
+		std::vector<Frustum> frustums(NUM_VOLUMES);
+		for (Frustum& frustum : frustums) {
+			Quaternion rotation(unit(rng) * 30.0f, unit(rng) * 180.0f, 0.0f);
+			frustum.Define(60.0f, 1.5f, 1.0f, 0.5f, 150.0f, Matrix3x4(Vector3(position(rng), 10.0f, position(rng)), rotation, 1.0f));
+		}
+		double queryTime = Measure([&]() {
+			for (size_t i = 0; i < NUM_VOLUME_ROUNDS; ++i) {
+				for (const Frustum& frustum : frustums) {
+					result.clear();
+					octree.FindDrawablesMasked(result, frustum, Drawable::FLAG_GEOMETRY, 1);
+				}
+			}
+		});
+
+		fmt::print("Octree fat bounds margin {:.2f} lookahead {:.0f}, speed {:.2f}: {:d} reinserted, update {:.1f} ms, {:d} frustum queries {:.2f} ms\n",
+			margin, lookaheadFrames, speed, numReinserted, updateTime, NUM_VOLUME_ROUNDS * NUM_VOLUMES, queryTime);
+
+		for (const std::unique_ptr<BoxDrawable>& drawable : drawables) {
+			octree.RemoveDrawable(drawable.get());
+		}
+	}
+}
+
+void BenchmarkOctree()
+{
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+	std::uniform_real_distribution<float> size(0.5f, 4.0f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	std::vector<std::unique_ptr<BoxDrawable>> drawables;
+	WorkQueue workQueue;
+	Octree octree(&workQueue);
+	octree.Resize(BoundingBox(-1000.0f, 1000.0f), 8);
+
+	// A flat world of small objects, one third of them shadow casters
+	for (size_t i = 0; i < NUM_DRAWABLES; ++i) {
+		std::unique_ptr<BoxDrawable> drawable = std::make_unique<BoxDrawable>();
+		Vector3 center(position(rng), position(rng) * 0.05f, position(rng));
+		Vector3 halfSize(size(rng), size(rng), size(rng));
+		drawable->SetBox(BoundingBox(center - halfSize, center + halfSize));
+		drawable->SetFlag(Drawable::FLAG_GEOMETRY, true);
+		drawable->SetFlag(Drawable::FLAG_CAST_SHADOWS, i % 3 == 0);
+		octree.QueueUpdate(drawable.get());
+		drawables.push_back(std::move(drawable));
+	}
+	octree.Update(1);
+	octree.FinishUpdate();
+
+	std::vector<Frustum> frustums(NUM_VOLUMES);
+	std::vector<Sphere> spheres;
+	std::vector<Ray> rays;
+	for (size_t i = 0; i < NUM_VOLUMES; ++i) {
+		Quaternion rotation(unit(rng) * 180.0f, unit(rng) * 180.0f, 0.0f);
+		frustums[i].Define(60.0f, 1.5f, 1.0f, 0.5f, 300.0f, Matrix3x4(Vector3(position(rng), 10.0f, position(rng)), rotation, 1.0f));
+		spheres.push_back(Sphere(Vector3(position(rng), 0.0f, position(rng)), 100.0f));
+	}
+	for (size_t i = 0; i < NUM_RAYS; ++i) {
+		Vector3 direction(unit(rng), unit(rng) * 0.1f, unit(rng));
+		rays.push_back(Ray(Vector3(position(rng), 1.0f, position(rng)), direction.Normalized()));
+	}
+
+	// The result counts are printed so that runs on different octree versions can be checked to agree
+	std::vector<Drawable*> result;
+	size_t numFound = 0;
+	double time = Measure([&]() {
+		for (size_t i = 0; i < NUM_VOLUME_ROUNDS; ++i) {
+			for (const Frustum& frustum : frustums) {
+				result.clear();
+				octree.FindDrawablesMasked(result, frustum, Drawable::FLAG_GEOMETRY, 1);
+				numFound += result.size();
+			}
+		}
+	});
+	fmt::print("Octree masked frustum queries x{:d}: {:.2f} ms, {:d} found\n", NUM_VOLUME_ROUNDS * NUM_VOLUMES, time, numFound);
+
+	numFound = 0;
+	time = Measure([&]() {
+		for (size_t i = 0; i < NUM_VOLUME_ROUNDS; ++i) {
+			for (const Sphere& sphere : spheres) {
+				result.clear();
+				octree.FindDrawables(result, sphere, Drawable::FLAG_GEOMETRY | Drawable::FLAG_CAST_SHADOWS, 1);
+				numFound += result.size();
+			}
+		}
+	});
+	fmt::print("Octree sphere queries x{:d}: {:.2f} ms, {:d} found\n", NUM_VOLUME_ROUNDS * NUM_VOLUMES, time, numFound);
+
+	size_t numHits = 0;
+	time = Measure([&]() {
+		for (const Ray& ray : rays) {
+			if (octree.RaycastSingle(ray, Drawable::FLAG_GEOMETRY, 1, 500.0f).drawable) {
+				++numHits;
+			}
+		}
+	});
+	fmt::print("Octree RaycastSingle x{:d}: {:.2f} ms, {:d} hits\n", NUM_RAYS, time, numHits);
+
+	std::vector<RaycastResult> raycastResult;
+	numHits = 0;
+	time = Measure([&]() {
+		for (size_t i = 0; i < NUM_ALL_HITS_RAYS; ++i) {
+			octree.Raycast(raycastResult, rays[i], Drawable::FLAG_GEOMETRY, 1, 500.0f);
+			numHits += raycastResult.size();
+		}
+	});
+	fmt::print("Octree Raycast x{:d}: {:.2f} ms, {:d} hits\n", NUM_ALL_HITS_RAYS, time, numHits);
+
+	// Frame update cost when almost nothing moves
+	time = Measure([&]() {
+		for (size_t i = 0; i < NUM_UPDATES; ++i) {
+			BoxDrawable* drawable = drawables[i].get();
+			drawable->SetBox(drawable->box.Transformed(Matrix3x4(Vector3(0.1f, 0.0f, 0.0f), Quaternion::IDENTITY(), 1.0f)));
+			octree.QueueUpdate(drawable);
+			octree.Update(static_cast<unsigned short>(2 + i));
+			octree.FinishUpdate();
+		}
+	});
+	fmt::print("Octree update with one moved drawable x{:d}: {:.3f} ms\n", NUM_UPDATES, time);
+
+	// The drawables have no owner node to detach them, so remove them before the octree is destroyed
+	for (const std::unique_ptr<BoxDrawable>& drawable : drawables) {
+		octree.RemoveDrawable(drawable.get());
+	}
+
+	// Without fattened bounds, and with the defaults
+	const float speeds[] = {0.05f, 0.3f, 1.0f};
+	for (float speed : speeds) {
+		BenchmarkFatBounds(speed, 0.0f, 0.0f);
+		BenchmarkFatBounds(speed, octree.FatBoundsMargin(), octree.FatBoundsLookahead());
+	}
+}
@@ -0,0 +1,310 @@
+#include "Tests.h"
+#include <Turso3D/Math/Frustum.h>
+#include <Turso3D/Math/Quaternion.h>
+#include <Turso3D/Math/Simd.h>
+#include <fmt/format.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#ifdef TURSO3D_SIMD
+namespace
+{
+	using namespace Turso3D;
+
+	constexpr size_t NUM_CASES = 200000;
+	constexpr size_t NUM_BENCHMARK_ROUNDS = 20;
+
+	// Random inputs shared by the tests and benchmarks.
+	struct TestData
+	{
+		// Transforms with rotation, translation and nonuniform scale.
+		std::vector<Matrix3x4> matrices;
+		// Boxes of varying size around the frustums.
+		std::vector<BoundingBox> boxes;
+		// Plane masks for the masked frustum tests.
+		std::vector<unsigned char> planeMasks;
+		// Perspective and orthographic frustums.
+		std::vector<Frustum> frustums;
+	};
+
+	TestData CreateTestData()
+	{
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+		std::uniform_real_distribution<float> angle(-180.0f, 180.0f);
+		std::uniform_real_distribution<float> scale(0.1f, 4.0f);
+
+		TestData data;
+		data.matrices.reserve(NUM_CASES);
+		data.boxes.reserve(NUM_CASES);
+		data.planeMasks.reserve(NUM_CASES);
+
+		for (size_t i = 0; i < NUM_CASES; ++i) {
+			Vector3 translation(position(rng), position(rng), position(rng));
+			Quaternion rotation(angle(rng), angle(rng), angle(rng));
+			data.matrices.push_back(Matrix3x4(translation, rotation, Vector3(scale(rng), scale(rng), scale(rng))));
+
+			Vector3 center(position(rng), position(rng), position(rng));
+			Vector3 halfSize(scale(rng), scale(rng), scale(rng));
+			data.boxes.push_back(BoundingBox(center - halfSize, center + halfSize));
+
+			data.planeMasks.push_back(static_cast<unsigned char>(rng() & 0x3f));
+		}
+
+		for (size_t i = 0; i < 4; ++i) {
+			Matrix3x4 transform(Vector3(position(rng), position(rng), position(rng)), Quaternion(angle(rng), angle(rng), angle(rng)), 1.0f);
+			Frustum frustum;
+			if (i & 1) {
+				frustum.DefineOrtho(15.0f, 1.5f, 1.0f, 0.5f, 30.0f, transform);
+			} else {
+				frustum.Define(60.0f, 1.5f, 1.0f, 0.5f, 30.0f, transform);
+			}
+			data.frustums.push_back(frustum);
+		}
+
+		return data;
+	}
+
+	// Scalar matrix multiply, as compiled with TURSO3D_NO_SIMD.
+	Matrix3x4 MultiplyScalar(const Matrix3x4& lhs, const Matrix3x4& rhs)
+	{
+		return Matrix3x4(
+			lhs.m00 * rhs.m00 + lhs.m01 * rhs.m10 + lhs.m02 * rhs.m20,
+			lhs.m00 * rhs.m01 + lhs.m01 * rhs.m11 + lhs.m02 * rhs.m21,
+			lhs.m00 * rhs.m02 + lhs.m01 * rhs.m12 + lhs.m02 * rhs.m22,
+			lhs.m00 * rhs.m03 + lhs.m01 * rhs.m13 + lhs.m02 * rhs.m23 + lhs.m03,
+			lhs.m10 * rhs.m00 + lhs.m11 * rhs.m10 + lhs.m12 * rhs.m20,
+			lhs.m10 * rhs.m01 + lhs.m11 * rhs.m11 + lhs.m12 * rhs.m21,
+			lhs.m10 * rhs.m02 + lhs.m11 * rhs.m12 + lhs.m12 * rhs.m22,
+			lhs.m10 * rhs.m03 + lhs.m11 * rhs.m13 + lhs.m12 * rhs.m23 + lhs.m13,
+			lhs.m20 * rhs.m00 + lhs.m21 * rhs.m10 + lhs.m22 * rhs.m20,
+			lhs.m20 * rhs.m01 + lhs.m21 * rhs.m11 + lhs.m22 * rhs.m21,
+			lhs.m20 * rhs.m02 + lhs.m21 * rhs.m12 + lhs.m22 * rhs.m22,
+			lhs.m20 * rhs.m03 + lhs.m21 * rhs.m13 + lhs.m22 * rhs.m23 + lhs.m23
+		);
+	}
+
+	// Scalar box transform, as compiled with TURSO3D_NO_SIMD.
+	BoundingBox TransformedScalar(const BoundingBox& box, const Matrix3x4& transform)
+	{
+		Vector3 oldCenter = box.Center();
+		Vector3 oldEdge = box.max - oldCenter;
+		Vector3 newCenter = transform * oldCenter;
+		Vector3 newEdge(
+			std::abs(transform.m00) * oldEdge.x + std::abs(transform.m01) * oldEdge.y + std::abs(transform.m02) * oldEdge.z,
+			std::abs(transform.m10) * oldEdge.x + std::abs(transform.m11) * oldEdge.y + std::abs(transform.m12) * oldEdge.z,
+			std::abs(transform.m20) * oldEdge.x + std::abs(transform.m21) * oldEdge.y + std::abs(transform.m22) * oldEdge.z
+		);
+		return BoundingBox(newCenter - newEdge, newCenter + newEdge);
+	}
+
+	// Scalar frustum box test, as compiled with TURSO3D_NO_SIMD.
+	Intersection IsInsideScalar(const Frustum& frustum, const BoundingBox& box)
+	{
+		Vector3 center = box.Center();
+		Vector3 edge = center - box.min;
+		bool allInside = true;
+
+		for (size_t i = 0; i < NUM_FRUSTUM_PLANES; ++i) {
+			const Plane& plane = frustum.planes[i];
+			float dist = plane.normal.DotProduct(center) + plane.d;
+			float absDist = plane.absNormal.DotProduct(edge);
+
+			if (dist < -absDist) {
+				return OUTSIDE;
+			} else if (dist < absDist) {
+				allInside = false;
+			}
+		}
+
+		return allInside ? INSIDE : INTERSECTS;
+	}
+
+	// Scalar masked frustum box test, as compiled with TURSO3D_NO_SIMD.
+	unsigned char IsInsideMaskedScalar(const Frustum& frustum, const BoundingBox& box, unsigned char planeMask)
+	{
+		Vector3 center = box.Center();
+		Vector3 edge = center - box.min;
+
+		for (size_t i = 0; i < NUM_FRUSTUM_PLANES; ++i) {
+			unsigned char bit = 1 << i;
+
+			if (planeMask & bit) {
+				const Plane& plane = frustum.planes[i];
+				float dist = plane.normal.DotProduct(center) + plane.d;
+				float absDist = plane.absNormal.DotProduct(edge);
+
+				if (dist < -absDist) {
+					return 0xff;
+				} else if (dist >= absDist) {
+					planeMask &= ~bit;
+				}
+			}
+		}
+
+		return planeMask;
+	}
+
+	// Return whether a box touches a frustum plane within rounding, so that the SIMD and scalar results may legitimately differ.
+	bool IsBorderline(const Frustum& frustum, const BoundingBox& box)
+	{
+		Vector3 center = box.Center();
+		Vector3 edge = center - box.min;
+
+		for (size_t i = 0; i < NUM_FRUSTUM_PLANES; ++i) {
+			const Plane& plane = frustum.planes[i];
+			float dist = plane.normal.DotProduct(center) + plane.d;
+			float absDist = plane.absNormal.DotProduct(edge);
+			if (std::abs(dist + absDist) < 1e-4f || std::abs(dist - absDist) < 1e-4f) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool Equals(float lhs, float rhs)
+	{
+		return std::abs(lhs - rhs) <= 1e-5f * std::max(1.0f, std::max(std::abs(lhs), std::abs(rhs)));
+	}
+
+	bool Equals(const Matrix3x4& lhs, const Matrix3x4& rhs)
+	{
+		const float* lhsData = lhs.Data();
+		const float* rhsData = rhs.Data();
+		for (size_t i = 0; i < 12; ++i) {
+			if (!Equals(lhsData[i], rhsData[i])) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool Equals(const BoundingBox& lhs, const BoundingBox& rhs)
+	{
+		return Equals(lhs.min.x, rhs.min.x) && Equals(lhs.min.y, rhs.min.y) && Equals(lhs.min.z, rhs.min.z) &&
+			Equals(lhs.max.x, rhs.max.x) && Equals(lhs.max.y, rhs.max.y) && Equals(lhs.max.z, rhs.max.z);
+	}
+
+	bool Report(const char* name, size_t numMismatches)
+	{
+		fmt::print("{:s}: {:d} cases, {:d} mismatches\n", name, NUM_CASES, numMismatches);
+		return numMismatches == 0;
+	}
+
+	template <typename Func>
+	double Measure(Func func)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < NUM_BENCHMARK_ROUNDS; ++i) {
+			func();
+		}
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	void ReportTimes(const char* name, double scalarTime, double simdTime)
+	{
+		fmt::print("{:s}: scalar {:.2f} ms, SIMD {:.2f} ms ({:.2f}x)\n", name, scalarTime, simdTime, scalarTime / simdTime);
+	}
+}
+#endif
+
+bool TestSimdMath()
+{
+#ifndef TURSO3D_SIMD
+	fmt::print("SIMD math: not compiled in, skipped\n");
+	return true;
+#else
+	TestData data = CreateTestData();
+	bool success = true;
+
+	size_t numMismatches = 0;
+	for (size_t i = 0; i < NUM_CASES; ++i) {
+		const Matrix3x4& lhs = data.matrices[i];
+		const Matrix3x4& rhs = data.matrices[(i + 1) % NUM_CASES];
+		if (!Equals(lhs * rhs, MultiplyScalar(lhs, rhs))) {
+			++numMismatches;
+		}
+	}
+	success &= Report("Matrix3x4 multiply", numMismatches);
+
+	numMismatches = 0;
+	for (size_t i = 0; i < NUM_CASES; ++i) {
+		if (!Equals(data.boxes[i].Transformed(data.matrices[i]), TransformedScalar(data.boxes[i], data.matrices[i]))) {
+			++numMismatches;
+		}
+	}
+	success &= Report("BoundingBox::Transformed", numMismatches);
+
+	numMismatches = 0;
+	for (size_t i = 0; i < NUM_CASES; ++i) {
+		const Frustum& frustum = data.frustums[i % data.frustums.size()];
+		const BoundingBox& box = data.boxes[i];
+		unsigned char planeMask = data.planeMasks[i];
+		if (IsBorderline(frustum, box)) {
+			continue;
+		}
+
+		// The fast variants return the outside result of the full tests, and the scalar code agrees with that by construction
+		unsigned char expectedMasked = IsInsideMaskedScalar(frustum, box, planeMask);
+		Intersection expected = IsInsideScalar(frustum, box);
+		if (frustum.IsInside(box) != expected || frustum.IsInsideMasked(box, planeMask) != expectedMasked ||
+			frustum.IsInsideFast(box) != (expected == OUTSIDE ? OUTSIDE : INSIDE) ||
+			frustum.IsInsideMaskedFast(box, planeMask) != (expectedMasked == 0xff ? OUTSIDE : INSIDE)) {
+			++numMismatches;
+		}
+	}
+	success &= Report("Frustum box tests", numMismatches);
+
+	return success;
+#endif
+}
+
+void BenchmarkSimdMath()
+{
+#ifdef TURSO3D_SIMD
+	TestData data = CreateTestData();
+	std::vector<Matrix3x4> matrixResults(NUM_CASES);
+	std::vector<BoundingBox> boxResults(NUM_CASES);
+	std::vector<unsigned char> maskResults(NUM_CASES);
+
+	double scalarTime = Measure([&]() {
+		for (size_t i = 0; i < NUM_CASES; ++i) {
+			matrixResults[i] = MultiplyScalar(data.matrices[i], data.matrices[(i + 1) % NUM_CASES]);
+		}
+	});
+	double simdTime = Measure([&]() {
+		for (size_t i = 0; i < NUM_CASES; ++i) {
+			matrixResults[i] = data.matrices[i] * data.matrices[(i + 1) % NUM_CASES];
+		}
+	});
+	ReportTimes("Matrix3x4 multiply", scalarTime, simdTime);
+
+	scalarTime = Measure([&]() {
+		for (size_t i = 0; i < NUM_CASES; ++i) {
+			boxResults[i] = TransformedScalar(data.boxes[i], data.matrices[i]);
+		}
+	});
+	simdTime = Measure([&]() {
+		for (size_t i = 0; i < NUM_CASES; ++i) {
+			boxResults[i] = data.boxes[i].Transformed(data.matrices[i]);
+		}
+	});
+	ReportTimes("BoundingBox::Transformed", scalarTime, simdTime);
+
+	const Frustum& frustum = data.frustums[0];
+	scalarTime = Measure([&]() {
+		for (size_t i = 0; i < NUM_CASES; ++i) {
+			maskResults[i] = IsInsideMaskedScalar(frustum, data.boxes[i], 0x3f);
+		}
+	});
+	simdTime = Measure([&]() {
+		for (size_t i = 0; i < NUM_CASES; ++i) {
+			maskResults[i] = frustum.IsInsideMasked(data.boxes[i]);
+		}
+	});
+	ReportTimes("Frustum::IsInsideMasked", scalarTime, simdTime);
+#endif
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+// Check the SIMD math paths against the scalar code. Return true if the results match.
+bool TestSimdMath();
+// Time the SIMD math paths against the scalar code.
+void BenchmarkSimdMath();
+// Time the octree queries and the update with few moved drawables.
+void BenchmarkOctree();
@@ -0,0 +1,21 @@
+#include "Tests.h"
+#include <Turso3D/IO/Log.h>
+#include <cstring>
+
+// Run the tests, and the benchmarks if the first argument is "bench".
+// Return 0 if all tests passed.
+int main(int argc, char** argv)
+{
+	Turso3D::Log::Initialize("tests.log", true);
+
+	bool success = true;
+	success &= TestSimdMath();
+
+	if (argc > 1 && !strcmp(argv[1], "bench")) {
+		BenchmarkSimdMath();
+		BenchmarkOctree();
+	}
+
+	fmt::print("{:s}\n", success ? "All tests passed" : "Tests FAILED");
+	return success ? 0 : 1;
+}
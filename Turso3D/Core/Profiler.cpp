@@ -0,0 +1,301 @@
+#include <Turso3D/Core/Profiler.h>
+#include <Turso3D/IO/FileStream.h>
+#include <Turso3D/IO/Log.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+	using namespace Turso3D;
+
+	// Maximum events recorded per thread and capture. Further events are dropped.
+	constexpr size_t MAX_THREAD_EVENTS = 1 << 20;
+
+	enum ProfileEventType
+	{
+		EVENT_ZONE,
+		EVENT_COUNTER,
+		EVENT_FLOW_BEGIN,
+		EVENT_FLOW_END
+	};
+
+	struct ProfileEvent
+	{
+		// Event type.
+		ProfileEventType type;
+		// Event name.
+		const char* name;
+		// Optional zone detail.
+		std::string detail;
+		// Timestamp in microseconds.
+		double time;
+		// Zone duration in microseconds, or counter value.
+		double value;
+		// Flow id.
+		uint64_t id;
+	};
+
+	// Events of one thread. Only the owning thread writes to it.
+	struct ThreadBuffer
+	{
+		// Trace thread id.
+		unsigned tid;
+		// Thread name.
+		std::string name;
+		// Capture the events belong to.
+		unsigned capture;
+		// Recorded events.
+		std::vector<ProfileEvent> events;
+		// Number of dropped events.
+		size_t numDropped;
+	};
+
+	struct ProfilerState
+	{
+		// Capture active flag.
+		std::atomic<bool> capturing;
+		// Current capture number. Buffers holding events of an older capture are cleared on the next write.
+		std::atomic<unsigned> capture;
+		// Last assigned flow id. Ids are not reused, so that arrows never link the events of different frames.
+		std::atomic<uint64_t> flowId;
+		// Mutex for registering thread buffers.
+		std::mutex buffersMutex;
+		// Thread buffers.
+		std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+		// Profiler epoch.
+		std::chrono::steady_clock::time_point epoch;
+	};
+
+	ProfilerState& State()
+	{
+		static ProfilerState state {false, 0u, 0u, {}, {}, std::chrono::steady_clock::now()};
+		return state;
+	}
+
+	ThreadBuffer& LocalBuffer()
+	{
+		thread_local ThreadBuffer* buffer = nullptr;
+		if (!buffer) {
+			ProfilerState& state = State();
+			std::lock_guard<std::mutex> lock(state.buffersMutex);
+
+			std::unique_ptr<ThreadBuffer> newBuffer = std::make_unique<ThreadBuffer>();
+			newBuffer->tid = static_cast<unsigned>(state.buffers.size()) + 1;
+			newBuffer->name = Log::ThreadName();
+			newBuffer->capture = state.capture.load();
+			newBuffer->numDropped = 0;
+			buffer = newBuffer.get();
+			state.buffers.push_back(std::move(newBuffer));
+		}
+		return *buffer;
+	}
+
+	ProfileEvent* AddEvent(ProfileEventType type, const char* name, double time)
+	{
+		ThreadBuffer& buffer = LocalBuffer();
+
+		unsigned capture = State().capture.load(std::memory_order_relaxed);
+		if (buffer.capture != capture) {
+			buffer.events.clear();
+			buffer.numDropped = 0;
+			buffer.capture = capture;
+		}
+
+		if (buffer.events.size() >= MAX_THREAD_EVENTS) {
+			++buffer.numDropped;
+			return nullptr;
+		}
+
+		ProfileEvent& event = buffer.events.emplace_back();
+		event.type = type;
+		event.name = name;
+		event.time = time;
+		event.value = 0.0;
+		event.id = 0;
+		return &event;
+	}
+
+	void AppendEscaped(std::string& dest, std::string_view str)
+	{
+		for (char c : str) {
+			switch (c) {
+				case '"': dest.append("\\\""); break;
+				case '\\': dest.append("\\\\"); break;
+				case '\n': dest.append("\\n"); break;
+				case '\t': dest.append("\\t"); break;
+				default:
+					if (static_cast<unsigned char>(c) < 0x20) {
+						dest.append(fmt::format("\\u{:04x}", static_cast<unsigned>(c)));
+					} else {
+						dest.push_back(c);
+					}
+					break;
+			}
+		}
+	}
+}
+
+namespace Turso3D
+{
+	void Profiler::BeginCapture()
+	{
+		ProfilerState& state = State();
+		state.capture.fetch_add(1);
+		state.capturing.store(true);
+	}
+
+	void Profiler::EndCapture()
+	{
+		State().capturing.store(false);
+	}
+
+	bool Profiler::IsCapturing()
+	{
+		return State().capturing.load(std::memory_order_relaxed);
+	}
+
+	void Profiler::SetThreadName(const std::string& name)
+	{
+		LocalBuffer().name = name;
+	}
+
+	void Profiler::Counter(const char* name, double value)
+	{
+		if (!IsCapturing()) {
+			return;
+		}
+		if (ProfileEvent* event = AddEvent(EVENT_COUNTER, name, Now()); event) {
+			event->value = value;
+		}
+	}
+
+	uint64_t Profiler::FlowBegin()
+	{
+		if (!IsCapturing()) {
+			return 0;
+		}
+
+		uint64_t id = State().flowId.fetch_add(1, std::memory_order_relaxed) + 1;
+		if (ProfileEvent* event = AddEvent(EVENT_FLOW_BEGIN, "Dependency", Now()); event) {
+			event->id = id;
+		}
+		return id;
+	}
+
+	void Profiler::FlowEnd(uint64_t& id)
+	{
+		if (!id) {
+			return;
+		}
+
+		if (IsCapturing()) {
+			if (ProfileEvent* event = AddEvent(EVENT_FLOW_END, "Dependency", Now()); event) {
+				event->id = id;
+			}
+		}
+		id = 0;
+	}
+
+	void Profiler::Zone(const char* name, const std::string* detail, double start, double end)
+	{
+		// The capture may have ended while the zone was open, and the events may already be being exported
+		if (!IsCapturing()) {
+			return;
+		}
+
+		if (ProfileEvent* event = AddEvent(EVENT_ZONE, name, start); event) {
+			event->value = end - start;
+			if (detail) {
+				event->detail = *detail;
+			}
+		}
+	}
+
+	double Profiler::Now()
+	{
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - State().epoch).count();
+	}
+
+	std::string Profiler::ChromeTrace()
+	{
+		ProfilerState& state = State();
+		std::lock_guard<std::mutex> lock(state.buffersMutex);
+
+		unsigned capture = state.capture.load();
+		std::string json;
+		json.append("{\"traceEvents\":[\n");
+		bool first = true;
+
+		auto beginEvent = [&json, &first]() {
+			if (!first) {
+				json.append(",\n");
+			}
+			first = false;
+		};
+
+		for (const std::unique_ptr<ThreadBuffer>& buffer : state.buffers) {
+			beginEvent();
+			json.append(fmt::format("{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{:d},\"args\":{{\"name\":\"", buffer->tid));
+			AppendEscaped(json, buffer->name.empty() ? fmt::format("Thread{:d}", buffer->tid) : buffer->name);
+			json.append("\"}}");
+
+			if (buffer->capture != capture) {
+				continue;
+			}
+			if (buffer->numDropped) {
+				LOG_WARNING("Profiler dropped {:d} events of thread {:s}", buffer->numDropped, buffer->name);
+			}
+
+			for (const ProfileEvent& event : buffer->events) {
+				beginEvent();
+				json.append("{\"name\":\"");
+				AppendEscaped(json, event.name);
+				json.append("\",");
+
+				switch (event.type) {
+					case EVENT_ZONE:
+						json.append(fmt::format("\"cat\":\"cpu\",\"ph\":\"X\",\"ts\":{:.3f},\"dur\":{:.3f},\"pid\":1,\"tid\":{:d}", event.time, event.value, buffer->tid));
+						if (!event.detail.empty()) {
+							json.append(",\"args\":{\"detail\":\"");
+							AppendEscaped(json, event.detail);
+							json.append("\"}");
+						}
+						break;
+
+					case EVENT_COUNTER:
+						json.append(fmt::format("\"ph\":\"C\",\"ts\":{:.3f},\"pid\":1,\"tid\":{:d},\"args\":{{\"value\":{}}}", event.time, buffer->tid, event.value));
+						break;
+
+					case EVENT_FLOW_BEGIN:
+						json.append(fmt::format("\"cat\":\"task\",\"ph\":\"s\",\"id\":{:d},\"ts\":{:.3f},\"pid\":1,\"tid\":{:d}", event.id, event.time, buffer->tid));
+						break;
+
+					case EVENT_FLOW_END:
+						json.append(fmt::format("\"cat\":\"task\",\"ph\":\"f\",\"bp\":\"e\",\"id\":{:d},\"ts\":{:.3f},\"pid\":1,\"tid\":{:d}", event.id, event.time, buffer->tid));
+						break;
+				}
+				json.append("}");
+			}
+		}
+
+		json.append("\n]}\n");
+		return json;
+	}
+
+	bool Profiler::SaveChromeTrace(const std::string& fileName)
+	{
+		Log::Scope logScope {"Profiler::SaveChromeTrace"};
+
+		FileStream file;
+		if (!file.Open(fileName, FileStream::Mode::ReadWriteTruncate)) {
+			LOG_ERROR("Could not open {:s} for writing", fileName);
+			return false;
+		}
+
+		std::string json = ChromeTrace();
+		return file.Write(json.data(), json.size()) == json.size();
+	}
+}
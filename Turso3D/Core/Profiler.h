@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace Turso3D
+{
+	// CPU instrumentation profiler.
+	// Zones, counters and task dependency flows are recorded into per-thread buffers without locking while a capture is active,
+	// and exported as Chrome trace / Perfetto JSON.
+	// The TURSO3D_PROFILE macros compile to nothing unless TURSO3D_PROFILING is defined.
+	namespace Profiler
+	{
+		// Start a capture, discarding the events of the previous capture.
+		void BeginCapture();
+		// Stop the capture.
+		void EndCapture();
+		// Return whether a capture is active.
+		bool IsCapturing();
+
+		// Set the name of the calling thread in the trace.
+		void SetThreadName(const std::string& name);
+		// Record a counter value.
+		void Counter(const char* name, double value);
+		// Record the start of a dependency arrow from the current zone. Return a new flow id for ending the arrow, or 0 if not capturing.
+		uint64_t FlowBegin();
+		// Record the end of a dependency arrow into the current zone and reset the flow id. Does nothing if the id is 0.
+		void FlowEnd(uint64_t& id);
+		// Record a zone if still capturing. Used by ProfileZone.
+		void Zone(const char* name, const std::string* detail, double start, double end);
+
+		// Return microseconds since the profiler epoch.
+		double Now();
+
+		// Return the captured events as Chrome trace JSON.
+		// Must not be called while other threads are recording, e.g. call after WorkQueue::Complete() or after EndCapture().
+		std::string ChromeTrace();
+		// Save the captured events as Chrome trace JSON. Return true on success.
+		bool SaveChromeTrace(const std::string& fileName);
+	}
+
+	// Scoped CPU profiler zone.
+	class ProfileZone
+	{
+	public:
+		// Begin a zone. The name must outlive the capture, e.g. a string literal.
+		ProfileZone(const char* name_, const std::string* detail_ = nullptr) :
+			name(name_),
+			detail(detail_),
+			start(Profiler::IsCapturing() ? Profiler::Now() : -1.0)
+		{
+		}
+
+		// End the zone.
+		~ProfileZone()
+		{
+			if (start >= 0.0) {
+				Profiler::Zone(name, detail, start, Profiler::Now());
+			}
+		}
+
+	private:
+		// Zone name.
+		const char* name;
+		// Optional detail, such as a resource name. Must outlive the zone.
+		const std::string* detail;
+		// Start time, or negative if not capturing.
+		double start;
+	};
+}
+
+#ifdef TURSO3D_PROFILING
+#define TURSO3D_PROFILE(name) Turso3D::ProfileZone turso3dProfileZone {name}
+#define TURSO3D_PROFILE_DETAIL(name, detail) Turso3D::ProfileZone turso3dProfileZone {name, &(detail)}
+#define TURSO3D_PROFILE_COUNTER(name, value) Turso3D::Profiler::Counter(name, static_cast<double>(value))
+#define TURSO3D_PROFILE_THREAD(name) Turso3D::Profiler::SetThreadName(name)
+#define TURSO3D_PROFILE_FLOW_BEGIN(id) id = Turso3D::Profiler::FlowBegin()
+#define TURSO3D_PROFILE_FLOW_END(id) Turso3D::Profiler::FlowEnd(id)
+#else
+#define TURSO3D_PROFILE(name)
+#define TURSO3D_PROFILE_DETAIL(name, detail)
+#define TURSO3D_PROFILE_COUNTER(name, value)
+#define TURSO3D_PROFILE_THREAD(name)
+#define TURSO3D_PROFILE_FLOW_BEGIN(id)
+#define TURSO3D_PROFILE_FLOW_END(id)
+#endif
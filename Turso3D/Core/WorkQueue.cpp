@@ -1,4 +1,5 @@
 #include <Turso3D/Core/WorkQueue.h>
+#include <Turso3D/Core/Profiler.h>
 #include <Turso3D/IO/Log.h>
 #include <cassert>
 #include <string>
@@ -8,7 +9,9 @@ namespace Turso3D
 	thread_local unsigned WorkQueue::threadIndex = 0;
 
 	// ==========================================================================================
-	Task::Task()
+	Task::Task() :
+		name("Task"),
+		flowId(0)
 	{
 		numDependencies.store(0);
 	}
@@ -25,6 +28,7 @@ namespace Turso3D
 		numPendingTasks.store(0);
 
 		Log::ThreadName().assign("MainThread");
+		TURSO3D_PROFILE_THREAD(Log::ThreadName());
 	}
 
 	WorkQueue::~WorkQueue()
@@ -117,6 +121,25 @@ namespace Turso3D
 		}
 	}
 
+	void WorkQueue::QueueBackgroundTask(Task* task)
+	{
+		assert(task);
+		assert(task->numDependencies.load() == 0);
+
+		if (threads.size()) {
+			{
+				std::lock_guard<std::mutex> lock(queueMutex);
+				backgroundTasks.push(task);
+			}
+
+			signal.notify_one();
+		} else {
+			// If no threads, execute directly
+			TURSO3D_PROFILE(task->name);
+			task->Complete(0);
+		}
+	}
+
 	void WorkQueue::AddDependency(Task* task, Task* dependency)
 	{
 		assert(task);
@@ -189,22 +212,37 @@ namespace Turso3D
 		WorkQueue::threadIndex = threadIndex_;
 
 		Log::ThreadName().assign(fmt::format("WorkQueue{:d}", threadIndex_));
+		TURSO3D_PROFILE_THREAD(Log::ThreadName());
 
 		for (;;) {
 			Task* task;
+			bool background = false;
 			{
 				std::unique_lock<std::mutex> lock(queueMutex);
 				signal.wait(lock, [this]
 				{
-					return !tasks.empty() || shouldExit;
+					return !tasks.empty() || !backgroundTasks.empty() || shouldExit;
 				});
 
 				if (shouldExit) {
 					break;
 				}
 
-				task = tasks.front();
-				tasks.pop();
+				// Frame tasks take precedence over background tasks
+				if (!tasks.empty()) {
+					task = tasks.front();
+					tasks.pop();
+				} else {
+					task = backgroundTasks.front();
+					backgroundTasks.pop();
+					background = true;
+				}
+			}
+
+			if (background) {
+				TURSO3D_PROFILE(task->name);
+				task->Complete(threadIndex_);
+				continue;
 			}
 
 			numQueuedTasks.fetch_add(-1);
@@ -214,30 +252,38 @@ namespace Turso3D
 
 	void WorkQueue::CompleteTask(Task* task, unsigned threadIndex_)
 	{
-		task->Complete(threadIndex_);
-
-		if (task->dependentTasks.size()) {
-			// Queue dependent tasks now if no more dependencies left
-			for (auto it = task->dependentTasks.begin(); it != task->dependentTasks.end(); ++it) {
-				Task* dependentTask = *it;
-
-				if (dependentTask->numDependencies.fetch_add(-1) == 1) {
-					if (threads.size()) {
-						{
-							std::lock_guard<std::mutex> lock(queueMutex);
-							tasks.push(dependentTask);
+		{
+			// The zone ends before the pending counter is decremented, so that it is recorded when WorkQueue::Complete() returns
+			TURSO3D_PROFILE(task->name);
+			TURSO3D_PROFILE_FLOW_END(task->flowId);
+
+			task->Complete(threadIndex_);
+
+			if (task->dependentTasks.size()) {
+				// Queue dependent tasks now if no more dependencies left
+				for (auto it = task->dependentTasks.begin(); it != task->dependentTasks.end(); ++it) {
+					Task* dependentTask = *it;
+
+					if (dependentTask->numDependencies.fetch_add(-1) == 1) {
+						// The last finished dependency releases the task, which is the edge on the critical path
+						TURSO3D_PROFILE_FLOW_BEGIN(dependentTask->flowId);
+						if (threads.size()) {
+							{
+								std::lock_guard<std::mutex> lock(queueMutex);
+								tasks.push(dependentTask);
+							}
+							numQueuedTasks.fetch_add(1);
+
+							signal.notify_one();
+						} else {
+							// If no threads, execute directly
+							CompleteTask(dependentTask, 0);
 						}
-						numQueuedTasks.fetch_add(1);
-
-						signal.notify_one();
-					} else {
-						// If no threads, execute directly
-						CompleteTask(dependentTask, 0);
 					}
 				}
-			}
 
-			task->dependentTasks.clear();
+				task->dependentTasks.clear();
+			}
 		}
 
 		// Decrement pending task counter last, so that WorkQueue::Complete() will also wait for the potentially added dependent tasks
@@ -2,6 +2,7 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <cstdint>
 #include <mutex>
 #include <queue>
 #include <thread>
@@ -25,6 +26,10 @@ namespace Turso3D
 		// Dependency counter.
 		// Once zero, this task will be automatically queue itself.
 		std::atomic<int> numDependencies;
+		// Task name for profiling. Must outlive the task, e.g. a string literal.
+		const char* name;
+		// Profiler flow id of the dependency arrow into the task, or 0 if none.
+		uint64_t flowId;
 	};
 
 	// Free function task.
@@ -98,6 +103,10 @@ namespace Turso3D
 		// Queue several tasks execution.
 		// If no worker threads, completes immediately in the main thread.
 		void QueueTasks(size_t count, Task** tasks);
+		// Queue a long-running task, such as resource loading, for execution by the worker threads when they have no other tasks.
+		// Background tasks are not waited for or executed by Complete() and TryComplete(), and can not have dependencies. The task should signal its own completion.
+		// If no worker threads, completes immediately in the main thread.
+		void QueueBackgroundTask(Task* task);
 		// Add a dependency to a task.
 		// These tasks should not be queued via QueueTask(), they will instead queue themselves when the dependencies have finished.
 		void AddDependency(Task* task, Task* dependency);
@@ -131,6 +140,8 @@ namespace Turso3D
 		volatile bool shouldExit;
 		// Task queue.
 		std::queue<Task*> tasks;
+		// Background task queue.
+		std::queue<Task*> backgroundTasks;
 		// Worker threads.
 		std::vector<std::thread> threads;
 		// Amount of tasks in queue.
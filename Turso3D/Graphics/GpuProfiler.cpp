@@ -0,0 +1,271 @@
+#include <Turso3D/Graphics/GpuProfiler.h>
+#include <glew/glew.h>
+
+namespace
+{
+	using namespace Turso3D;
+
+	// Number of frames in flight. Results are read back when a frame slot is about to be reused at the latest.
+	constexpr size_t NUM_FRAMES = 4;
+	// Number of resolved frames per averaging period.
+	constexpr int AVERAGE_FRAMES = 30;
+
+	constexpr size_t NO_PARENT = static_cast<size_t>(-1);
+
+	struct ScopeRecord
+	{
+		// Scope name.
+		std::string name;
+		// Parent scope index within the frame.
+		size_t parent;
+		// Timestamp query at scope begin.
+		unsigned beginQuery;
+		// Timestamp query at scope end.
+		unsigned endQuery;
+	};
+
+	struct FrameRecord
+	{
+		// Scopes in the order they were begun.
+		std::vector<ScopeRecord> scopes;
+		// Query objects owned by the frame slot.
+		std::vector<unsigned> queries;
+		// Number of queries issued this frame.
+		size_t numQueries;
+		// Timestamp query at frame begin.
+		unsigned beginQuery;
+		// Timestamp query at frame end.
+		unsigned endQuery;
+		// Whether the frame has been issued but not read back.
+		bool pending;
+	};
+
+	struct ProfilerState
+	{
+		// Enabled flag, applied at the start of the next frame.
+		bool enabled;
+		// Whether a frame is being recorded.
+		bool inFrame;
+		// Ring of frames.
+		FrameRecord frames[NUM_FRAMES];
+		// Index of the frame being recorded.
+		size_t frameIndex;
+		// Open scope indices.
+		std::vector<size_t> scopeStack;
+
+		// Per-scope results.
+		std::vector<GpuProfileResult> results;
+		// Average frame time of the last averaging period.
+		float averageFrameTime;
+		// Accumulated frame time of the current averaging period.
+		float accumulatedFrameTime;
+		// Number of frames resolved in the current averaging period.
+		int periodFrames;
+
+		// Scratch buffers for resolving a frame.
+		std::vector<std::string> paths;
+		std::vector<size_t> resultIndices;
+	};
+
+	static ProfilerState State {};
+
+	unsigned IssueTimestamp(FrameRecord& frame)
+	{
+		if (frame.numQueries == frame.queries.size()) {
+			GLuint queryId;
+			glGenQueries(1, &queryId);
+			frame.queries.push_back(queryId);
+		}
+
+		unsigned queryId = frame.queries[frame.numQueries++];
+		glQueryCounter(queryId, GL_TIMESTAMP);
+		return queryId;
+	}
+
+	float ElapsedMs(unsigned beginQuery, unsigned endQuery)
+	{
+		GLuint64 begin = 0, end = 0;
+		glGetQueryObjectui64v(beginQuery, GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(endQuery, GL_QUERY_RESULT, &end);
+		return end > begin ? static_cast<float>(end - begin) * 1.0e-6f : 0.0f;
+	}
+
+	void ResolveFrame(FrameRecord& frame)
+	{
+		frame.pending = false;
+
+		for (GpuProfileResult& result : State.results) {
+			result.time = 0.0f;
+		}
+
+		// Match each scope to a result by its path, so that scopes entered several times per frame are summed
+		State.paths.resize(frame.scopes.size());
+		State.resultIndices.resize(frame.scopes.size());
+		for (size_t i = 0; i < frame.scopes.size(); ++i) {
+			const ScopeRecord& scope = frame.scopes[i];
+			std::string& path = State.paths[i];
+			path = scope.parent != NO_PARENT ? State.paths[scope.parent] + "/" + scope.name : scope.name;
+
+			size_t index = 0;
+			while (index < State.results.size() && State.results[index].path != path) {
+				++index;
+			}
+			if (index == State.results.size()) {
+				GpuProfileResult& result = State.results.emplace_back();
+				result.name = scope.name;
+				result.path = path;
+				result.depth = scope.parent != NO_PARENT ? State.results[State.resultIndices[scope.parent]].depth + 1 : 0;
+				result.time = 0.0f;
+				result.averageTime = 0.0f;
+				result.accumulatedTime = 0.0f;
+			}
+			State.resultIndices[i] = index;
+
+			State.results[index].time += ElapsedMs(scope.beginQuery, scope.endQuery);
+		}
+
+		State.accumulatedFrameTime += ElapsedMs(frame.beginQuery, frame.endQuery);
+		for (GpuProfileResult& result : State.results) {
+			result.accumulatedTime += result.time;
+		}
+
+		if (++State.periodFrames >= AVERAGE_FRAMES) {
+			State.averageFrameTime = State.accumulatedFrameTime / static_cast<float>(State.periodFrames);
+			State.accumulatedFrameTime = 0.0f;
+			for (GpuProfileResult& result : State.results) {
+				result.averageTime = result.accumulatedTime / static_cast<float>(State.periodFrames);
+				result.accumulatedTime = 0.0f;
+			}
+			State.periodFrames = 0;
+		}
+	}
+}
+
+namespace Turso3D
+{
+	void GpuProfiler::SetEnabled(bool enable)
+	{
+		State.enabled = enable;
+	}
+
+	bool GpuProfiler::IsEnabled()
+	{
+		return State.enabled;
+	}
+
+	void GpuProfiler::BeginFrame()
+	{
+		if (State.inFrame) {
+			EndFrame();
+		}
+		if (!State.enabled) {
+			return;
+		}
+
+		// Read back the issued frames oldest first. The oldest is in the slot about to be reused and must be read back now, but it was issued
+		// NUM_FRAMES frames ago, so this rarely waits. The newer frames are read back only if their results have arrived, without stalling
+		for (size_t i = 0; i < NUM_FRAMES; ++i) {
+			FrameRecord& pendingFrame = State.frames[(State.frameIndex + i) % NUM_FRAMES];
+			if (!pendingFrame.pending) {
+				continue;
+			}
+
+			if (i > 0) {
+				GLuint available = 0;
+				glGetQueryObjectuiv(pendingFrame.endQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+				if (!available) {
+					break;
+				}
+			}
+			ResolveFrame(pendingFrame);
+		}
+
+		FrameRecord& frame = State.frames[State.frameIndex % NUM_FRAMES];
+
+		frame.scopes.clear();
+		frame.numQueries = 0;
+		frame.beginQuery = IssueTimestamp(frame);
+
+		State.scopeStack.clear();
+		State.inFrame = true;
+	}
+
+	void GpuProfiler::EndFrame()
+	{
+		if (!State.inFrame) {
+			return;
+		}
+
+		while (!State.scopeStack.empty()) {
+			EndScope();
+		}
+
+		FrameRecord& frame = State.frames[State.frameIndex % NUM_FRAMES];
+		frame.endQuery = IssueTimestamp(frame);
+		frame.pending = true;
+
+		State.inFrame = false;
+		++State.frameIndex;
+	}
+
+	void GpuProfiler::BeginScope(const char* name)
+	{
+		if (!State.inFrame) {
+			return;
+		}
+
+		FrameRecord& frame = State.frames[State.frameIndex % NUM_FRAMES];
+		ScopeRecord& scope = frame.scopes.emplace_back();
+		scope.name = name;
+		scope.parent = State.scopeStack.empty() ? NO_PARENT : State.scopeStack.back();
+		scope.beginQuery = IssueTimestamp(frame);
+		scope.endQuery = 0;
+
+		State.scopeStack.push_back(frame.scopes.size() - 1);
+	}
+
+	void GpuProfiler::EndScope()
+	{
+		if (!State.inFrame || State.scopeStack.empty()) {
+			return;
+		}
+
+		FrameRecord& frame = State.frames[State.frameIndex % NUM_FRAMES];
+		frame.scopes[State.scopeStack.back()].endQuery = IssueTimestamp(frame);
+		State.scopeStack.pop_back();
+	}
+
+	const std::vector<GpuProfileResult>& GpuProfiler::Results()
+	{
+		return State.results;
+	}
+
+	float GpuProfiler::AverageFrameTime()
+	{
+		return State.averageFrameTime;
+	}
+
+	void GpuProfiler::ClearResults()
+	{
+		State.results.clear();
+		State.averageFrameTime = 0.0f;
+		State.accumulatedFrameTime = 0.0f;
+		State.periodFrames = 0;
+	}
+
+	void GpuProfiler::ShutDown()
+	{
+		for (FrameRecord& frame : State.frames) {
+			if (!frame.queries.empty()) {
+				glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+			}
+			frame.queries.clear();
+			frame.scopes.clear();
+			frame.numQueries = 0;
+			frame.pending = false;
+		}
+
+		State.scopeStack.clear();
+		State.inFrame = false;
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Turso3D
+{
+	// Measured GPU time of a profiler scope.
+	struct GpuProfileResult
+	{
+		// Scope name.
+		std::string name;
+		// Full path of the scope, including the parent scope names.
+		std::string path;
+		// Nesting depth, 0 for top level scopes.
+		int depth;
+		// GPU time in milliseconds of the most recent resolved frame. Scopes entered several times in a frame are summed.
+		float time;
+		// Average GPU time per frame in milliseconds over the last averaging period.
+		float averageTime;
+		// Accumulated time of the current averaging period.
+		float accumulatedTime;
+	};
+
+	// GPU pass profiler using timestamp queries.
+	// Queries are kept in a ring of frames and read back a few frames later, so that profiling does not stall the pipeline.
+	// Must only be used from the main thread.
+	namespace GpuProfiler
+	{
+		// Enable or disable profiling. Disabled by default.
+		void SetEnabled(bool enable);
+		// Return whether profiling is enabled.
+		bool IsEnabled();
+
+		// Begin a frame. Read back the results of the frames whose queries have completed.
+		void BeginFrame();
+		// End the frame.
+		void EndFrame();
+		// Begin a scope. Scopes may be nested.
+		void BeginScope(const char* name);
+		// End the current scope.
+		void EndScope();
+
+		// Return per-scope results in the order the scopes were first seen.
+		const std::vector<GpuProfileResult>& Results();
+		// Return the average GPU frame time in milliseconds.
+		float AverageFrameTime();
+		// Clear accumulated results.
+		void ClearResults();
+		// Release the query objects. Called by Graphics::ShutDown().
+		void ShutDown();
+	}
+
+	// Scoped GPU profiler block.
+	class GpuProfileScope
+	{
+	public:
+		// Begin the scope.
+		GpuProfileScope(const char* name)
+		{
+			GpuProfiler::BeginScope(name);
+		}
+
+		// End the scope.
+		~GpuProfileScope()
+		{
+			GpuProfiler::EndScope();
+		}
+	};
+}
+
+#define TURSO3D_GPU_PROFILE(name) Turso3D::GpuProfileScope turso3dGpuProfileScope {name}
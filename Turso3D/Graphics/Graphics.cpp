@@ -1,5 +1,6 @@
 #include <Turso3D/Graphics/Graphics.h>
 #include <Turso3D/Graphics/FrameBuffer.h>
+#include <Turso3D/Graphics/GpuProfiler.h>
 #include <Turso3D/Graphics/IndexBuffer.h>
 #include <Turso3D/Graphics/Shader.h>
 #include <Turso3D/Graphics/ShaderProgram.h>
@@ -135,6 +136,12 @@ namespace
 		FrameBuffer* boundReadBuffer;
 		ShaderProgram* boundProgram;
 		UniformBuffer* boundUniformBuffers[MAX_CONSTANT_BUFFER_SLOTS];
+		size_t boundUniformBufferOffsets[MAX_CONSTANT_BUFFER_SLOTS];
+		size_t boundUniformBufferSizes[MAX_CONSTANT_BUFFER_SLOTS];
+		// Required alignment of uniform buffer range offsets.
+		size_t uniformBufferOffsetAlignment;
+		// Maximum width and height of a 2D texture.
+		int maxTextureSize;
 
 		unsigned activeTargets[MAX_TEXTURE_UNITS];
 		Texture* boundTextures[MAX_TEXTURE_UNITS];
@@ -167,6 +174,9 @@ namespace
 		VAO* boundVAO;
 		// Cache map for VAOs.
 		std::vector<VAO> vaoCache;
+
+		// Rendering statistics.
+		GraphicsStats stats;
 	};
 
 #ifdef _DEBUG
@@ -191,6 +201,13 @@ namespace
 
 	static GraphicsState State;
 	static bool StateInitialized = false;
+
+	void CountDraw(PrimitiveType type, size_t drawCount, size_t instanceCount)
+	{
+		++State.stats.drawCalls;
+		State.stats.instances += instanceCount;
+		State.stats.primitives += (type == PT_TRIANGLE_LIST ? drawCount / 3 : drawCount / 2) * instanceCount;
+	}
 }
 
 // ==========================================================================================
@@ -260,6 +277,14 @@ namespace Turso3D
 			return false;
 		}
 
+		GLint offsetAlignmentUBO = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignmentUBO);
+		State.uniformBufferOffsetAlignment = std::max(offsetAlignmentUBO, 1);
+
+		GLint maxTextureSize = 0;
+		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+		State.maxTextureSize = maxTextureSize;
+
 		if (!GLEW_VERSION_4_0 && !GLEW_ARB_texture_cube_map_array) {
 			LOG_ERROR("ARB_texture_cube_map_array not supported.");
 			return false;
@@ -346,6 +371,8 @@ namespace Turso3D
 
 	void Graphics::ShutDown()
 	{
+		GpuProfiler::ShutDown();
+
 		glBindVertexArray(0);
 		glDeleteVertexArrays(1, &State.defaultVAO);
 		for (size_t i = 0; i < State.vaoCache.size(); ++i) {
@@ -644,6 +671,7 @@ namespace Turso3D
 
 				glBindVertexArray(vao->vao);
 				State.boundVAO = vao;
+				++State.stats.vaoSwitches;
 
 				// Vertex binding index
 				unsigned index = 0;
@@ -678,6 +706,7 @@ namespace Turso3D
 				vao = &*it;
 				glBindVertexArray(vao->vao);
 				State.boundVAO = vao;
+				++State.stats.vaoSwitches;
 			}
 		}
 
@@ -708,6 +737,7 @@ namespace Turso3D
 		if (State.boundVAO) {
 			glBindVertexArray(State.defaultVAO);
 			State.boundVAO = nullptr;
+			++State.stats.vaoSwitches;
 		}
 	}
 
@@ -752,6 +782,7 @@ namespace Turso3D
 		if (program != State.boundProgram) {
 			if (program) {
 				glUseProgram(program->GLProgram());
+				++State.stats.programSwitches;
 			}
 			State.boundProgram = program;
 		}
@@ -759,12 +790,31 @@ namespace Turso3D
 
 	void Graphics::BindUniformBuffer(size_t index, UniformBuffer* buffer)
 	{
-		if (buffer != State.boundUniformBuffers[index]) {
-			glBindBufferRange(GL_UNIFORM_BUFFER, (GLuint)index, buffer ? buffer->GLBuffer() : 0, 0, buffer ? buffer->Size() : 0);
+		BindUniformBuffer(index, buffer, 0, buffer ? buffer->Size() : 0);
+	}
+
+	void Graphics::BindUniformBuffer(size_t index, UniformBuffer* buffer, size_t offset, size_t size)
+	{
+		assert(offset % State.uniformBufferOffsetAlignment == 0);
+
+		if (buffer != State.boundUniformBuffers[index] || offset != State.boundUniformBufferOffsets[index] || size != State.boundUniformBufferSizes[index]) {
+			glBindBufferRange(GL_UNIFORM_BUFFER, (GLuint)index, buffer ? buffer->GLBuffer() : 0, offset, size);
 			State.boundUniformBuffers[index] = buffer;
+			State.boundUniformBufferOffsets[index] = offset;
+			State.boundUniformBufferSizes[index] = size;
 		}
 	}
 
+	size_t Graphics::UniformBufferOffsetAlignment()
+	{
+		return State.uniformBufferOffsetAlignment;
+	}
+
+	int Graphics::MaxTextureSize()
+	{
+		return State.maxTextureSize;
+	}
+
 	void Graphics::BindTexture(size_t unit, Texture* texture, bool force)
 	{
 		assert(unit < MAX_TEXTURE_UNITS);
@@ -789,6 +839,7 @@ namespace Turso3D
 
 			glBindTexture(target, texture->GLTexture());
 			activeTarget = target;
+			++State.stats.textureSwitches;
 
 		} else if (activeTarget) {
 			glBindTexture(activeTarget, 0);
@@ -854,6 +905,7 @@ namespace Turso3D
 	void Graphics::Draw(PrimitiveType type, size_t drawStart, size_t drawCount)
 	{
 		glDrawArrays(glPrimitiveTypes[type], (GLint)drawStart, (GLsizei)drawCount);
+		CountDraw(type, drawCount, 1);
 	}
 
 	void Graphics::DrawIndexed(PrimitiveType type, size_t drawStart, size_t drawCount)
@@ -861,11 +913,13 @@ namespace Turso3D
 		size_t index_size = State.boundVAO->indexBuffer->IndexSize();
 		GLenum index_type = (index_size == sizeof(unsigned short)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
 		glDrawElements(glPrimitiveTypes[type], (GLsizei)drawCount, index_type, (const void*)(drawStart * index_size));
+		CountDraw(type, drawCount, 1);
 	}
 
 	void Graphics::DrawInstanced(PrimitiveType type, size_t drawStart, size_t drawCount, size_t instanceCount)
 	{
 		glDrawArraysInstanced(glPrimitiveTypes[type], (GLint)drawStart, (GLsizei)drawCount, (GLsizei)instanceCount);
+		CountDraw(type, drawCount, instanceCount);
 	}
 
 	void Graphics::DrawIndexedInstanced(PrimitiveType type, size_t drawStart, size_t drawCount, size_t instanceCount)
@@ -873,6 +927,7 @@ namespace Turso3D
 		size_t index_size = State.boundVAO->indexBuffer->IndexSize();
 		GLenum index_type = (index_size == sizeof(unsigned short)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
 		glDrawElementsInstanced(glPrimitiveTypes[type], (GLsizei)drawCount, index_type, (const void*)(drawStart * index_size), (GLsizei)instanceCount);
+		CountDraw(type, drawCount, instanceCount);
 	}
 
 	void Graphics::DrawQuad()
@@ -886,6 +941,11 @@ namespace Turso3D
 		glfwSwapBuffers(State.window);
 	}
 
+	const GraphicsStats& Graphics::Stats()
+	{
+		return State.stats;
+	}
+
 	unsigned Graphics::BeginOcclusionQuery(void* object)
 	{
 		GLuint queryId;
@@ -48,6 +48,24 @@ namespace Turso3D
 		bool enabled;
 	};
 
+	// Cumulative rendering statistics since initialization.
+	// Difference two snapshots to measure a range of rendering.
+	struct GraphicsStats
+	{
+		// Draw calls.
+		size_t drawCalls;
+		// Rendered instances, 1 per non-instanced draw call.
+		size_t instances;
+		// Rendered primitives (triangles or lines) including all instances.
+		size_t primitives;
+		// Shader program changes.
+		size_t programSwitches;
+		// Texture binding changes.
+		size_t textureSwitches;
+		// Vertex array object changes.
+		size_t vaoSwitches;
+	};
+
 #ifdef _DEBUG
 	class GraphicsMarker
 	{
@@ -143,6 +161,13 @@ namespace Turso3D
 		// Bind the uniform buffer.
 		// If buffer is nullptr, the buffer slot is unbound.
 		void BindUniformBuffer(size_t index, UniformBuffer* buffer = nullptr);
+		// Bind a range of the uniform buffer.
+		// The offset must be a multiple of the uniform buffer offset alignment.
+		void BindUniformBuffer(size_t index, UniformBuffer* buffer, size_t offset, size_t size);
+		// Return the required alignment of uniform buffer range offsets in bytes.
+		size_t UniformBufferOffsetAlignment();
+		// Return the maximum width and height of a 2D texture in texels. Queried on initialization, so can be called from any thread.
+		int MaxTextureSize();
 		// Bind to texture unit.
 		// No-op if already bound (unless force is true).
 		// If texture is nullptr, the texture unit is unbound.
@@ -171,6 +196,8 @@ namespace Turso3D
 
 		// Present the contents of the backbuffer.
 		void Present();
+		// Return the cumulative rendering statistics.
+		const GraphicsStats& Stats();
 
 		// Begin an occlusion query and associate an object with it for checking results.
 		// Return the query ID.
@@ -0,0 +1,300 @@
+#include <Turso3D/Graphics/RenderGraph.h>
+#include <Turso3D/Graphics/FrameBuffer.h>
+#include <Turso3D/Graphics/GpuProfiler.h>
+#include <Turso3D/Graphics/Graphics.h>
+#include <Turso3D/Graphics/Texture.h>
+#include <Turso3D/IO/Log.h>
+#include <algorithm>
+
+namespace
+{
+	using namespace Turso3D;
+
+	constexpr size_t NO_PASS = static_cast<size_t>(-1);
+
+	// Number of compiles a pooled target may stay unused before it is released.
+	constexpr unsigned MAX_UNUSED_COMPILES = 8;
+}
+
+namespace Turso3D
+{
+	struct RenderGraph::ResourceNode
+	{
+		// Resource name for diagnostics.
+		std::string name;
+		// Texture description.
+		RenderTextureDesc desc;
+		// Imported texture, or null for the backbuffer and transients.
+		Texture* importedTexture;
+		// Imported framebuffer.
+		FrameBuffer* importedFbo;
+		// Imported flag.
+		bool imported;
+		// Graph output flag.
+		bool output;
+		// Pooled target assigned by Compile().
+		PooledTarget* target;
+		// First and last position in the execution order that uses the resource.
+		size_t firstUse;
+		size_t lastUse;
+	};
+
+	struct RenderGraph::PassNode
+	{
+		// Pass name for graphics markers and diagnostics.
+		std::string name;
+		// Execution function.
+		RenderPassFunction function;
+		// Resources read by the pass.
+		std::vector<size_t> reads;
+		// Resources written by the pass.
+		std::vector<size_t> writes;
+		// Passes that wrote the resources read by this pass.
+		std::vector<size_t> producers;
+		// Live flag, set when the pass contributes to an output.
+		bool live;
+	};
+
+	struct RenderGraph::PooledTarget
+	{
+		// Texture description.
+		RenderTextureDesc desc;
+		// Texture.
+		std::unique_ptr<Texture> texture;
+		// Framebuffer rendering to the texture.
+		std::unique_ptr<FrameBuffer> fbo;
+		// Whether the target is assigned to a resource at the current point of the allocation sweep.
+		bool inUse;
+		// Whether the target was used by the last compile.
+		bool used;
+		// Number of consecutive compiles the target has not been used.
+		unsigned unusedCompiles;
+	};
+
+	// ==========================================================================================
+	RenderGraph::RenderGraph()
+	{
+	}
+
+	RenderGraph::~RenderGraph()
+	{
+	}
+
+	void RenderGraph::Reset()
+	{
+		resources.clear();
+		passes.clear();
+		executionOrder.clear();
+	}
+
+	size_t RenderGraph::ImportTexture(const std::string& name, Texture* texture, FrameBuffer* fbo)
+	{
+		ResourceNode& res = resources.emplace_back();
+		res.name = name;
+		res.desc = texture ? RenderTextureDesc {texture->Size2D(), texture->Format(), texture->FilterMode()} : RenderTextureDesc {Graphics::RenderSize(), FORMAT_NONE, FILTER_POINT};
+		res.importedTexture = texture;
+		res.importedFbo = fbo;
+		res.imported = true;
+		res.output = false;
+		res.target = nullptr;
+		res.firstUse = NO_PASS;
+		res.lastUse = NO_PASS;
+		return resources.size() - 1;
+	}
+
+	size_t RenderGraph::CreateTexture(const std::string& name, const RenderTextureDesc& desc)
+	{
+		ResourceNode& res = resources.emplace_back();
+		res.name = name;
+		res.desc = desc;
+		res.importedTexture = nullptr;
+		res.importedFbo = nullptr;
+		res.imported = false;
+		res.output = false;
+		res.target = nullptr;
+		res.firstUse = NO_PASS;
+		res.lastUse = NO_PASS;
+		return resources.size() - 1;
+	}
+
+	size_t RenderGraph::AddPass(const std::string& name, RenderPassFunction function)
+	{
+		PassNode& pass = passes.emplace_back();
+		pass.name = name;
+		pass.function = std::move(function);
+		pass.live = false;
+		return passes.size() - 1;
+	}
+
+	void RenderGraph::Read(size_t pass, size_t resource)
+	{
+		passes[pass].reads.push_back(resource);
+	}
+
+	void RenderGraph::Write(size_t pass, size_t resource)
+	{
+		passes[pass].writes.push_back(resource);
+	}
+
+	void RenderGraph::SetOutput(size_t resource)
+	{
+		resources[resource].output = true;
+	}
+
+	bool RenderGraph::Compile()
+	{
+		Log::Scope logScope {"RenderGraph::Compile"};
+
+		bool success = true;
+
+		// Find the producer of each read, walking the passes in declaration order
+		std::vector<size_t> lastWriter(resources.size(), NO_PASS);
+		for (size_t i = 0; i < passes.size(); ++i) {
+			PassNode& pass = passes[i];
+			pass.producers.clear();
+			pass.live = false;
+
+			for (size_t r : pass.reads) {
+				if (lastWriter[r] != NO_PASS) {
+					pass.producers.push_back(lastWriter[r]);
+				} else if (!resources[r].imported) {
+					LOG_ERROR("Pass {:s} reads transient texture {:s} before it is written", pass.name, resources[r].name);
+					success = false;
+				}
+			}
+			for (size_t r : pass.writes) {
+				lastWriter[r] = i;
+			}
+		}
+
+		// Cull passes that do not contribute to an output
+		std::vector<size_t> stack;
+		for (size_t r = 0; r < resources.size(); ++r) {
+			if (resources[r].output && lastWriter[r] != NO_PASS) {
+				stack.push_back(lastWriter[r]);
+			}
+		}
+		while (!stack.empty()) {
+			size_t i = stack.back();
+			stack.pop_back();
+			if (passes[i].live) {
+				continue;
+			}
+			passes[i].live = true;
+			stack.insert(stack.end(), passes[i].producers.begin(), passes[i].producers.end());
+		}
+
+		executionOrder.clear();
+		for (size_t i = 0; i < passes.size(); ++i) {
+			if (passes[i].live) {
+				executionOrder.push_back(i);
+			}
+		}
+
+		// Compute the lifetimes of the transient resources
+		for (ResourceNode& res : resources) {
+			res.target = nullptr;
+			res.firstUse = NO_PASS;
+			res.lastUse = NO_PASS;
+		}
+		for (size_t pos = 0; pos < executionOrder.size(); ++pos) {
+			const PassNode& pass = passes[executionOrder[pos]];
+			for (const std::vector<size_t>* accesses : {&pass.reads, &pass.writes}) {
+				for (size_t r : *accesses) {
+					ResourceNode& res = resources[r];
+					if (res.firstUse == NO_PASS) {
+						res.firstUse = pos;
+					}
+					res.lastUse = pos;
+				}
+			}
+		}
+
+		// Release targets that have stayed unused for too long, then allocate.
+		// A target is returned to the pool after the last pass using its resource, so later resources with an equal description alias it
+		for (auto it = pool.begin(); it != pool.end();) {
+			PooledTarget* target = it->get();
+			target->unusedCompiles = target->used ? 0 : target->unusedCompiles + 1;
+			target->used = false;
+			target->inUse = false;
+			if (target->unusedCompiles > MAX_UNUSED_COMPILES) {
+				it = pool.erase(it);
+			} else {
+				++it;
+			}
+		}
+
+		for (size_t pos = 0; pos < executionOrder.size(); ++pos) {
+			for (ResourceNode& res : resources) {
+				if (!res.imported && res.firstUse == pos) {
+					res.target = AcquireTarget(res.desc);
+				}
+			}
+			for (ResourceNode& res : resources) {
+				if (res.target && res.lastUse == pos) {
+					res.target->inUse = false;
+				}
+			}
+		}
+
+		return success;
+	}
+
+	void RenderGraph::Execute()
+	{
+		for (size_t i : executionOrder) {
+			const PassNode& pass = passes[i];
+			TURSO3D_GRAPHICS_MARKER(pass.name.c_str());
+			TURSO3D_GPU_PROFILE(pass.name.c_str());
+			pass.function(*this);
+		}
+	}
+
+	const RenderTextureDesc& RenderGraph::GetDesc(size_t resource) const
+	{
+		return resources[resource].desc;
+	}
+
+	Texture* RenderGraph::GetTexture(size_t resource) const
+	{
+		const ResourceNode& res = resources[resource];
+		if (res.imported) {
+			return res.importedTexture;
+		}
+		return res.target ? res.target->texture.get() : nullptr;
+	}
+
+	FrameBuffer* RenderGraph::GetFramebuffer(size_t resource) const
+	{
+		const ResourceNode& res = resources[resource];
+		if (res.imported) {
+			return res.importedFbo;
+		}
+		return res.target ? res.target->fbo.get() : nullptr;
+	}
+
+	RenderGraph::PooledTarget* RenderGraph::AcquireTarget(const RenderTextureDesc& desc)
+	{
+		for (const std::unique_ptr<PooledTarget>& target : pool) {
+			if (!target->inUse && target->desc == desc) {
+				target->inUse = true;
+				target->used = true;
+				return target.get();
+			}
+		}
+
+		std::unique_ptr<PooledTarget> target = std::make_unique<PooledTarget>();
+		target->desc = desc;
+		target->texture = std::make_unique<Texture>();
+		target->texture->Define(TARGET_2D, desc.size, desc.format);
+		target->texture->DefineSampler(desc.filter, ADDRESS_CLAMP, ADDRESS_CLAMP, ADDRESS_CLAMP);
+		target->fbo = std::make_unique<FrameBuffer>();
+		target->fbo->Define(target->texture.get(), nullptr);
+		target->inUse = true;
+		target->used = true;
+		target->unusedCompiles = 0;
+
+		pool.push_back(std::move(target));
+		return pool.back().get();
+	}
+}
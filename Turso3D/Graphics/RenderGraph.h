@@ -0,0 +1,105 @@
+#pragma once
+
+#include <Turso3D/Graphics/GraphicsDefs.h>
+#include <Turso3D/Math/IntVector2.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Turso3D
+{
+	class FrameBuffer;
+	class Texture;
+	class RenderGraph;
+
+	// Description of a transient render graph texture.
+	// Transient textures with equal descriptions may share the same GPU texture when their lifetimes don't overlap.
+	struct RenderTextureDesc
+	{
+		// Test for equality with another description.
+		bool operator == (const RenderTextureDesc& rhs) const
+		{
+			return size == rhs.size && format == rhs.format && filter == rhs.filter;
+		}
+
+		// Texture dimensions.
+		IntVector2 size;
+		// Texture format.
+		ImageFormat format;
+		// Texture filter mode. Addressing is always clamped.
+		TextureFilterMode filter;
+	};
+
+	// Render graph pass execution function.
+	typedef std::function<void(const RenderGraph& graph)> RenderPassFunction;
+
+	// Frame graph for rendering passes that communicate through textures.
+	// Passes declare what they read and write; Compile() culls the passes that do not contribute to an output,
+	// and assigns pooled textures and framebuffers to the transient resources for the span of passes that use them.
+	// Passes execute in declaration order, which also defines the order of accesses to each resource.
+	// The graph is rebuilt each frame by calling Reset() and declaring the passes again, while the texture pool persists.
+	class RenderGraph
+	{
+		struct ResourceNode;
+		struct PassNode;
+		struct PooledTarget;
+
+	public:
+		// Construct.
+		RenderGraph();
+		// Destruct.
+		~RenderGraph();
+
+		// Clear all passes and resources for the next frame. Pooled textures are kept.
+		void Reset();
+
+		// Import an externally owned texture, with an optional framebuffer to render to it.
+		// Import a null texture and framebuffer to refer to the backbuffer.
+		// Imported resources are never aliased.
+		size_t ImportTexture(const std::string& name, Texture* texture, FrameBuffer* fbo = nullptr);
+		// Declare a transient texture, which is allocated from the pool only while it is in use.
+		size_t CreateTexture(const std::string& name, const RenderTextureDesc& desc);
+		// Add a pass. Return its index.
+		size_t AddPass(const std::string& name, RenderPassFunction function);
+		// Declare that a pass reads a resource.
+		void Read(size_t pass, size_t resource);
+		// Declare that a pass writes a resource.
+		// A pass that both reads and writes a resource (e.g. blending) should declare both.
+		void Write(size_t pass, size_t resource);
+		// Mark a resource as an output of the graph. Passes not contributing to any output are culled.
+		void SetOutput(size_t resource);
+
+		// Cull passes and allocate the transient resources.
+		// Return false if a pass reads a transient resource that no earlier pass writes.
+		bool Compile();
+		// Execute the compiled passes.
+		void Execute();
+
+		// Return the description of a resource. Imported resources are described by their texture.
+		const RenderTextureDesc& GetDesc(size_t resource) const;
+		// Return the texture of a resource. Only valid during Execute().
+		Texture* GetTexture(size_t resource) const;
+		// Return the framebuffer that renders to a resource. Only valid during Execute().
+		// Return null for the backbuffer.
+		FrameBuffer* GetFramebuffer(size_t resource) const;
+		// Return number of passes executed by the last compile.
+		size_t NumExecutedPasses() const { return executionOrder.size(); }
+		// Return number of textures in the pool.
+		size_t NumPooledTextures() const { return pool.size(); }
+
+	private:
+		// Acquire a pooled target matching the description, which is not in use. Create a new one if necessary.
+		PooledTarget* AcquireTarget(const RenderTextureDesc& desc);
+
+	private:
+		// Resources declared this frame.
+		std::vector<ResourceNode> resources;
+		// Passes declared this frame.
+		std::vector<PassNode> passes;
+		// Indices of the passes to execute in order.
+		std::vector<size_t> executionOrder;
+		// Pooled transient textures and their framebuffers.
+		std::vector<std::unique_ptr<PooledTarget>> pool;
+	};
+}
@@ -1,4 +1,5 @@
 #include <Turso3D/Graphics/Shader.h>
+#include <Turso3D/Core/Profiler.h>
 #include <Turso3D/Graphics/ShaderProgram.h>
 #include <Turso3D/IO/Log.h>
 #include <Turso3D/IO/MemoryStream.h>
@@ -337,6 +338,8 @@ namespace Turso3D
 
 	unsigned Shader::Compile(ShaderType type, const ShaderPermutation& permutation)
 	{
+		TURSO3D_PROFILE_DETAIL("Shader::Compile", Name());
+
 		std::string shader_code;
 		shader_code.reserve(version.length() + sharedCode.length() + sourceCode[type].length());
 
@@ -1,4 +1,5 @@
 ﻿#include <Turso3D/Graphics/ShaderProgram.h>
+#include <Turso3D/Core/Profiler.h>
 #include <Turso3D/Graphics/Graphics.h>
 #include <Turso3D/IO/Log.h>
 #include <glew/glew.h>
@@ -114,6 +115,8 @@ namespace Turso3D
 			return false;
 		}
 
+		TURSO3D_PROFILE("ShaderProgram::Link");
+
 		program = glCreateProgram();
 		glAttachShader(program, vs);
 		glAttachShader(program, fs);
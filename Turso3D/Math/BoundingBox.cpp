@@ -1,6 +1,7 @@
 #include <Turso3D/Math/BoundingBox.h>
 #include <Turso3D/Math/Frustum.h>
 #include <Turso3D/Math/Polyhedron.h>
+#include <Turso3D/Math/Simd.h>
 #include <utility>
 #include <cstdlib>
 
@@ -114,6 +115,28 @@ namespace Turso3D
 	{
 		Vector3 oldCenter = Center();
 		Vector3 oldEdge = max - oldCenter;
+#ifdef TURSO3D_SIMD
+		// Transpose the rows to columns, so that the center and edge are transformed by scaling and summing the columns
+		Simd::Float4 c0 = Simd::Load(&transform.m00);
+		Simd::Float4 c1 = Simd::Load(&transform.m10);
+		Simd::Float4 c2 = Simd::Load(&transform.m20);
+		Simd::Float4 c3 = Simd::Zero();
+		Simd::Transpose(c0, c1, c2, c3);
+
+		Simd::Float4 newCenter = Simd::Mul(c0, Simd::Splat(oldCenter.x));
+		newCenter = Simd::Add(newCenter, Simd::Mul(c1, Simd::Splat(oldCenter.y)));
+		newCenter = Simd::Add(newCenter, Simd::Mul(c2, Simd::Splat(oldCenter.z)));
+		newCenter = Simd::Add(newCenter, c3);
+
+		Simd::Float4 newEdge = Simd::Mul(Simd::Abs(c0), Simd::Splat(oldEdge.x));
+		newEdge = Simd::Add(newEdge, Simd::Mul(Simd::Abs(c1), Simd::Splat(oldEdge.y)));
+		newEdge = Simd::Add(newEdge, Simd::Mul(Simd::Abs(c2), Simd::Splat(oldEdge.z)));
+
+		float newMin[4], newMax[4];
+		Simd::Store(newMin, Simd::Sub(newCenter, newEdge));
+		Simd::Store(newMax, Simd::Add(newCenter, newEdge));
+		return BoundingBox(Vector3(newMin[0], newMin[1], newMin[2]), Vector3(newMax[0], newMax[1], newMax[2]));
+#else
 		Vector3 newCenter = transform * oldCenter;
 		Vector3 newEdge(
 			std::abs(transform.m00) * oldEdge.x + std::abs(transform.m01) * oldEdge.y + std::abs(transform.m02) * oldEdge.z,
@@ -121,6 +144,7 @@ namespace Turso3D
 			std::abs(transform.m20) * oldEdge.x + std::abs(transform.m21) * oldEdge.y + std::abs(transform.m22) * oldEdge.z
 		);
 		return BoundingBox(newCenter - newEdge, newCenter + newEdge);
+#endif
 	}
 
 	Rect BoundingBox::Projected(const Matrix4& projection) const
@@ -188,6 +188,8 @@ namespace Turso3D
 		void Merge(const Sphere& sphere);
 		// Clip with another bounding box.
 		void Clip(const BoundingBox& box);
+		// Move by an offset.
+		void Translate(const Vector3& offset) { min += offset; max += offset; }
 		// Transform with a 3x3 matrix.
 		void Transform(const Matrix3& transform);
 		// Transform with a 3x4 matrix.
@@ -92,6 +92,9 @@ namespace Turso3D
 		for (size_t i = 0; i < NUM_FRUSTUM_VERTICES; ++i) {
 			vertices[i] = rhs.vertices[i];
 		}
+#ifdef TURSO3D_SIMD
+		simdPlanes = rhs.simdPlanes;
+#endif
 		return *this;
 	}
 
@@ -237,5 +240,19 @@ namespace Turso3D
 				planes[i].d = -planes[i].d;
 			}
 		}
+
+#ifdef TURSO3D_SIMD
+		for (size_t i = 0; i < NUM_SIMD_FRUSTUM_PLANES; ++i) {
+			// Padding planes have a zero normal and distance, so any box is inside them
+			const Plane* plane = i < NUM_FRUSTUM_PLANES ? &planes[i] : nullptr;
+			simdPlanes.normalX[i] = plane ? plane->normal.x : 0.0f;
+			simdPlanes.normalY[i] = plane ? plane->normal.y : 0.0f;
+			simdPlanes.normalZ[i] = plane ? plane->normal.z : 0.0f;
+			simdPlanes.d[i] = plane ? plane->d : 0.0f;
+			simdPlanes.absNormalX[i] = plane ? plane->absNormal.x : 0.0f;
+			simdPlanes.absNormalY[i] = plane ? plane->absNormal.y : 0.0f;
+			simdPlanes.absNormalZ[i] = plane ? plane->absNormal.z : 0.0f;
+		}
+#endif
 	}
 }
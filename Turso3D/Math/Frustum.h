@@ -3,6 +3,7 @@
 #include <Turso3D/Math/BoundingBox.h>
 #include <Turso3D/Math/Matrix3x4.h>
 #include <Turso3D/Math/Plane.h>
+#include <Turso3D/Math/Simd.h>
 #include <Turso3D/Math/Sphere.h>
 
 namespace Turso3D
@@ -10,6 +11,8 @@ namespace Turso3D
 	constexpr size_t NUM_FRUSTUM_PLANES = 6;
 	constexpr size_t NUM_FRUSTUM_VERTICES = 8;
 	constexpr size_t NUM_SAT_AXES = 3 + 5 + 3 * 6;
+	// Number of planes in the transposed plane data, padded to a multiple of 4.
+	constexpr size_t NUM_SIMD_FRUSTUM_PLANES = 8;
 
 	// Frustum planes.
 	enum FrustumPlane
@@ -102,6 +105,14 @@ namespace Turso3D
 		// Test if a bounding box is inside, outside or intersects.
 		Intersection IsInside(const BoundingBox& box) const
 		{
+#ifdef TURSO3D_SIMD
+			unsigned outsideMask, insideMask;
+			TestPlanes(box, outsideMask, insideMask);
+			if (outsideMask) {
+				return OUTSIDE;
+			}
+			return (insideMask & 0x3f) == 0x3f ? INSIDE : INTERSECTS;
+#else
 			Vector3 center = box.Center();
 			Vector3 edge = center - box.min;
 			bool allInside = true;
@@ -119,6 +130,7 @@ namespace Turso3D
 			}
 
 			return allInside ? INSIDE : INTERSECTS;
+#endif
 		}
 
 		// Test if a bounding box is inside, outside or intersects.
@@ -126,6 +138,14 @@ namespace Turso3D
 		// Returns updated plane mask: 0xff if outside, 0x00 if completely inside, otherwise intersecting.
 		unsigned char IsInsideMasked(const BoundingBox& box, unsigned char planeMask = 0x3f) const
 		{
+#ifdef TURSO3D_SIMD
+			unsigned outsideMask, insideMask;
+			TestPlanes(box, outsideMask, insideMask);
+			if (outsideMask & planeMask) {
+				return 0xff;
+			}
+			return planeMask & ~insideMask;
+#else
 			Vector3 center = box.Center();
 			Vector3 edge = center - box.min;
 
@@ -146,11 +166,17 @@ namespace Turso3D
 			}
 
 			return planeMask;
+#endif
 		}
 
 		// Test if a bounding box is inside, using a mask to skip unnecessary planes.
 		Intersection IsInsideMaskedFast(const BoundingBox& box, unsigned char planeMask = 0x3f) const
 		{
+#ifdef TURSO3D_SIMD
+			unsigned outsideMask, insideMask;
+			TestPlanes(box, outsideMask, insideMask);
+			return (outsideMask & planeMask) ? OUTSIDE : INSIDE;
+#else
 			Vector3 center = box.Center();
 			Vector3 edge = center - box.min;
 
@@ -169,11 +195,17 @@ namespace Turso3D
 			}
 
 			return INSIDE;
+#endif
 		}
 
 		// Test if a bounding box is (partially) inside or outside.
 		Intersection IsInsideFast(const BoundingBox& box) const
 		{
+#ifdef TURSO3D_SIMD
+			unsigned outsideMask, insideMask;
+			TestPlanes(box, outsideMask, insideMask);
+			return outsideMask ? OUTSIDE : INSIDE;
+#else
 			Vector3 center = box.Center();
 			Vector3 edge = center - box.min;
 
@@ -188,6 +220,7 @@ namespace Turso3D
 			}
 
 			return INSIDE;
+#endif
 		}
 
 		// Test if a bounding box is (partially) inside or outside using SAT.
@@ -226,10 +259,57 @@ namespace Turso3D
 		// Update the planes. Called internally.
 		void UpdatePlanes();
 
+#ifdef TURSO3D_SIMD
+		// Test a bounding box against all planes, 4 planes at a time.
+		// Return bitmasks of the planes the box is outside of, and of the planes the box is completely inside of.
+		void TestPlanes(const BoundingBox& box, unsigned& outsideMask, unsigned& insideMask) const
+		{
+			Vector3 center = box.Center();
+			Vector3 edge = center - box.min;
+			Simd::Float4 centerX = Simd::Splat(center.x);
+			Simd::Float4 centerY = Simd::Splat(center.y);
+			Simd::Float4 centerZ = Simd::Splat(center.z);
+			Simd::Float4 edgeX = Simd::Splat(edge.x);
+			Simd::Float4 edgeY = Simd::Splat(edge.y);
+			Simd::Float4 edgeZ = Simd::Splat(edge.z);
+
+			outsideMask = 0;
+			insideMask = 0;
+
+			for (size_t i = 0; i < NUM_SIMD_FRUSTUM_PLANES; i += 4) {
+				Simd::Float4 dist = Simd::Mul(Simd::Load(&simdPlanes.normalX[i]), centerX);
+				dist = Simd::Add(dist, Simd::Mul(Simd::Load(&simdPlanes.normalY[i]), centerY));
+				dist = Simd::Add(dist, Simd::Mul(Simd::Load(&simdPlanes.normalZ[i]), centerZ));
+				dist = Simd::Add(dist, Simd::Load(&simdPlanes.d[i]));
+
+				Simd::Float4 absDist = Simd::Mul(Simd::Load(&simdPlanes.absNormalX[i]), edgeX);
+				absDist = Simd::Add(absDist, Simd::Mul(Simd::Load(&simdPlanes.absNormalY[i]), edgeY));
+				absDist = Simd::Add(absDist, Simd::Mul(Simd::Load(&simdPlanes.absNormalZ[i]), edgeZ));
+
+				outsideMask |= Simd::LessMask(dist, Simd::Sub(Simd::Zero(), absDist)) << i;
+				insideMask |= Simd::GreaterEqualMask(dist, absDist) << i;
+			}
+		}
+#endif
+
 	public:
 		// Frustum planes.
 		Plane planes[NUM_FRUSTUM_PLANES];
 		// Frustum vertices.
 		Vector3 vertices[NUM_FRUSTUM_VERTICES];
+
+#ifdef TURSO3D_SIMD
+		// Plane data transposed for testing 4 planes at a time. The padding planes never reject.
+		struct
+		{
+			float normalX[NUM_SIMD_FRUSTUM_PLANES];
+			float normalY[NUM_SIMD_FRUSTUM_PLANES];
+			float normalZ[NUM_SIMD_FRUSTUM_PLANES];
+			float d[NUM_SIMD_FRUSTUM_PLANES];
+			float absNormalX[NUM_SIMD_FRUSTUM_PLANES];
+			float absNormalY[NUM_SIMD_FRUSTUM_PLANES];
+			float absNormalZ[NUM_SIMD_FRUSTUM_PLANES];
+		} simdPlanes;
+#endif
 	};
 }
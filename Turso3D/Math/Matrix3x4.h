@@ -2,6 +2,7 @@
 
 #include <Turso3D/Math/Matrix3.h>
 #include <Turso3D/Math/Matrix4.h>
+#include <Turso3D/Math/Simd.h>
 
 namespace Turso3D
 {
@@ -168,6 +169,26 @@ namespace Turso3D
 		// Multiply a matrix.
 		Matrix3x4 operator * (const Matrix3x4& rhs) const
 		{
+#ifdef TURSO3D_SIMD
+			// Each result row is a combination of the right-hand rows, the implicit fourth row (0, 0, 0, 1) adds the translation
+			Simd::Float4 r0 = Simd::Load(&rhs.m00);
+			Simd::Float4 r1 = Simd::Load(&rhs.m10);
+			Simd::Float4 r2 = Simd::Load(&rhs.m20);
+			Simd::Float4 r3 = Simd::Set(0.0f, 0.0f, 0.0f, 1.0f);
+
+			Matrix3x4 ret;
+			const float* src = &m00;
+			float* dest = &ret.m00;
+			for (size_t i = 0; i < 3; ++i) {
+				Simd::Float4 row = Simd::Load(src + i * 4);
+				Simd::Float4 result = Simd::Mul(Simd::SplatLane<0>(row), r0);
+				result = Simd::Add(result, Simd::Mul(Simd::SplatLane<1>(row), r1));
+				result = Simd::Add(result, Simd::Mul(Simd::SplatLane<2>(row), r2));
+				result = Simd::Add(result, Simd::Mul(Simd::SplatLane<3>(row), r3));
+				Simd::Store(dest + i * 4, result);
+			}
+			return ret;
+#else
 			return Matrix3x4(
 				m00 * rhs.m00 + m01 * rhs.m10 + m02 * rhs.m20,
 				m00 * rhs.m01 + m01 * rhs.m11 + m02 * rhs.m21,
@@ -182,6 +203,7 @@ namespace Turso3D
 				m20 * rhs.m02 + m21 * rhs.m12 + m22 * rhs.m22,
 				m20 * rhs.m03 + m21 * rhs.m13 + m22 * rhs.m23 + m23
 			);
+#endif
 		}
 
 		// Multiply a 4x4 matrix.
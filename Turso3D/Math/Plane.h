@@ -64,6 +64,12 @@ namespace Turso3D
 			d = plane.w;
 		}
 
+		// Move by an offset.
+		void Translate(const Vector3& offset)
+		{
+			d -= normal.DotProduct(offset);
+		}
+
 		// Transform with a 3x3 matrix.
 		void Transform(const Matrix3& transform)
 		{
@@ -0,0 +1,54 @@
+#pragma once
+
+// The math library uses SSE2 when compiling for x86 / x64, and the scalar code paths on other platforms.
+// Define TURSO3D_NO_SIMD to use the scalar code paths only.
+#if !defined(TURSO3D_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define TURSO3D_SSE
+#define TURSO3D_SIMD
+#include <emmintrin.h>
+#endif
+
+#ifdef TURSO3D_SIMD
+namespace Turso3D
+{
+	// Thin wrappers over the 4-wide float intrinsics.
+	// Multiplies and adds are kept separate instead of fused, so that the results stay within rounding of the scalar code.
+	namespace Simd
+	{
+		typedef __m128 Float4;
+
+		// Load 4 floats from unaligned memory.
+		inline Float4 Load(const float* src) { return _mm_loadu_ps(src); }
+		// Store 4 floats to unaligned memory.
+		inline void Store(float* dest, Float4 v) { _mm_storeu_ps(dest, v); }
+		// Return a vector with all lanes set to a value.
+		inline Float4 Splat(float value) { return _mm_set1_ps(value); }
+		// Return a vector from lane values.
+		inline Float4 Set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+		// Return a zero vector.
+		inline Float4 Zero() { return _mm_setzero_ps(); }
+		// Return a vector with all lanes set to one lane of the source.
+		template <int Lane> inline Float4 SplatLane(Float4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(Lane, Lane, Lane, Lane)); }
+
+		// Lane-wise arithmetic.
+		inline Float4 Add(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+		inline Float4 Sub(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+		inline Float4 Mul(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+		inline Float4 Min(Float4 a, Float4 b) { return _mm_min_ps(a, b); }
+		inline Float4 Max(Float4 a, Float4 b) { return _mm_max_ps(a, b); }
+		inline Float4 Abs(Float4 v) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+		inline Float4 Div(Float4 a, Float4 b) { return _mm_div_ps(a, b); }
+		inline Float4 Sqrt(Float4 v) { return _mm_sqrt_ps(v); }
+		// Return the lanes negated where the sign of the other vector is negative.
+		inline Float4 MulSign(Float4 v, Float4 sign) { return _mm_xor_ps(v, _mm_and_ps(sign, _mm_set1_ps(-0.0f))); }
+
+		// Return a bitmask of the lanes where a < b.
+		inline unsigned LessMask(Float4 a, Float4 b) { return static_cast<unsigned>(_mm_movemask_ps(_mm_cmplt_ps(a, b))); }
+		// Return a bitmask of the lanes where a >= b.
+		inline unsigned GreaterEqualMask(Float4 a, Float4 b) { return static_cast<unsigned>(_mm_movemask_ps(_mm_cmpge_ps(a, b))); }
+
+		// Transpose a 4x4 matrix held in 4 row vectors.
+		inline void Transpose(Float4& r0, Float4& r1, Float4& r2, Float4& r3) { _MM_TRANSPOSE4_PS(r0, r1, r2, r3); }
+	}
+}
+#endif
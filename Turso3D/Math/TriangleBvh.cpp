@@ -0,0 +1,318 @@
+#include <Turso3D/Math/TriangleBvh.h>
+#include <Turso3D/Math/Ray.h>
+#include <algorithm>
+
+namespace
+{
+	using namespace Turso3D;
+
+	// Number of bins per axis for evaluating the split candidates.
+	constexpr size_t NUM_BINS = 12;
+	// Triangle count below which nodes are not split.
+	constexpr unsigned MIN_SPLIT_TRIANGLES = 3;
+	// Triangle count above which nodes are split even if the heuristic would prefer a leaf.
+	constexpr unsigned MAX_LEAF_TRIANGLES = 8;
+	// Cost of traversing a node relative to testing a triangle.
+	constexpr float TRAVERSAL_COST = 1.0f;
+	// Maximum tree depth. Bounds the traversal stack.
+	constexpr unsigned MAX_DEPTH = 64;
+	// Inverse ray direction used for a zero direction component.
+	constexpr float MAX_INVERSE_DIRECTION = 1.0e30f;
+
+	constexpr unsigned NO_TRIANGLE = 0xffffffff;
+
+	struct BuildTriangle
+	{
+		// Triangle bounds.
+		BoundingBox box;
+		// Bounds center.
+		Vector3 center;
+	};
+
+	struct Bin
+	{
+		// Bounds of the triangles in the bin.
+		BoundingBox box;
+		// Number of triangles in the bin.
+		unsigned count;
+	};
+
+	static inline float HalfArea(const BoundingBox& box)
+	{
+		if (!box.IsDefined()) {
+			return 0.0f;
+		}
+
+		Vector3 size = box.Size();
+		return size.x * size.y + size.y * size.z + size.z * size.x;
+	}
+
+	static inline size_t BinIndex(float value, float minValue, float scale)
+	{
+		return std::min(static_cast<size_t>((value - minValue) * scale), NUM_BINS - 1);
+	}
+
+	static inline float InverseDirection(float direction)
+	{
+		if (direction != 0.0f) {
+			return 1.0f / direction;
+		} else {
+			return MAX_INVERSE_DIRECTION;
+		}
+	}
+
+	// Return hit distance to a node's bounds with the slab method, or infinity if no hit.
+	static inline float HitDistance(const TriangleBvh::Node& node, const Vector3& origin, const Vector3& invDirection)
+	{
+		float t1 = (node.min.x - origin.x) * invDirection.x;
+		float t2 = (node.max.x - origin.x) * invDirection.x;
+		float tMin = std::min(t1, t2);
+		float tMax = std::max(t1, t2);
+		t1 = (node.min.y - origin.y) * invDirection.y;
+		t2 = (node.max.y - origin.y) * invDirection.y;
+		tMin = std::max(tMin, std::min(t1, t2));
+		tMax = std::min(tMax, std::max(t1, t2));
+		t1 = (node.min.z - origin.z) * invDirection.z;
+		t2 = (node.max.z - origin.z) * invDirection.z;
+		tMin = std::max(std::max(tMin, std::min(t1, t2)), 0.0f);
+		tMax = std::min(tMax, std::max(t1, t2));
+
+		return tMax >= tMin ? tMin : M_INFINITY;
+	}
+}
+
+namespace Turso3D
+{
+	TriangleBvh::TriangleBvh()
+	{
+	}
+
+	void TriangleBvh::Define(const Vector3* srcVertices, const unsigned* indices, size_t numIndices)
+	{
+		Clear();
+
+		size_t numTriangles = numIndices / 3;
+		if (!numTriangles) {
+			return;
+		}
+
+		std::vector<BuildTriangle> triangles(numTriangles);
+		std::vector<unsigned> order(numTriangles);
+		for (size_t i = 0; i < numTriangles; ++i) {
+			BuildTriangle& triangle = triangles[i];
+			triangle.box.Define(srcVertices[indices[i * 3]]);
+			triangle.box.Merge(srcVertices[indices[i * 3 + 1]]);
+			triangle.box.Merge(srcVertices[indices[i * 3 + 2]]);
+			triangle.center = triangle.box.Center();
+			order[i] = static_cast<unsigned>(i);
+		}
+
+		nodes.reserve(numTriangles * 2 - 1);
+		Node& root = nodes.emplace_back();
+		root.start = 0;
+		root.count = static_cast<unsigned>(numTriangles);
+
+		// Nodes to split and their depths
+		std::vector<std::pair<unsigned, unsigned>> stack;
+		stack.push_back(std::make_pair(0u, 0u));
+
+		while (!stack.empty()) {
+			unsigned nodeIndex = stack.back().first;
+			unsigned depth = stack.back().second;
+			stack.pop_back();
+
+			unsigned start = nodes[nodeIndex].start;
+			unsigned count = nodes[nodeIndex].count;
+
+			BoundingBox box;
+			BoundingBox centerBox;
+			for (unsigned i = start; i < start + count; ++i) {
+				box.Merge(triangles[order[i]].box);
+				centerBox.Merge(triangles[order[i]].center);
+			}
+			nodes[nodeIndex].min = box.min;
+			nodes[nodeIndex].max = box.max;
+
+			if (count < MIN_SPLIT_TRIANGLES || depth >= MAX_DEPTH - 1) {
+				continue;
+			}
+
+			// Find the lowest cost split among the bin boundaries of each axis
+			float bestCost = M_INFINITY;
+			int bestAxis = -1;
+			size_t bestSplit = 0;
+			Vector3 centerSize = centerBox.Size();
+
+			for (int axis = 0; axis < 3; ++axis) {
+				float extent = centerSize.Data()[axis];
+				if (extent <= 0.0f) {
+					continue;
+				}
+
+				float minValue = centerBox.min.Data()[axis];
+				float scale = NUM_BINS / extent;
+
+				Bin bins[NUM_BINS];
+				for (size_t b = 0; b < NUM_BINS; ++b) {
+					bins[b].count = 0;
+				}
+				for (unsigned i = start; i < start + count; ++i) {
+					const BuildTriangle& triangle = triangles[order[i]];
+					Bin& bin = bins[BinIndex(triangle.center.Data()[axis], minValue, scale)];
+					bin.box.Merge(triangle.box);
+					++bin.count;
+				}
+
+				// Sweep from the right to get the area and triangle count on the right side of each boundary, then from the left to evaluate
+				float rightAreas[NUM_BINS];
+				unsigned rightCounts[NUM_BINS];
+				BoundingBox rightBox;
+				unsigned rightCount = 0;
+				for (size_t b = NUM_BINS - 1; b > 0; --b) {
+					rightBox.Merge(bins[b].box);
+					rightCount += bins[b].count;
+					rightAreas[b] = HalfArea(rightBox);
+					rightCounts[b] = rightCount;
+				}
+
+				BoundingBox leftBox;
+				unsigned leftCount = 0;
+				for (size_t b = 1; b < NUM_BINS; ++b) {
+					leftBox.Merge(bins[b - 1].box);
+					leftCount += bins[b - 1].count;
+					if (!leftCount || !rightCounts[b]) {
+						continue;
+					}
+
+					float cost = leftCount * HalfArea(leftBox) + rightCounts[b] * rightAreas[b];
+					if (cost < bestCost) {
+						bestCost = cost;
+						bestAxis = axis;
+						bestSplit = b;
+					}
+				}
+			}
+
+			unsigned middle;
+			if (bestAxis >= 0) {
+				float nodeArea = HalfArea(box);
+				if (TRAVERSAL_COST * nodeArea + bestCost >= count * nodeArea && count <= MAX_LEAF_TRIANGLES) {
+					continue;
+				}
+
+				float minValue = centerBox.min.Data()[bestAxis];
+				float scale = NUM_BINS / centerSize.Data()[bestAxis];
+				unsigned* splitPoint = std::partition(&order[start], &order[start] + count, [&](unsigned index) {
+					return BinIndex(triangles[index].center.Data()[bestAxis], minValue, scale) < bestSplit;
+				});
+				middle = static_cast<unsigned>(splitPoint - &order[0]);
+			} else {
+				// All triangle centers coincide, so any split is as good
+				if (count <= MAX_LEAF_TRIANGLES) {
+					continue;
+				}
+				middle = start + count / 2;
+			}
+
+			unsigned childIndex = static_cast<unsigned>(nodes.size());
+			nodes.resize(nodes.size() + 2);
+			nodes[childIndex].start = start;
+			nodes[childIndex].count = middle - start;
+			nodes[childIndex + 1].start = middle;
+			nodes[childIndex + 1].count = start + count - middle;
+
+			nodes[nodeIndex].start = childIndex;
+			nodes[nodeIndex].count = 0;
+
+			stack.push_back(std::make_pair(childIndex, depth + 1));
+			stack.push_back(std::make_pair(childIndex + 1, depth + 1));
+		}
+
+		// Store the triangles in leaf order
+		vertices.resize(numTriangles * 3);
+		triangleIndices.resize(numTriangles);
+		for (size_t i = 0; i < numTriangles; ++i) {
+			const unsigned* triangleIndexData = indices + order[i] * 3;
+			vertices[i * 3] = srcVertices[triangleIndexData[0]];
+			vertices[i * 3 + 1] = srcVertices[triangleIndexData[1]];
+			vertices[i * 3 + 2] = srcVertices[triangleIndexData[2]];
+			triangleIndices[i] = order[i];
+		}
+	}
+
+	void TriangleBvh::Clear()
+	{
+		nodes.clear();
+		vertices.clear();
+		triangleIndices.clear();
+	}
+
+	float TriangleBvh::HitDistance(const Ray& ray, Vector3* outNormal, unsigned* outTriangle, float maxDistance) const
+	{
+		if (nodes.empty()) {
+			return M_INFINITY;
+		}
+
+		Vector3 invDirection(InverseDirection(ray.direction.x), InverseDirection(ray.direction.y), InverseDirection(ray.direction.z));
+		float closest = maxDistance;
+		unsigned closestTriangle = NO_TRIANGLE;
+		Vector3 closestNormal = Vector3::ZERO();
+
+		// Nodes to visit and their hit distances. The nearer child is pushed last to be visited first
+		std::pair<unsigned, float> stack[MAX_DEPTH + 1];
+		size_t stackSize = 0;
+
+		float rootDistance = ::HitDistance(nodes[0], ray.origin, invDirection);
+		if (rootDistance < closest) {
+			stack[stackSize++] = std::make_pair(0u, rootDistance);
+		}
+
+		while (stackSize) {
+			std::pair<unsigned, float> entry = stack[--stackSize];
+			if (entry.second >= closest) {
+				continue;
+			}
+
+			const Node& node = nodes[entry.first];
+			if (node.count) {
+				for (unsigned i = node.start; i < node.start + node.count; ++i) {
+					Vector3 normal = Vector3::ZERO();
+					float distance = ray.HitDistance(vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2], &normal);
+					if (distance < closest) {
+						closest = distance;
+						closestTriangle = i;
+						closestNormal = normal;
+					}
+				}
+			} else {
+				unsigned nearChild = node.start;
+				unsigned farChild = node.start + 1;
+				float nearDistance = ::HitDistance(nodes[nearChild], ray.origin, invDirection);
+				float farDistance = ::HitDistance(nodes[farChild], ray.origin, invDirection);
+				if (farDistance < nearDistance) {
+					std::swap(nearChild, farChild);
+					std::swap(nearDistance, farDistance);
+				}
+
+				if (farDistance < closest) {
+					stack[stackSize++] = std::make_pair(farChild, farDistance);
+				}
+				if (nearDistance < closest) {
+					stack[stackSize++] = std::make_pair(nearChild, nearDistance);
+				}
+			}
+		}
+
+		if (closestTriangle == NO_TRIANGLE) {
+			return M_INFINITY;
+		}
+
+		if (outNormal) {
+			*outNormal = closestNormal;
+		}
+		if (outTriangle) {
+			*outTriangle = triangleIndices[closestTriangle];
+		}
+		return closest;
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Turso3D/Math/BoundingBox.h>
+#include <vector>
+
+namespace Turso3D
+{
+	class Ray;
+
+	// Bounding volume hierarchy of an indexed triangle mesh for raycasts.
+	// Built with the surface area heuristic. The triangles are stored in leaf order for cache-friendly traversal.
+	class TriangleBvh
+	{
+	public:
+		// Tree node. A leaf node has triangles, an interior node has two consecutive children.
+		struct Node
+		{
+			// Minimum bounds.
+			Vector3 min;
+			// First triangle of a leaf node, or the first child of an interior node.
+			unsigned start;
+			// Maximum bounds.
+			Vector3 max;
+			// Number of triangles of a leaf node, or zero for an interior node.
+			unsigned count;
+		};
+
+		// Construct empty.
+		TriangleBvh();
+
+		// Build from indexed triangles.
+		void Define(const Vector3* vertices, const unsigned* indices, size_t numIndices);
+		// Clear the hierarchy.
+		void Clear();
+
+		// Return hit distance to the closest front-facing triangle, or infinity if no hit or not closer than the max distance.
+		// Optionally return the unnormalized normal and the original index of the triangle.
+		float HitDistance(const Ray& ray, Vector3* outNormal = nullptr, unsigned* outTriangle = nullptr, float maxDistance = M_INFINITY) const;
+
+		// Return the nodes. The root is the first node.
+		const std::vector<Node>& Nodes() const { return nodes; }
+		// Return number of triangles.
+		size_t NumTriangles() const { return triangleIndices.size(); }
+		// Return whether has no triangles.
+		bool IsEmpty() const { return nodes.empty(); }
+
+	private:
+		// Tree nodes.
+		std::vector<Node> nodes;
+		// Triangle vertices in leaf order, 3 per triangle.
+		std::vector<Vector3> vertices;
+		// Original indices of the triangles in leaf order.
+		std::vector<unsigned> triangleIndices;
+	};
+}
@@ -5,18 +5,32 @@
 #include <Turso3D/Math/Ray.h>
 #include <Turso3D/Renderer/AnimatedModel.h>
 #include <Turso3D/Renderer/Animation.h>
+#include <Turso3D/Renderer/AnimationBlendGraph.h>
+#include <Turso3D/Renderer/AnimationBlendGraphState.h>
 #include <Turso3D/Renderer/AnimationState.h>
+#include <Turso3D/Renderer/Camera.h>
 #include <Turso3D/Renderer/DebugRenderer.h>
 #include <Turso3D/Renderer/Model.h>
 #include <Turso3D/Renderer/Octree.h>
 #include <algorithm>
+#include <atomic>
 
 namespace
 {
 	using namespace Turso3D;
 
+	static Vector3 DOT_SCALE(1 / 3.0f, 1 / 3.0f, 1 / 3.0f);
+
+	// Bone depth that includes the whole skeleton.
+	constexpr unsigned char MAX_BONE_DEPTH = 255;
+
 	static Allocator<AnimatedModelDrawable> drawableAllocator;
 
+	// Animation LOD settings for models without own settings.
+	static AnimationLodSettings defaultLodSettings;
+	// Evaluation phase for the next animated model, to stagger the pose evaluations. Atomic, as models may be created from several threads, e.g. during background scene loading.
+	static std::atomic<unsigned> nextEvaluationPhase(0);
+
 	static inline bool CompareAnimationStates(const std::shared_ptr<AnimationState>& lhs, const std::shared_ptr<AnimationState>& rhs)
 	{
 		return lhs->BlendLayer() < rhs->BlendLayer();
@@ -26,7 +40,12 @@ namespace
 namespace Turso3D
 {
 	AnimatedModelDrawable::AnimatedModelDrawable() :
-		animatedModelFlags(0)
+		animatedModelFlags(0),
+		poseTimeStep(0.0f),
+		lodDistance(0.0f),
+		lastEvaluationFrameNumber(0),
+		animationFrameNumber(0),
+		evaluationPhase(static_cast<unsigned char>(nextEvaluationPhase.fetch_add(1, std::memory_order_relaxed)))
 	{
 	}
 
@@ -34,14 +53,45 @@ namespace Turso3D
 	{
 	}
 
-	void AnimatedModelDrawable::OnOctreeUpdate(unsigned short frameNumber)
+	bool AnimatedModelDrawable::OnPrepareRender(unsigned short frameNumber, Camera* camera)
+	{
+		if (!SkinnedModelDrawable::OnPrepareRender(frameNumber, camera)) {
+			return false;
+		}
+
+		lodDistance = camera->LodDistance(distance, WorldScale().DotProduct(DOT_SCALE), lodBias);
+		return true;
+	}
+
+	void AnimatedModelDrawable::OnAnimationUpdate(unsigned short frameNumber)
 	{
-		if (TestFlag(Drawable::FLAG_UPDATE_INVISIBLE) || WasInView(frameNumber)) {
-			if (animatedModelFlags & FLAG_ANIMATION_DIRTY) {
-				UpdateAnimation();
+		if (animatedModelFlags & FLAG_ANIMATION_DIRTY) {
+			UpdateAnimationLod(frameNumber, CurrentLodLevel(frameNumber));
+		}
+		SkinnedModelDrawable::OnAnimationUpdate(frameNumber);
+
+		// Derive the attachments' skin matrices from the now up to date skin matrices
+		const std::vector<SkinnedModel*>& attachments = static_cast<AnimatedModel*>(owner)->GetAttachments();
+		for (size_t i = 0; i < attachments.size(); ++i) {
+			attachments[i]->GetDrawable()->UpdateSkinningFromSkeleton(this, frameNumber);
+		}
+	}
+
+	size_t AnimatedModelDrawable::AnimationUpdateCost(unsigned short frameNumber) const
+	{
+		size_t cost = SkinnedModelDrawable::AnimationUpdateCost(frameNumber);
+		const std::vector<SkinnedModel*>& attachments = static_cast<AnimatedModel*>(owner)->GetAttachments();
+		for (size_t i = 0; i < attachments.size(); ++i) {
+			cost += attachments[i]->Bones().size();
+		}
+		if (animatedModelFlags & FLAG_ANIMATION_DIRTY) {
+			AnimationLodLevel level = CurrentLodLevel(frameNumber);
+			if (level.updateInterval && IsEvaluationDue(frameNumber, level.updateInterval)) {
+				size_t numClips = animationStates.size() + (blendGraph ? blendGraph->Graph()->NumClips() : 0);
+				cost += NumLodBones(level.maxBoneDepth) * numClips;
 			}
 		}
-		SkinnedModelDrawable::OnOctreeUpdate(frameNumber);
+		return cost;
 	}
 
 	void AnimatedModelDrawable::OnAnimationOrderChanged()
@@ -63,59 +113,239 @@ namespace Turso3D
 	}
 
 	void AnimatedModelDrawable::UpdateAnimation()
+	{
+		const AnimationPoseCacheEntry* sharedPose = EvaluatePose(pose, MAX_BONE_DEPTH);
+		animatedModelFlags &= ~FLAG_ANIMATION_DIRTY;
+
+		// Restart interpolation from the up to date pose if the animation LOD uses it later
+		lodPoses[0].Resize(0);
+		lodPoses[1].Resize(0);
+
+		ApplyPose(sharedPose);
+	}
+
+	const AnimationLodSettings& AnimatedModelDrawable::LodSettings() const
+	{
+		return lodSettings ? *lodSettings : defaultLodSettings;
+	}
+
+	AnimationLodLevel AnimatedModelDrawable::CurrentLodLevel(unsigned short frameNumber) const
+	{
+		const AnimationLodSettings& settings = LodSettings();
+		AnimationLodLevel level;
+
+		// Out of view or occluded, updated only because of updating when invisible
+		if (!WasInView(frameNumber)) {
+			level.updateInterval = settings.invisibleUpdateInterval;
+			return level;
+		}
+
+		Octree* octree = owner->GetOctree();
+		float biasedDistance = octree ? lodDistance / std::max(octree->AnimationLodBias(), M_EPSILON) : lodDistance;
+		for (size_t i = 0; i < settings.levels.size() && biasedDistance >= settings.levels[i].distance; ++i) {
+			level = settings.levels[i];
+		}
+
+		return level;
+	}
+
+	void AnimatedModelDrawable::PrepareForRender()
+	{
+		// Update animation here too if just came into view and animation / skinning is still dirty, unless the animation LOD already held or interpolated the pose this frame
+		if ((animatedModelFlags & FLAG_ANIMATION_DIRTY) && animationFrameNumber != lastFrameNumber) {
+			UpdateAnimation();
+			lastEvaluationFrameNumber = animationFrameNumber = lastFrameNumber;
+		}
+		SkinnedModelDrawable::PrepareForRender();
+	}
+
+	void AnimatedModelDrawable::UpdateAnimationLod(unsigned short frameNumber, const AnimationLodLevel& level)
+	{
+		// Frozen pose. The animation stays dirty, so that it is updated when comes into view
+		if (!level.updateInterval) {
+			return;
+		}
+
+		animationFrameNumber = frameNumber;
+
+		if (level.updateInterval == 1 && level.maxBoneDepth == MAX_BONE_DEPTH) {
+			UpdateAnimation();
+			lastEvaluationFrameNumber = frameNumber;
+			return;
+		}
+
+		size_t numBones = Bones().size();
+		bool interpolate = LodSettings().interpolate && level.updateInterval > 1 && WasInView(frameNumber);
+
+		if (IsEvaluationDue(frameNumber, level.updateInterval)) {
+			lastEvaluationFrameNumber = frameNumber;
+
+			if (!interpolate) {
+				const AnimationPoseCacheEntry* sharedPose = EvaluatePose(pose, level.maxBoneDepth);
+				animatedModelFlags &= ~FLAG_ANIMATION_DIRTY;
+				ApplyPose(sharedPose);
+				return;
+			}
+
+			// Keep the last evaluated pose to interpolate from. If there is none, start from the new pose
+			std::swap(lodPoses[0], lodPoses[1]);
+			EvaluatePose(lodPoses[1], level.maxBoneDepth);
+			if (lodPoses[0].NumBones() != numBones) {
+				lodPoses[0] = lodPoses[1];
+			}
+		} else if (!interpolate || lodPoses[1].NumBones() != numBones) {
+			// Hold the pose until the next evaluation. The animation stays dirty
+			return;
+		}
+
+		// The evaluated pose is reached when the next evaluation is due, so the animation is delayed by the update interval. It stays dirty meanwhile
+		unsigned short framesSinceEvaluation = frameNumber - lastEvaluationFrameNumber;
+		pose.Resize(numBones);
+		pose.Interpolate(lodPoses[0], lodPoses[1], std::min(static_cast<float>(framesSinceEvaluation) / level.updateInterval, 1.0f));
+		ApplyPose();
+	}
+
+	const AnimationPoseCacheEntry* AnimatedModelDrawable::EvaluatePose(AnimationPose& dest, unsigned char maxBoneDepth)
 	{
 		if (animatedModelFlags & FLAG_ANIMATION_ORDER_DIRTY) {
 			std::sort(animationStates.begin(), animationStates.end(), CompareAnimationStates);
+			animatedModelFlags &= ~FLAG_ANIMATION_ORDER_DIRTY;
 		}
-		animatedModelFlags |= FLAG_IN_ANIMATION_UPDATE;
 
-		// Reset bones to initial pose, then apply animations
-		const std::vector<ModelBone>& modelBones = model->Bones();
+		// Take the pose from the cache if another model already evaluated it on this frame, otherwise evaluate it for the others
+		AnimationPoseCache* poseCache = nullptr;
+		AnimationPoseCacheEntry* sharedPose = nullptr;
+		float timeStep = 0.0f;
 
-		const std::vector<Bone*>& bones = Bones();
-		for (size_t i = 0; i < bones.size(); ++i) {
-			Bone* bone = bones[i];
-			const ModelBone& modelBone = modelBones[i];
-			if (bone->AnimationEnabled()) {
-				bone->SetTransformSilent(modelBone.position, modelBone.rotation, modelBone.scale);
+		if ((animatedModelFlags & FLAG_POSE_SHARING) && BuildPoseKey(maxBoneDepth)) {
+			Octree* octree = owner->GetOctree();
+			poseCache = octree ? octree->GetAnimationPoseCache() : nullptr;
+			timeStep = poseTimeStep;
+
+			if (poseCache) {
+				bool evaluate;
+				sharedPose = poseCache->Acquire(poseKey, evaluate);
+				if (sharedPose && !evaluate) {
+					dest = sharedPose->pose;
+					return sharedPose;
+				}
 			}
 		}
 
+		AnimationPose& target = sharedPose ? sharedPose->pose : dest;
+		animatedModelFlags |= FLAG_IN_ANIMATION_UPDATE;
+
+		// Start from the blend graph output or the initial pose, then blend the animations in the pose buffer
+		target.Resize(Bones().size());
+
+		const unsigned char* depths = maxBoneDepth < MAX_BONE_DEPTH && boneDepths.size() >= target.NumBones() ? boneDepths.data() : nullptr;
+		if (blendGraph) {
+			blendGraph->Evaluate(target, depths, maxBoneDepth);
+		} else {
+			target.SetBindPose(model->Bones());
+		}
+
 		for (size_t i = 0; i < animationStates.size(); ++i) {
 			AnimationState* state = animationStates[i].get();
 			if (state->Enabled()) {
-				state->Apply();
+				state->ApplyToPose(target, depths, maxBoneDepth, timeStep);
 			}
 		}
 
+		animatedModelFlags &= ~FLAG_IN_ANIMATION_UPDATE;
+
+		if (sharedPose) {
+			poseCache->Publish(sharedPose, model->Bones());
+			dest = sharedPose->pose;
+		}
+		return sharedPose;
+	}
+
+	void AnimatedModelDrawable::ApplyPose(const AnimationPoseCacheEntry* sharedPose)
+	{
+		// Set the bones once
+		pose.ApplyToBones(Bones());
+
 		// Dirty the bone hierarchy now.
 		// This will also dirty and queue reinsertion for attached models
 		static_cast<AnimatedModel*>(owner)->SetBonesDirty();
 
-		animatedModelFlags &= ~(FLAG_ANIMATION_ORDER_DIRTY | FLAG_ANIMATION_DIRTY | FLAG_IN_ANIMATION_UPDATE);
-
-		// Update bounding box already here to take advantage of threaded update, and also to update bone world transforms for skinning
-		OnWorldBoundingBoxUpdate();
+		if (sharedPose && CanUseSharedSkinning()) {
+			// The shared pose is in model space, so only the world transform remains to be applied. The bone world transforms are left to be updated on demand
+			const Matrix3x4& worldTransform = WorldTransform();
+			for (size_t i = 0; i < sharedPose->skinMatrices.size(); ++i) {
+				skinMatrices[i] = worldTransform * sharedPose->skinMatrices[i];
+			}
+			boneBoundingBox = sharedPose->boneBoundingBox;
+			skinFlags &= ~(FLAG_SKINNING_DIRTY | FLAG_BONE_BOUNDING_BOX_DIRTY);
+			skinFlags |= FLAG_SKINNING_BUFFER_DIRTY;
+		} else {
+			// Update bounding box from the bones already here to take advantage of threaded update, and also to update bone world transforms for skinning
+			skinFlags |= FLAG_SKINNING_DIRTY | FLAG_BONE_BOUNDING_BOX_DIRTY;
+		}
+		SetFlag(Drawable::FLAG_BOUNDING_BOX_DIRTY, true);
+		WorldBoundingBox();
 
 		// If updating only when visible, queue octree reinsertion for next frame. This also ensures shadowmap rendering happens correctly
-		// Else just dirty the skinning
+		// When called from the octree's animation update, the drawable is already queued and its reinsertion is checked right after
 		if (!TestFlag(Drawable::FLAG_UPDATE_INVISIBLE)) {
 			Octree* octree = owner->GetOctree();
 			if (octree && octant && !TestFlag(Drawable::FLAG_OCTREE_REINSERT_QUEUED)) {
 				octree->QueueUpdate(this);
 			}
 		}
+	}
+
+	bool AnimatedModelDrawable::BuildPoseKey(unsigned char maxBoneDepth)
+	{
+		if (blendGraph) {
+			return false;
+		}
 
-		skinFlags |= FLAG_SKINNING_DIRTY | FLAG_BONE_BOUNDING_BOX_DIRTY;
+		poseKey.Reset(model.get(), maxBoneDepth, poseTimeStep);
+		for (size_t i = 0; i < animationStates.size(); ++i) {
+			const AnimationState* state = animationStates[i].get();
+			if (state->Enabled()) {
+				if (!state->IsShareable()) {
+					return false;
+				}
+				poseKey.AddState(*state);
+			}
+		}
+		poseKey.Finalize();
+		return true;
 	}
 
-	void AnimatedModelDrawable::PrepareForRender()
+	bool AnimatedModelDrawable::CanUseSharedSkinning() const
 	{
-		// Update animation here too if just came into view and animation / skinning is still dirty
-		if (animatedModelFlags & FLAG_ANIMATION_DIRTY) {
-			UpdateAnimation();
+		// The skeleton must be owned by this model and not shared with attachments, and no bone may be controlled manually
+		const Bone* rootBone = RootBone();
+		if (!rootBone || rootBone->Parent() != owner || !skinMatrices || !static_cast<AnimatedModel*>(owner)->GetAttachments().empty()) {
+			return false;
 		}
-		SkinnedModelDrawable::PrepareForRender();
+		// The shared skin matrices are only multiplied by the model's world transform, so the root bone must not add a transform of its own
+		if (rootBone->Position() != Vector3::ZERO() || rootBone->Rotation() != Quaternion::IDENTITY() || rootBone->Scale() != Vector3::ONE()) {
+			return false;
+		}
+
+		const std::vector<Bone*>& bones = Bones();
+		for (size_t i = 0; i < bones.size(); ++i) {
+			if (!bones[i]->AnimationEnabled()) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool AnimatedModelDrawable::IsEvaluationDue(unsigned short frameNumber, unsigned char updateInterval) const
+	{
+		unsigned short framesSinceEvaluation = frameNumber - lastEvaluationFrameNumber;
+		return updateInterval <= 1 || framesSinceEvaluation >= updateInterval || !((frameNumber + evaluationPhase) % updateInterval);
+	}
+
+	size_t AnimatedModelDrawable::NumLodBones(unsigned char maxBoneDepth) const
+	{
+		return maxBoneDepth < lodBoneCounts.size() ? lodBoneCounts[maxBoneDepth] : Bones().size();
 	}
 
 	// ==========================================================================================
@@ -137,6 +367,83 @@ namespace Turso3D
 	{
 		StaticModel::SetModel(model);
 		SetupBones();
+
+		// The skeleton was recreated
+		for (size_t i = 0; i < attachments.size(); ++i) {
+			MapAttachmentBones(i);
+		}
+
+		// Restart the blend graph on the new skeleton
+		AnimatedModelDrawable* drawable = GetDrawable();
+		if (drawable->blendGraph) {
+			SetBlendGraph(drawable->blendGraph->Graph());
+		}
+
+		// Find the bone depths in the skeleton and count bones per depth for the animation LOD
+		drawable->boneDepths.clear();
+		drawable->lodBoneCounts.clear();
+		if (!model) {
+			return;
+		}
+
+		const std::vector<ModelBone>& modelBones = model->Bones();
+		drawable->boneDepths.resize(modelBones.size());
+		for (size_t i = 0; i < modelBones.size(); ++i) {
+			size_t depth = 0;
+			for (size_t j = i; modelBones[j].parentIndex != j && depth < MAX_BONE_DEPTH; j = modelBones[j].parentIndex) {
+				++depth;
+			}
+			drawable->boneDepths[i] = static_cast<unsigned char>(depth);
+			if (drawable->lodBoneCounts.size() <= depth) {
+				drawable->lodBoneCounts.resize(depth + 1);
+			}
+			++drawable->lodBoneCounts[depth];
+		}
+		for (size_t i = 1; i < drawable->lodBoneCounts.size(); ++i) {
+			drawable->lodBoneCounts[i] += drawable->lodBoneCounts[i - 1];
+		}
+	}
+
+	void AnimatedModel::SetAnimationLod(const std::shared_ptr<AnimationLodSettings>& settings)
+	{
+		GetDrawable()->lodSettings = settings;
+	}
+
+	void AnimatedModel::SetDefaultAnimationLod(const AnimationLodSettings& settings)
+	{
+		defaultLodSettings = settings;
+	}
+
+	const AnimationLodSettings& AnimatedModel::DefaultAnimationLod()
+	{
+		return defaultLodSettings;
+	}
+
+	AnimationBlendGraphState* AnimatedModel::SetBlendGraph(const std::shared_ptr<AnimationBlendGraph>& graph)
+	{
+		AnimatedModelDrawable* drawable = GetDrawable();
+
+		// Copy the reference first, as the graph may be referenced only by the old instance
+		std::shared_ptr<AnimationBlendGraph> newGraph = graph;
+		drawable->blendGraph.reset();
+		if (newGraph) {
+			drawable->blendGraph = std::make_unique<AnimationBlendGraphState>(drawable, drawable->model.get(), newGraph);
+		}
+
+		drawable->OnAnimationChanged();
+		return drawable->blendGraph.get();
+	}
+
+	void AnimatedModel::SetPoseSharing(bool enable, float timeStep)
+	{
+		AnimatedModelDrawable* drawable = GetDrawable();
+		if (enable) {
+			drawable->animatedModelFlags |= AnimatedModelDrawable::FLAG_POSE_SHARING;
+		} else {
+			drawable->animatedModelFlags &= ~AnimatedModelDrawable::FLAG_POSE_SHARING;
+		}
+		drawable->poseTimeStep = std::max(timeStep, 0.0f);
+		drawable->OnAnimationChanged();
 	}
 
 	AnimationState* AnimatedModel::AddAnimationState(const std::shared_ptr<Animation>& animation)
@@ -262,7 +569,8 @@ namespace Turso3D
 			}
 		}
 		attachments.push_back(model);
-		model->SetSkinningDirty();
+		attachmentBoneMasks.emplace_back();
+		MapAttachmentBones(attachments.size() - 1);
 	}
 
 	void AnimatedModel::RemoveAttachment(SkinnedModel* attachment)
@@ -270,7 +578,10 @@ namespace Turso3D
 		for (size_t i = 0; i < attachments.size(); ++i) {
 			if (attachments[i] == attachment) {
 				std::swap(attachments.back(), attachments[i]);
+				std::swap(attachmentBoneMasks.back(), attachmentBoneMasks[i]);
 				attachments.pop_back();
+				attachmentBoneMasks.pop_back();
+				attachment->SetSkeletonBoneMap(std::vector<size_t>(), std::vector<Matrix3x4>());
 				return;
 			}
 		}
@@ -280,20 +591,64 @@ namespace Turso3D
 	{
 		SkinnedModel::OnBoneTransformChanged(bone);
 
+		// Bones created by attachments are not in this model's skeleton. They dirty the attachments that have bones of their own
+		size_t boneIndex = bone ? bone->Index() : 0;
+		bool skeletonBone = bone && bone != rootBone && boneIndex < bones.size() && bones[boneIndex] == bone;
+
 		for (size_t i = 0; i < attachments.size(); ++i) {
-			SkinnedModel* attachment = attachments[i];
-
-			if (bone && bone != rootBone) {
-				const std::vector<Bone*>& bones = attachment->Bones();
-				for (size_t j = 0; j < bones.size(); ++j) {
-					if (bones[i]->NameHash() == bone->NameHash()) {
-						attachment->SetSkinningDirty();
-						break;
-					}
+			const std::vector<bool>& mask = attachmentBoneMasks[i];
+			if (!skeletonBone || mask.empty() || mask[boneIndex]) {
+				attachments[i]->SetSkinningDirty();
+			}
+		}
+	}
+
+	void AnimatedModel::MapAttachmentBones(size_t index)
+	{
+		SkinnedModel* attachment = attachments[index];
+		std::vector<bool>& mask = attachmentBoneMasks[index];
+		mask.clear();
+
+		std::vector<size_t> boneIndices;
+		std::vector<Matrix3x4> offsetCorrections;
+
+		const Model* model = GetModel().get();
+		const Model* attachmentModel = attachment->GetModel().get();
+		const std::vector<Bone*>& attachmentBones = attachment->Bones();
+
+		if (model && attachmentModel && rootBone && attachment->RootBone() == rootBone && !attachmentBones.empty()) {
+			const std::vector<ModelBone>& modelBones = model->Bones();
+			const std::vector<ModelBone>& attachmentModelBones = attachmentModel->Bones();
+			bool identicalOffsets = true;
+
+			mask.resize(bones.size());
+			boneIndices.resize(attachmentBones.size());
+			offsetCorrections.resize(attachmentBones.size());
+
+			for (size_t i = 0; i < attachmentBones.size(); ++i) {
+				Bone* bone = attachmentBones[i];
+				size_t boneIndex = bone->Index();
+				if (boneIndex >= bones.size() || bones[boneIndex] != bone) {
+					mask.clear();
+					boneIndices.clear();
+					break;
 				}
-			} else {
-				attachment->SetSkinningDirty();
+
+				boneIndices[i] = boneIndex;
+				offsetCorrections[i] = modelBones[boneIndex].offsetMatrix.Inverse() * attachmentModelBones[i].offsetMatrix;
+				identicalOffsets = identicalOffsets && attachmentModelBones[i].offsetMatrix == modelBones[boneIndex].offsetMatrix;
+
+				// Only the topmost bone of a transform change is notified, so the ancestors affect the attachment too
+				for (size_t j = boneIndex; !mask[j]; j = modelBones[j].parentIndex) {
+					mask[j] = true;
+				}
+			}
+
+			if (boneIndices.empty() || identicalOffsets) {
+				offsetCorrections.clear();
 			}
 		}
+
+		attachment->SetSkeletonBoneMap(boneIndices, offsetCorrections);
 	}
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <Turso3D/Renderer/AnimationPose.h>
+#include <Turso3D/Renderer/AnimationPoseCache.h>
 #include <Turso3D/Renderer/SkinnedModel.h>
 #include <vector>
 #include <memory>
@@ -8,8 +10,32 @@ namespace Turso3D
 {
 	class AnimatedModel;
 	class Animation;
+	class AnimationBlendGraph;
+	class AnimationBlendGraphState;
 	class AnimationState;
 
+	// Animation LOD level.
+	struct AnimationLodLevel
+	{
+		// LOD distance from which the level is used.
+		float distance = 0.0f;
+		// Frames between animation evaluations. 1 evaluates every frame.
+		unsigned char updateInterval = 1;
+		// Maximum depth of the animated bones in the skeleton, the root bones being at depth 0. Deeper bones are left in the initial pose.
+		unsigned char maxBoneDepth = 255;
+	};
+
+	// Animation LOD settings for animated models.
+	struct AnimationLodSettings
+	{
+		// LOD levels in increasing distance order. When empty, the whole skeleton is evaluated every frame.
+		std::vector<AnimationLodLevel> levels;
+		// Frames between animation evaluations when out of view or occluded, for models that update when invisible. 0 freezes the pose until back in view.
+		unsigned char invisibleUpdateInterval = 1;
+		// Interpolate between the last two evaluated poses on frames without evaluation, which delays the animation by the update interval. Otherwise the pose is held.
+		bool interpolate = true;
+	};
+
 	// ==========================================================================================
 	// Animated model drawable.
 	class AnimatedModelDrawable : public SkinnedModelDrawable
@@ -21,7 +47,8 @@ namespace Turso3D
 		{
 			FLAG_ANIMATION_ORDER_DIRTY = 0x1,
 			FLAG_ANIMATION_DIRTY = 0x2,
-			FLAG_IN_ANIMATION_UPDATE = 0x4
+			FLAG_IN_ANIMATION_UPDATE = 0x4,
+			FLAG_POSE_SHARING = 0x8
 		};
 
 	public:
@@ -29,9 +56,15 @@ namespace Turso3D
 		AnimatedModelDrawable();
 		~AnimatedModelDrawable();
 
-		// Do animation processing before octree reinsertion, if should update without regard to visibility.
-		// Called by Octree in worker threads. Must be opted-in by setting FLAG_OCTREE_UPDATE_CALL flag.
-		void OnOctreeUpdate(unsigned short frameNumber) override;
+		// Prepare object for rendering, and store the LOD distance for the animation LOD.
+		// Called by Renderer in worker threads. Return false if should not render.
+		bool OnPrepareRender(unsigned short frameNumber, Camera* camera) override;
+
+		// Apply animation states if dirty according to the animation LOD, then update bone world transforms, bone bounding box and skin matrices before octree reinsertion.
+		// Called by Octree in worker threads, if was in view last frame or should update without regard to visibility.
+		void OnAnimationUpdate(unsigned short frameNumber) override;
+		// Return the relative cost of the animation update, which grows with the number of bones and animation states to evaluate in the frame.
+		size_t AnimationUpdateCost(unsigned short frameNumber) const override;
 
 		// Set animation order dirty when animation state changes layer order and queue octree reinsertion.
 		// Note: bounding box will only be dirtied once animation actually updates.
@@ -40,18 +73,65 @@ namespace Turso3D
 		// Note: bounding box will only be dirtied once animation actually updates.
 		void OnAnimationChanged();
 
-		// Apply animation states and recalculate bounding box.
+		// Apply animation states to the whole skeleton and recalculate bounding box, regardless of the animation LOD. Skinning is left dirty.
 		void UpdateAnimation();
 
+		// Return the animation LOD settings in use.
+		const AnimationLodSettings& LodSettings() const;
+		// Return the animation LOD level to use in a frame.
+		AnimationLodLevel CurrentLodLevel(unsigned short frameNumber) const;
+
 	protected:
 		void PrepareForRender() override;
 
+	private:
+		// Apply animation states according to an animation LOD level. Either evaluate the pose, interpolate between evaluated poses or hold the pose.
+		void UpdateAnimationLod(unsigned short frameNumber, const AnimationLodLevel& level);
+		// Sort the animation states if necessary and blend them into a pose, starting from the blend graph output or the initial pose.
+		// With pose sharing the pose is taken from or published to the octree's pose cache. Return the shared pose if was used.
+		const AnimationPoseCacheEntry* EvaluatePose(AnimationPose& dest, unsigned char maxBoneDepth);
+		// Set the pose to the bones and recalculate bounding box.
+		// If the pose is shared, take the skin matrices and bone bounding box from its model space data when the skeleton allows.
+		void ApplyPose(const AnimationPoseCacheEntry* sharedPose = nullptr);
+		// Build the pose cache key of the animation states. Return false if some enabled state cannot be shared or a blend graph is set.
+		bool BuildPoseKey(unsigned char maxBoneDepth);
+		// Return whether the skin matrices and bone bounding box can be calculated from a shared pose's model space data.
+		bool CanUseSharedSkinning() const;
+		// Return whether the pose should be evaluated in a frame with an update interval.
+		bool IsEvaluationDue(unsigned short frameNumber, unsigned char updateInterval) const;
+		// Return number of bones animated up to a skeleton depth.
+		size_t NumLodBones(unsigned char maxBoneDepth) const;
+
 	protected:
 		// Internal dirty status flags.
 		mutable unsigned animatedModelFlags;
 
 		// Animation states.
 		std::vector<std::shared_ptr<AnimationState>> animationStates;
+		// Blend graph instance evaluated before the animation states, or null if not set.
+		std::unique_ptr<AnimationBlendGraphState> blendGraph;
+		// Pose buffer the animation states are blended into.
+		AnimationPose pose;
+		// Last two evaluated poses to interpolate between, when the animation LOD has an update interval.
+		AnimationPose lodPoses[2];
+		// Animation LOD settings, or null to use the default.
+		std::shared_ptr<AnimationLodSettings> lodSettings;
+		// Depth of each bone in the skeleton.
+		std::vector<unsigned char> boneDepths;
+		// Number of bones up to each skeleton depth.
+		std::vector<size_t> lodBoneCounts;
+		// Key of the current pose in the pose cache.
+		AnimationPoseKey poseKey;
+		// Time quantization step in seconds for pose sharing, or 0 to share only exactly matching time positions.
+		float poseTimeStep;
+		// LOD scaled distance from the last render.
+		float lodDistance;
+		// Frame number of the last pose evaluation with the animation LOD.
+		unsigned short lastEvaluationFrameNumber;
+		// Frame number when the animation was last applied, held or interpolated.
+		unsigned short animationFrameNumber;
+		// Offset to frame numbers to stagger the pose evaluations of models with the same update interval.
+		unsigned char evaluationPhase;
 	};
 
 	// ==========================================================================================
@@ -93,7 +173,34 @@ namespace Turso3D
 		// Return all animation states.
 		const std::vector<std::shared_ptr<AnimationState>>& AnimationStates() const { return GetDrawable()->animationStates; }
 
+		// Set a blend graph to evaluate before the animation states, which are then blended over its output. Null removes.
+		// Return the created blend graph instance for setting parameters and advancing time, or null if removed.
+		AnimationBlendGraphState* SetBlendGraph(const std::shared_ptr<AnimationBlendGraph>& graph);
+		// Return the blend graph instance, or null if not set.
+		AnimationBlendGraphState* BlendGraph() const { return GetDrawable()->blendGraph.get(); }
+
+		// Set animation LOD settings for this model. Null uses the default settings.
+		void SetAnimationLod(const std::shared_ptr<AnimationLodSettings>& settings);
+		// Return the animation LOD settings of this model, or null if uses the default settings.
+		const std::shared_ptr<AnimationLodSettings>& AnimationLod() const { return GetDrawable()->lodSettings; }
+
+		// Set the default animation LOD settings for models without own settings. The default evaluates the whole skeleton every frame.
+		// To be called only from the main thread outside the octree update.
+		static void SetDefaultAnimationLod(const AnimationLodSettings& settings);
+		// Return the default animation LOD settings.
+		static const AnimationLodSettings& DefaultAnimationLod();
+
+		// Set whether to share the evaluated pose, skin matrices and bone bounding box with identically animated models through the octree's pose cache. Default disabled.
+		// With a nonzero time step the animation time positions are rounded to it, so that models close in phase share the pose.
+		// States with a start bone or modified bone weights are not shared.
+		void SetPoseSharing(bool enable, float timeStep = 0.0f);
+		// Return whether pose sharing is enabled.
+		bool PoseSharing() const { return (GetDrawable()->animatedModelFlags & AnimatedModelDrawable::FLAG_POSE_SHARING) != 0; }
+		// Return the pose sharing time step.
+		float PoseTimeStep() const { return GetDrawable()->poseTimeStep; }
+
 		// Add a skinned model as attachment to this model.
+		// If the attachment's bones were set up from this model's root bone, its skin matrices are derived from this model's in the animation update through a bone remap.
 		void AddAttachment(SkinnedModel* model);
 		// Remove an attached skinned model.
 		void RemoveAttachment(SkinnedModel* model);
@@ -104,7 +211,14 @@ namespace Turso3D
 		// Called when a bone had its transform changed.
 		void OnBoneTransformChanged(Bone* bone) override;
 
+	private:
+		// Build the bone remap of an attachment and the mask of the bones affecting it.
+		void MapAttachmentBones(size_t index);
+
 	protected:
+		// Attached skinned models.
 		std::vector<SkinnedModel*> attachments;
+		// Bones whose transform changes affect each attachment, including the ancestors of the bones it uses. Empty if the attachment has bones of its own.
+		std::vector<std::vector<bool>> attachmentBoneMasks;
 	};
 }
@@ -1,6 +1,367 @@
 #include <Turso3D/Renderer/Animation.h>
 #include <Turso3D/IO/Log.h>
 #include <Turso3D/IO/Stream.h>
+#include <Turso3D/Renderer/Model.h>
+#include <algorithm>
+
+namespace
+{
+	using namespace Turso3D;
+
+	// Largest quantized key time.
+	constexpr float MAX_QUANTIZED_TIME = 65535.0f;
+	// Allowed deviation of key times from the key time step, relative to the step, to consider an animation uniformly sampled.
+	constexpr float UNIFORM_TIME_TOLERANCE = 0.01f;
+	// Largest quantized position or scale component.
+	constexpr float MAX_QUANTIZED_VALUE = 65535.0f;
+	// Largest quantized rotation component. The top bit is used for the index of the omitted component.
+	constexpr float MAX_QUANTIZED_ROTATION = 32767.0f;
+	// Absolute value limit of the three smallest components of a unit quaternion.
+	constexpr float MAX_ROTATION_COMPONENT = 0.70710678f;
+	// Maximum number of consecutive keys to consider removing at once. Bounds the keyframe reduction cost of long clips.
+	constexpr size_t MAX_REDUCTION_SPAN = 1024;
+
+	static inline unsigned short QuantizeTime(float time, float timeStep)
+	{
+		return static_cast<unsigned short>(roundf(Clamp(time / timeStep, 0.0f, MAX_QUANTIZED_TIME)));
+	}
+
+	static inline unsigned short QuantizeValue(float value, float minValue, float range)
+	{
+		return range > 0.0f ? static_cast<unsigned short>(roundf(Clamp((value - minValue) / range, 0.0f, 1.0f) * MAX_QUANTIZED_VALUE)) : 0;
+	}
+
+	static inline unsigned short QuantizeRotationComponent(float value)
+	{
+		return static_cast<unsigned short>(roundf(Clamp(value / MAX_ROTATION_COMPONENT * 0.5f + 0.5f, 0.0f, 1.0f) * MAX_QUANTIZED_ROTATION));
+	}
+
+	static inline float DequantizeRotationComponent(unsigned short value)
+	{
+		return ((value & 0x7fff) / MAX_QUANTIZED_ROTATION * 2.0f - 1.0f) * MAX_ROTATION_COMPONENT;
+	}
+
+	static inline Vector3 DecodeVector(const CompressedAnimationChannel& channel, size_t key)
+	{
+		const unsigned short* data = &channel.values[key * 3];
+		return Vector3(
+			channel.minValue.x + data[0] * channel.valueRange.x * (1.0f / MAX_QUANTIZED_VALUE),
+			channel.minValue.y + data[1] * channel.valueRange.y * (1.0f / MAX_QUANTIZED_VALUE),
+			channel.minValue.z + data[2] * channel.valueRange.z * (1.0f / MAX_QUANTIZED_VALUE)
+		);
+	}
+
+	// Store the three smallest components of a rotation. The largest is known to be positive and is reconstructed from unit length.
+	static inline void EncodeRotation(const Quaternion& rotation, unsigned short* dest)
+	{
+		const float* data = rotation.Data();
+		size_t largest = 0;
+		for (size_t i = 1; i < 4; ++i) {
+			if (fabsf(data[i]) > fabsf(data[largest])) {
+				largest = i;
+			}
+		}
+
+		float sign = data[largest] < 0.0f ? -1.0f : 1.0f;
+		size_t j = 0;
+		for (size_t i = 0; i < 4; ++i) {
+			if (i != largest) {
+				dest[j++] = QuantizeRotationComponent(data[i] * sign);
+			}
+		}
+
+		dest[0] |= static_cast<unsigned short>((largest & 1) << 15);
+		dest[1] |= static_cast<unsigned short>((largest >> 1) << 15);
+	}
+
+	// Return the rotation error tolerance in degrees as distance between unit quaternions, which stays accurate for small angles unlike the dot product.
+	static inline float RotationDistance(float angle)
+	{
+		return 2.0f * sinf(angle * M_DEGTORAD * 0.25f);
+	}
+
+	// Return distance between unit quaternions, accounting for both representing the same rotation.
+	static inline float RotationDistance(const Quaternion& lhs, const Quaternion& rhs)
+	{
+		return sqrtf(std::min((lhs - rhs).LengthSquared(), (lhs + rhs).LengthSquared()));
+	}
+
+	static inline Quaternion DecodeRotation(const CompressedAnimationChannel& channel, size_t key)
+	{
+		const unsigned short* src = &channel.values[key * 3];
+		size_t largest = (src[0] >> 15) | ((src[1] >> 15) << 1);
+		float a = DequantizeRotationComponent(src[0]);
+		float b = DequantizeRotationComponent(src[1]);
+		float c = DequantizeRotationComponent(src[2]);
+
+		float data[4];
+		size_t j = 0;
+		for (size_t i = 0; i < 4; ++i) {
+			if (i != largest) {
+				data[i] = j == 0 ? a : (j == 1 ? b : c);
+				++j;
+			}
+		}
+		data[largest] = sqrtf(std::max(1.0f - a * a - b * b - c * c, 0.0f));
+
+		return Quaternion(data);
+	}
+
+	// Find the last key at or before a time, or the first key if none. The key time function returns the time of a key by index.
+	// The last found key is checked first, as continuous playback stays on it or moves to the next. Else the key is estimated from the average key interval, which is exact for uniformly sampled keys, and binary searched if the estimate misses.
+	template <class T> static inline void FindKeyIndex(size_t numKeys, float time, T keyTime, size_t& index)
+	{
+		if (index >= numKeys) {
+			index = numKeys - 1;
+		}
+
+		if (keyTime(index) <= time && (index + 1 >= numKeys || time < keyTime(index + 1))) {
+			return;
+		}
+		if (index + 1 < numKeys && keyTime(index + 1) <= time && (index + 2 >= numKeys || time < keyTime(index + 2))) {
+			++index;
+			return;
+		}
+
+		float firstTime = keyTime(0);
+		float lastTime = keyTime(numKeys - 1);
+		if (time < firstTime || numKeys == 1) {
+			index = 0;
+			return;
+		}
+		if (time >= lastTime) {
+			index = numKeys - 1;
+			return;
+		}
+
+		size_t estimate = std::min(static_cast<size_t>((time - firstTime) / (lastTime - firstTime) * (numKeys - 1)), numKeys - 2);
+		if (keyTime(estimate) <= time && time < keyTime(estimate + 1)) {
+			index = estimate;
+			return;
+		}
+
+		// Search for the first key after the time. The first key is known to be at or before and the last key after
+		size_t low = 1;
+		size_t high = numKeys - 1;
+		while (low < high) {
+			size_t middle = (low + high) / 2;
+			if (keyTime(middle) <= time) {
+				low = middle + 1;
+			} else {
+				high = middle;
+			}
+		}
+		index = low - 1;
+	}
+
+	// Find the keys to interpolate between at a quantized time, starting the search from the last key. Return the interpolation factor.
+	static inline float FindChannelKeys(const CompressedAnimationChannel& channel, float quantizedTime, float quantizedLength, bool looped, size_t& index, size_t& nextIndex)
+	{
+		const unsigned short* times = channel.times.data();
+		size_t numKeys = channel.times.size();
+
+		FindKeyIndex(numKeys, quantizedTime, [times](size_t i) { return static_cast<float>(times[i]); }, index);
+
+		float timeInterval;
+		nextIndex = index + 1;
+		if (nextIndex >= numKeys) {
+			if (!looped || numKeys == 1) {
+				nextIndex = index;
+				return 0.0f;
+			}
+			nextIndex = 0;
+			timeInterval = quantizedLength - times[index] + times[0];
+		} else {
+			timeInterval = static_cast<float>(times[nextIndex] - times[index]);
+		}
+
+		return timeInterval > 0.0f ? Clamp((quantizedTime - times[index]) / timeInterval, 0.0f, 1.0f) : 1.0f;
+	}
+
+	// Choose the keys to keep, so that interpolating between them reproduces the removed keys within tolerance.
+	// The tolerance function is called with the start and end kept keys, the tested key and its interpolation factor.
+	template <class T> static void ReduceKeys(const std::vector<unsigned short>& times, T withinTolerance, std::vector<size_t>& result)
+	{
+		size_t numKeys = times.size();
+		result.clear();
+		result.push_back(0);
+
+		size_t start = 0;
+		for (size_t end = 2; end < numKeys; ++end) {
+			bool reduce = end - start <= MAX_REDUCTION_SPAN && times[end] > times[start];
+			for (size_t i = start + 1; reduce && i < end; ++i) {
+				float t = static_cast<float>(times[i] - times[start]) / (times[end] - times[start]);
+				reduce = withinTolerance(start, end, i, t);
+			}
+			if (!reduce) {
+				start = end - 1;
+				result.push_back(start);
+			}
+		}
+
+		if (numKeys > 1) {
+			result.push_back(numKeys - 1);
+		}
+
+		// Keys may quantize to the same time in long animations. Keep only the last of them
+		size_t numResults = 1;
+		for (size_t i = 1; i < result.size(); ++i) {
+			if (times[result[i]] == times[result[numResults - 1]]) {
+				result[numResults - 1] = result[i];
+			} else {
+				result[numResults++] = result[i];
+			}
+		}
+		result.resize(numResults);
+	}
+
+	// Quantize and reduce the keys of a position or scale channel. Return false if quantizing over the value range alone would exceed the tolerance.
+	static bool CompressVectorChannel(const std::vector<Vector3>& values, const std::vector<unsigned short>& times, float tolerance, CompressedAnimationChannel& dest)
+	{
+		dest.times.clear();
+		dest.values.clear();
+
+		bool constant = true;
+		for (size_t i = 1; i < values.size() && constant; ++i) {
+			constant = (values[i] - values[0]).Length() <= tolerance;
+		}
+
+		// A constant value is stored exactly, with zero range
+		if (constant) {
+			dest.minValue = values[0];
+			dest.valueRange = Vector3::ZERO();
+			dest.times.push_back(times[0]);
+			dest.values.resize(3, 0);
+			return true;
+		}
+
+		Vector3 minValue = values[0];
+		Vector3 maxValue = values[0];
+		for (size_t i = 1; i < values.size(); ++i) {
+			minValue = Vector3(std::min(minValue.x, values[i].x), std::min(minValue.y, values[i].y), std::min(minValue.z, values[i].z));
+			maxValue = Vector3(std::max(maxValue.x, values[i].x), std::max(maxValue.y, values[i].y), std::max(maxValue.z, values[i].z));
+		}
+		dest.minValue = minValue;
+		dest.valueRange = maxValue - minValue;
+
+		// Quantize all keys first, so that the reduction accounts for the quantization error
+		CompressedAnimationChannel quantized;
+		quantized.minValue = dest.minValue;
+		quantized.valueRange = dest.valueRange;
+		quantized.values.resize(values.size() * 3);
+		std::vector<Vector3> decoded(values.size());
+		for (size_t i = 0; i < values.size(); ++i) {
+			quantized.values[i * 3] = QuantizeValue(values[i].x, minValue.x, dest.valueRange.x);
+			quantized.values[i * 3 + 1] = QuantizeValue(values[i].y, minValue.y, dest.valueRange.y);
+			quantized.values[i * 3 + 2] = QuantizeValue(values[i].z, minValue.z, dest.valueRange.z);
+			decoded[i] = DecodeVector(quantized, i);
+			// A long range, such as root motion, may have a quantization step larger than the tolerance
+			if ((decoded[i] - values[i]).Length() > tolerance) {
+				return false;
+			}
+		}
+
+		std::vector<size_t> keys;
+		ReduceKeys(times, [&](size_t start, size_t end, size_t i, float t) {
+			return (decoded[start].Lerp(decoded[end], t) - values[i]).Length() <= tolerance;
+		}, keys);
+
+		dest.times.resize(keys.size());
+		dest.values.resize(keys.size() * 3);
+		for (size_t i = 0; i < keys.size(); ++i) {
+			dest.times[i] = times[keys[i]];
+			std::copy(&quantized.values[keys[i] * 3], &quantized.values[keys[i] * 3] + 3, &dest.values[i * 3]);
+		}
+
+		return true;
+	}
+
+	// Quantize and reduce the keys of a rotation channel. Return false if quantization alone would exceed the tolerance.
+	static bool CompressRotationChannel(const std::vector<Quaternion>& values, const std::vector<unsigned short>& times, float tolerance, CompressedAnimationChannel& dest)
+	{
+		dest.times.clear();
+		dest.values.clear();
+		dest.minValue = Vector3::ZERO();
+		dest.valueRange = Vector3::ZERO();
+
+		float maxDistance = RotationDistance(tolerance);
+
+		bool constant = true;
+		for (size_t i = 1; i < values.size() && constant; ++i) {
+			constant = RotationDistance(values[i], values[0]) <= maxDistance;
+		}
+
+		if (constant) {
+			dest.times.push_back(times[0]);
+			dest.values.resize(3);
+			EncodeRotation(values[0], &dest.values[0]);
+			return true;
+		}
+
+		CompressedAnimationChannel quantized;
+		quantized.values.resize(values.size() * 3);
+		std::vector<Quaternion> decoded(values.size());
+		for (size_t i = 0; i < values.size(); ++i) {
+			EncodeRotation(values[i], &quantized.values[i * 3]);
+			decoded[i] = DecodeRotation(quantized, i);
+			if (RotationDistance(decoded[i], values[i]) > maxDistance) {
+				return false;
+			}
+		}
+
+		std::vector<size_t> keys;
+		ReduceKeys(times, [&](size_t start, size_t end, size_t i, float t) {
+			return RotationDistance(decoded[start].Nlerp(decoded[end], t, true), values[i]) <= maxDistance;
+		}, keys);
+
+		dest.times.resize(keys.size());
+		dest.values.resize(keys.size() * 3);
+		for (size_t i = 0; i < keys.size(); ++i) {
+			dest.times[i] = times[keys[i]];
+			std::copy(&quantized.values[keys[i] * 3], &quantized.values[keys[i] * 3] + 3, &dest.values[i * 3]);
+		}
+
+		return true;
+	}
+
+	static void ReadKeyFrames(Stream& source, AnimationTrack& track)
+	{
+		size_t numKeyFrames = source.Read<unsigned>();
+		track.keyFrames.resize(numKeyFrames);
+
+		for (size_t j = 0; j < numKeyFrames; ++j) {
+			AnimationKeyFrame& newKeyFrame = track.keyFrames[j];
+			newKeyFrame.time = source.Read<float>();
+			if (track.channelMask & CHANNEL_POSITION) {
+				newKeyFrame.position = source.Read<Vector3>();
+			}
+			if (track.channelMask & CHANNEL_ROTATION) {
+				newKeyFrame.rotation = source.Read<Quaternion>();
+			}
+			if (track.channelMask & CHANNEL_SCALE) {
+				newKeyFrame.scale = source.Read<Vector3>();
+			}
+		}
+	}
+
+	static void WriteKeyFrames(Stream& dest, const AnimationTrack& track)
+	{
+		dest.Write<unsigned>(static_cast<unsigned>(track.keyFrames.size()));
+
+		for (const AnimationKeyFrame& keyFrame : track.keyFrames) {
+			dest.Write<float>(keyFrame.time);
+			if (track.channelMask & CHANNEL_POSITION) {
+				dest.Write<Vector3>(keyFrame.position);
+			}
+			if (track.channelMask & CHANNEL_ROTATION) {
+				dest.Write<Quaternion>(keyFrame.rotation);
+			}
+			if (track.channelMask & CHANNEL_SCALE) {
+				dest.Write<Vector3>(keyFrame.scale);
+			}
+		}
+	}
+}
 
 namespace Turso3D
 {
@@ -10,23 +371,103 @@ namespace Turso3D
 			time = 0.0f;
 		}
 
-		if (index >= keyFrames.size()) {
-			index = keyFrames.size() - 1;
+		const AnimationKeyFrame* keyFrameData = keyFrames.data();
+		FindKeyIndex(keyFrames.size(), time, [keyFrameData](size_t i) { return keyFrameData[i].time; }, index);
+	}
+
+	void AnimationTrack::FindKeys(const Animation& animation, float time, bool looped, size_t* lastKeyFrames, AnimationTrackKeys& keys) const
+	{
+		float length = animation.Length();
+
+		if (!keyFrames.empty()) {
+			FindKeyFrameIndex(time, lastKeyFrames[0]);
+			const AnimationKeyFrame& keyFrame = keyFrames[lastKeyFrames[0]];
+
+			// Check if next frame to interpolate to is valid, or if wrapping is needed (looping animation only)
+			size_t nextFrame = lastKeyFrames[0] + 1;
+			float t = 0.0f;
+			if (nextFrame >= keyFrames.size()) {
+				if (!looped) {
+					nextFrame = lastKeyFrames[0];
+				} else {
+					nextFrame = 0;
+				}
+			}
+
+			const AnimationKeyFrame& nextKeyFrame = keyFrames[nextFrame];
+			if (nextFrame != lastKeyFrames[0]) {
+				float timeInterval = nextKeyFrame.time - keyFrame.time;
+				if (timeInterval < 0.0f) {
+					timeInterval += length;
+				}
+				t = timeInterval > 0.0f ? Clamp((time - keyFrame.time) / timeInterval, 0.0f, 1.0f) : 1.0f;
+			}
+
+			if (channelMask & CHANNEL_POSITION) {
+				keys.positions[0] = keyFrame.position;
+				keys.positions[1] = nextKeyFrame.position;
+				keys.factors[0] = t;
+			}
+			if (channelMask & CHANNEL_ROTATION) {
+				keys.rotations[0] = keyFrame.rotation;
+				keys.rotations[1] = nextKeyFrame.rotation;
+				keys.factors[1] = t;
+			}
+			if (channelMask & CHANNEL_SCALE) {
+				keys.scales[0] = keyFrame.scale;
+				keys.scales[1] = nextKeyFrame.scale;
+				keys.factors[2] = t;
+			}
+			return;
 		}
 
-		// Check for being too far ahead
-		while (index && time < keyFrames[index].time) {
-			--index;
+		// Compressed keys are decoded here. Each channel has its own keys after reduction
+		float quantizedLength = length / animation.KeyTimeStep();
+		float quantizedTime = Clamp(time / animation.KeyTimeStep(), 0.0f, quantizedLength);
+		size_t nextKey;
+
+		if ((channelMask & CHANNEL_POSITION) && channels[0].NumKeys()) {
+			keys.factors[0] = FindChannelKeys(channels[0], quantizedTime, quantizedLength, looped, lastKeyFrames[0], nextKey);
+			keys.positions[0] = DecodeVector(channels[0], lastKeyFrames[0]);
+			keys.positions[1] = DecodeVector(channels[0], nextKey);
+		}
+		if ((channelMask & CHANNEL_ROTATION) && channels[1].NumKeys()) {
+			keys.factors[1] = FindChannelKeys(channels[1], quantizedTime, quantizedLength, looped, lastKeyFrames[1], nextKey);
+			keys.rotations[0] = DecodeRotation(channels[1], lastKeyFrames[1]);
+			keys.rotations[1] = DecodeRotation(channels[1], nextKey);
 		}
+		if ((channelMask & CHANNEL_SCALE) && channels[2].NumKeys()) {
+			keys.factors[2] = FindChannelKeys(channels[2], quantizedTime, quantizedLength, looped, lastKeyFrames[2], nextKey);
+			keys.scales[0] = DecodeVector(channels[2], lastKeyFrames[2]);
+			keys.scales[1] = DecodeVector(channels[2], nextKey);
+		}
+	}
 
-		// Check for being too far behind
-		while (index < keyFrames.size() - 1 && time >= keyFrames[index + 1].time) {
-			++index;
+	void AnimationTrack::Sample(const Animation& animation, float time, bool looped, size_t* lastKeyFrames, Vector3& position, Quaternion& rotation, Vector3& scale) const
+	{
+		AnimationTrackKeys keys;
+		keys.positions[0] = keys.positions[1] = position;
+		keys.rotations[0] = keys.rotations[1] = rotation;
+		keys.scales[0] = keys.scales[1] = scale;
+		keys.factors[0] = keys.factors[1] = keys.factors[2] = 0.0f;
+
+		FindKeys(animation, time, looped, lastKeyFrames, keys);
+
+		if (channelMask & CHANNEL_POSITION) {
+			position = keys.positions[0].Lerp(keys.positions[1], keys.factors[0]);
+		}
+		if (channelMask & CHANNEL_ROTATION) {
+			rotation = keys.rotations[0].Nlerp(keys.rotations[1], keys.factors[1], true);
+		}
+		if (channelMask & CHANNEL_SCALE) {
+			scale = keys.scales[0].Lerp(keys.scales[1], keys.factors[2]);
 		}
 	}
 
 	Animation::Animation() :
-		length(0.0f)
+		length(0.0f),
+		keyTimeStep(1.0f),
+		compressed(false)
 	{
 	}
 
@@ -40,7 +481,9 @@ namespace Turso3D
 		source.Read(header, 4);
 
 		// TODO: Develop own format for Turso3D
-		if (memcmp(header, "UANI", 4) != 0) {
+		// CANI is the compressed format written by Save()
+		bool compressedFormat = memcmp(header, "CANI", 4) == 0;
+		if (memcmp(header, "UANI", 4) != 0 && !compressedFormat) {
 			LOG_ERROR(source.Name() + " is not a valid animation file");
 			return false;
 		}
@@ -49,7 +492,9 @@ namespace Turso3D
 		animationName = source.Read<std::string>();
 		animationNameHash = animationName;
 		length = source.Read<float>();
+		keyTimeStep = compressedFormat ? source.Read<float>() : 1.0f;
 		tracks.clear();
+		compressed = compressedFormat;
 
 		size_t numTracks = source.Read<unsigned>();
 
@@ -58,22 +503,69 @@ namespace Turso3D
 			AnimationTrack* newTrack = CreateTrack(source.Read<std::string>());
 			newTrack->channelMask = source.Read<unsigned char>();
 
-			size_t numKeyFrames = source.Read<unsigned>();
-			newTrack->keyFrames.resize(numKeyFrames);
+			// Tracks left uncompressed are stored as keyframes also in the compressed format
+			ReadKeyFrames(source, *newTrack);
+			if (!compressedFormat || newTrack->keyFrames.size()) {
+				continue;
+			}
 
-			// Read keyframes of the track
-			for (size_t j = 0; j < numKeyFrames; ++j) {
-				AnimationKeyFrame& newKeyFrame = newTrack->keyFrames[j];
-				newKeyFrame.time = source.Read<float>();
-				if (newTrack->channelMask & CHANNEL_POSITION) {
-					newKeyFrame.position = source.Read<Vector3>();
+			for (size_t j = 0; j < NUM_ANIMATION_CHANNELS; ++j) {
+				if (!(newTrack->channelMask & (1 << j))) {
+					continue;
 				}
-				if (newTrack->channelMask & CHANNEL_ROTATION) {
-					newKeyFrame.rotation = source.Read<Quaternion>();
+
+				CompressedAnimationChannel& channel = newTrack->channels[j];
+				size_t numKeys = source.Read<unsigned>();
+				channel.minValue = source.Read<Vector3>();
+				channel.valueRange = source.Read<Vector3>();
+
+				// Each key has a time and 3 values. Check against the remaining data before allocating
+				if (!numKeys || numKeys * 4 * sizeof(unsigned short) > source.Size() - source.Position()) {
+					LOG_ERROR(source.Name() + " has an invalid compressed animation track " + newTrack->name);
+					return false;
 				}
-				if (newTrack->channelMask & CHANNEL_SCALE) {
-					newKeyFrame.scale = source.Read<Vector3>();
+
+				channel.times.resize(numKeys);
+				channel.values.resize(numKeys * 3);
+				source.Read(channel.times.data(), numKeys * sizeof(unsigned short));
+				source.Read(channel.values.data(), numKeys * 3 * sizeof(unsigned short));
+			}
+		}
+
+		return true;
+	}
+
+	bool Animation::Save(Stream& dest)
+	{
+		dest.Write(compressed ? "CANI" : "UANI", 4);
+		dest.Write<std::string>(animationName);
+		dest.Write<float>(length);
+		if (compressed) {
+			dest.Write<float>(keyTimeStep);
+		}
+		dest.Write<unsigned>(static_cast<unsigned>(tracks.size()));
+
+		for (auto it = tracks.begin(); it != tracks.end(); ++it) {
+			const AnimationTrack& track = it->second;
+			dest.Write<std::string>(track.name);
+			dest.Write<unsigned char>(track.channelMask);
+
+			WriteKeyFrames(dest, track);
+			if (!compressed || track.keyFrames.size()) {
+				continue;
+			}
+
+			for (size_t j = 0; j < NUM_ANIMATION_CHANNELS; ++j) {
+				if (!(track.channelMask & (1 << j))) {
+					continue;
 				}
+
+				const CompressedAnimationChannel& channel = track.channels[j];
+				dest.Write<unsigned>(static_cast<unsigned>(channel.NumKeys()));
+				dest.Write<Vector3>(channel.minValue);
+				dest.Write<Vector3>(channel.valueRange);
+				dest.Write(channel.times.data(), channel.times.size() * sizeof(unsigned short));
+				dest.Write(channel.values.data(), channel.values.size() * sizeof(unsigned short));
 			}
 		}
 
@@ -118,6 +610,129 @@ namespace Turso3D
 		tracks.clear();
 	}
 
+	void Animation::Compress(const AnimationCompressionSettings& settings)
+	{
+		std::vector<unsigned short> times;
+		std::vector<Vector3> vectors;
+		std::vector<Quaternion> rotations;
+
+		// Use the keyframe interval as the time unit if the animation is uniformly sampled, so that key times stay exact.
+		// Else divide the length evenly. Tracks compressed earlier keep the existing unit
+		if (!compressed) {
+			// Estimate the interval from the track with most keys. Averaging over the track avoids the precision loss of subtracting late key times
+			float interval = 0.0f;
+			size_t maxKeyFrames = 1;
+			for (auto it = tracks.begin(); it != tracks.end(); ++it) {
+				const std::vector<AnimationKeyFrame>& keyFrames = it->second.keyFrames;
+				if (keyFrames.size() > maxKeyFrames) {
+					maxKeyFrames = keyFrames.size();
+					interval = (keyFrames.back().time - keyFrames.front().time) / (keyFrames.size() - 1);
+				}
+			}
+
+			bool uniform = interval > 0.0f && length / interval <= MAX_QUANTIZED_TIME;
+			for (auto it = tracks.begin(); it != tracks.end() && uniform; ++it) {
+				for (const AnimationKeyFrame& keyFrame : it->second.keyFrames) {
+					float steps = keyFrame.time / interval;
+					if (fabsf(steps - roundf(steps)) > UNIFORM_TIME_TOLERANCE) {
+						uniform = false;
+						break;
+					}
+				}
+			}
+
+			if (uniform) {
+				keyTimeStep = interval;
+			} else {
+				keyTimeStep = length > 0.0f ? length / MAX_QUANTIZED_TIME : 1.0f;
+			}
+		}
+
+		for (auto it = tracks.begin(); it != tracks.end();) {
+			AnimationTrack& track = it->second;
+			if (track.keyFrames.empty()) {
+				++it;
+				continue;
+			}
+
+			const std::vector<AnimationKeyFrame>& keyFrames = track.keyFrames;
+			times.resize(keyFrames.size());
+			for (size_t i = 0; i < keyFrames.size(); ++i) {
+				times[i] = QuantizeTime(keyFrames[i].time, keyTimeStep);
+			}
+
+			bool withinTolerance = true;
+			if (track.channelMask & CHANNEL_POSITION) {
+				vectors.resize(keyFrames.size());
+				for (size_t i = 0; i < keyFrames.size(); ++i) {
+					vectors[i] = keyFrames[i].position;
+				}
+				withinTolerance &= CompressVectorChannel(vectors, times, settings.positionTolerance, track.channels[0]);
+			}
+			if (track.channelMask & CHANNEL_ROTATION) {
+				rotations.resize(keyFrames.size());
+				for (size_t i = 0; i < keyFrames.size(); ++i) {
+					rotations[i] = keyFrames[i].rotation.Normalized();
+				}
+				withinTolerance &= CompressRotationChannel(rotations, times, settings.rotationTolerance, track.channels[1]);
+			}
+			if (track.channelMask & CHANNEL_SCALE) {
+				vectors.resize(keyFrames.size());
+				for (size_t i = 0; i < keyFrames.size(); ++i) {
+					vectors[i] = keyFrames[i].scale;
+				}
+				withinTolerance &= CompressVectorChannel(vectors, times, settings.scaleTolerance, track.channels[2]);
+			}
+
+			// Keep the track as keyframes if a channel can not be quantized within the tolerance
+			if (!withinTolerance) {
+				for (size_t i = 0; i < NUM_ANIMATION_CHANNELS; ++i) {
+					track.channels[i] = CompressedAnimationChannel();
+				}
+				++it;
+				continue;
+			}
+
+			// Remove the constant channels that are equal to the bind pose
+			const ModelBone* bone = nullptr;
+			if (settings.bindPoseModel) {
+				for (const ModelBone& modelBone : settings.bindPoseModel->Bones()) {
+					if (modelBone.nameHash == track.nameHash) {
+						bone = &modelBone;
+						break;
+					}
+				}
+			}
+			if (bone) {
+				if ((track.channelMask & CHANNEL_POSITION) && track.channels[0].NumKeys() == 1 && (DecodeVector(track.channels[0], 0) - bone->position).Length() <= settings.positionTolerance) {
+					track.channelMask &= ~CHANNEL_POSITION;
+				}
+				if ((track.channelMask & CHANNEL_ROTATION) && track.channels[1].NumKeys() == 1 && RotationDistance(DecodeRotation(track.channels[1], 0), bone->rotation.Normalized()) <= RotationDistance(settings.rotationTolerance)) {
+					track.channelMask &= ~CHANNEL_ROTATION;
+				}
+				if ((track.channelMask & CHANNEL_SCALE) && track.channels[2].NumKeys() == 1 && (DecodeVector(track.channels[2], 0) - bone->scale).Length() <= settings.scaleTolerance) {
+					track.channelMask &= ~CHANNEL_SCALE;
+				}
+			}
+
+			for (size_t i = 0; i < NUM_ANIMATION_CHANNELS; ++i) {
+				if (!(track.channelMask & (1 << i))) {
+					track.channels[i] = CompressedAnimationChannel();
+				}
+			}
+			std::vector<AnimationKeyFrame>().swap(track.keyFrames);
+
+			// Remove tracks that no longer animate anything
+			if (!track.channelMask) {
+				it = tracks.erase(it);
+			} else {
+				++it;
+			}
+		}
+
+		compressed = true;
+	}
+
 	AnimationTrack* Animation::Track(size_t index) const
 	{
 		if (index >= tracks.size()) {
@@ -146,4 +761,17 @@ namespace Turso3D
 		auto it = tracks.find(nameHash_);
 		return it != tracks.end() ? const_cast<AnimationTrack*>(&(it->second)) : nullptr;
 	}
+
+	size_t Animation::DataSize() const
+	{
+		size_t size = 0;
+		for (auto it = tracks.begin(); it != tracks.end(); ++it) {
+			const AnimationTrack& track = it->second;
+			size += track.keyFrames.size() * sizeof(AnimationKeyFrame);
+			for (size_t i = 0; i < NUM_ANIMATION_CHANNELS; ++i) {
+				size += (track.channels[i].times.size() + track.channels[i].values.size()) * sizeof(unsigned short);
+			}
+		}
+		return size;
+	}
 }
@@ -8,10 +8,16 @@
 
 namespace Turso3D
 {
+	class Animation;
+	class Model;
+
 	constexpr unsigned char CHANNEL_POSITION = 1;
 	constexpr unsigned char CHANNEL_ROTATION = 2;
 	constexpr unsigned char CHANNEL_SCALE = 4;
 
+	// Number of keyframe channels.
+	constexpr size_t NUM_ANIMATION_CHANNELS = 3;
+
 	// Skeletal animation keyframe.
 	struct AnimationKeyFrame
 	{
@@ -32,11 +38,64 @@ namespace Turso3D
 		Vector3 scale;
 	};
 
+	// Compressed keyframes of one track channel (position, rotation or scale.)
+	// Each channel keeps its own keys, so that keyframe reduction can drop them independently.
+	struct CompressedAnimationChannel
+	{
+		// Return number of keys. One key means a constant value.
+		size_t NumKeys() const { return times.size(); }
+
+		// Key times in units of the animation's key time step.
+		std::vector<unsigned short> times;
+		// Quantized values, 3 per key. Positions and scales are quantized to 16 bits over the value range, rotations are stored as the smallest three components.
+		std::vector<unsigned short> values;
+		// Minimum value for dequantizing positions and scales.
+		Vector3 minValue;
+		// Value range for dequantizing positions and scales.
+		Vector3 valueRange;
+	};
+
+	// Settings for compressing an animation.
+	struct AnimationCompressionSettings
+	{
+		// Maximum position error allowed by keyframe reduction and quantization.
+		float positionTolerance = 0.001f;
+		// Maximum rotation error in degrees allowed by keyframe reduction and quantization.
+		float rotationTolerance = 0.1f;
+		// Maximum scale error allowed by keyframe reduction and quantization.
+		float scaleTolerance = 0.001f;
+		// Model to compare the tracks against. If set, channels that stay in the model's bind pose are removed, and tracks left without channels are removed entirely.
+		// The bones are reset to the bind pose before animations are applied, so this only changes the result when the animation is blended at partial weight on top of other animations.
+		const Model* bindPoseModel = nullptr;
+	};
+
+	// Keys of an animation track to interpolate between at a time position.
+	struct AnimationTrackKeys
+	{
+		// Position keys.
+		Vector3 positions[2];
+		// Rotation keys.
+		Quaternion rotations[2];
+		// Scale keys.
+		Vector3 scales[2];
+		// Interpolation factors per channel.
+		float factors[NUM_ANIMATION_CHANNELS];
+	};
+
 	// Skeletal animation track, stores keyframes of a single bone.
 	struct AnimationTrack
 	{
 		// Adjust keyframe index by time.
+		// Continuous playback finds the key in constant time from the previous index, and uniformly sampled keys are found in constant time also after a jump.
 		void FindKeyFrameIndex(float time, size_t& index) const;
+		// Find the keys to interpolate between at a time position. Keys of channels not included in the track are left unchanged.
+		// Last key frame indices per channel are given for faster key search and updated. Uncompressed tracks use only the first.
+		void FindKeys(const Animation& animation, float time, bool looped, size_t* lastKeyFrames, AnimationTrackKeys& keys) const;
+		// Sample the track at a time position. Channels not included in the track are left unchanged. Rotations are interpolated with normalized lerp.
+		// Last key frame indices per channel are given for faster key search and updated. Uncompressed tracks use only the first.
+		void Sample(const Animation& animation, float time, bool looped, size_t* lastKeyFrames, Vector3& position, Quaternion& rotation, Vector3& scale) const;
+		// Return whether has no keyframes in either format.
+		bool IsEmpty() const { return keyFrames.empty() && !channels[0].NumKeys() && !channels[1].NumKeys() && !channels[2].NumKeys(); }
 
 		// Bone or scene node name.
 		std::string name;
@@ -46,6 +105,8 @@ namespace Turso3D
 		unsigned char channelMask;
 		// Keyframes.
 		std::vector<AnimationKeyFrame> keyFrames;
+		// Compressed keyframes per channel in position, rotation, scale order. Used instead of the keyframes after the animation has been compressed.
+		CompressedAnimationChannel channels[NUM_ANIMATION_CHANNELS];
 	};
 
 	// Skeletal animation resource.
@@ -59,6 +120,8 @@ namespace Turso3D
 
 		// Load animation from a stream. Return true on success.
 		bool BeginLoad(Stream& source) override;
+		// Save animation to a stream. Compressed animations are saved in the compressed format. Return true on success.
+		bool Save(Stream& dest) override;
 
 		// Set animation name.
 		void SetAnimationName(const std::string& name);
@@ -73,6 +136,11 @@ namespace Turso3D
 		// Remove all tracks.
 		// This is unsafe if the animation is currently used in playback.
 		void RemoveAllTracks();
+		// Convert the keyframes of all tracks to the compressed format, using quantization, constant channel elimination and error-bounded keyframe reduction.
+		// Tracks that can not be quantized within the tolerances, such as long root motion, are left as keyframes.
+		// Can be called again to compress tracks that were created afterward.
+		// This is unsafe if the animation is currently used in playback.
+		void Compress(const AnimationCompressionSettings& settings = AnimationCompressionSettings());
 
 		// Return animation name.
 		const std::string& AnimationName() const { return animationName; }
@@ -90,6 +158,12 @@ namespace Turso3D
 		AnimationTrack* FindTrack(const std::string& name) const;
 		// Return animation track by name hash.
 		AnimationTrack* FindTrack(StringHash nameHash) const;
+		// Return whether has been compressed.
+		bool IsCompressed() const { return compressed; }
+		// Return the time unit of compressed keys. This is the keyframe interval for uniformly sampled animations, so that their key times are exact.
+		float KeyTimeStep() const { return keyTimeStep; }
+		// Return the memory use of the keyframe data in bytes.
+		size_t DataSize() const;
 
 	private:
 		// Animation name.
@@ -100,5 +174,9 @@ namespace Turso3D
 		float length;
 		// Animation tracks.
 		std::map<StringHash, AnimationTrack> tracks;
+		// Time unit of compressed keys.
+		float keyTimeStep;
+		// Compressed flag.
+		bool compressed;
 	};
 }
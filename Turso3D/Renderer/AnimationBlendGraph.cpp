@@ -0,0 +1,348 @@
+#include <Turso3D/Renderer/AnimationBlendGraph.h>
+#include <Turso3D/IO/Log.h>
+#include <Turso3D/IO/MemoryStream.h>
+#include <Turso3D/Renderer/Animation.h>
+#include <Turso3D/Resource/ResourceCache.h>
+#include <pugixml/pugixml.hpp>
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	using namespace Turso3D;
+
+	static const char* BlendNodeTypeName(AnimationBlendNodeType value)
+	{
+		constexpr const char* data[] = {
+			"clip",
+			"blendSpace1D",
+			"blendSpace2D",
+			"additive",
+			"crossfade",
+			"mask",
+			nullptr
+		};
+		return data[value];
+	}
+
+	static AnimationBlendNodeType BlendNodeTypeFromName(const char* name)
+	{
+		for (int i = 0; i < MAX_BLEND_NODE_TYPES; ++i) {
+			AnimationBlendNodeType type = static_cast<AnimationBlendNodeType>(i);
+			if (strcmp(name, BlendNodeTypeName(type)) == 0) {
+				return type;
+			}
+		}
+		return MAX_BLEND_NODE_TYPES;
+	}
+
+	// Node visit states for ordering the nodes.
+	constexpr unsigned char NODE_UNVISITED = 0;
+	constexpr unsigned char NODE_VISITING = 1;
+	constexpr unsigned char NODE_VISITED = 2;
+}
+
+namespace Turso3D
+{
+	struct AnimationBlendGraph::LoadBuffer
+	{
+		// Node with its references still by name.
+		struct LoadNode
+		{
+			// Node data.
+			AnimationBlendNode node;
+			// Input node names.
+			std::vector<std::string> inputNames;
+			// Parameter names.
+			std::string parameterNames[2];
+			// Animation resource name of a clip node.
+			std::string animationName;
+		};
+
+		// Load from an xml node.
+		bool LoadXML(pugi::xml_node& root)
+		{
+			using namespace pugi;
+
+			outputName = root.attribute("output").value();
+
+			for (xml_node element : root.children()) {
+				if (strcmp(element.name(), "parameter") == 0) {
+					AnimationBlendParameter& parameter = parameters.emplace_back();
+					parameter.name = element.attribute("name").value();
+					parameter.nameHash = StringHash(parameter.name);
+					parameter.defaultValue = element.attribute("value").as_float();
+					continue;
+				}
+
+				AnimationBlendNodeType type = BlendNodeTypeFromName(element.name());
+				if (type == MAX_BLEND_NODE_TYPES) {
+					LOG_ERROR("Unknown blend graph node type {:s}", element.name());
+					return false;
+				}
+
+				LoadNode& data = nodes.emplace_back();
+				AnimationBlendNode& node = data.node;
+				node.type = type;
+				node.name = element.attribute("name").value();
+				node.nameHash = StringHash(node.name);
+				node.parameters[0] = node.parameters[1] = NO_BLEND_PARAMETER;
+				node.speed = element.attribute("speed").as_float(1.0f);
+				node.looped = element.attribute("looped").as_bool(true);
+				node.weight = element.attribute("weight").as_float(1.0f);
+				node.fadeTime = element.attribute("fadeTime").as_float(0.2f);
+
+				switch (type) {
+				case BLEND_NODE_CLIP:
+					{
+						data.animationName = element.attribute("animation").value();
+
+						// When loading asynchronously, load the animation in parallel. EndLoad takes it from the cache
+						ResourceCache* cache = ResourceCache::Instance();
+						if (cache->IsLoadingAsync()) {
+							std::shared_ptr<Animation> animation = std::make_shared<Animation>();
+							animation->SetName(data.animationName);
+							cache->LoadDependencyAsync(animation);
+						}
+					}
+					break;
+
+				case BLEND_NODE_BLEND_SPACE_2D:
+					data.parameterNames[0] = element.attribute("parameterX").value();
+					data.parameterNames[1] = element.attribute("parameterY").value();
+					[[fallthrough]];
+
+				case BLEND_NODE_BLEND_SPACE_1D:
+				case BLEND_NODE_CROSSFADE:
+					if (type != BLEND_NODE_BLEND_SPACE_2D) {
+						data.parameterNames[0] = element.attribute("parameter").value();
+					}
+					for (xml_node input : element.children("input")) {
+						data.inputNames.push_back(input.attribute("node").value());
+						node.positions.push_back(Vector2(input.attribute("x").as_float(), input.attribute("y").as_float()));
+					}
+					break;
+
+				case BLEND_NODE_ADDITIVE:
+				case BLEND_NODE_MASK:
+					data.parameterNames[0] = element.attribute("parameter").value();
+					data.inputNames.push_back(element.attribute("base").value());
+					data.inputNames.push_back(element.attribute(type == BLEND_NODE_ADDITIVE ? "additive" : "overlay").value());
+					for (xml_node bone : element.children("bone")) {
+						AnimationBlendMaskBone& maskBone = node.maskBones.emplace_back();
+						maskBone.nameHash = StringHash(bone.attribute("name").value());
+						maskBone.weight = bone.attribute("weight").as_float(1.0f);
+						maskBone.recursive = bone.attribute("recursive").as_bool(true);
+					}
+					break;
+
+				default:
+					break;
+				}
+			}
+
+			return true;
+		}
+
+		// Return index of a node by name, or the node count if not found.
+		size_t FindNode(const std::string& name) const
+		{
+			for (size_t i = 0; i < nodes.size(); ++i) {
+				if (nodes[i].node.name == name) {
+					return i;
+				}
+			}
+			return nodes.size();
+		}
+
+		// Add a node to the evaluation order after its inputs. Return false on a cycle.
+		bool OrderNode(size_t index, std::vector<unsigned char>& states, std::vector<size_t>& order) const
+		{
+			if (states[index] == NODE_VISITED) {
+				return true;
+			}
+			if (states[index] == NODE_VISITING) {
+				LOG_ERROR("Blend graph node {:s} depends on itself", nodes[index].node.name);
+				return false;
+			}
+
+			states[index] = NODE_VISITING;
+			for (size_t input : nodes[index].node.inputs) {
+				if (!OrderNode(input, states, order)) {
+					return false;
+				}
+			}
+			states[index] = NODE_VISITED;
+			order.push_back(index);
+			return true;
+		}
+
+		// Parsed nodes in file order, with inputs indexing this vector once resolved.
+		std::vector<LoadNode> nodes;
+		// Parameters.
+		std::vector<AnimationBlendParameter> parameters;
+		// Name of the output node. Empty to use the last node.
+		std::string outputName;
+	};
+
+	// ==========================================================================================
+	AnimationBlendGraph::AnimationBlendGraph() :
+		numClips(0)
+	{
+	}
+
+	AnimationBlendGraph::~AnimationBlendGraph()
+	{
+	}
+
+	bool AnimationBlendGraph::BeginLoad(Stream& source)
+	{
+		MemoryStream buffer {};
+		buffer.Resize(source.Size());
+		buffer.Resize(source.Read(buffer.ModifiableData(), buffer.Size()));
+
+		pugi::xml_document document {};
+		pugi::xml_parse_result result = document.load_buffer(buffer.Data(), buffer.Size());
+		if (result.status != pugi::status_ok) {
+			LOG_ERROR("Failed to parse xml from archive \"{:s}\": {:s}", source.Name(), result.description());
+			return false;
+		}
+		pugi::xml_node root = document.root().child("blendGraph");
+
+		loadBuffer = std::make_unique<LoadBuffer>();
+		if (!loadBuffer->LoadXML(root)) {
+			loadBuffer.reset();
+			return false;
+		}
+		return true;
+	}
+
+	bool AnimationBlendGraph::EndLoad()
+	{
+		if (!loadBuffer) {
+			return false;
+		}
+
+		std::unique_ptr<LoadBuffer> data = std::move(loadBuffer);
+		std::vector<LoadBuffer::LoadNode>& loadNodes = data->nodes;
+
+		nodes.clear();
+		parameters = std::move(data->parameters);
+		numClips = 0;
+
+		if (loadNodes.empty()) {
+			LOG_ERROR("Blend graph {:s} has no nodes", Name());
+			return false;
+		}
+
+		ResourceCache* cache = ResourceCache::Instance();
+
+		// Resolve the references by name
+		for (LoadBuffer::LoadNode& loadNode : loadNodes) {
+			AnimationBlendNode& node = loadNode.node;
+
+			for (size_t i = 0; i < 2; ++i) {
+				if (loadNode.parameterNames[i].empty()) {
+					continue;
+				}
+				node.parameters[i] = FindParameter(StringHash(loadNode.parameterNames[i]));
+				if (node.parameters[i] == NO_BLEND_PARAMETER) {
+					LOG_ERROR("Blend graph node {:s} uses undeclared parameter {:s}", node.name, loadNode.parameterNames[i]);
+					return false;
+				}
+			}
+
+			bool needsParameters = node.type == BLEND_NODE_BLEND_SPACE_1D || node.type == BLEND_NODE_BLEND_SPACE_2D || node.type == BLEND_NODE_CROSSFADE;
+			bool needsSecondParameter = node.type == BLEND_NODE_BLEND_SPACE_2D;
+			if ((needsParameters && node.parameters[0] == NO_BLEND_PARAMETER) || (needsSecondParameter && node.parameters[1] == NO_BLEND_PARAMETER)) {
+				LOG_ERROR("Blend graph node {:s} has no parameter", node.name);
+				return false;
+			}
+
+			for (const std::string& inputName : loadNode.inputNames) {
+				size_t input = data->FindNode(inputName);
+				if (input >= loadNodes.size()) {
+					LOG_ERROR("Blend graph node {:s} has unknown input {:s}", node.name, inputName);
+					return false;
+				}
+				node.inputs.push_back(input);
+			}
+
+			if (node.type != BLEND_NODE_CLIP && node.inputs.empty()) {
+				LOG_ERROR("Blend graph node {:s} has no inputs", node.name);
+				return false;
+			}
+
+			if (node.type == BLEND_NODE_CLIP) {
+				node.animation = cache->LoadResource<Animation>(loadNode.animationName);
+				if (!node.animation) {
+					LOG_ERROR("Failed to load animation {:s} for blend graph node {:s}", loadNode.animationName, node.name);
+					return false;
+				}
+			}
+		}
+
+		size_t output = data->outputName.empty() ? loadNodes.size() - 1 : data->FindNode(data->outputName);
+		if (output >= loadNodes.size()) {
+			LOG_ERROR("Blend graph {:s} has unknown output node {:s}", Name(), data->outputName);
+			return false;
+		}
+
+		// Flatten the graph so that the inputs of each node are evaluated before it. Nodes not leading to the output are left out
+		std::vector<unsigned char> states(loadNodes.size(), NODE_UNVISITED);
+		std::vector<size_t> order;
+		if (!data->OrderNode(output, states, order)) {
+			return false;
+		}
+
+		std::vector<size_t> newIndices(loadNodes.size(), 0);
+		for (size_t i = 0; i < order.size(); ++i) {
+			newIndices[order[i]] = i;
+		}
+
+		nodes.resize(order.size());
+		for (size_t i = 0; i < order.size(); ++i) {
+			AnimationBlendNode& node = nodes[i];
+			node = std::move(loadNodes[order[i]].node);
+			for (size_t& input : node.inputs) {
+				input = newIndices[input];
+			}
+
+			if (node.type == BLEND_NODE_BLEND_SPACE_1D) {
+				std::vector<std::pair<float, size_t>> sorted;
+				for (size_t j = 0; j < node.inputs.size(); ++j) {
+					sorted.push_back(std::make_pair(node.positions[j].x, node.inputs[j]));
+				}
+				std::sort(sorted.begin(), sorted.end());
+				for (size_t j = 0; j < sorted.size(); ++j) {
+					node.positions[j] = Vector2(sorted[j].first, 0.0f);
+					node.inputs[j] = sorted[j].second;
+				}
+			} else if (node.type == BLEND_NODE_CLIP) {
+				++numClips;
+			}
+		}
+
+		return true;
+	}
+
+	size_t AnimationBlendGraph::FindNode(StringHash nameHash) const
+	{
+		for (size_t i = 0; i < nodes.size(); ++i) {
+			if (nodes[i].nameHash == nameHash) {
+				return i;
+			}
+		}
+		return nodes.size();
+	}
+
+	size_t AnimationBlendGraph::FindParameter(StringHash nameHash) const
+	{
+		for (size_t i = 0; i < parameters.size(); ++i) {
+			if (parameters[i].nameHash == nameHash) {
+				return i;
+			}
+		}
+		return NO_BLEND_PARAMETER;
+	}
+}
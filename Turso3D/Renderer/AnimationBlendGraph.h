@@ -0,0 +1,122 @@
+#pragma once
+
+#include <Turso3D/Math/Vector2.h>
+#include <Turso3D/Resource/Resource.h>
+#include <memory>
+#include <vector>
+
+namespace Turso3D
+{
+	class Animation;
+
+	// Blend graph node types.
+	enum AnimationBlendNodeType
+	{
+		// Samples an animation clip.
+		BLEND_NODE_CLIP = 0,
+		// Blends the inputs by their positions along one parameter.
+		BLEND_NODE_BLEND_SPACE_1D,
+		// Blends the inputs by their positions on the plane of two parameters, with gradient band interpolation.
+		BLEND_NODE_BLEND_SPACE_2D,
+		// Adds the difference of the second input from the skeleton's initial pose to the first input.
+		BLEND_NODE_ADDITIVE,
+		// Selects an input by a parameter, fading from the previous selection over time.
+		BLEND_NODE_CROSSFADE,
+		// Blends the second input over the first with per-bone weights.
+		BLEND_NODE_MASK,
+		MAX_BLEND_NODE_TYPES
+	};
+
+	// Parameter index value for nodes without a parameter.
+	constexpr size_t NO_BLEND_PARAMETER = ~static_cast<size_t>(0);
+
+	// Named value that drives blend weights.
+	struct AnimationBlendParameter
+	{
+		// Parameter name.
+		std::string name;
+		// Parameter name hash.
+		StringHash nameHash;
+		// Initial value.
+		float defaultValue;
+	};
+
+	// Bone weight of a mask node.
+	struct AnimationBlendMaskBone
+	{
+		// Bone name hash.
+		StringHash nameHash;
+		// Blend weight.
+		float weight;
+		// Whether the weight also applies to the child bones that are not listed.
+		bool recursive;
+	};
+
+	// Node of a compiled blend graph.
+	struct AnimationBlendNode
+	{
+		// Node type.
+		AnimationBlendNodeType type;
+		// Node name.
+		std::string name;
+		// Node name hash.
+		StringHash nameHash;
+		// Input node indices. Inputs precede the node in the evaluation order.
+		std::vector<size_t> inputs;
+		// Blend space positions of the inputs. Blend space 1D inputs are sorted by position.
+		std::vector<Vector2> positions;
+		// Parameter indices. Blend space 2D uses both, other nodes only the first.
+		size_t parameters[2];
+		// Animation of a clip node.
+		std::shared_ptr<Animation> animation;
+		// Playback speed of a clip node.
+		float speed;
+		// Looped flag of a clip node.
+		bool looped;
+		// Weight of the second input of an additive or mask node, when not driven by a parameter.
+		float weight;
+		// Crossfade duration in seconds.
+		float fadeTime;
+		// Bone weights of a mask node.
+		std::vector<AnimationBlendMaskBone> maskBones;
+	};
+
+	// Data-driven animation blend graph, loaded from XML. Compiled on load to a flat list of nodes in evaluation order, with the output node last.
+	// Played on an animated model through AnimationBlendGraphState.
+	class AnimationBlendGraph : public Resource
+	{
+		struct LoadBuffer;
+
+	public:
+		// Construct.
+		AnimationBlendGraph();
+		// Destruct.
+		~AnimationBlendGraph();
+
+		// Parse the XML description. Return true on success.
+		bool BeginLoad(Stream& source) override;
+		// Load the animations and compile the nodes. Return true on success.
+		bool EndLoad() override;
+
+		// Return the nodes in evaluation order. The output node is last.
+		const std::vector<AnimationBlendNode>& Nodes() const { return nodes; }
+		// Return the parameters.
+		const std::vector<AnimationBlendParameter>& Parameters() const { return parameters; }
+		// Return index of a node by name hash, or the node count if not found.
+		size_t FindNode(StringHash nameHash) const;
+		// Return index of a parameter by name hash, or NO_BLEND_PARAMETER if not found.
+		size_t FindParameter(StringHash nameHash) const;
+		// Return number of clip nodes.
+		size_t NumClips() const { return numClips; }
+
+	private:
+		// Nodes in evaluation order.
+		std::vector<AnimationBlendNode> nodes;
+		// Parameters.
+		std::vector<AnimationBlendParameter> parameters;
+		// Number of clip nodes.
+		size_t numClips;
+		// Parsed data waiting for EndLoad.
+		std::unique_ptr<LoadBuffer> loadBuffer;
+	};
+}
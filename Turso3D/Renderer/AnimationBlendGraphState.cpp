@@ -0,0 +1,354 @@
+#include <Turso3D/Renderer/AnimationBlendGraphState.h>
+#include <Turso3D/Math/Math.h>
+#include <Turso3D/Renderer/AnimatedModel.h>
+#include <Turso3D/Renderer/AnimationBlendGraph.h>
+#include <Turso3D/Renderer/AnimationState.h>
+#include <Turso3D/Renderer/Model.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+	using namespace Turso3D;
+
+	// Return the input of a crossfade node selected by a parameter value.
+	static inline size_t SelectInput(float value, size_t numInputs)
+	{
+		return static_cast<size_t>(Clamp(static_cast<int>(std::lround(value)), 0, static_cast<int>(numInputs) - 1));
+	}
+}
+
+namespace Turso3D
+{
+	AnimationBlendGraphState::AnimationBlendGraphState(AnimatedModelDrawable* drawable_, const Model* model, const std::shared_ptr<AnimationBlendGraph>& graph_) :
+		drawable(drawable_),
+		graph(graph_)
+	{
+		assert(drawable);
+		assert(graph);
+
+		const std::vector<AnimationBlendParameter>& parameters = graph->Parameters();
+		parameterValues.resize(parameters.size());
+		for (size_t i = 0; i < parameters.size(); ++i) {
+			parameterValues[i] = parameters[i].defaultValue;
+		}
+
+		static const std::vector<ModelBone> noBones;
+		const std::vector<ModelBone>& modelBones = model ? model->Bones() : noBones;
+		bindPose.Resize(modelBones.size());
+		bindPose.SetBindPose(modelBones);
+		scaledMaskWeights.resize(bindPose.NumPaddedBones());
+
+		const std::vector<AnimationBlendNode>& nodes = graph->Nodes();
+		clips.resize(nodes.size());
+		crossfades.resize(nodes.size());
+		maskWeights.resize(nodes.size());
+		firstInputWeights.resize(nodes.size());
+		activeNodes.resize(nodes.size());
+		poses.resize(nodes.size());
+
+		size_t numInputs = 0;
+		for (size_t i = 0; i < nodes.size(); ++i) {
+			const AnimationBlendNode& node = nodes[i];
+			firstInputWeights[i] = numInputs;
+			numInputs += node.inputs.size();
+
+			if (node.type == BLEND_NODE_CLIP) {
+				clips[i] = std::make_unique<AnimationState>(drawable, node.animation);
+				clips[i]->SetLooped(node.looped);
+				clips[i]->SetWeight(1.0f);
+			} else if (node.type == BLEND_NODE_CROSSFADE) {
+				Crossfade& crossfade = crossfades[i];
+				crossfade.current = crossfade.previous = SelectInput(parameterValues[node.parameters[0]], node.inputs.size());
+				crossfade.elapsed = node.fadeTime;
+			} else if (node.type == BLEND_NODE_MASK) {
+				// Use the weight of the bone, or of the closest ancestor with a recursive weight. Bones not covered stay in the base pose
+				std::vector<float>& weights = maskWeights[i];
+				weights.resize(bindPose.NumPaddedBones());
+
+				for (size_t j = 0; j < modelBones.size(); ++j) {
+					size_t boneIndex = j;
+					for (;;) {
+						auto it = std::find_if(node.maskBones.begin(), node.maskBones.end(), [&](const AnimationBlendMaskBone& maskBone) {
+							return maskBone.nameHash == modelBones[boneIndex].nameHash && (boneIndex == j || maskBone.recursive);
+						});
+						if (it != node.maskBones.end()) {
+							weights[j] = it->weight;
+							break;
+						}
+
+						size_t parentIndex = modelBones[boneIndex].parentIndex;
+						if (parentIndex == boneIndex || parentIndex >= modelBones.size()) {
+							break;
+						}
+						boneIndex = parentIndex;
+					}
+				}
+			}
+		}
+
+		inputWeights.resize(numInputs);
+	}
+
+	AnimationBlendGraphState::~AnimationBlendGraphState()
+	{
+	}
+
+	void AnimationBlendGraphState::SetParameter(size_t index, float value)
+	{
+		if (index >= parameterValues.size() || parameterValues[index] == value) {
+			return;
+		}
+
+		parameterValues[index] = value;
+
+		// Start fading to a newly selected crossfade input
+		const std::vector<AnimationBlendNode>& nodes = graph->Nodes();
+		for (size_t i = 0; i < nodes.size(); ++i) {
+			const AnimationBlendNode& node = nodes[i];
+			if (node.type != BLEND_NODE_CROSSFADE || node.parameters[0] != index) {
+				continue;
+			}
+
+			Crossfade& crossfade = crossfades[i];
+			size_t selected = SelectInput(value, node.inputs.size());
+			if (selected != crossfade.current) {
+				crossfade.previous = crossfade.current;
+				crossfade.current = selected;
+				crossfade.elapsed = 0.0f;
+			}
+		}
+
+		drawable->OnAnimationChanged();
+	}
+
+	bool AnimationBlendGraphState::SetParameter(StringHash nameHash, float value)
+	{
+		size_t index = graph->FindParameter(nameHash);
+		if (index == NO_BLEND_PARAMETER) {
+			return false;
+		}
+
+		SetParameter(index, value);
+		return true;
+	}
+
+	void AnimationBlendGraphState::AddTime(float delta)
+	{
+		const std::vector<AnimationBlendNode>& nodes = graph->Nodes();
+		for (size_t i = 0; i < nodes.size(); ++i) {
+			const AnimationBlendNode& node = nodes[i];
+			if (clips[i]) {
+				clips[i]->AddTime(delta * node.speed);
+			} else if (node.type == BLEND_NODE_CROSSFADE) {
+				crossfades[i].elapsed = std::min(crossfades[i].elapsed + delta, node.fadeTime);
+			}
+		}
+
+		drawable->OnAnimationChanged();
+	}
+
+	void AnimationBlendGraphState::Reset()
+	{
+		const std::vector<AnimationBlendNode>& nodes = graph->Nodes();
+		for (size_t i = 0; i < nodes.size(); ++i) {
+			if (clips[i]) {
+				clips[i]->SetTime(0.0f);
+			} else if (nodes[i].type == BLEND_NODE_CROSSFADE) {
+				crossfades[i].previous = crossfades[i].current;
+				crossfades[i].elapsed = nodes[i].fadeTime;
+			}
+		}
+
+		drawable->OnAnimationChanged();
+	}
+
+	void AnimationBlendGraphState::Evaluate(AnimationPose& dest, const unsigned char* boneDepths, unsigned char maxBoneDepth)
+	{
+		const std::vector<AnimationBlendNode>& nodes = graph->Nodes();
+		if (nodes.empty()) {
+			dest = bindPose;
+			return;
+		}
+
+		// Find the nodes contributing to the output, going backward from it, so that inputs at zero weight are not evaluated
+		std::fill(activeNodes.begin(), activeNodes.end(), 0);
+		activeNodes.back() = 1;
+
+		for (size_t i = nodes.size(); i-- > 0;) {
+			if (!activeNodes[i]) {
+				continue;
+			}
+
+			CalculateInputWeights(i);
+			const AnimationBlendNode& node = nodes[i];
+			const float* weights = &inputWeights[firstInputWeights[i]];
+			for (size_t j = 0; j < node.inputs.size(); ++j) {
+				if (weights[j] != 0.0f) {
+					activeNodes[node.inputs[j]] = 1;
+				}
+			}
+		}
+
+		// Evaluate forward, inputs first, each node into its own pose buffer
+		for (size_t i = 0; i < nodes.size(); ++i) {
+			if (!activeNodes[i]) {
+				continue;
+			}
+
+			const AnimationBlendNode& node = nodes[i];
+			const float* weights = node.inputs.empty() ? nullptr : &inputWeights[firstInputWeights[i]];
+			AnimationPose& pose = poses[i];
+
+			switch (node.type) {
+			case BLEND_NODE_CLIP:
+				pose = bindPose;
+				clips[i]->ApplyToPose(pose, boneDepths, maxBoneDepth);
+				break;
+
+			case BLEND_NODE_BLEND_SPACE_1D:
+			case BLEND_NODE_BLEND_SPACE_2D:
+			case BLEND_NODE_CROSSFADE:
+				{
+					// Blend the inputs one by one, each at its share of the weight so far
+					float totalWeight = 0.0f;
+					for (size_t j = 0; j < node.inputs.size(); ++j) {
+						if (weights[j] <= 0.0f) {
+							continue;
+						}
+						if (totalWeight == 0.0f) {
+							pose = poses[node.inputs[j]];
+						} else {
+							pose.Interpolate(pose, poses[node.inputs[j]], weights[j] / (totalWeight + weights[j]));
+						}
+						totalWeight += weights[j];
+					}
+				}
+				break;
+
+			case BLEND_NODE_ADDITIVE:
+				pose = poses[node.inputs[0]];
+				if (weights[1] != 0.0f) {
+					pose.Add(poses[node.inputs[1]], bindPose, weights[1]);
+				}
+				break;
+
+			case BLEND_NODE_MASK:
+				pose = poses[node.inputs[0]];
+				if (weights[1] != 0.0f) {
+					const std::vector<float>& boneWeights = maskWeights[i];
+					float weight = Clamp(weights[1], 0.0f, 1.0f);
+					for (size_t j = 0; j < boneWeights.size(); ++j) {
+						scaledMaskWeights[j] = boneWeights[j] * weight;
+					}
+					pose.Interpolate(pose, poses[node.inputs[1]], scaledMaskWeights.data());
+				}
+				break;
+
+			default:
+				break;
+			}
+		}
+
+		dest = poses.back();
+	}
+
+	float AnimationBlendGraphState::Parameter(StringHash nameHash) const
+	{
+		return Parameter(graph->FindParameter(nameHash));
+	}
+
+	void AnimationBlendGraphState::CalculateInputWeights(size_t index)
+	{
+		const AnimationBlendNode& node = graph->Nodes()[index];
+		size_t numInputs = node.inputs.size();
+		if (!numInputs) {
+			return;
+		}
+
+		float* weights = &inputWeights[firstInputWeights[index]];
+		std::fill(weights, weights + numInputs, 0.0f);
+
+		switch (node.type) {
+		case BLEND_NODE_BLEND_SPACE_1D:
+			{
+				// Linear between the two closest positions, clamped to the ends
+				const std::vector<Vector2>& positions = node.positions;
+				float x = parameterValues[node.parameters[0]];
+
+				if (x <= positions.front().x) {
+					weights[0] = 1.0f;
+				} else if (x >= positions.back().x) {
+					weights[numInputs - 1] = 1.0f;
+				} else {
+					for (size_t i = 0; i + 1 < numInputs; ++i) {
+						if (x < positions[i + 1].x) {
+							float span = positions[i + 1].x - positions[i].x;
+							float t = span > 0.0f ? (x - positions[i].x) / span : 1.0f;
+							weights[i] = 1.0f - t;
+							weights[i + 1] = t;
+							break;
+						}
+					}
+				}
+			}
+			break;
+
+		case BLEND_NODE_BLEND_SPACE_2D:
+			{
+				// Gradient band interpolation: each input's weight falls off toward every other input
+				const std::vector<Vector2>& positions = node.positions;
+				Vector2 point(parameterValues[node.parameters[0]], parameterValues[node.parameters[1]]);
+				float totalWeight = 0.0f;
+
+				for (size_t i = 0; i < numInputs; ++i) {
+					Vector2 offset = point - positions[i];
+					float weight = 1.0f;
+					for (size_t j = 0; j < numInputs && weight > 0.0f; ++j) {
+						Vector2 edge = positions[j] - positions[i];
+						float lengthSquared = edge.LengthSquared();
+						if (j != i && lengthSquared > 0.0f) {
+							weight = std::min(weight, Clamp(1.0f - offset.DotProduct(edge) / lengthSquared, 0.0f, 1.0f));
+						}
+					}
+					weights[i] = weight;
+					totalWeight += weight;
+				}
+
+				if (totalWeight > 0.0f) {
+					for (size_t i = 0; i < numInputs; ++i) {
+						weights[i] /= totalWeight;
+					}
+				} else {
+					weights[0] = 1.0f;
+				}
+			}
+			break;
+
+		case BLEND_NODE_CROSSFADE:
+			{
+				const Crossfade& crossfade = crossfades[index];
+				float t = node.fadeTime > 0.0f ? Clamp(crossfade.elapsed / node.fadeTime, 0.0f, 1.0f) : 1.0f;
+				weights[crossfade.current] += t;
+				weights[crossfade.previous] += 1.0f - t;
+			}
+			break;
+
+		case BLEND_NODE_ADDITIVE:
+		case BLEND_NODE_MASK:
+			weights[0] = 1.0f;
+			weights[1] = OverlayWeight(index);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	float AnimationBlendGraphState::OverlayWeight(size_t index) const
+	{
+		const AnimationBlendNode& node = graph->Nodes()[index];
+		return node.parameters[0] != NO_BLEND_PARAMETER ? node.weight * parameterValues[node.parameters[0]] : node.weight;
+	}
+}
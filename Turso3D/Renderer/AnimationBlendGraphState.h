@@ -0,0 +1,91 @@
+#pragma once
+
+#include <Turso3D/Renderer/AnimationPose.h>
+#include <Turso3D/Utils/StringHash.h>
+#include <memory>
+#include <vector>
+
+namespace Turso3D
+{
+	class AnimatedModelDrawable;
+	class AnimationBlendGraph;
+	class AnimationState;
+	class Model;
+
+	// Blend graph instance playing on an animated model. Holds the parameter values, clip time positions, crossfade progress and the pose buffers of the nodes.
+	// The output pose is evaluated in the model's animation update, before the animation states are blended over it.
+	class AnimationBlendGraphState
+	{
+	public:
+		// Construct with animated model drawable, the model whose skeleton to animate and the blend graph.
+		AnimationBlendGraphState(AnimatedModelDrawable* drawable, const Model* model, const std::shared_ptr<AnimationBlendGraph>& graph);
+		// Destruct.
+		~AnimationBlendGraphState();
+
+		// Set parameter value by index.
+		void SetParameter(size_t index, float value);
+		// Set parameter value by name hash. Return true if found.
+		bool SetParameter(StringHash nameHash, float value);
+		// Advance the clips by their speeds and the crossfades.
+		void AddTime(float delta);
+		// Rewind the clips and complete the crossfades.
+		void Reset();
+
+		// Evaluate the graph into a pose. Only the nodes contributing to the output are evaluated.
+		// Optionally skip the bones deeper in the skeleton than a maximum depth, given the depth of each bone. They are left in the initial pose.
+		// Called by AnimatedModelDrawable in the animation update worker threads.
+		void Evaluate(AnimationPose& dest, const unsigned char* boneDepths = nullptr, unsigned char maxBoneDepth = 0);
+
+		// Return the blend graph.
+		const std::shared_ptr<AnimationBlendGraph>& Graph() const { return graph; }
+		// Return parameter value by index.
+		float Parameter(size_t index) const { return index < parameterValues.size() ? parameterValues[index] : 0.0f; }
+		// Return parameter value by name hash.
+		float Parameter(StringHash nameHash) const;
+		// Return playback state of a clip node by node index, or null if not a clip node.
+		AnimationState* Clip(size_t index) const { return index < clips.size() ? clips[index].get() : nullptr; }
+
+	private:
+		// Crossfade progress of a crossfade node.
+		struct Crossfade
+		{
+			// Selected input.
+			size_t current;
+			// Input faded out from.
+			size_t previous;
+			// Time since the selection changed.
+			float elapsed;
+		};
+
+		// Calculate the weights of a node's inputs from the parameters.
+		void CalculateInputWeights(size_t index);
+		// Return the weight of the second input of an additive or mask node.
+		float OverlayWeight(size_t index) const;
+
+	private:
+		// Animated model drawable.
+		AnimatedModelDrawable* drawable;
+		// Blend graph.
+		std::shared_ptr<AnimationBlendGraph> graph;
+		// Parameter values.
+		std::vector<float> parameterValues;
+		// Playback states of clip nodes by node index. Null for other nodes.
+		std::vector<std::unique_ptr<AnimationState>> clips;
+		// Crossfade progress by node index.
+		std::vector<Crossfade> crossfades;
+		// Per-bone weights of mask nodes by node index, padded like the pose. Empty for other nodes.
+		std::vector<std::vector<float>> maskWeights;
+		// Position of each node's first input weight.
+		std::vector<size_t> firstInputWeights;
+		// Input weights of all nodes.
+		std::vector<float> inputWeights;
+		// Whether each node contributes to the output on the current evaluation.
+		std::vector<unsigned char> activeNodes;
+		// Pose buffers by node index.
+		std::vector<AnimationPose> poses;
+		// Initial pose of the skeleton.
+		AnimationPose bindPose;
+		// Mask weights scaled by the node weight.
+		std::vector<float> scaledMaskWeights;
+	};
+}
@@ -0,0 +1,195 @@
+#include <Turso3D/Renderer/AnimationPose.h>
+#include <Turso3D/Math/Simd.h>
+#include <Turso3D/Renderer/Model.h>
+#include <Turso3D/Renderer/SkinnedModel.h>
+#include <algorithm>
+#include <cassert>
+
+#ifdef TURSO3D_SIMD
+namespace
+{
+	using namespace Turso3D;
+
+	// Position and scale components, which are interpolated linearly.
+	constexpr size_t VECTOR_COMPONENTS[] = {
+		AnimationPose::POSITION_X,
+		AnimationPose::POSITION_Y,
+		AnimationPose::POSITION_Z,
+		AnimationPose::SCALE_X,
+		AnimationPose::SCALE_Y,
+		AnimationPose::SCALE_Z
+	};
+
+	// Interpolate the transforms of 4 bones starting from index i. Rotations use normalized lerp along the shortest path.
+	static inline void InterpolateLanes(const float* a, const float* b, float* dest, size_t n, size_t i, Simd::Float4 factor)
+	{
+		// Positions and scales
+		for (size_t c : VECTOR_COMPONENTS) {
+			Simd::Float4 va = Simd::Load(a + c * n + i);
+			Simd::Float4 vb = Simd::Load(b + c * n + i);
+			Simd::Store(dest + c * n + i, Simd::Add(va, Simd::Mul(Simd::Sub(vb, va), factor)));
+		}
+
+		// Rotations
+		Simd::Float4 qa[4];
+		Simd::Float4 qb[4];
+		for (size_t j = 0; j < 4; ++j) {
+			qa[j] = Simd::Load(a + (AnimationPose::ROTATION_W + j) * n + i);
+			qb[j] = Simd::Load(b + (AnimationPose::ROTATION_W + j) * n + i);
+		}
+
+		Simd::Float4 dot = Simd::Mul(qa[0], qb[0]);
+		for (size_t j = 1; j < 4; ++j) {
+			dot = Simd::Add(dot, Simd::Mul(qa[j], qb[j]));
+		}
+
+		Simd::Float4 lengthSquared = Simd::Zero();
+		for (size_t j = 0; j < 4; ++j) {
+			qa[j] = Simd::Add(qa[j], Simd::Mul(Simd::Sub(Simd::MulSign(qb[j], dot), qa[j]), factor));
+			lengthSquared = Simd::Add(lengthSquared, Simd::Mul(qa[j], qa[j]));
+		}
+
+		Simd::Float4 length = Simd::Sqrt(lengthSquared);
+		for (size_t j = 0; j < 4; ++j) {
+			Simd::Store(dest + (AnimationPose::ROTATION_W + j) * n + i, Simd::Div(qa[j], length));
+		}
+	}
+}
+#endif
+
+namespace Turso3D
+{
+	AnimationPose::AnimationPose() :
+		numBones(0),
+		numPaddedBones(0)
+	{
+	}
+
+	void AnimationPose::Resize(size_t numBones_)
+	{
+		numBones = numBones_;
+		numPaddedBones = (numBones + 3) & ~static_cast<size_t>(3);
+		data.resize(NUM_COMPONENTS * numPaddedBones);
+
+		for (size_t i = numBones; i < numPaddedBones; ++i) {
+			SetTransform(i, Vector3::ZERO(), Quaternion::IDENTITY(), Vector3::ONE());
+		}
+	}
+
+	void AnimationPose::SetBindPose(const std::vector<ModelBone>& modelBones)
+	{
+		size_t count = std::min(modelBones.size(), numBones);
+		for (size_t i = 0; i < count; ++i) {
+			const ModelBone& modelBone = modelBones[i];
+			SetTransform(i, modelBone.position, modelBone.rotation, modelBone.scale);
+		}
+	}
+
+	void AnimationPose::SetFromBones(const std::vector<Bone*>& bones)
+	{
+		size_t count = std::min(bones.size(), numBones);
+		for (size_t i = 0; i < count; ++i) {
+			const Bone* bone = bones[i];
+			SetTransform(i, bone->Position(), bone->Rotation(), bone->Scale());
+		}
+	}
+
+	void AnimationPose::ApplyToBones(const std::vector<Bone*>& bones) const
+	{
+		size_t count = std::min(bones.size(), numBones);
+		for (size_t i = 0; i < count; ++i) {
+			Bone* bone = bones[i];
+			if (bone->AnimationEnabled()) {
+				bone->SetTransformSilent(Position(i), Rotation(i), Scale(i));
+			}
+		}
+	}
+
+	void AnimationPose::SetTransform(size_t index, const Vector3& position, const Quaternion& rotation, const Vector3& scale)
+	{
+		float* dest = &data[index];
+		dest[POSITION_X * numPaddedBones] = position.x;
+		dest[POSITION_Y * numPaddedBones] = position.y;
+		dest[POSITION_Z * numPaddedBones] = position.z;
+		dest[ROTATION_W * numPaddedBones] = rotation.w;
+		dest[ROTATION_X * numPaddedBones] = rotation.x;
+		dest[ROTATION_Y * numPaddedBones] = rotation.y;
+		dest[ROTATION_Z * numPaddedBones] = rotation.z;
+		dest[SCALE_X * numPaddedBones] = scale.x;
+		dest[SCALE_Y * numPaddedBones] = scale.y;
+		dest[SCALE_Z * numPaddedBones] = scale.z;
+	}
+
+	void AnimationPose::Interpolate(const AnimationPose& from, const AnimationPose& to, float t)
+	{
+		assert(from.numPaddedBones == numPaddedBones && to.numPaddedBones == numPaddedBones);
+
+		const float* a = from.data.data();
+		const float* b = to.data.data();
+		float* dest = data.data();
+		size_t n = numPaddedBones;
+
+#ifdef TURSO3D_SIMD
+		Simd::Float4 factor = Simd::Splat(t);
+
+		for (size_t i = 0; i < n; i += 4) {
+			InterpolateLanes(a, b, dest, n, i, factor);
+		}
+#else
+		for (size_t i = 0; i < n; ++i) {
+			SetTransform(i, from.Position(i).Lerp(to.Position(i), t), from.Rotation(i).Nlerp(to.Rotation(i), t, true), from.Scale(i).Lerp(to.Scale(i), t));
+		}
+#endif
+	}
+
+	void AnimationPose::Interpolate(const AnimationPose& from, const AnimationPose& to, const float* boneWeights)
+	{
+		assert(from.numPaddedBones == numPaddedBones && to.numPaddedBones == numPaddedBones);
+
+		const float* a = from.data.data();
+		const float* b = to.data.data();
+		float* dest = data.data();
+		size_t n = numPaddedBones;
+
+#ifdef TURSO3D_SIMD
+		for (size_t i = 0; i < n; i += 4) {
+			InterpolateLanes(a, b, dest, n, i, Simd::Load(boneWeights + i));
+		}
+#else
+		for (size_t i = 0; i < n; ++i) {
+			float t = boneWeights[i];
+			SetTransform(i, from.Position(i).Lerp(to.Position(i), t), from.Rotation(i).Nlerp(to.Rotation(i), t, true), from.Scale(i).Lerp(to.Scale(i), t));
+		}
+#endif
+	}
+
+	void AnimationPose::Add(const AnimationPose& additive, const AnimationPose& reference, float weight)
+	{
+		assert(additive.numBones == numBones && reference.numBones == numBones);
+
+		for (size_t i = 0; i < numBones; ++i) {
+			Vector3 position = Position(i) + (additive.Position(i) - reference.Position(i)) * weight;
+			Quaternion rotation = Rotation(i) * Quaternion::IDENTITY().Nlerp(reference.Rotation(i).Inverse() * additive.Rotation(i), weight, true);
+			Vector3 scale = Scale(i) * Vector3::ONE().Lerp(additive.Scale(i) / reference.Scale(i), weight);
+			SetTransform(i, position, rotation, scale);
+		}
+	}
+
+	Vector3 AnimationPose::Position(size_t index) const
+	{
+		const float* src = &data[index];
+		return Vector3(src[POSITION_X * numPaddedBones], src[POSITION_Y * numPaddedBones], src[POSITION_Z * numPaddedBones]);
+	}
+
+	Quaternion AnimationPose::Rotation(size_t index) const
+	{
+		const float* src = &data[index];
+		return Quaternion(src[ROTATION_W * numPaddedBones], src[ROTATION_X * numPaddedBones], src[ROTATION_Y * numPaddedBones], src[ROTATION_Z * numPaddedBones]);
+	}
+
+	Vector3 AnimationPose::Scale(size_t index) const
+	{
+		const float* src = &data[index];
+		return Vector3(src[SCALE_X * numPaddedBones], src[SCALE_Y * numPaddedBones], src[SCALE_Z * numPaddedBones]);
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <Turso3D/Math/Quaternion.h>
+#include <vector>
+
+namespace Turso3D
+{
+	class Bone;
+	struct ModelBone;
+
+	// Bone transforms of a skeleton in structure of arrays layout, indexed by bone.
+	// The bone count is padded to a multiple of 4, so that the transforms can be processed 4 bones at a time with SIMD. The padding bones hold identity transforms.
+	class AnimationPose
+	{
+	public:
+		enum Component
+		{
+			POSITION_X = 0,
+			POSITION_Y,
+			POSITION_Z,
+			ROTATION_W,
+			ROTATION_X,
+			ROTATION_Y,
+			ROTATION_Z,
+			SCALE_X,
+			SCALE_Y,
+			SCALE_Z,
+			NUM_COMPONENTS
+		};
+
+	public:
+		// Construct empty.
+		AnimationPose();
+
+		// Set number of bones. Existing transforms are not preserved.
+		void Resize(size_t numBones);
+		// Set the transforms from the initial pose of model bones.
+		void SetBindPose(const std::vector<ModelBone>& modelBones);
+		// Set the transforms from bone scene nodes.
+		void SetFromBones(const std::vector<Bone*>& bones);
+		// Set the transforms to bone scene nodes without dirtying the hierarchy. Bones with animation disabled are left unchanged.
+		void ApplyToBones(const std::vector<Bone*>& bones) const;
+		// Set transform of a bone.
+		void SetTransform(size_t index, const Vector3& position, const Quaternion& rotation, const Vector3& scale);
+		// Set the transforms by interpolating between two poses of the same size. Rotations use normalized lerp along the shortest path.
+		void Interpolate(const AnimationPose& from, const AnimationPose& to, float t);
+		// Set the transforms by interpolating between two poses of the same size with a factor per bone. The factors must cover the padded bone count.
+		void Interpolate(const AnimationPose& from, const AnimationPose& to, const float* boneWeights);
+		// Add the difference of an additive pose from its reference pose, scaled by weight. The poses must have the same size.
+		void Add(const AnimationPose& additive, const AnimationPose& reference, float weight);
+
+		// Return number of bones.
+		size_t NumBones() const { return numBones; }
+		// Return number of bones including the padding.
+		size_t NumPaddedBones() const { return numPaddedBones; }
+		// Return position of a bone.
+		Vector3 Position(size_t index) const;
+		// Return rotation of a bone.
+		Quaternion Rotation(size_t index) const;
+		// Return scale of a bone.
+		Vector3 Scale(size_t index) const;
+		// Return the values of one transform component for all bones.
+		float* ComponentData(size_t component) { return &data[component * numPaddedBones]; }
+		// Return the values of one transform component for all bones.
+		const float* ComponentData(size_t component) const { return &data[component * numPaddedBones]; }
+
+	private:
+		// Transform components, one array of padded bone count per component.
+		std::vector<float> data;
+		// Number of bones.
+		size_t numBones;
+		// Number of bones including the padding.
+		size_t numPaddedBones;
+	};
+}
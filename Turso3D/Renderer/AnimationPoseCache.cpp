@@ -0,0 +1,185 @@
+#include <Turso3D/Renderer/AnimationPoseCache.h>
+#include <Turso3D/Renderer/AnimationState.h>
+#include <Turso3D/Renderer/Model.h>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+namespace
+{
+	using namespace Turso3D;
+
+	static inline void CombineHash(size_t& hash, size_t value)
+	{
+		hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	}
+
+	static inline unsigned FloatBits(float value)
+	{
+		unsigned bits;
+		memcpy(&bits, &value, sizeof bits);
+		return bits;
+	}
+
+	// Calculate the model space transform of a bone and its parents from the pose.
+	void CalculateModelTransform(size_t index, const std::vector<ModelBone>& modelBones, const AnimationPose& pose, std::vector<Matrix3x4>& modelTransforms, std::vector<bool>& calculated)
+	{
+		if (calculated[index]) {
+			return;
+		}
+
+		Matrix3x4 localTransform(pose.Position(index), pose.Rotation(index), pose.Scale(index));
+		size_t parentIndex = modelBones[index].parentIndex;
+		if (parentIndex == index || parentIndex >= modelBones.size()) {
+			modelTransforms[index] = localTransform;
+		} else {
+			CalculateModelTransform(parentIndex, modelBones, pose, modelTransforms, calculated);
+			modelTransforms[index] = modelTransforms[parentIndex] * localTransform;
+		}
+		calculated[index] = true;
+	}
+}
+
+namespace Turso3D
+{
+	void AnimationPoseKey::Reset(const Model* model_, unsigned char maxBoneDepth_, float timeStep_)
+	{
+		model = model_;
+		maxBoneDepth = maxBoneDepth_;
+		timeStep = timeStep_;
+		states.clear();
+		hash = 0;
+	}
+
+	void AnimationPoseKey::AddState(const AnimationState& state)
+	{
+		AnimationPoseKeyState& dest = states.emplace_back();
+		dest.animation = state.GetAnimation().get();
+		dest.time = timeStep > 0.0f ? static_cast<unsigned>(std::lround(state.Time() / timeStep)) : FloatBits(state.Time());
+		dest.weight = FloatBits(state.Weight());
+		dest.looped = state.Looped();
+	}
+
+	void AnimationPoseKey::Finalize()
+	{
+		hash = std::hash<const void*>()(model);
+		CombineHash(hash, maxBoneDepth);
+		CombineHash(hash, FloatBits(timeStep));
+		for (const AnimationPoseKeyState& state : states) {
+			CombineHash(hash, std::hash<const void*>()(state.animation));
+			CombineHash(hash, state.time);
+			CombineHash(hash, state.weight);
+			CombineHash(hash, state.looped);
+		}
+	}
+
+	bool AnimationPoseKey::operator == (const AnimationPoseKey& rhs) const
+	{
+		if (model != rhs.model || maxBoneDepth != rhs.maxBoneDepth || timeStep != rhs.timeStep || states.size() != rhs.states.size()) {
+			return false;
+		}
+
+		for (size_t i = 0; i < states.size(); ++i) {
+			const AnimationPoseKeyState& a = states[i];
+			const AnimationPoseKeyState& b = rhs.states[i];
+			if (a.animation != b.animation || a.time != b.time || a.weight != b.weight || a.looped != b.looped) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// ==========================================================================================
+	AnimationPoseCache::AnimationPoseCache()
+	{
+	}
+
+	AnimationPoseCache::~AnimationPoseCache()
+	{
+	}
+
+	void AnimationPoseCache::Clear()
+	{
+		for (Shard& shard : shards) {
+			shard.entries.clear();
+			shard.numUsed = 0;
+			shard.hits = 0;
+			shard.misses = 0;
+		}
+	}
+
+	AnimationPoseCacheEntry* AnimationPoseCache::Acquire(const AnimationPoseKey& key, bool& evaluate)
+	{
+		evaluate = false;
+
+		Shard& shard = shards[key.hash % NUM_POSE_CACHE_SHARDS];
+		std::lock_guard<std::mutex> lock(shard.mutex);
+
+		auto it = shard.entries.find(key.hash);
+		if (it != shard.entries.end()) {
+			// Still being evaluated, or a hash collision with another pose
+			AnimationPoseCacheEntry* entry = it->second;
+			if (!entry->ready.load(std::memory_order_acquire) || !(entry->key == key)) {
+				++shard.misses;
+				return nullptr;
+			}
+
+			++shard.hits;
+			return entry;
+		}
+
+		if (shard.numUsed == shard.pool.size()) {
+			shard.pool.push_back(std::make_unique<AnimationPoseCacheEntry>());
+		}
+
+		AnimationPoseCacheEntry* entry = shard.pool[shard.numUsed++].get();
+		entry->key = key;
+		entry->ready.store(false, std::memory_order_relaxed);
+		shard.entries[key.hash] = entry;
+
+		++shard.misses;
+		evaluate = true;
+		return entry;
+	}
+
+	void AnimationPoseCache::Publish(AnimationPoseCacheEntry* entry, const std::vector<ModelBone>& modelBones)
+	{
+		size_t numBones = modelBones.size();
+		assert(entry->pose.NumBones() == numBones);
+
+		std::vector<bool> calculated(numBones);
+
+		entry->modelTransforms.resize(numBones);
+		entry->skinMatrices.resize(numBones);
+		entry->boneBoundingBox.Undefine();
+
+		for (size_t i = 0; i < numBones; ++i) {
+			CalculateModelTransform(i, modelBones, entry->pose, entry->modelTransforms, calculated);
+			entry->skinMatrices[i] = entry->modelTransforms[i] * modelBones[i].offsetMatrix;
+			if (modelBones[i].active) {
+				entry->boneBoundingBox.Merge(modelBones[i].boundingBox.Transformed(entry->modelTransforms[i]));
+			}
+		}
+
+		entry->ready.store(true, std::memory_order_release);
+	}
+
+	size_t AnimationPoseCache::NumHits() const
+	{
+		size_t hits = 0;
+		for (const Shard& shard : shards) {
+			hits += shard.hits;
+		}
+		return hits;
+	}
+
+	size_t AnimationPoseCache::NumMisses() const
+	{
+		size_t misses = 0;
+		for (const Shard& shard : shards) {
+			misses += shard.misses;
+		}
+		return misses;
+	}
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <Turso3D/Math/BoundingBox.h>
+#include <Turso3D/Math/Matrix3x4.h>
+#include <Turso3D/Renderer/AnimationPose.h>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Turso3D
+{
+	class Animation;
+	class AnimationState;
+	class Model;
+	struct ModelBone;
+
+	// Number of independently locked parts of the pose cache.
+	constexpr size_t NUM_POSE_CACHE_SHARDS = 16;
+
+	// Animation state blended into a shared pose.
+	struct AnimationPoseKeyState
+	{
+		// Animation resource.
+		const Animation* animation;
+		// Time position bits, or the index of the time step if the time is quantized.
+		unsigned time;
+		// Blending weight bits.
+		unsigned weight;
+		// Looped flag.
+		bool looped;
+	};
+
+	// Identifies an animated pose: the skeleton, the animation states in blending order, the time quantization and the animation LOD bone depth.
+	struct AnimationPoseKey
+	{
+		// Start a new key.
+		void Reset(const Model* model, unsigned char maxBoneDepth, float timeStep);
+		// Add an enabled animation state in blending order.
+		void AddState(const AnimationState& state);
+		// Calculate the hash after all states have been added.
+		void Finalize();
+
+		// Test for equality with another key.
+		bool operator == (const AnimationPoseKey& rhs) const;
+
+		// Model whose skeleton is animated.
+		const Model* model = nullptr;
+		// Animation states in blending order.
+		std::vector<AnimationPoseKeyState> states;
+		// Time quantization step in seconds, or 0 for exact time positions.
+		float timeStep = 0.0f;
+		// Maximum depth of the animated bones.
+		unsigned char maxBoneDepth = 0;
+		// Hash of the key.
+		size_t hash = 0;
+	};
+
+	// Pose evaluated once and shared by all models with the same key on a frame.
+	struct AnimationPoseCacheEntry
+	{
+		// Key of the pose.
+		AnimationPoseKey key;
+		// Bone transforms of the pose.
+		AnimationPose pose;
+		// Model space transforms of the bones.
+		std::vector<Matrix3x4> modelTransforms;
+		// Model space skin matrices.
+		std::vector<Matrix3x4> skinMatrices;
+		// Model space bounding box of the active bones.
+		BoundingBox boneBoundingBox;
+		// Set when the pose has been evaluated and can be shared.
+		std::atomic<bool> ready;
+	};
+
+	// Per-frame cache of the poses of identically animated models, so that crowds playing the same animations evaluate each pose once.
+	// Accessed from the animation update worker threads.
+	class AnimationPoseCache
+	{
+	public:
+		// Construct.
+		AnimationPoseCache();
+		// Destruct.
+		~AnimationPoseCache();
+
+		// Forget the poses and statistics of the last frame. Called by Octree at the start of its update.
+		void Clear();
+		// Look up a pose by key. Return an evaluated pose, or a new entry with evaluate set true which the caller must evaluate into and then publish.
+		// Return null if another thread is evaluating the pose, in which case the caller evaluates its own pose.
+		AnimationPoseCacheEntry* Acquire(const AnimationPoseKey& key, bool& evaluate);
+		// Calculate the model space data of an evaluated pose and share it.
+		void Publish(AnimationPoseCacheEntry* entry, const std::vector<ModelBone>& modelBones);
+
+		// Return number of lookups that found an evaluated pose since the last clear.
+		size_t NumHits() const;
+		// Return number of lookups that had to evaluate the pose since the last clear.
+		size_t NumMisses() const;
+
+	private:
+		// Independently locked part of the cache.
+		struct Shard
+		{
+			// Mutex for lookups.
+			std::mutex mutex;
+			// Poses of the frame by key hash.
+			std::unordered_map<size_t, AnimationPoseCacheEntry*> entries;
+			// Entries reused between frames.
+			std::vector<std::unique_ptr<AnimationPoseCacheEntry>> pool;
+			// Number of pool entries in use on the frame.
+			size_t numUsed = 0;
+			// Lookups that found an evaluated pose.
+			size_t hits = 0;
+			// Lookups that had to evaluate the pose.
+			size_t misses = 0;
+		};
+
+		// Cache shards selected by key hash.
+		Shard shards[NUM_POSE_CACHE_SHARDS];
+	};
+}
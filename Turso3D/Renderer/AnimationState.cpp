@@ -1,8 +1,124 @@
 #include <Turso3D/Renderer/AnimationState.h>
 #include <Turso3D/IO/Log.h>
+#include <Turso3D/Math/Simd.h>
 #include <Turso3D/Renderer/AnimatedModel.h>
 #include <Turso3D/Renderer/Animation.h>
+#include <Turso3D/Renderer/AnimationPose.h>
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+
+namespace
+{
+	using namespace Turso3D;
+
+	// Number of bones sampled at a time.
+	constexpr size_t POSE_LANES = 4;
+
+	// Keys, interpolation factors and blend weights of a group of bones, gathered per transform component.
+	struct PoseLanes
+	{
+		// Keys to interpolate from.
+		float keys0[AnimationPose::NUM_COMPONENTS][POSE_LANES];
+		// Keys to interpolate to.
+		float keys1[AnimationPose::NUM_COMPONENTS][POSE_LANES];
+		// Interpolation factors per channel.
+		float factors[NUM_ANIMATION_CHANNELS][POSE_LANES];
+		// Blend weights.
+		float weights[POSE_LANES];
+	};
+
+#ifdef TURSO3D_SIMD
+	// Interpolate the keys of a position or scale channel and blend over the pose.
+	static inline void BlendVectorLanes(const PoseLanes& lanes, size_t channel, size_t firstComponent, float** dest, size_t start)
+	{
+		Simd::Float4 t = Simd::Load(lanes.factors[channel]);
+		Simd::Float4 w = Simd::Load(lanes.weights);
+
+		for (size_t c = firstComponent; c < firstComponent + 3; ++c) {
+			Simd::Float4 a = Simd::Load(lanes.keys0[c]);
+			Simd::Float4 b = Simd::Load(lanes.keys1[c]);
+			Simd::Float4 value = Simd::Add(a, Simd::Mul(Simd::Sub(b, a), t));
+			Simd::Float4 old = Simd::Load(dest[c] + start);
+			Simd::Store(dest[c] + start, Simd::Add(old, Simd::Mul(Simd::Sub(value, old), w)));
+		}
+	}
+
+	// Normalized lerp of 4 quaternions along the shortest path.
+	static inline void NlerpLanes(Simd::Float4* a, Simd::Float4* b, Simd::Float4 t, Simd::Float4* result)
+	{
+		Simd::Float4 dot = Simd::Mul(a[0], b[0]);
+		for (size_t i = 1; i < 4; ++i) {
+			dot = Simd::Add(dot, Simd::Mul(a[i], b[i]));
+		}
+
+		Simd::Float4 lengthSquared = Simd::Zero();
+		for (size_t i = 0; i < 4; ++i) {
+			result[i] = Simd::Add(a[i], Simd::Mul(Simd::Sub(Simd::MulSign(b[i], dot), a[i]), t));
+			lengthSquared = Simd::Add(lengthSquared, Simd::Mul(result[i], result[i]));
+		}
+
+		Simd::Float4 length = Simd::Sqrt(lengthSquared);
+		for (size_t i = 0; i < 4; ++i) {
+			result[i] = Simd::Div(result[i], length);
+		}
+	}
+
+	static inline void BlendLanes(const PoseLanes& lanes, float** dest, size_t start)
+	{
+		BlendVectorLanes(lanes, 0, AnimationPose::POSITION_X, dest, start);
+		BlendVectorLanes(lanes, 2, AnimationPose::SCALE_X, dest, start);
+
+		Simd::Float4 a[4];
+		Simd::Float4 b[4];
+		Simd::Float4 old[4];
+		Simd::Float4 value[4];
+		for (size_t i = 0; i < 4; ++i) {
+			a[i] = Simd::Load(lanes.keys0[AnimationPose::ROTATION_W + i]);
+			b[i] = Simd::Load(lanes.keys1[AnimationPose::ROTATION_W + i]);
+			old[i] = Simd::Load(dest[AnimationPose::ROTATION_W + i] + start);
+		}
+
+		NlerpLanes(a, b, Simd::Load(lanes.factors[1]), value);
+		NlerpLanes(old, value, Simd::Load(lanes.weights), a);
+
+		for (size_t i = 0; i < 4; ++i) {
+			Simd::Store(dest[AnimationPose::ROTATION_W + i] + start, a[i]);
+		}
+	}
+#else
+	static inline void BlendLanes(const PoseLanes& lanes, float** dest, size_t start)
+	{
+		for (size_t i = 0; i < POSE_LANES; ++i) {
+			float* const* c = dest;
+			size_t j = start + i;
+			float w = lanes.weights[i];
+
+			Vector3 position = Vector3(lanes.keys0[AnimationPose::POSITION_X][i], lanes.keys0[AnimationPose::POSITION_Y][i], lanes.keys0[AnimationPose::POSITION_Z][i]).Lerp(
+				Vector3(lanes.keys1[AnimationPose::POSITION_X][i], lanes.keys1[AnimationPose::POSITION_Y][i], lanes.keys1[AnimationPose::POSITION_Z][i]), lanes.factors[0][i]);
+			Quaternion rotation = Quaternion(lanes.keys0[AnimationPose::ROTATION_W][i], lanes.keys0[AnimationPose::ROTATION_X][i], lanes.keys0[AnimationPose::ROTATION_Y][i], lanes.keys0[AnimationPose::ROTATION_Z][i]).Nlerp(
+				Quaternion(lanes.keys1[AnimationPose::ROTATION_W][i], lanes.keys1[AnimationPose::ROTATION_X][i], lanes.keys1[AnimationPose::ROTATION_Y][i], lanes.keys1[AnimationPose::ROTATION_Z][i]), lanes.factors[1][i], true);
+			Vector3 scale = Vector3(lanes.keys0[AnimationPose::SCALE_X][i], lanes.keys0[AnimationPose::SCALE_Y][i], lanes.keys0[AnimationPose::SCALE_Z][i]).Lerp(
+				Vector3(lanes.keys1[AnimationPose::SCALE_X][i], lanes.keys1[AnimationPose::SCALE_Y][i], lanes.keys1[AnimationPose::SCALE_Z][i]), lanes.factors[2][i]);
+
+			position = Vector3(c[AnimationPose::POSITION_X][j], c[AnimationPose::POSITION_Y][j], c[AnimationPose::POSITION_Z][j]).Lerp(position, w);
+			rotation = Quaternion(c[AnimationPose::ROTATION_W][j], c[AnimationPose::ROTATION_X][j], c[AnimationPose::ROTATION_Y][j], c[AnimationPose::ROTATION_Z][j]).Nlerp(rotation, w, true);
+			scale = Vector3(c[AnimationPose::SCALE_X][j], c[AnimationPose::SCALE_Y][j], c[AnimationPose::SCALE_Z][j]).Lerp(scale, w);
+
+			c[AnimationPose::POSITION_X][j] = position.x;
+			c[AnimationPose::POSITION_Y][j] = position.y;
+			c[AnimationPose::POSITION_Z][j] = position.z;
+			c[AnimationPose::ROTATION_W][j] = rotation.w;
+			c[AnimationPose::ROTATION_X][j] = rotation.x;
+			c[AnimationPose::ROTATION_Y][j] = rotation.y;
+			c[AnimationPose::ROTATION_Z][j] = rotation.z;
+			c[AnimationPose::SCALE_X][j] = scale.x;
+			c[AnimationPose::SCALE_Y][j] = scale.y;
+			c[AnimationPose::SCALE_Z][j] = scale.z;
+		}
+	}
+#endif
+}
 
 namespace Turso3D
 {
@@ -10,6 +126,7 @@ namespace Turso3D
 		drawable(drawable),
 		animation(animation),
 		looped(false),
+		customBoneWeights(false),
 		weight(0.0f),
 		time(0.0f),
 		blendLayer(0)
@@ -27,6 +144,7 @@ namespace Turso3D
 		animation(animation),
 		startBone(nullptr),
 		looped(false),
+		customBoneWeights(false),
 		weight(1.0f),
 		time(0.0f),
 		blendLayer(0)
@@ -38,7 +156,7 @@ namespace Turso3D
 		stateTracks.clear();
 
 		for (auto it = tracks.begin(); it != tracks.end(); ++it) {
-			if (it->second.keyFrames.empty()) {
+			if (it->second.IsEmpty()) {
 				continue;
 			}
 
@@ -78,12 +196,13 @@ namespace Turso3D
 		}
 
 		startBone = startBone_;
+		customBoneWeights = false;
 
 		const std::map<StringHash, AnimationTrack>& tracks = animation->Tracks();
 		stateTracks.clear();
 
 		for (auto it = tracks.begin(); it != tracks.end(); ++it) {
-			if (it->second.keyFrames.empty()) {
+			if (it->second.IsEmpty()) {
 				continue;
 			}
 
@@ -97,7 +216,7 @@ namespace Turso3D
 				stateTrack.node = startBone;
 			} else {
 				Node* bone = startBone->FindChild(nameHash, true);
-				if (bone->TestFlag(Node::FLAG_BONE)) {
+				if (bone && bone->TestFlag(Node::FLAG_BONE)) {
 					stateTrack.node = static_cast<SpatialNode*>(bone);
 				}
 			}
@@ -107,6 +226,17 @@ namespace Turso3D
 			}
 		}
 
+		// Map the skeleton bones to tracks for sampling whole poses
+		const std::vector<Bone*>& bones = drawable->Bones();
+		boneTracks.assign(bones.size(), UINT_MAX);
+		for (size_t i = 0; i < stateTracks.size(); ++i) {
+			size_t boneIndex = std::find(bones.begin(), bones.end(), stateTracks[i].node) - bones.begin();
+			stateTracks[i].boneIndex = boneIndex;
+			if (boneIndex < bones.size()) {
+				boneTracks[boneIndex] = i;
+			}
+		}
+
 		drawable->OnAnimationOrderChanged();
 	}
 
@@ -149,6 +279,7 @@ namespace Turso3D
 		weight_ = Clamp(weight_, 0.0f, 1.0f);
 		if (weight_ != stateTracks[index].weight) {
 			stateTracks[index].weight = weight_;
+			customBoneWeights = true;
 			if (drawable) {
 				drawable->OnAnimationChanged();
 			}
@@ -266,6 +397,11 @@ namespace Turso3D
 		return animation->Length();
 	}
 
+	bool AnimationState::IsShareable() const
+	{
+		return drawable && startBone == drawable->RootBone() && !customBoneWeights;
+	}
+
 	void AnimationState::Apply()
 	{
 		if (drawable) {
@@ -275,84 +411,97 @@ namespace Turso3D
 		}
 	}
 
-	void AnimationState::ApplyToModel()
+	void AnimationState::ApplyToPose(AnimationPose& pose, const unsigned char* boneDepths, unsigned char maxBoneDepth, float timeStep)
 	{
-		for (auto it = stateTracks.begin(); it != stateTracks.end(); ++it) {
-			AnimationStateTrack& stateTrack = *it;
-			const AnimationTrack* track = stateTrack.track;
-			float finalWeight = weight * stateTrack.weight;
-			Bone* bone = static_cast<Bone*>(stateTrack.node);
+		float sampleTime = timeStep > 0.0f ? std::min(std::round(time / timeStep) * timeStep, animation->Length()) : time;
 
-			// Do not apply if zero effective weight or the bone has animation disabled
-			if (EpsilonEquals(finalWeight, 0.0f) || !bone->AnimationEnabled()) {
-				continue;
-			}
-
-			track->FindKeyFrameIndex(time, stateTrack.keyFrame);
-			const AnimationKeyFrame& keyFrame = track->keyFrames[stateTrack.keyFrame];
+		float* dest[AnimationPose::NUM_COMPONENTS];
+		for (size_t i = 0; i < AnimationPose::NUM_COMPONENTS; ++i) {
+			dest[i] = pose.ComponentData(i);
+		}
 
-			// Check if next frame to interpolate to is valid, or if wrapping is needed (looping animation only)
-			size_t nextFrame = stateTrack.keyFrame + 1;
-			bool interpolate = true;
-			if (nextFrame >= track->keyFrames.size()) {
-				if (!looped) {
-					nextFrame = stateTrack.keyFrame;
-					interpolate = false;
-				} else {
-					nextFrame = 0;
-				}
-			}
+		size_t numBones = std::min(boneTracks.size(), pose.NumBones());
+		PoseLanes lanes;
+		AnimationTrackKeys keys;
 
-			Vector3 newPosition = bone->Position();
-			Quaternion newRotation = bone->Rotation();
-			Vector3 newScale = bone->Scale();
+		for (size_t start = 0; start < numBones; start += POSE_LANES) {
+			bool active = false;
 
-			if (interpolate) {
-				const AnimationKeyFrame& nextKeyFrame = track->keyFrames[nextFrame];
-				float timeInterval = nextKeyFrame.time - keyFrame.time;
-				if (timeInterval < 0.0f) {
-					timeInterval += animation->Length();
-				}
-				float t = timeInterval > 0.0f ? (time - keyFrame.time) / timeInterval : 1.0f;
+			// Gather the keys of each bone. Bones without effect interpolate their pose transform with itself at zero weight
+			for (size_t i = 0; i < POSE_LANES; ++i) {
+				size_t boneIndex = start + i;
+				size_t trackIndex = boneIndex < numBones && (!boneDepths || boneDepths[boneIndex] <= maxBoneDepth) ? boneTracks[boneIndex] : UINT_MAX;
+				float finalWeight = trackIndex < stateTracks.size() ? weight * stateTracks[trackIndex].weight : 0.0f;
 
-				if (track->channelMask & CHANNEL_POSITION) {
-					newPosition = keyFrame.position.Lerp(nextKeyFrame.position, t);
+				for (size_t c = 0; c < AnimationPose::NUM_COMPONENTS; ++c) {
+					lanes.keys0[c][i] = lanes.keys1[c][i] = dest[c][boneIndex];
 				}
-				if (track->channelMask & CHANNEL_ROTATION) {
-					newRotation = keyFrame.rotation.Slerp(nextKeyFrame.rotation, t);
-				}
-				if (track->channelMask & CHANNEL_SCALE) {
-					newScale = keyFrame.scale.Lerp(nextKeyFrame.scale, t);
-				}
-			} else {
-				if (track->channelMask & CHANNEL_POSITION) {
-					newPosition = keyFrame.position;
-				}
-				if (track->channelMask & CHANNEL_ROTATION) {
-					newRotation = keyFrame.rotation;
+				for (size_t c = 0; c < NUM_ANIMATION_CHANNELS; ++c) {
+					lanes.factors[c][i] = 0.0f;
 				}
-				if (track->channelMask & CHANNEL_SCALE) {
-					newScale = keyFrame.scale;
+				lanes.weights[i] = 0.0f;
+
+				if (EpsilonEquals(finalWeight, 0.0f)) {
+					continue;
 				}
-			}
 
-			// If not full weight, blend
-			if (weight < 1.0f) {
+				AnimationStateTrack& stateTrack = stateTracks[trackIndex];
+				const AnimationTrack* track = stateTrack.track;
+				keys.factors[0] = keys.factors[1] = keys.factors[2] = 0.0f;
+				track->FindKeys(*animation, sampleTime, looped, stateTrack.keyFrames, keys);
+
 				if (track->channelMask & CHANNEL_POSITION) {
-					newPosition = bone->Position().Lerp(newPosition, weight);
+					lanes.keys0[AnimationPose::POSITION_X][i] = keys.positions[0].x;
+					lanes.keys0[AnimationPose::POSITION_Y][i] = keys.positions[0].y;
+					lanes.keys0[AnimationPose::POSITION_Z][i] = keys.positions[0].z;
+					lanes.keys1[AnimationPose::POSITION_X][i] = keys.positions[1].x;
+					lanes.keys1[AnimationPose::POSITION_Y][i] = keys.positions[1].y;
+					lanes.keys1[AnimationPose::POSITION_Z][i] = keys.positions[1].z;
+					lanes.factors[0][i] = keys.factors[0];
 				}
 				if (track->channelMask & CHANNEL_ROTATION) {
-					newRotation = bone->Rotation().Slerp(newRotation, weight);
+					lanes.keys0[AnimationPose::ROTATION_W][i] = keys.rotations[0].w;
+					lanes.keys0[AnimationPose::ROTATION_X][i] = keys.rotations[0].x;
+					lanes.keys0[AnimationPose::ROTATION_Y][i] = keys.rotations[0].y;
+					lanes.keys0[AnimationPose::ROTATION_Z][i] = keys.rotations[0].z;
+					lanes.keys1[AnimationPose::ROTATION_W][i] = keys.rotations[1].w;
+					lanes.keys1[AnimationPose::ROTATION_X][i] = keys.rotations[1].x;
+					lanes.keys1[AnimationPose::ROTATION_Y][i] = keys.rotations[1].y;
+					lanes.keys1[AnimationPose::ROTATION_Z][i] = keys.rotations[1].z;
+					lanes.factors[1][i] = keys.factors[1];
 				}
 				if (track->channelMask & CHANNEL_SCALE) {
-					newScale = bone->Scale().Lerp(newScale, weight);
+					lanes.keys0[AnimationPose::SCALE_X][i] = keys.scales[0].x;
+					lanes.keys0[AnimationPose::SCALE_Y][i] = keys.scales[0].y;
+					lanes.keys0[AnimationPose::SCALE_Z][i] = keys.scales[0].z;
+					lanes.keys1[AnimationPose::SCALE_X][i] = keys.scales[1].x;
+					lanes.keys1[AnimationPose::SCALE_Y][i] = keys.scales[1].y;
+					lanes.keys1[AnimationPose::SCALE_Z][i] = keys.scales[1].z;
+					lanes.factors[2][i] = keys.factors[2];
 				}
+
+				lanes.weights[i] = std::min(finalWeight, 1.0f);
+				active = true;
 			}
 
-			bone->SetTransformSilent(newPosition, newRotation, newScale);
+			// Interpolate and blend the whole group at once
+			if (active) {
+				BlendLanes(lanes, dest, start);
+			}
 		}
 	}
 
+	void AnimationState::ApplyToModel()
+	{
+		const std::vector<Bone*>& bones = drawable->Bones();
+
+		AnimationPose pose;
+		pose.Resize(bones.size());
+		pose.SetFromBones(bones);
+		ApplyToPose(pose);
+		pose.ApplyToBones(bones);
+	}
+
 	void AnimationState::ApplyToNodes()
 	{
 		// When applying to a node hierarchy, can only use full weight (nothing to blend to)
@@ -361,53 +510,10 @@ namespace Turso3D
 			const AnimationTrack* track = stateTrack.track;
 			SpatialNode* node = stateTrack.node;
 
-			track->FindKeyFrameIndex(time, stateTrack.keyFrame);
-			const AnimationKeyFrame& keyFrame = track->keyFrames[stateTrack.keyFrame];
-
-			// Check if next frame to interpolate to is valid, or if wrapping is needed (looping animation only)
-			size_t nextFrame = stateTrack.keyFrame + 1;
-			bool interpolate = true;
-			if (nextFrame >= track->keyFrames.size()) {
-				if (!looped) {
-					nextFrame = stateTrack.keyFrame;
-					interpolate = false;
-				} else {
-					nextFrame = 0;
-				}
-			}
-
 			Vector3 newPosition = node->Position();
 			Quaternion newRotation = node->Rotation();
 			Vector3 newScale = node->Scale();
-
-			if (interpolate) {
-				const AnimationKeyFrame& nextKeyFrame = track->keyFrames[nextFrame];
-				float timeInterval = nextKeyFrame.time - keyFrame.time;
-				if (timeInterval < 0.0f) {
-					timeInterval += animation->Length();
-				}
-				float t = timeInterval > 0.0f ? (time - keyFrame.time) / timeInterval : 1.0f;
-
-				if (track->channelMask & CHANNEL_POSITION) {
-					newPosition = keyFrame.position.Lerp(nextKeyFrame.position, t);
-				}
-				if (track->channelMask & CHANNEL_ROTATION) {
-					newRotation = keyFrame.rotation.Slerp(nextKeyFrame.rotation, t);
-				}
-				if (track->channelMask & CHANNEL_SCALE) {
-					newScale = keyFrame.scale.Lerp(nextKeyFrame.scale, t);
-				}
-			} else {
-				if (track->channelMask & CHANNEL_POSITION) {
-					newPosition = keyFrame.position;
-				}
-				if (track->channelMask & CHANNEL_ROTATION) {
-					newRotation = keyFrame.rotation;
-				}
-				if (track->channelMask & CHANNEL_SCALE) {
-					newScale = keyFrame.scale;
-				}
-			}
+			track->Sample(*animation, time, looped, stateTrack.keyFrames, newPosition, newRotation, newScale);
 
 			node->SetTransform(newPosition, newRotation, newScale);
 		}
@@ -8,6 +8,7 @@ namespace Turso3D
 {
 	class Animation;
 	class AnimatedModelDrawable;
+	class AnimationPose;
 	class Bone;
 	class SpatialNode;
 	struct AnimationTrack;
@@ -19,10 +20,12 @@ namespace Turso3D
 		const AnimationTrack* track = nullptr;
 		// Scene node. May be a model's bone or a plain scene node.
 		SpatialNode* node = nullptr;
+		// Index of the bone in the skeleton (model mode.)
+		size_t boneIndex = 0;
 		// Blending weight.
 		float weight = 1.0f;
-		// Last key frame.
-		size_t keyFrame = 0;
+		// Last key frame per channel. Uncompressed tracks use only the first.
+		size_t keyFrames[3] = { 0, 0, 0 };
 	};
 
 	// Animation instance.
@@ -87,11 +90,16 @@ namespace Turso3D
 		float Length() const;
 		// Return blending layer.
 		unsigned char BlendLayer() const { return blendLayer; }
+		// Return whether the state animates the whole skeleton with full bone weights, so that its pose can be shared between models.
+		bool IsShareable() const;
 
 		// Apply the animation at the current time position.
-		// Called by AnimatedModel.
 		// Needs to be called manually for node hierarchies.
 		void Apply();
+		// Blend the animation at the current time position into a pose indexed by the model's bones.
+		// Optionally skip the bones deeper in the skeleton than a maximum depth, given the depth of each bone, and round the time position to a step in seconds.
+		// Called by AnimatedModel.
+		void ApplyToPose(AnimationPose& pose, const unsigned char* boneDepths = nullptr, unsigned char maxBoneDepth = 0, float timeStep = 0.0f);
 
 	private:
 		// Apply animation to a skeleton.
@@ -111,8 +119,12 @@ namespace Turso3D
 		Bone* startBone;
 		// Per-track data.
 		std::vector<AnimationStateTrack> stateTracks;
+		// Track index per skeleton bone, or UINT_MAX if the animation does not affect the bone (model mode.)
+		std::vector<size_t> boneTracks;
 		// Looped flag.
 		bool looped;
+		// Whether per-bone weights have been modified since the start bone was set.
+		bool customBoneWeights;
 		// Blending weight.
 		float weight;
 		// Time position.
@@ -0,0 +1,233 @@
+#include <Turso3D/Renderer/AnimationTexture.h>
+#include <Turso3D/Graphics/Graphics.h>
+#include <Turso3D/Graphics/Texture.h>
+#include <Turso3D/IO/Log.h>
+#include <Turso3D/IO/Stream.h>
+#include <Turso3D/Renderer/Animation.h>
+#include <Turso3D/Renderer/Model.h>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	using namespace Turso3D;
+
+	// Float texels per skin matrix.
+	constexpr int TEXELS_PER_BONE = 3;
+
+	// Calculate the model space transform of a bone and its parents.
+	void CalculateModelTransform(size_t index, const std::vector<ModelBone>& modelBones, const std::vector<Matrix3x4>& localTransforms, std::vector<Matrix3x4>& modelTransforms, std::vector<bool>& calculated)
+	{
+		if (calculated[index]) {
+			return;
+		}
+
+		size_t parentIndex = modelBones[index].parentIndex;
+		if (parentIndex == index || parentIndex >= modelBones.size()) {
+			modelTransforms[index] = localTransforms[index];
+		} else {
+			CalculateModelTransform(parentIndex, modelBones, localTransforms, modelTransforms, calculated);
+			modelTransforms[index] = modelTransforms[parentIndex] * localTransforms[index];
+		}
+		calculated[index] = true;
+	}
+}
+
+namespace Turso3D
+{
+	AnimationTexture::AnimationTexture() :
+		numBones(0)
+	{
+	}
+
+	AnimationTexture::~AnimationTexture()
+	{
+	}
+
+	bool AnimationTexture::BeginLoad(Stream& source)
+	{
+		char header[4];
+		source.Read(header, 4);
+
+		if (memcmp(header, "BANT", 4) != 0) {
+			LOG_ERROR("{:s} is not a valid animation texture file", source.Name());
+			return false;
+		}
+
+		numBones = source.Read<unsigned>();
+		boundingBox = source.Read<BoundingBox>();
+
+		size_t numClips = source.Read<unsigned>();
+		clips.resize(numClips);
+		size_t numFrames = 0;
+		for (size_t i = 0; i < numClips; ++i) {
+			AnimationTextureClip& clip = clips[i];
+			clip.name = source.Read<std::string>();
+			clip.nameHash = StringHash(clip.name);
+			clip.startFrame = source.Read<unsigned>();
+			clip.numFrames = source.Read<unsigned>();
+			clip.length = source.Read<float>();
+			clip.looped = source.Read<bool>();
+			numFrames = std::max(numFrames, (size_t)clip.startFrame + clip.numFrames);
+		}
+
+		// The bones are laid out horizontally and the frames vertically, so both must fit the texture size limit
+		size_t maxTextureSize = Graphics::MaxTextureSize();
+		if (!numBones || !numFrames || numBones * TEXELS_PER_BONE > maxTextureSize || numFrames > maxTextureSize) {
+			LOG_ERROR("{:s} has an unsupported animation texture size of {:d} bones and {:d} frames", source.Name(), numBones, numFrames);
+			return false;
+		}
+		if (numFrames * numBones * sizeof(Matrix3x4) > source.Size() - source.Position()) {
+			LOG_ERROR("{:s} is truncated", source.Name());
+			return false;
+		}
+
+		skinMatrices.resize(numFrames * numBones);
+		source.Read(skinMatrices.data(), skinMatrices.size() * sizeof(Matrix3x4));
+		return true;
+	}
+
+	bool AnimationTexture::EndLoad()
+	{
+		return UpdateTexture();
+	}
+
+	bool AnimationTexture::Save(Stream& dest)
+	{
+		dest.Write("BANT", 4);
+		dest.Write<unsigned>(static_cast<unsigned>(numBones));
+		dest.Write<BoundingBox>(boundingBox);
+
+		dest.Write<unsigned>(static_cast<unsigned>(clips.size()));
+		for (const AnimationTextureClip& clip : clips) {
+			dest.Write<std::string>(clip.name);
+			dest.Write<unsigned>(clip.startFrame);
+			dest.Write<unsigned>(clip.numFrames);
+			dest.Write<float>(clip.length);
+			dest.Write<bool>(clip.looped);
+		}
+
+		dest.Write(skinMatrices.data(), skinMatrices.size() * sizeof(Matrix3x4));
+		return true;
+	}
+
+	bool AnimationTexture::Bake(const Model* model, const std::vector<std::shared_ptr<Animation>>& animations, float frameRate)
+	{
+		Log::Scope logScope {"AnimationTexture::Bake"};
+
+		if (!model || model->Bones().empty()) {
+			LOG_ERROR("Null model or model without skeleton");
+			return false;
+		}
+
+		const std::vector<ModelBone>& modelBones = model->Bones();
+		numBones = modelBones.size();
+		frameRate = std::max(frameRate, M_EPSILON);
+		skinMatrices.clear();
+		clips.clear();
+		boundingBox.Undefine();
+
+		std::vector<const AnimationTrack*> tracks(numBones);
+		std::vector<size_t> lastKeyFrames(numBones * NUM_ANIMATION_CHANNELS);
+		std::vector<Matrix3x4> localTransforms(numBones);
+		std::vector<Matrix3x4> modelTransforms(numBones);
+		std::vector<bool> calculated(numBones);
+
+		for (const std::shared_ptr<Animation>& animation : animations) {
+			if (!animation) {
+				continue;
+			}
+
+			for (size_t i = 0; i < numBones; ++i) {
+				tracks[i] = animation->FindTrack(modelBones[i].nameHash);
+			}
+			std::fill(lastKeyFrames.begin(), lastKeyFrames.end(), 0);
+
+			// Divide the clip into whole frames, so that the last frame lands on the clip end and looped playback wraps to the first
+			AnimationTextureClip& clip = clips.emplace_back();
+			clip.name = animation->AnimationName();
+			clip.nameHash = animation->AnimationNameHash();
+			clip.startFrame = static_cast<unsigned>(skinMatrices.size() / numBones);
+			clip.numFrames = std::max(static_cast<unsigned>(std::lround(animation->Length() * frameRate)), 1u) + 1;
+			clip.length = animation->Length();
+			clip.looped = true;
+
+			for (unsigned j = 0; j < clip.numFrames; ++j) {
+				float time = clip.length * j / (clip.numFrames - 1);
+
+				// Bones without a track stay in the bind pose, like they are reset before playback
+				for (size_t i = 0; i < numBones; ++i) {
+					const ModelBone& modelBone = modelBones[i];
+					Vector3 position = modelBone.position;
+					Quaternion rotation = modelBone.rotation;
+					Vector3 scale = modelBone.scale;
+					if (tracks[i]) {
+						tracks[i]->Sample(*animation, time, false, &lastKeyFrames[i * NUM_ANIMATION_CHANNELS], position, rotation, scale);
+					}
+					localTransforms[i] = Matrix3x4(position, rotation, scale);
+				}
+
+				std::fill(calculated.begin(), calculated.end(), false);
+				for (size_t i = 0; i < numBones; ++i) {
+					CalculateModelTransform(i, modelBones, localTransforms, modelTransforms, calculated);
+					skinMatrices.push_back(modelTransforms[i] * modelBones[i].offsetMatrix);
+					if (modelBones[i].active) {
+						boundingBox.Merge(modelBones[i].boundingBox.Transformed(modelTransforms[i]));
+					}
+				}
+			}
+		}
+
+		if (clips.empty()) {
+			LOG_ERROR("No animations to bake");
+			return false;
+		}
+
+		return UpdateTexture();
+	}
+
+	void AnimationTexture::SetClipLooped(size_t index, bool enable)
+	{
+		if (index < clips.size()) {
+			clips[index].looped = enable;
+		}
+	}
+
+	size_t AnimationTexture::FindClip(const std::string& name) const
+	{
+		StringHash nameHash(name);
+		for (size_t i = 0; i < clips.size(); ++i) {
+			if (clips[i].nameHash == nameHash) {
+				return i;
+			}
+		}
+		return clips.size();
+	}
+
+	bool AnimationTexture::UpdateTexture()
+	{
+		if (!numBones || skinMatrices.empty()) {
+			texture.reset();
+			return false;
+		}
+
+		IntVector2 size {static_cast<int>(numBones) * TEXELS_PER_BONE, static_cast<int>(NumFrames())};
+
+		if (!texture) {
+			texture = std::make_unique<Texture>();
+		}
+		if (!texture->Define(TARGET_2D, size, FORMAT_RGBA32_SFLOAT_PACK32) || !texture->DefineSampler(FILTER_POINT, ADDRESS_CLAMP, ADDRESS_CLAMP, ADDRESS_CLAMP)) {
+			LOG_ERROR("Failed to define animation texture of {:d}x{:d}", size.x, size.y);
+			return false;
+		}
+
+		ImageLevel level {
+			skinMatrices.data(),
+			0,
+			IntBox {0, 0, 0, size.x, size.y, 1},
+			0,
+			0
+		};
+		return texture->SetData(level);
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <Turso3D/Math/BoundingBox.h>
+#include <Turso3D/Math/Matrix3x4.h>
+#include <Turso3D/Resource/Resource.h>
+#include <memory>
+#include <vector>
+
+namespace Turso3D
+{
+	class Animation;
+	class Model;
+	class Texture;
+
+	// Animation clip baked into an animation texture.
+	struct AnimationTextureClip
+	{
+		// Animation name.
+		std::string name;
+		// Animation name hash.
+		StringHash nameHash;
+		// Texture row of the first frame.
+		unsigned startFrame;
+		// Number of frames, including both the start and the end of the clip.
+		unsigned numFrames;
+		// Clip length in seconds.
+		float length;
+		// Whether playback loops. Otherwise playback holds the last frame.
+		bool looped;
+	};
+
+	// Skin matrices of animation clips sampled on a model skeleton, stored in a texture for playing the animations entirely on the GPU.
+	// Each texture row is one frame, which holds the model space skin matrices of all bones as 3 float texels per bone.
+	// Can be baked offline and saved, or baked at load time.
+	class AnimationTexture : public Resource
+	{
+	public:
+		// Construct.
+		AnimationTexture();
+		// Destruct.
+		~AnimationTexture();
+
+		// Load the baked frames from a stream. Return true on success.
+		bool BeginLoad(Stream& source) override;
+		// Finish loading by uploading the texture. Return true on success.
+		bool EndLoad() override;
+		// Save the baked frames to a stream. Return true on success.
+		bool Save(Stream& dest) override;
+
+		// Sample animation clips on the model's skeleton and upload the texture. Each clip is sampled evenly at approximately the given frame rate.
+		// Must be called from the main thread.
+		// Return true on success.
+		bool Bake(const Model* model, const std::vector<std::shared_ptr<Animation>>& animations, float frameRate = 30.0f);
+		// Set whether a clip loops. Baked clips loop by default.
+		void SetClipLooped(size_t index, bool enable);
+
+		// Return the texture.
+		Texture* GetTexture() const { return texture.get(); }
+		// Return the baked clips.
+		const std::vector<AnimationTextureClip>& Clips() const { return clips; }
+		// Return index of a clip by animation name, or the number of clips if not found.
+		size_t FindClip(const std::string& name) const;
+		// Return number of bones in the baked skeleton.
+		size_t NumBones() const { return numBones; }
+		// Return total number of frames in all clips.
+		size_t NumFrames() const { return numBones ? skinMatrices.size() / numBones : 0; }
+		// Return the model space bounding box of the skeleton over all frames.
+		const BoundingBox& LocalBoundingBox() const { return boundingBox; }
+
+	private:
+		// Upload the skin matrices to the texture. Return true on success.
+		bool UpdateTexture();
+
+	private:
+		// Texture holding the skin matrices.
+		std::unique_ptr<Texture> texture;
+		// Skin matrices of all frames, one row of bones per frame.
+		std::vector<Matrix3x4> skinMatrices;
+		// Baked clips.
+		std::vector<AnimationTextureClip> clips;
+		// Model space bounding box over all frames.
+		BoundingBox boundingBox;
+		// Number of bones.
+		size_t numBones;
+	};
+}
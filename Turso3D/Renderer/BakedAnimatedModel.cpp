@@ -0,0 +1,119 @@
+#include <Turso3D/Renderer/BakedAnimatedModel.h>
+#include <Turso3D/Core/Allocator.h>
+#include <Turso3D/IO/Log.h>
+#include <Turso3D/Renderer/AnimationTexture.h>
+#include <Turso3D/Renderer/Model.h>
+
+namespace
+{
+	using namespace Turso3D;
+
+	static Allocator<BakedAnimatedModelDrawable> drawableAllocator;
+}
+
+namespace Turso3D
+{
+	BakedAnimatedModelDrawable::BakedAnimatedModelDrawable() :
+		playbackData(0.0f, 1.0f, 0.0f, 0.0f),
+		clipIndex(0),
+		timeOffset(0.0f),
+		speed(1.0f)
+	{
+		SetFlag(Drawable::FLAG_CUSTOM_GEOMETRY | Drawable::FLAG_BAKED_ANIMATION, true);
+	}
+
+	void BakedAnimatedModelDrawable::OnWorldBoundingBoxUpdate() const
+	{
+		if (model && animationTexture && animationTexture->LocalBoundingBox().IsDefined()) {
+			worldBoundingBox = animationTexture->LocalBoundingBox().Transformed(WorldTransform());
+		} else {
+			StaticModelDrawable::OnWorldBoundingBoxUpdate();
+		}
+	}
+
+	bool BakedAnimatedModelDrawable::OnPrepareRender(unsigned short frameNumber, Camera* camera)
+	{
+		if (!StaticModelDrawable::OnPrepareRender(frameNumber, camera)) {
+			return false;
+		}
+
+		if (playbackData.w != 0.0f) {
+			lastUpdateFrameNumber = frameNumber;
+		}
+		return true;
+	}
+
+	// ==========================================================================================
+	BakedAnimatedModel::BakedAnimatedModel() :
+		StaticModel(drawableAllocator.Allocate())
+	{
+	}
+
+	BakedAnimatedModel::~BakedAnimatedModel()
+	{
+		if (drawable) {
+			RemoveFromOctree();
+			drawableAllocator.Free(static_cast<BakedAnimatedModelDrawable*>(drawable));
+			drawable = nullptr;
+		}
+	}
+
+	void BakedAnimatedModel::SetAnimationTexture(std::shared_ptr<AnimationTexture> texture)
+	{
+		BakedAnimatedModelDrawable* drawable = GetDrawable();
+		drawable->animationTexture = texture;
+
+		UpdatePlaybackData();
+		OnBoundingBoxChanged();
+	}
+
+	void BakedAnimatedModel::Play(size_t clipIndex, float timeOffset, float speed)
+	{
+		BakedAnimatedModelDrawable* drawable = GetDrawable();
+		drawable->clipIndex = clipIndex;
+		drawable->timeOffset = timeOffset;
+		drawable->speed = speed;
+
+		UpdatePlaybackData();
+	}
+
+	bool BakedAnimatedModel::Play(const std::string& clipName, float timeOffset, float speed)
+	{
+		BakedAnimatedModelDrawable* drawable = GetDrawable();
+		if (!drawable->animationTexture) {
+			LOG_ERROR("No animation texture to play {:s} from", clipName);
+			return false;
+		}
+
+		size_t index = drawable->animationTexture->FindClip(clipName);
+		if (index >= drawable->animationTexture->Clips().size()) {
+			LOG_ERROR("Animation texture has no clip {:s}", clipName);
+			return false;
+		}
+
+		Play(index, timeOffset, speed);
+		return true;
+	}
+
+	void BakedAnimatedModel::UpdatePlaybackData()
+	{
+		BakedAnimatedModelDrawable* drawable = GetDrawable();
+		AnimationTexture* texture = drawable->animationTexture.get();
+
+		if (!texture || drawable->clipIndex >= texture->Clips().size()) {
+			drawable->playbackData = Vector4(0.0f, 1.0f, 0.0f, 0.0f);
+			return;
+		}
+
+		const AnimationTextureClip& clip = texture->Clips()[drawable->clipIndex];
+		float framesPerSecond = clip.length > 0.0f ? (clip.numFrames - 1) / clip.length : 0.0f;
+		float numFrames = static_cast<float>(clip.numFrames);
+
+		drawable->playbackData = Vector4(
+			static_cast<float>(clip.startFrame),
+			clip.looped ? numFrames : -numFrames,
+			drawable->timeOffset * framesPerSecond,
+			drawable->speed * framesPerSecond
+		);
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <Turso3D/Renderer/StaticModel.h>
+#include <memory>
+
+namespace Turso3D
+{
+	class AnimationTexture;
+
+	// Drawable that plays animations baked into an animation texture entirely on the GPU.
+	// Renders through the instanced batch path with its playback parameters in the instance stream, and has no per-frame animation update.
+	class BakedAnimatedModelDrawable : public StaticModelDrawable
+	{
+		friend class BakedAnimatedModel;
+
+	public:
+		// Construct.
+		BakedAnimatedModelDrawable();
+
+		// Recalculate the world space bounding box, which covers all baked frames.
+		void OnWorldBoundingBoxUpdate() const override;
+		// Prepare object for rendering. Mark the drawable updated while the animation plays, so that cached shadow maps are not reused.
+		bool OnPrepareRender(unsigned short frameNumber, Camera* camera) override;
+
+		// Return the animation texture.
+		AnimationTexture* GetAnimationTexture() const { return animationTexture.get(); }
+		// Return the playback parameters for the instance stream.
+		// X is the texture row of the clip's first frame, Y the number of frames (negative if not looped), Z the frame at zero animation time and W the frames per second.
+		const Vector4& PlaybackData() const { return playbackData; }
+
+	protected:
+		// Animation texture.
+		std::shared_ptr<AnimationTexture> animationTexture;
+		// Playback parameters for the instance stream.
+		Vector4 playbackData;
+		// Index of the playing clip.
+		size_t clipIndex;
+		// Clip time at zero animation time.
+		float timeOffset;
+		// Playback speed.
+		float speed;
+	};
+
+	// ==========================================================================================
+	// Scene node that renders a skinned model animated from an animation texture, for large crowds.
+	// The clip time is the time offset plus the renderer's animation time multiplied by the speed. Bones are not exposed to the scene.
+	class BakedAnimatedModel : public StaticModel
+	{
+	public:
+		// Construct.
+		BakedAnimatedModel();
+		// Destruct.
+		~BakedAnimatedModel();
+
+		// Return derived drawable.
+		BakedAnimatedModelDrawable* GetDrawable() const { return static_cast<BakedAnimatedModelDrawable*>(drawable); }
+
+		// Set the animation texture. It should be baked from the same model's skeleton.
+		void SetAnimationTexture(std::shared_ptr<AnimationTexture> texture);
+		// Play a clip by index.
+		void Play(size_t clipIndex, float timeOffset = 0.0f, float speed = 1.0f);
+		// Play a clip by animation name. Return true on success.
+		bool Play(const std::string& clipName, float timeOffset = 0.0f, float speed = 1.0f);
+
+		// Return the animation texture.
+		const std::shared_ptr<AnimationTexture>& GetAnimationTexture() const { return GetDrawable()->animationTexture; }
+		// Return index of the playing clip.
+		size_t ClipIndex() const { return GetDrawable()->clipIndex; }
+		// Return clip time at zero animation time.
+		float TimeOffset() const { return GetDrawable()->timeOffset; }
+		// Return playback speed.
+		float Speed() const { return GetDrawable()->speed; }
+
+	private:
+		// Recalculate the playback parameters of the instance stream.
+		void UpdatePlaybackData();
+	};
+}
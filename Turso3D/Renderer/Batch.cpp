@@ -1,6 +1,8 @@
 #include <Turso3D/Renderer/Batch.h>
+#include <Turso3D/Renderer/BakedAnimatedModel.h>
 #include <Turso3D/Renderer/GeometryNode.h>
 #include <Turso3D/Renderer/Material.h>
+#include <Turso3D/Renderer/SkinnedModel.h>
 #include <algorithm>
 
 namespace Turso3D
@@ -15,13 +17,33 @@ namespace Turso3D
 		return lhs.distance > rhs.distance;
 	}
 
+	inline bool IsSkinnedBatch(const Batch& batch)
+	{
+		return batch.type == BatchType::Complex && (batch.drawable->Flags() & Drawable::FLAG_COMPLEX_GEOMETRY) == Drawable::FLAG_SKINNED_GEOMETRY;
+	}
+
+	inline bool IsInstancedSkinBatch(const Batch& batch, size_t maxInstancedBones)
+	{
+		return IsSkinnedBatch(batch) && static_cast<SkinnedModelDrawable*>(batch.drawable)->Bones().size() <= maxInstancedBones;
+	}
+
+	inline bool IsBakedAnimationBatch(const Batch& batch)
+	{
+		return batch.type == BatchType::Complex && batch.drawable->TestFlag(Drawable::FLAG_BAKED_ANIMATION);
+	}
+
+	inline AnimationTexture* GetAnimationTexture(const Batch& batch)
+	{
+		return static_cast<BakedAnimatedModelDrawable*>(batch.drawable)->GetAnimationTexture();
+	}
+
 	// ==========================================================================================
 	void BatchQueue::Clear()
 	{
 		batches.clear();
 	}
 
-	void BatchQueue::Sort(BatchSortMode sortMode, bool convertToInstanced)
+	void BatchQueue::Sort(BatchSortMode sortMode, bool convertToInstanced, size_t maxInstancedBones)
 	{
 		switch (sortMode) {
 			case BatchSortMode::State:
@@ -50,41 +72,58 @@ namespace Turso3D
 
 		}
 
-		if (!convertToInstanced || batches.size() < 2) {
+		if (!convertToInstanced) {
 			return;
 		}
 
-		for (size_t i = 0; i < batches.size() - 1; ++i) {
+		for (size_t i = 0; i < batches.size(); ++i) {
 			Batch& batch = batches[i];
 
-			// Check if batch is static geometry and can be converted to instanced
-			if (batch.type != BatchType::Static) {
+			// Check if batch is static, skinned or baked animation geometry and can be converted to instanced.
+			// Skinned geometry with more bones than fit the instanced skin matrix range is left to render with its own skin matrices
+			bool skinned = IsInstancedSkinBatch(batch, maxInstancedBones);
+			bool baked = IsBakedAnimationBatch(batch);
+			if (batch.type != BatchType::Static && !skinned && !baked) {
 				continue;
 			}
 
-			size_t instanceCount = 0;
+			size_t instanceCount = 1;
 			for (size_t j = i + 1; j < batches.size(); ++j) {
 				const Batch& next = batches[j];
 				if (next.pass != batch.pass ||
 					next.geometry != batch.geometry ||
 					next.drawable->LightMask() != batch.drawable->LightMask() ||
-					next.type != BatchType::Static
+					next.type != batch.type ||
+					IsInstancedSkinBatch(next, maxInstancedBones) != skinned ||
+					IsBakedAnimationBatch(next) != baked ||
+					(baked && GetAnimationTexture(next) != GetAnimationTexture(batch))
 				) {
 					break;
 				}
 
-				if (instanceCount == 0) {
-					instanceCount = 1u;
-				}
 				++instanceCount;
 			}
 
 			// Finalize the conversion by changing type and writing offsets.
-			if (instanceCount) {
+			// Skinned geometry is converted also without other instances, so that it uses the renderer's shared skin matrix buffer.
+			// Baked animation geometry is only rendered instanced, as its playback parameters are in the instance stream.
+			if (instanceCount > 1 || skinned || baked) {
 				batch.type = BatchType::Instanced;
 				batch.instanceCount = instanceCount;
 				i += instanceCount - 1;
 			}
 		}
 	}
+
+	size_t BatchQueue::NumDrawCalls() const
+	{
+		size_t count = 0;
+		for (size_t i = 0; i < batches.size(); ++i) {
+			if (batches[i].type == BatchType::Instanced) {
+				i += batches[i].instanceCount - 1;
+			}
+			++count;
+		}
+		return count;
+	}
 }
@@ -25,7 +25,7 @@ namespace Turso3D
 		Static,
 		// Complex geometry rendering, the batch contains a drawable.
 		Complex,
-		// The batch was converted from Static to instance, the batch contains instance count.
+		// The batch was converted from Static, skinned or baked animation Complex to instance, the batch contains instance count.
 		Instanced
 	};
 
@@ -69,10 +69,12 @@ namespace Turso3D
 	{
 		// Clear for the next frame.
 		void Clear();
-		// Sort batches and setup instancing groups.
-		void Sort(BatchSortMode sortMode, bool convertToInstanced);
+		// Sort batches and setup instancing groups. Skinned geometry is instanced only if it has at most maxInstancedBones bones.
+		void Sort(BatchSortMode sortMode, bool convertToInstanced, size_t maxInstancedBones);
 		// Return whether has batches added.
 		bool HasBatches() const { return batches.size(); }
+		// Return the number of draw calls after instancing conversion.
+		size_t NumDrawCalls() const;
 
 		// Batches.
 		std::vector<Batch> batches;
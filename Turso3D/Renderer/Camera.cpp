@@ -284,6 +284,16 @@ namespace Turso3D
 		return farClip > NearClip();
 	}
 
+	void Camera::OnOriginShift(const Vector3& offset)
+	{
+		SpatialNode::OnOriginShift(offset);
+
+		reflectionPlane.Translate(offset);
+		reflectionMatrix = reflectionPlane.ReflectionMatrix();
+		clipPlane.Translate(offset);
+		viewMatrixDirty = true;
+	}
+
 	void Camera::OnTransformChanged()
 	{
 		SpatialNode::OnTransformChanged();
@@ -128,6 +128,9 @@ namespace Turso3D
 		// Return if projection parameters are valid for rendering and raycasting.
 		bool IsProjectionValid() const;
 
+		// Move by a world space offset when the world origin is rebased, along with the reflection and clip planes.
+		void OnOriginShift(const Vector3& offset) override;
+
 	protected:
 		// Handle the transform matrix changing.
 		void OnTransformChanged() override;
@@ -0,0 +1,216 @@
+#include <Turso3D/Renderer/Imposter.h>
+#include <Turso3D/Graphics/FrameBuffer.h>
+#include <Turso3D/Graphics/Graphics.h>
+#include <Turso3D/Graphics/IndexBuffer.h>
+#include <Turso3D/Graphics/Shader.h>
+#include <Turso3D/Graphics/ShaderProgram.h>
+#include <Turso3D/Graphics/Texture.h>
+#include <Turso3D/Graphics/VertexBuffer.h>
+#include <Turso3D/IO/Log.h>
+#include <Turso3D/Renderer/Camera.h>
+#include <Turso3D/Renderer/GeometryNode.h>
+#include <Turso3D/Renderer/Material.h>
+#include <Turso3D/Renderer/Model.h>
+#include <Turso3D/Resource/ResourceCache.h>
+
+namespace
+{
+	using namespace Turso3D;
+
+	constexpr int MAX_ATLAS_SIZE = 4096;
+
+	// Return the up vector used to build the frame basis. Must match imposter.glsl.
+	inline Vector3 FrameUpVector(const Vector3& forward)
+	{
+		return fabsf(forward.y) > 0.999f ? Vector3::FORWARD() : Vector3::UP();
+	}
+}
+
+namespace Turso3D
+{
+	Imposter::Imposter() :
+		numFrames(0),
+		center(Vector3::ZERO()),
+		radius(0.0f)
+	{
+	}
+
+	Imposter::~Imposter()
+	{
+	}
+
+	bool Imposter::Bake(const Model* model, const std::vector<std::shared_ptr<Material>>& materials, int numFrames_, int frameSize)
+	{
+		Log::Scope logScope {"Imposter::Bake"};
+
+		if (!model || !model->NumGeometries()) {
+			LOG_ERROR("Null or empty model");
+			return false;
+		}
+		if (numFrames_ < 1 || frameSize < 1 || numFrames_ * frameSize > MAX_ATLAS_SIZE) {
+			LOG_ERROR("Invalid imposter atlas dimensions {:d}x{:d}", numFrames_, frameSize);
+			return false;
+		}
+
+		ResourceCache* cache = ResourceCache::Instance();
+		constexpr StringHash bakeViewProjMatrixHash {"bakeViewProjMatrix"};
+		constexpr StringHash bakeBaseColorHash {"bakeBaseColor"};
+		constexpr StringHash baseColorHash {"BaseColor"};
+
+		// Texture and untextured variations of the bake shader
+		std::shared_ptr<ShaderProgram> programs[2] = {
+			Graphics::CreateProgram("imposter_bake.glsl", "", ""),
+			Graphics::CreateProgram("imposter_bake.glsl", "", "NOTEXTURE")
+		};
+		if (!programs[0] || !programs[1]) {
+			return false;
+		}
+
+		const BoundingBox& box = model->LocalBoundingBox();
+		numFrames = numFrames_;
+		center = box.Center();
+		radius = std::max(box.HalfSize().Length(), M_EPSILON);
+
+		IntVector2 atlasSize {numFrames * frameSize, numFrames * frameSize};
+
+		albedoTexture = std::make_shared<Texture>();
+		albedoTexture->Define(TARGET_2D, atlasSize, FORMAT_RGBA8_UNORM_PACK8);
+		albedoTexture->DefineSampler(FILTER_BILINEAR, ADDRESS_CLAMP, ADDRESS_CLAMP, ADDRESS_CLAMP);
+
+		normalTexture = std::make_shared<Texture>();
+		normalTexture->Define(TARGET_2D, atlasSize, FORMAT_RGBA8_UNORM_PACK8);
+		normalTexture->DefineSampler(FILTER_BILINEAR, ADDRESS_CLAMP, ADDRESS_CLAMP, ADDRESS_CLAMP);
+
+		Texture depthTexture;
+		depthTexture.Define(TARGET_2D, atlasSize, FORMAT_D24_UNORM_PACK32);
+
+		Texture* colorTextures[] = {albedoTexture.get(), normalTexture.get()};
+		FrameBuffer fbo;
+		fbo.Define(colorTextures, 2, &depthTexture);
+
+		Graphics::BindFramebuffer(&fbo, nullptr);
+		Graphics::SetViewport(IntRect {IntVector2::ZERO(), atlasSize});
+		Graphics::SetRenderState(BLEND_REPLACE, CULL_NONE, CMP_LESS_EQUAL, true, true);
+		Graphics::Clear(true, true, IntRect::ZERO(), Color {0.0f, 0.0f, 0.0f, 0.0f});
+
+		Camera camera;
+		camera.SetOrthographic(true);
+		camera.SetOrthoSize(2.0f * radius);
+		camera.SetFarClip(4.0f * radius);
+
+		for (int y = 0; y < numFrames; ++y) {
+			for (int x = 0; x < numFrames; ++x) {
+				// Place the camera on the bounding sphere looking at the model center
+				Vector3 forward = -FrameDirection(x, y, numFrames);
+				Vector3 right = FrameUpVector(forward).CrossProduct(forward).Normalized();
+				Vector3 up = forward.CrossProduct(right);
+
+				camera.SetPosition(center - forward * (2.0f * radius));
+				camera.SetRotation(Quaternion {right, up, forward});
+
+				Matrix4 viewProj = camera.ProjectionMatrix() * camera.ViewMatrix();
+				Graphics::SetViewport(IntRect {x * frameSize, y * frameSize, (x + 1) * frameSize, (y + 1) * frameSize});
+
+				for (size_t i = 0; i < model->NumGeometries(); ++i) {
+					Geometry* geometry = model->GetGeometry(i, 0).get();
+					if (!geometry || !geometry->vertexBuffer) {
+						continue;
+					}
+
+					Material* material = i < materials.size() && materials[i] ? materials[i].get() : Material::GetDefault().get();
+					Texture* albedo = material->GetTexture(0).get();
+
+					ShaderProgram* program = programs[albedo ? 0 : 1].get();
+					Graphics::BindProgram(program);
+					Graphics::SetUniform(program->Uniform(bakeViewProjMatrixHash), viewProj);
+
+					if (albedo) {
+						Graphics::BindTexture(0, albedo);
+					}
+
+					// Look up the base color by name, as the materials' uniform layouts differ. Bake white if not defined
+					Vector4 baseColor = Vector4::ONE();
+					for (size_t j = 0; j < material->NumUniforms(); ++j) {
+						if (material->UniformNameHash(j) == baseColorHash) {
+							baseColor = material->Uniform(j);
+							break;
+						}
+					}
+					Graphics::SetUniform(program->Uniform(bakeBaseColorHash), baseColor);
+
+					Graphics::BindVertexBuffers(geometry->vertexBuffer.get());
+					if (IndexBuffer* ib = geometry->indexBuffer.get(); ib) {
+						Graphics::BindIndexBuffer(ib);
+						Graphics::DrawIndexed(PT_TRIANGLE_LIST, geometry->drawStart, geometry->drawCount);
+					} else {
+						Graphics::Draw(PT_TRIANGLE_LIST, geometry->drawStart, geometry->drawCount);
+					}
+				}
+			}
+		}
+
+		Graphics::BindFramebuffer(nullptr, nullptr);
+
+		// Unit quad, expanded and oriented towards the viewer in the vertex shader
+		const float quadVertexData[] = {
+			-1.0f, 1.0f, 0.0f,
+			1.0f, 1.0f, 0.0f,
+			1.0f, -1.0f, 0.0f,
+			-1.0f, -1.0f, 0.0f
+		};
+		const unsigned short quadIndexData[] = {
+			0, 1, 2,
+			2, 3, 0
+		};
+		const VertexElement elements[] = {
+			{ELEM_VECTOR3, ATTR_POSITION}
+		};
+
+		std::shared_ptr<VertexBuffer> vb = std::make_shared<VertexBuffer>();
+		vb->Define(USAGE_DEFAULT, 4, elements, 1, quadVertexData);
+		std::shared_ptr<IndexBuffer> ib = std::make_shared<IndexBuffer>();
+		ib->Define(USAGE_DEFAULT, 6, sizeof(unsigned short), quadIndexData);
+
+		geometry = std::make_shared<Geometry>();
+		geometry->vertexBuffer = vb;
+		geometry->indexBuffer = ib;
+		geometry->drawStart = 0;
+		geometry->drawCount = 6;
+		geometry->lodDistance = 0.0f;
+
+		std::vector<std::pair<std::string, Vector4>> uniforms;
+		uniforms.push_back(std::make_pair("ImposterCenter", Vector4 {center, radius}));
+		uniforms.push_back(std::make_pair("ImposterParams", Vector4 {static_cast<float>(numFrames), 1.0f / static_cast<float>(numFrames), 0.0f, 0.0f}));
+		uniforms.push_back(std::make_pair("AoRoughMetal", Vector4 {1.0f, 0.8f, 0.0f, 1.0f}));
+
+		material = std::make_shared<Material>();
+		material->DefineUniforms(uniforms);
+		material->SetTexture(0, albedoTexture);
+		material->SetTexture(1, normalTexture);
+		// The quad is always oriented towards the viewer, but may be mirrored by reflection cameras
+		material->SetCullMode(CULL_NONE);
+
+		Pass* pass = material->CreatePass(PASS_OPAQUE);
+		pass->SetShader(cache->LoadResource<Shader>("imposter.glsl"), "", "");
+		pass->SetRenderState(BLEND_REPLACE, CMP_LESS_EQUAL, true, true);
+
+		return true;
+	}
+
+	Vector3 Imposter::FrameDirection(int x, int y, int numFrames)
+	{
+		// Octahedral decode of the frame center, with Y as the octahedron axis. Must match imposter.glsl.
+		Vector2 p {
+			(static_cast<float>(x) + 0.5f) / static_cast<float>(numFrames) * 2.0f - 1.0f,
+			(static_cast<float>(y) + 0.5f) / static_cast<float>(numFrames) * 2.0f - 1.0f
+		};
+
+		Vector3 n {p.x, 1.0f - fabsf(p.x) - fabsf(p.y), p.y};
+		if (n.y < 0.0f) {
+			float nx = n.x;
+			n.x = (1.0f - fabsf(n.z)) * (nx >= 0.0f ? 1.0f : -1.0f);
+			n.z = (1.0f - fabsf(nx)) * (n.z >= 0.0f ? 1.0f : -1.0f);
+		}
+		return n.Normalized();
+	}
+}
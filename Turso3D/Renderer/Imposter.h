@@ -0,0 +1,66 @@
+#pragma once
+
+#include <Turso3D/Math/Vector3.h>
+#include <memory>
+#include <vector>
+
+namespace Turso3D
+{
+	class Material;
+	class Model;
+	class Texture;
+	struct Geometry;
+
+	// Octahedral imposter of a model.
+	// Stores an atlas of the model rendered from a grid of directions covering the whole sphere,
+	// and a camera facing quad that selects the closest baked view in the vertex shader.
+	// The quad renders as a static geometry, so that distant imposters of the same model are drawn in a single instanced batch.
+	class Imposter
+	{
+	public:
+		// Construct.
+		Imposter();
+		// Destruct.
+		~Imposter();
+
+		// Bake the imposter atlas from the model's highest LOD level.
+		// Materials are indexed by geometry; the first texture unit is used as albedo and the first material uniform as base color.
+		// Must be called from the main thread. Leaves the backbuffer bound on return.
+		// Return true on success.
+		bool Bake(const Model* model, const std::vector<std::shared_ptr<Material>>& materials, int numFrames = 8, int frameSize = 128);
+
+		// Return the quad geometry.
+		const std::shared_ptr<Geometry>& GetGeometry() const { return geometry; }
+		// Return the imposter material.
+		const std::shared_ptr<Material>& GetMaterial() const { return material; }
+		// Return the albedo and coverage atlas.
+		Texture* AlbedoTexture() const { return albedoTexture.get(); }
+		// Return the local space normal atlas.
+		Texture* NormalTexture() const { return normalTexture.get(); }
+		// Return number of frames per atlas axis.
+		int NumFrames() const { return numFrames; }
+		// Return the local space center of the baked model.
+		const Vector3& Center() const { return center; }
+		// Return the bounding sphere radius of the baked model.
+		float Radius() const { return radius; }
+
+		// Return the view direction (from the model towards the viewer) of an atlas frame.
+		static Vector3 FrameDirection(int x, int y, int numFrames);
+
+	private:
+		// Camera facing quad.
+		std::shared_ptr<Geometry> geometry;
+		// Material that renders the quad using the atlas.
+		std::shared_ptr<Material> material;
+		// Albedo and coverage atlas.
+		std::shared_ptr<Texture> albedoTexture;
+		// Local space normal atlas.
+		std::shared_ptr<Texture> normalTexture;
+		// Number of frames per atlas axis.
+		int numFrames;
+		// Local space center of the baked model.
+		Vector3 center;
+		// Bounding sphere radius of the baked model.
+		float radius;
+	};
+}
@@ -60,6 +60,20 @@ namespace
 		return data[value];
 	}
 
+	// Return whether a space-separated define list contains a define.
+	static bool HasDefine(const std::string& defines, std::string_view define)
+	{
+		size_t pos = 0;
+		while ((pos = defines.find(define, pos)) != std::string::npos) {
+			size_t end = pos + define.length();
+			if ((pos == 0 || defines[pos - 1] == ' ') && (end == defines.length() || defines[end] == ' ')) {
+				return true;
+			}
+			pos = end;
+		}
+		return false;
+	}
+
 	static std::set<Material*> AllMaterials;
 	static std::string GlobalDefines[MAX_SHADER_TYPES];
 }
@@ -140,6 +154,13 @@ namespace Turso3D
 							}
 						}
 
+						// When loading asynchronously, load the shader in parallel. EndLoad takes it from the cache
+						if (!data.shader.empty() && ResourceCache::Instance()->IsLoadingAsync()) {
+							std::shared_ptr<Shader> shader = std::make_shared<Shader>();
+							shader->SetName(data.shader);
+							ResourceCache::Instance()->LoadDependencyAsync(shader);
+						}
+
 						break;
 					}
 				}
@@ -157,23 +178,30 @@ namespace Turso3D
 						namepath = std::filesystem::path {basePath}.replace_filename(namepath).string();
 					}
 
-					std::unique_ptr<Stream> image = cache->OpenData(namepath);
-					if (!image) {
-						continue;
-					}
-
-					TextureData& data = textures.emplace_back();
-					data.slot = texture.attribute("slot").as_uint();
 					bool srgb = texture.attribute("srgb").as_bool();
 					bool genMips = texture.attribute("generateMips").as_bool();
 
-					data.texture = std::make_shared<Texture>();
-					data.texture->SetName(namepath);
-					data.texture->SetLoadFlag(Texture::LOAD_FLAG_SRGB, srgb);
-					data.texture->SetLoadFlag(Texture::LOAD_FLAG_GENERATE_MIPS, genMips);
-					if (!data.texture->BeginLoad(*image)) {
-						data.texture.reset();
+					std::shared_ptr<Texture> tex = std::make_shared<Texture>();
+					tex->SetName(namepath);
+					tex->SetLoadFlag(Texture::LOAD_FLAG_SRGB, srgb);
+					tex->SetLoadFlag(Texture::LOAD_FLAG_GENERATE_MIPS, genMips);
+
+					// When loading asynchronously, load the texture in parallel. EndLoad takes it from the cache
+					bool async = cache->LoadDependencyAsync(tex);
+					if (!async) {
+						std::unique_ptr<Stream> image = cache->OpenData(namepath);
+						if (!image) {
+							continue;
+						}
+						if (!tex->BeginLoad(*image)) {
+							tex.reset();
+						}
 					}
+
+					TextureData& data = textures.emplace_back();
+					data.slot = texture.attribute("slot").as_uint();
+					data.texture = tex;
+					data.async = async;
 				}
 			}
 
@@ -216,6 +244,7 @@ namespace Turso3D
 		{
 			unsigned slot;
 			std::shared_ptr<Texture> texture;
+			bool async;
 		};
 		std::vector<TextureData> textures;
 
@@ -228,7 +257,8 @@ namespace Turso3D
 		blendMode(BLEND_REPLACE),
 		depthTest(CMP_LESS_EQUAL),
 		colorWrite(true),
-		depthWrite(true)
+		depthWrite(true),
+		alphaMasked(false)
 	{
 	}
 
@@ -261,6 +291,10 @@ namespace Turso3D
 		for (size_t i = 0; i < MaxPassPermutations; ++i) {
 			shaderPrograms[i].reset();
 		}
+
+		constexpr std::string_view alphaMaskDefine {"ALPHAMASK"};
+		alphaMasked = HasDefine(vsDefines, alphaMaskDefine) || HasDefine(fsDefines, alphaMaskDefine) ||
+			HasDefine(parent->VSDefines(), alphaMaskDefine) || HasDefine(parent->FSDefines(), alphaMaskDefine);
 	}
 
 	std::shared_ptr<ShaderProgram> Pass::CreateShaderProgram(GeometryPermutation geometry, LightMaskPermutation lightmask)
@@ -268,7 +302,9 @@ namespace Turso3D
 		constexpr std::string_view geometryDefines[] = {
 			{},
 			{"SKINNED"},
-			{"INSTANCED"}
+			{"INSTANCED"},
+			{"SKINNED INSTANCED"},
+			{"BAKED_ANIMATION INSTANCED"}
 		};
 		constexpr std::string_view lightmaskDefines[] = {
 			{},
@@ -344,6 +380,12 @@ namespace Turso3D
 				continue;
 			}
 
+			// An asynchronously loaded texture is in the cache unless its load failed
+			if (data.async) {
+				LOG_ERROR("Failed to load texture \"{:s}\" for material \"{:s}\".", data.texture->Name(), Name());
+				continue;
+			}
+
 			// Upload texture data to GPU and store in the cache
 			if (data.texture->EndLoad()) {
 				cache->StoreResource(data.texture);
@@ -43,7 +43,9 @@ namespace Turso3D
 		{
 			None,
 			Skinned,
-			Instanced
+			Instanced,
+			SkinnedInstanced,
+			BakedAnimation
 		};
 		enum class LightMaskPermutation
 		{
@@ -52,7 +54,7 @@ namespace Turso3D
 		};
 
 	private:
-		constexpr static size_t MaxGeometryPermutation = 3;
+		constexpr static size_t MaxGeometryPermutation = 5;
 		constexpr static size_t MaxLightMaskPermutation = 2;
 		constexpr static size_t MaxPassPermutations = MaxGeometryPermutation * MaxLightMaskPermutation;
 
@@ -69,8 +71,7 @@ namespace Turso3D
 		// Get a shader program and cache for later use.
 		ShaderProgram* GetShaderProgram(GeometryPermutation geometry, LightMaskPermutation lightmask)
 		{
-			size_t index = (size_t)geometry + (size_t)lightmask +
-				(MaxGeometryPermutation * (size_t)lightmask);
+			size_t index = (size_t)geometry + (MaxGeometryPermutation * (size_t)lightmask);
 
 			if (shaderPrograms[index]) {
 				return shaderPrograms[index].get();
@@ -84,7 +85,7 @@ namespace Turso3D
 			return shaderPrograms[index].get();
 		}
 
-		// Reset existing shader programs.
+		// Reset existing shader programs and update the alpha mask flag from the defines.
 		void ResetShaderPrograms();
 
 		// Return parent material.
@@ -97,6 +98,8 @@ namespace Turso3D
 		bool GetColorWrite() const { return colorWrite; }
 		// Return depth write flag.
 		bool GetDepthWrite() const { return depthWrite; }
+		// Return whether the pass or material defines ALPHAMASK, so that fragments may be discarded.
+		bool IsAlphaMasked() const { return alphaMasked; }
 
 		// Return shader.
 		const std::shared_ptr<Shader>& GetShader() const { return shader; }
@@ -124,6 +127,8 @@ namespace Turso3D
 		bool colorWrite;
 		// Depth write flag.
 		bool depthWrite;
+		// Alpha mask flag.
+		bool alphaMasked;
 
 		// Shader resource.
 		std::shared_ptr<Shader> shader;
@@ -201,6 +206,8 @@ namespace Turso3D
 		size_t NumUniforms() const { return uniformValues.size(); }
 		// Return uniform value by index.
 		const Vector4& Uniform(size_t index) const { return uniformValues[index]; }
+		// Return uniform name hash by index.
+		StringHash UniformNameHash(size_t index) const { return uniformNameHashes[index]; }
 		// Return uniform value by name hash.
 		const Vector4& Uniform(StringHash nameHash) const;
 		// Return culling mode.
@@ -55,6 +55,11 @@ namespace Turso3D
 
 			offset += vertex_stride + index_stride;
 		}
+
+		bvhs.resize(numMeshes);
+		for (size_t i = 0; i < numMeshes; ++i) {
+			bvhs[i].Define(meshes[i].vertices, meshes[i].indices, meshes[i].numIndices);
+		}
 	}
 
 	void HullGroup::Clear()
@@ -62,6 +67,7 @@ namespace Turso3D
 		data.reset();
 		meshes = nullptr;
 		numMeshes = 0;
+		bvhs.clear();
 	}
 
 	// ==========================================================================================
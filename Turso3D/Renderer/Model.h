@@ -4,6 +4,7 @@
 #include <Turso3D/Math/BoundingBox.h>
 #include <Turso3D/Math/Quaternion.h>
 #include <Turso3D/Math/Matrix3x4.h>
+#include <Turso3D/Math/TriangleBvh.h>
 #include <Turso3D/Resource/Resource.h>
 #include <memory>
 #include <map>
@@ -71,6 +72,8 @@ namespace Turso3D
 		const unsigned* GetIndices(size_t meshIndex) const { return meshes[meshIndex].indices; }
 		// Return the number of indices of the specified hull mesh.
 		unsigned GetIndexCount(size_t meshIndex) const { return meshes[meshIndex].numIndices; }
+		// Return the raycast hierarchy of the specified hull mesh.
+		const TriangleBvh& GetBvh(size_t meshIndex) const { return bvhs[meshIndex]; }
 
 	private:
 		void Define(const std::vector<MeshInfo>& srcMeshes);
@@ -83,6 +86,8 @@ namespace Turso3D
 		MeshInfo* meshes;
 		// The number of meshes.
 		size_t numMeshes;
+		// Raycast hierarchy for each mesh.
+		std::vector<TriangleBvh> bvhs;
 	};
 
 	// ==========================================================================================
@@ -1,8 +1,10 @@
 #include <Turso3D/Renderer/Octree.h>
+#include <Turso3D/Core/Profiler.h>
 #include <Turso3D/Core/WorkQueue.h>
 #include <Turso3D/Graphics/Graphics.h>
 #include <Turso3D/IO/Log.h>
 #include <Turso3D/Math/Ray.h>
+#include <Turso3D/Renderer/AnimationPoseCache.h>
 #include <Turso3D/Renderer/DebugRenderer.h>
 #include <cassert>
 #include <algorithm>
@@ -15,6 +17,33 @@ namespace
 	constexpr int DEFAULT_OCTREE_LEVELS = 8;
 	constexpr int MAX_OCTREE_LEVELS = 255;
 	constexpr size_t MIN_THREADED_UPDATE = 16;
+	// Minimum animation update cost, roughly the number of bones, per animation update task.
+	constexpr size_t MIN_ANIMATION_UPDATE_COST = 256;
+	// Minimum animation LOD bias when over the animation budget.
+	constexpr float MIN_ANIMATION_LOD_BIAS = 0.05f;
+	// Maximum animation LOD bias decrease per frame when over the animation budget.
+	constexpr float ANIMATION_LOD_BIAS_DECREASE = 0.5f;
+	// Animation LOD bias increase per frame when within the animation budget.
+	constexpr float ANIMATION_LOD_BIAS_INCREASE = 1.05f;
+	// Fraction of the animation budget the cost must fall below before the animation LOD bias increases. Avoids oscillating between LOD levels.
+	constexpr float ANIMATION_BUDGET_HYSTERESIS = 0.8f;
+	// Fattened bounds defaults. A moving drawable is typically placed one octree level higher than its bounds alone would allow, which halves its reinsertion rate or better.
+	constexpr float DEFAULT_FAT_BOUNDS_MARGIN = 1.0f;
+	constexpr float DEFAULT_FAT_BOUNDS_LOOKAHEAD = 30.0f;
+	constexpr size_t MIN_THREADED_RAYCAST = 64;
+	constexpr float DEFAULT_AUTO_EXPAND_MAX_SIZE = 1.0e6f;
+	// Minimum number of octants, flattened octants and drawables to move per origin rebase task.
+	constexpr size_t MIN_ORIGIN_SHIFT_ITEMS = 4096;
+	// Number of octant subtrees per thread to split between the origin rebase tasks.
+	constexpr size_t ORIGIN_SHIFT_SUBTREES_PER_THREAD = 16;
+	// Inverse ray direction used for a zero direction component. Any box not containing the origin on that axis is missed.
+	constexpr float MAX_INVERSE_DIRECTION = 1.0e30f;
+
+	// Return whether a queued drawable's animation should be updated along with the reinsertion check.
+	static inline bool IsAnimationUpdated(const Drawable* drawable, unsigned short frameNumber)
+	{
+		return drawable && drawable->TestFlag(Drawable::FLAG_ANIMATION_UPDATE_CALL) && (drawable->TestFlag(Drawable::FLAG_UPDATE_INVISIBLE) || drawable->WasInView(frameNumber));
+	}
 
 	static inline bool CompareRaycastResults(const RaycastResult& lhs, const RaycastResult& rhs)
 	{
@@ -26,6 +55,136 @@ namespace
 		return lhs.second < rhs.second;
 	}
 
+	static inline float InverseDirection(float direction)
+	{
+		if (direction != 0.0f) {
+			return 1.0f / direction;
+		} else {
+			return MAX_INVERSE_DIRECTION;
+		}
+	}
+
+	// Return the part of an array processed by one of several tasks, as start and end indices.
+	static inline std::pair<size_t, size_t> TaskRange(size_t size, size_t taskIndex, size_t numTasks)
+	{
+		return std::make_pair(size * taskIndex / numTasks, size * (taskIndex + 1) / numTasks);
+	}
+
+	// Up to 4 rays in SoA layout for testing against bounding boxes.
+	struct RayPacket
+	{
+		// Define from rays. Unused lanes repeat the last ray.
+		void Define(const Ray* rays, size_t count)
+		{
+			float values[6][4];
+			for (size_t i = 0; i < 4; ++i) {
+				const Ray& ray = rays[std::min(i, count - 1)];
+				values[0][i] = ray.origin.x;
+				values[1][i] = ray.origin.y;
+				values[2][i] = ray.origin.z;
+				values[3][i] = InverseDirection(ray.direction.x);
+				values[4][i] = InverseDirection(ray.direction.y);
+				values[5][i] = InverseDirection(ray.direction.z);
+			}
+
+#ifdef TURSO3D_SIMD
+			originX = Simd::Load(values[0]);
+			originY = Simd::Load(values[1]);
+			originZ = Simd::Load(values[2]);
+			invDirX = Simd::Load(values[3]);
+			invDirY = Simd::Load(values[4]);
+			invDirZ = Simd::Load(values[5]);
+#else
+			for (size_t i = 0; i < 4; ++i) {
+				originX[i] = values[0][i];
+				originY[i] = values[1][i];
+				originZ[i] = values[2][i];
+				invDirX[i] = values[3][i];
+				invDirY[i] = values[4][i];
+				invDirZ[i] = values[5][i];
+			}
+#endif
+		}
+
+#ifdef TURSO3D_SIMD
+		Simd::Float4 originX, originY, originZ;
+		Simd::Float4 invDirX, invDirY, invDirZ;
+#else
+		float originX[4], originY[4], originZ[4];
+		float invDirX[4], invDirY[4], invDirZ[4];
+#endif
+	};
+
+	// Test a ray packet against a bounding box with the slab method. Return a bitmask of the rays hitting closer than the max distance, and the hit distances.
+	// The distance is zero for rays starting inside the box.
+	static inline unsigned HitDistances(const RayPacket& packet, const BoundingBox& box, float maxDistance, float* distances)
+	{
+#ifdef TURSO3D_SIMD
+		Simd::Float4 t1 = Simd::Mul(Simd::Sub(Simd::Splat(box.min.x), packet.originX), packet.invDirX);
+		Simd::Float4 t2 = Simd::Mul(Simd::Sub(Simd::Splat(box.max.x), packet.originX), packet.invDirX);
+		Simd::Float4 tMin = Simd::Min(t1, t2);
+		Simd::Float4 tMax = Simd::Max(t1, t2);
+		t1 = Simd::Mul(Simd::Sub(Simd::Splat(box.min.y), packet.originY), packet.invDirY);
+		t2 = Simd::Mul(Simd::Sub(Simd::Splat(box.max.y), packet.originY), packet.invDirY);
+		tMin = Simd::Max(tMin, Simd::Min(t1, t2));
+		tMax = Simd::Min(tMax, Simd::Max(t1, t2));
+		t1 = Simd::Mul(Simd::Sub(Simd::Splat(box.min.z), packet.originZ), packet.invDirZ);
+		t2 = Simd::Mul(Simd::Sub(Simd::Splat(box.max.z), packet.originZ), packet.invDirZ);
+		tMin = Simd::Max(Simd::Max(tMin, Simd::Min(t1, t2)), Simd::Zero());
+		tMax = Simd::Min(tMax, Simd::Max(t1, t2));
+
+		Simd::Store(distances, tMin);
+		return Simd::GreaterEqualMask(tMax, tMin) & Simd::LessMask(tMin, Simd::Splat(maxDistance));
+#else
+		unsigned mask = 0;
+		for (size_t i = 0; i < 4; ++i) {
+			float t1 = (box.min.x - packet.originX[i]) * packet.invDirX[i];
+			float t2 = (box.max.x - packet.originX[i]) * packet.invDirX[i];
+			float tMin = std::min(t1, t2);
+			float tMax = std::max(t1, t2);
+			t1 = (box.min.y - packet.originY[i]) * packet.invDirY[i];
+			t2 = (box.max.y - packet.originY[i]) * packet.invDirY[i];
+			tMin = std::max(tMin, std::min(t1, t2));
+			tMax = std::min(tMax, std::max(t1, t2));
+			t1 = (box.min.z - packet.originZ[i]) * packet.invDirZ[i];
+			t2 = (box.max.z - packet.originZ[i]) * packet.invDirZ[i];
+			tMin = std::max(std::max(tMin, std::min(t1, t2)), 0.0f);
+			tMax = std::min(tMax, std::max(t1, t2));
+
+			distances[i] = tMin;
+			if (tMax >= tMin && tMin < maxDistance) {
+				mask |= 1u << i;
+			}
+		}
+		return mask;
+#endif
+	}
+
+	// Octant or drawable in the best-first nearest query queue.
+	struct NearestQueueEntry
+	{
+		// Squared distance to the bounding box.
+		float distanceSquared;
+		// Flattened octant or drawable index.
+		unsigned index;
+		// Whether is a drawable.
+		bool isDrawable;
+	};
+
+	static inline bool CompareNearestQueueEntries(const NearestQueueEntry& lhs, const NearestQueueEntry& rhs)
+	{
+		// Reversed for a min-heap
+		return lhs.distanceSquared > rhs.distanceSquared;
+	}
+
+	static inline float DistanceSquared(const BoundingBox& box, const Vector3& position)
+	{
+		float dx = std::max(std::max(box.min.x - position.x, position.x - box.max.x), 0.0f);
+		float dy = std::max(std::max(box.min.y - position.y, position.y - box.max.y), 0.0f);
+		float dz = std::max(std::max(box.min.z - position.z, position.z - box.max.z), 0.0f);
+		return dx * dx + dy * dy + dz * dz;
+	}
+
 	static inline bool CompareDrawables(Drawable* lhs, Drawable* rhs)
 	{
 		unsigned lhsFlags = lhs->Flags() & (Drawable::FLAG_LIGHT | Drawable::FLAG_GEOMETRY);
@@ -47,6 +206,7 @@ namespace Turso3D
 		ReinsertDrawablesTask(Octree* object_, MemberWorkFunctionPtr function_) :
 			MemberFunctionTask<Octree>(object_, function_)
 		{
+			name = "CheckReinsert";
 		}
 
 		// Start pointer.
@@ -55,8 +215,68 @@ namespace Turso3D
 		Drawable** end;
 	};
 
+	// Task for updating animation of a part of the update queue and checking the drawables for reinsertion.
+	struct Octree::AnimationUpdateTask : public ReinsertDrawablesTask
+	{
+		// Construct.
+		AnimationUpdateTask(Octree* object_, MemberWorkFunctionPtr function_) :
+			ReinsertDrawablesTask(object_, function_)
+		{
+			name = "AnimationUpdate";
+		}
+	};
+
+	// Task for querying a part of a raycast batch.
+	struct Octree::RaycastBatchTask : public MemberFunctionTask<Octree>
+	{
+		// Construct.
+		RaycastBatchTask(Octree* object_, MemberWorkFunctionPtr function_) :
+			MemberFunctionTask<Octree>(object_, function_)
+		{
+			name = "RaycastBatch";
+		}
+
+		// Rays to query.
+		const Ray* rays;
+		// Number of rays.
+		size_t numRays;
+		// Query mode.
+		RaycastMode mode;
+		// Drawable flags to match.
+		unsigned drawableFlags;
+		// View mask to match.
+		unsigned viewMask;
+		// Maximum hit distance.
+		float maxDistance;
+		// Hits of the rays.
+		std::vector<RaycastResult> result;
+		// Start index of each ray's hits.
+		std::vector<unsigned> resultStart;
+		// Scratch buffers.
+		RaycastScratch scratch;
+	};
+
+	// Task for moving a part of the octree when the world origin is rebased.
+	struct Octree::OriginShiftTask : public MemberFunctionTask<Octree>
+	{
+		// Construct.
+		OriginShiftTask(Octree* object_, MemberWorkFunctionPtr function_) :
+			MemberFunctionTask<Octree>(object_, function_)
+		{
+			name = "OriginShift";
+		}
+
+		// Offset to move by.
+		Vector3 offset;
+		// Index of this task.
+		size_t taskIndex;
+		// Total number of tasks.
+		size_t numTasks;
+	};
+
 	// ==========================================================================================
 	Octant::Octant() :
+		flatLayoutDirty(false),
 		parent(nullptr),
 		visibility(VIS_VISIBLE_UNKNOWN),
 		occlusionQueryId(0),
@@ -148,7 +368,7 @@ namespace Turso3D
 				BoundingBox tempBox;
 
 				for (size_t i = 0; i < drawables.size(); ++i) {
-					tempBox.Merge(drawables[i]->WorldBoundingBox());
+					tempBox.Merge(BoundingBox(Vector3(culling.minX[i], culling.minY[i], culling.minZ[i]), Vector3(culling.maxX[i], culling.maxY[i], culling.maxZ[i])));
 				}
 
 				if (numChildren) {
@@ -168,17 +388,189 @@ namespace Turso3D
 		return cullingBox;
 	}
 
+	void Octant::CullDrawables(std::vector<unsigned>& result, const Frustum& frustum, unsigned char planeMask, const Vector3& viewPosition, unsigned drawableFlags, unsigned viewMask) const
+	{
+		result.clear();
+
+		for (size_t i = 0; i < drawables.size(); i += 4) {
+			// Test flags and view mask first, as they reject whole groups, such as the lights, without touching the bounds
+			unsigned passMask = 0;
+			for (size_t j = 0; j < 4; ++j) {
+				if ((culling.flags[i + j] & drawableFlags) == drawableFlags && (culling.viewMask[i + j] & viewMask)) {
+					passMask |= 1 << j;
+				}
+			}
+			if (!passMask) {
+				continue;
+			}
+
+#ifdef TURSO3D_SIMD
+			Simd::Float4 minX = Simd::Load(&culling.minX[i]);
+			Simd::Float4 minY = Simd::Load(&culling.minY[i]);
+			Simd::Float4 minZ = Simd::Load(&culling.minZ[i]);
+			Simd::Float4 maxX = Simd::Load(&culling.maxX[i]);
+			Simd::Float4 maxY = Simd::Load(&culling.maxY[i]);
+			Simd::Float4 maxZ = Simd::Load(&culling.maxZ[i]);
+
+			if (planeMask) {
+				Simd::Float4 half = Simd::Splat(0.5f);
+				Simd::Float4 centerX = Simd::Mul(Simd::Add(maxX, minX), half);
+				Simd::Float4 centerY = Simd::Mul(Simd::Add(maxY, minY), half);
+				Simd::Float4 centerZ = Simd::Mul(Simd::Add(maxZ, minZ), half);
+				Simd::Float4 edgeX = Simd::Sub(centerX, minX);
+				Simd::Float4 edgeY = Simd::Sub(centerY, minY);
+				Simd::Float4 edgeZ = Simd::Sub(centerZ, minZ);
+
+				for (size_t j = 0; j < NUM_FRUSTUM_PLANES && passMask; ++j) {
+					if (planeMask & (1 << j)) {
+						const Plane& plane = frustum.planes[j];
+						Simd::Float4 dist = Simd::Mul(Simd::Splat(plane.normal.x), centerX);
+						dist = Simd::Add(dist, Simd::Mul(Simd::Splat(plane.normal.y), centerY));
+						dist = Simd::Add(dist, Simd::Mul(Simd::Splat(plane.normal.z), centerZ));
+						dist = Simd::Add(dist, Simd::Splat(plane.d));
+
+						Simd::Float4 absDist = Simd::Mul(Simd::Splat(plane.absNormal.x), edgeX);
+						absDist = Simd::Add(absDist, Simd::Mul(Simd::Splat(plane.absNormal.y), edgeY));
+						absDist = Simd::Add(absDist, Simd::Mul(Simd::Splat(plane.absNormal.z), edgeZ));
+
+						passMask &= ~Simd::LessMask(dist, Simd::Sub(Simd::Zero(), absDist));
+					}
+				}
+			}
+
+			// Reject by the distance from the view position to the nearest point of the bounding box
+			Simd::Float4 maxDistance = Simd::Load(&culling.maxDistance[i]);
+			unsigned limitedMask = passMask & Simd::LessMask(Simd::Zero(), maxDistance);
+			if (limitedMask) {
+				Simd::Float4 viewX = Simd::Splat(viewPosition.x);
+				Simd::Float4 viewY = Simd::Splat(viewPosition.y);
+				Simd::Float4 viewZ = Simd::Splat(viewPosition.z);
+				Simd::Float4 deltaX = Simd::Max(Simd::Max(Simd::Sub(minX, viewX), Simd::Sub(viewX, maxX)), Simd::Zero());
+				Simd::Float4 deltaY = Simd::Max(Simd::Max(Simd::Sub(minY, viewY), Simd::Sub(viewY, maxY)), Simd::Zero());
+				Simd::Float4 deltaZ = Simd::Max(Simd::Max(Simd::Sub(minZ, viewZ), Simd::Sub(viewZ, maxZ)), Simd::Zero());
+				Simd::Float4 distSquared = Simd::Mul(deltaX, deltaX);
+				distSquared = Simd::Add(distSquared, Simd::Mul(deltaY, deltaY));
+				distSquared = Simd::Add(distSquared, Simd::Mul(deltaZ, deltaZ));
+
+				passMask &= ~(limitedMask & Simd::LessMask(Simd::Mul(maxDistance, maxDistance), distSquared));
+			}
+#else
+			for (size_t j = 0; j < 4; ++j) {
+				if (!(passMask & (1 << j))) {
+					continue;
+				}
+
+				size_t k = i + j;
+				BoundingBox box(Vector3(culling.minX[k], culling.minY[k], culling.minZ[k]), Vector3(culling.maxX[k], culling.maxY[k], culling.maxZ[k]));
+				if ((planeMask && frustum.IsInsideMaskedFast(box, planeMask) == OUTSIDE) ||
+					(culling.maxDistance[k] > 0.0f && box.Distance(viewPosition) > culling.maxDistance[k])) {
+					passMask &= ~(1 << j);
+				}
+			}
+#endif
+
+			for (size_t j = 0; j < 4; ++j) {
+				if (passMask & (1 << j)) {
+					result.push_back(static_cast<unsigned>(i + j));
+				}
+			}
+		}
+	}
+
+	void Octant::SetCullingData(size_t index, const Drawable* drawable)
+	{
+		const BoundingBox& box = drawable->WorldBoundingBox();
+		culling.minX[index] = box.min.x;
+		culling.minY[index] = box.min.y;
+		culling.minZ[index] = box.min.z;
+		culling.maxX[index] = box.max.x;
+		culling.maxY[index] = box.max.y;
+		culling.maxZ[index] = box.max.z;
+		culling.maxDistance[index] = drawable->MaxDistance();
+		culling.viewMask[index] = drawable->ViewMask();
+		culling.flags[index] = drawable->Flags();
+
+		// Mark the parent hierarchy for the flattened layout refresh, as their culling boxes may change.
+		// Whichever thread sets a flag continues to the parent, so this is safe to call from several threads
+		const Octant* octant = this;
+		while (octant && !octant->flatLayoutDirty.exchange(true, std::memory_order_relaxed)) {
+			octant = octant->parent;
+		}
+	}
+
+	void Octant::EraseCullingData(size_t index)
+	{
+		culling.minX.erase(culling.minX.begin() + index);
+		culling.minY.erase(culling.minY.begin() + index);
+		culling.minZ.erase(culling.minZ.begin() + index);
+		culling.maxX.erase(culling.maxX.begin() + index);
+		culling.maxY.erase(culling.maxY.begin() + index);
+		culling.maxZ.erase(culling.maxZ.begin() + index);
+		culling.maxDistance.erase(culling.maxDistance.begin() + index);
+		culling.viewMask.erase(culling.viewMask.begin() + index);
+		culling.flags.erase(culling.flags.begin() + index);
+		ResizeCullingData();
+	}
+
+	void Octant::ResizeCullingData()
+	{
+		size_t size = (drawables.size() + 3) & ~static_cast<size_t>(3);
+		culling.minX.resize(size, 0.0f);
+		culling.minY.resize(size, 0.0f);
+		culling.minZ.resize(size, 0.0f);
+		culling.maxX.resize(size, 0.0f);
+		culling.maxY.resize(size, 0.0f);
+		culling.maxZ.resize(size, 0.0f);
+		culling.maxDistance.resize(size, 0.0f);
+		culling.viewMask.resize(size, 0);
+		culling.flags.resize(size, 0);
+	}
+
+	void Octant::OnOriginShift(const Vector3& offset)
+	{
+		fittingBox.Translate(offset);
+		center += offset;
+		if (!TestFlag(FLAG_CULLING_BOX_DIRTY)) {
+			cullingBox.Translate(offset);
+		}
+
+		// The padding entries never pass culling regardless of their bounds
+		for (size_t i = 0; i < drawables.size(); ++i) {
+			culling.minX[i] += offset.x;
+			culling.minY[i] += offset.y;
+			culling.minZ[i] += offset.z;
+			culling.maxX[i] += offset.x;
+			culling.maxY[i] += offset.y;
+			culling.maxZ[i] += offset.z;
+		}
+	}
+
 	// ==========================================================================================
 	Octree::Octree(WorkQueue* workQueue) :
 		threadedUpdate(false),
 		workQueue(workQueue),
-		frameNumber(0)
+		frameNumber(0),
+		fatBoundsMargin(DEFAULT_FAT_BOUNDS_MARGIN),
+		fatBoundsLookahead(DEFAULT_FAT_BOUNDS_LOOKAHEAD),
+		autoExpand(true),
+		autoExpandMaxSize(DEFAULT_AUTO_EXPAND_MAX_SIZE),
+		stats {},
+		numAnimatedDrawables(0),
+		animationCost(0),
+		animationBudget(0),
+		animationLodBias(1.0f),
+		flatStructureDirty(true),
+		flatLayoutDirty(false),
+		numUpdatedDrawables(0),
+		numKeptInFatBounds(0),
+		numKeptInOctant(0)
 	{
 		root.Initialize(nullptr, BoundingBox(-DEFAULT_OCTREE_SIZE, DEFAULT_OCTREE_SIZE), DEFAULT_OCTREE_LEVELS, 0);
 
 		// Have at least 1 task for reinsert processing
 		reinsertTasks.push_back(std::make_unique<ReinsertDrawablesTask>(this, &Octree::CheckReinsertWork));
 		reinsertQueues = std::make_unique<std::vector<Drawable*>[]>(workQueue->NumThreads());
+		poseCache = std::make_unique<AnimationPoseCache>();
 	}
 
 	Octree::~Octree()
@@ -198,20 +590,57 @@ namespace Turso3D
 
 	void Octree::Update(unsigned short frameNumber_)
 	{
+		TURSO3D_PROFILE("Octree::Update");
+
 		frameNumber = frameNumber_;
+		poseCache->Clear();
 
 		// Avoid overhead of threaded update if only a small number of objects to update / reinsert
 		if (updateQueue.size()) {
 			SetThreadedUpdate(true);
 
-			// Split into smaller tasks to encourage work stealing in case some thread is slower
-			size_t nodesPerTask = std::max(MIN_THREADED_UPDATE, updateQueue.size() / workQueue->NumThreads() / 4);
+			// Move the drawables to animate to the end of the queue. As their update cost varies greatly, split them into tasks by the cost instead of count
+			Drawable** queueStart = &updateQueue[0];
+			Drawable** queueEnd = queueStart + updateQueue.size();
+			Drawable** animationStart = std::partition(queueStart, queueEnd, [&](Drawable* drawable) {
+				return !IsAnimationUpdated(drawable, frameNumber);
+			});
+			numAnimatedDrawables = queueEnd - animationStart;
+
+			animationCost = 0;
+			for (Drawable** it = animationStart; it != queueEnd; ++it) {
+				animationCost += (*it)->AnimationUpdateCost(frameNumber);
+			}
+
+			size_t costPerTask = std::max(MIN_ANIMATION_UPDATE_COST, animationCost / workQueue->NumThreads() / 4);
+			size_t numAnimationTasks = 0;
+			size_t taskCost = 0;
+
+			for (Drawable** it = animationStart; it != queueEnd; ++it) {
+				if (!taskCost) {
+					if (animationTasks.size() <= numAnimationTasks) {
+						animationTasks.push_back(std::make_unique<AnimationUpdateTask>(this, &Octree::AnimationUpdateWork));
+					}
+					animationTasks[numAnimationTasks]->start = it;
+					++numAnimationTasks;
+				}
+
+				taskCost += (*it)->AnimationUpdateCost(frameNumber);
+				if (taskCost >= costPerTask || it + 1 == queueEnd) {
+					animationTasks[numAnimationTasks - 1]->end = it + 1;
+					taskCost = 0;
+				}
+			}
+
+			// Split the rest into smaller tasks to encourage work stealing in case some thread is slower
+			size_t numOthers = animationStart - queueStart;
+			size_t nodesPerTask = std::max(MIN_THREADED_UPDATE, numOthers / workQueue->NumThreads() / 4);
 			size_t taskIdx = 0;
 
-			for (size_t start = 0; start < updateQueue.size(); start += nodesPerTask) {
+			for (size_t start = 0; start < numOthers; start += nodesPerTask) {
 				size_t end = start + nodesPerTask;
-				if (end > updateQueue.size()) {
-					end = updateQueue.size();
+				if (end > numOthers) {
+					end = numOthers;
 				}
 
 				if (reinsertTasks.size() <= taskIdx) {
@@ -222,9 +651,17 @@ namespace Turso3D
 				++taskIdx;
 			}
 
-			numPendingReinsertionTasks.store((int)taskIdx);
-			workQueue->QueueTasks(taskIdx, reinterpret_cast<Task**>(&reinsertTasks[0]));
+			// Queue the animation tasks first, as they take longer
+			numPendingReinsertionTasks.store((int)(numAnimationTasks + taskIdx));
+			if (numAnimationTasks) {
+				workQueue->QueueTasks(numAnimationTasks, reinterpret_cast<Task**>(&animationTasks[0]));
+			}
+			if (taskIdx) {
+				workQueue->QueueTasks(taskIdx, reinterpret_cast<Task**>(&reinsertTasks[0]));
+			}
 		} else {
+			numAnimatedDrawables = 0;
+			animationCost = 0;
 			numPendingReinsertionTasks.store(0);
 		}
 	}
@@ -240,20 +677,55 @@ namespace Turso3D
 		SetThreadedUpdate(false);
 
 		// Now reinsert drawables that actually need reinsertion into a different octant
+		size_t numReinserted = 0;
 		for (size_t i = 0; i < workQueue->NumThreads(); ++i) {
-			ReinsertDrawables(reinsertQueues[i]);
+			numReinserted += ReinsertDrawables(reinsertQueues[i]);
+		}
+
+		// Expand the octree if drawables were left in the root octant for being outside it
+		if (expandBounds.IsDefined()) {
+			numReinserted += ExpandRoot();
 		}
 
 		updateQueue.clear();
 
-		// Sort octants' drawables by address and put lights first
+		stats.updatedDrawables = numUpdatedDrawables.exchange(0);
+		stats.animatedDrawables = numAnimatedDrawables;
+		stats.animationCost = animationCost;
+		stats.poseCacheHits = poseCache->NumHits();
+		stats.poseCacheMisses = poseCache->NumMisses();
+		stats.keptInFatBounds = numKeptInFatBounds.exchange(0);
+		stats.keptInOctant = numKeptInOctant.exchange(0);
+		stats.reinsertedDrawables = numReinserted;
+		stats.sortedOctants = sortDirtyOctants.size();
+		TURSO3D_PROFILE_COUNTER("Octree reinsertions", numReinserted);
+
+		// Adjust the animation LOD bias for the next update by the cost of this update
+		if (animationBudget) {
+			if (animationCost > animationBudget) {
+				animationLodBias *= std::max(static_cast<float>(animationBudget) / animationCost, ANIMATION_LOD_BIAS_DECREASE);
+				animationLodBias = std::max(animationLodBias, MIN_ANIMATION_LOD_BIAS);
+			} else if (animationCost < animationBudget * ANIMATION_BUDGET_HYSTERESIS) {
+				animationLodBias = std::min(animationLodBias * ANIMATION_LOD_BIAS_INCREASE, 1.0f);
+			}
+		}
+
+		// Sort octants' drawables by address and put lights first, then rewrite the culling data in the new order
 		for (size_t i = 0; i < sortDirtyOctants.size(); ++i) {
 			Octant* octant = sortDirtyOctants[i];
-			std::sort(octant->drawables.begin(), octant->drawables.end(), CompareDrawables);
+			std::vector<Drawable*>& drawables = octant->drawables;
+			std::sort(drawables.begin(), drawables.end(), CompareDrawables);
+			for (size_t j = 0; j < drawables.size(); ++j) {
+				drawables[j]->octantIndex = static_cast<unsigned>(j);
+				octant->SetCullingData(j, drawables[j]);
+			}
 			octant->SetFlag(Octant::FLAG_DRAWABLES_SORT_DIRTY, false);
 		}
 
 		sortDirtyOctants.clear();
+
+		// Update the flattened layout now, as queries from worker threads during rendering will not
+		UpdateFlatLayout();
 	}
 
 	void Octree::Resize(const BoundingBox& boundingBox, int numLevels)
@@ -269,6 +741,78 @@ namespace Turso3D
 		root.Initialize(nullptr, boundingBox, (unsigned char)Clamp(numLevels, 1, MAX_OCTREE_LEVELS), 0);
 	}
 
+	void Octree::SetAutoExpand(bool enable, float maxSize)
+	{
+		autoExpand = enable;
+		autoExpandMaxSize = std::max(maxSize, 0.0f);
+	}
+
+	void Octree::SetAnimationBudget(size_t cost)
+	{
+		animationBudget = cost;
+		if (!animationBudget) {
+			animationLodBias = 1.0f;
+		}
+	}
+
+	void Octree::RebaseOrigin(const Vector3& newOrigin)
+	{
+		TURSO3D_PROFILE("Octree::RebaseOrigin");
+
+		Vector3 offset = -newOrigin;
+
+		// Move the top levels of the octant hierarchy here, until there are enough subtrees to split between the tasks
+		originShiftOctants.clear();
+		originShiftOctants.push_back(&root);
+		std::vector<Octant*> subtrees;
+		while (originShiftOctants.size() < workQueue->NumThreads() * ORIGIN_SHIFT_SUBTREES_PER_THREAD) {
+			subtrees.clear();
+			for (size_t i = 0; i < originShiftOctants.size(); ++i) {
+				Octant* octant = originShiftOctants[i];
+				if (octant->numChildren) {
+					octant->OnOriginShift(offset);
+					for (size_t j = 0; j < NUM_OCTANTS; ++j) {
+						if (octant->children[j]) {
+							subtrees.push_back(octant->children[j]);
+						}
+					}
+				} else {
+					subtrees.push_back(octant);
+				}
+			}
+
+			bool split = subtrees.size() > originShiftOctants.size();
+			originShiftOctants.swap(subtrees);
+			if (!split) {
+				break;
+			}
+		}
+
+		// Split the subtrees and the flattened layout evenly between the tasks. The flattened octants estimate the octant count
+		size_t numItems = 2 * flatOctants.size() + flatDrawables.size();
+		size_t numTasks = Clamp((int)(numItems / MIN_ORIGIN_SHIFT_ITEMS), 1, (int)workQueue->NumThreads() * 4);
+		while (originShiftTasks.size() < numTasks) {
+			originShiftTasks.push_back(std::make_unique<OriginShiftTask>(this, &Octree::OriginShiftWork));
+		}
+
+		for (size_t i = 0; i < numTasks; ++i) {
+			OriginShiftTask* task = originShiftTasks[i].get();
+			task->offset = offset;
+			task->taskIndex = i;
+			task->numTasks = numTasks;
+		}
+
+		numPendingOriginShiftTasks.store((int)numTasks);
+		workQueue->QueueTasks(numTasks, reinterpret_cast<Task**>(&originShiftTasks[0]));
+
+		// Other tasks, such as moving the scene nodes, may be completed at the same time
+		while (numPendingOriginShiftTasks.load() > 0) {
+			workQueue->TryComplete();
+		}
+
+		expandBounds.Translate(offset);
+	}
+
 	void Octree::OnRenderDebug(DebugRenderer* debug)
 	{
 		root.OnRenderDebug(debug);
@@ -276,20 +820,57 @@ namespace Turso3D
 
 	void Octree::Raycast(std::vector<RaycastResult>& result, const Ray& ray, unsigned drawableFlags, unsigned viewMask, float maxDistance) const
 	{
+		UpdateFlatLayout();
+
 		result.clear();
-		CollectDrawables(result, const_cast<Octant*>(&root), ray, drawableFlags, viewMask, maxDistance);
+		for (size_t i = 0; i < flatOctants.size();) {
+			const FlatOctant& octant = flatOctants[i];
+			if (ray.HitDistance(octant.cullingBox) >= maxDistance) {
+				i = octant.skip;
+				continue;
+			}
+
+			for (size_t j = octant.drawableStart; j < octant.drawableEnd; ++j) {
+				const FlatDrawable& drawable = flatDrawables[j];
+				if ((drawable.flags & drawableFlags) == drawableFlags && (drawable.viewMask & viewMask) && ray.HitDistance(drawable.box) < maxDistance) {
+					drawable.drawable->OnRaycast(result, ray, maxDistance);
+				}
+			}
+			++i;
+		}
+
 		std::sort(result.begin(), result.end(), CompareRaycastResults);
 	}
 
 	RaycastResult Octree::RaycastSingle(const Ray& ray, unsigned drawableFlags, unsigned viewMask, float maxDistance) const
 	{
+		UpdateFlatLayout();
+
+		std::vector<std::pair<Drawable*, float>> initialRayResult;
+		std::vector<RaycastResult> finalRayResult;
+
 		// Get the potential hits first
-		initialRayResult.clear();
-		CollectDrawables(initialRayResult, const_cast<Octant*>(&root), ray, drawableFlags, viewMask, maxDistance);
+		for (size_t i = 0; i < flatOctants.size();) {
+			const FlatOctant& octant = flatOctants[i];
+			if (ray.HitDistance(octant.cullingBox) >= maxDistance) {
+				i = octant.skip;
+				continue;
+			}
+
+			for (size_t j = octant.drawableStart; j < octant.drawableEnd; ++j) {
+				const FlatDrawable& drawable = flatDrawables[j];
+				if ((drawable.flags & drawableFlags) == drawableFlags && (drawable.viewMask & viewMask)) {
+					float distance = ray.HitDistance(drawable.box);
+					if (distance < maxDistance) {
+						initialRayResult.push_back(std::make_pair(drawable.drawable, distance));
+					}
+				}
+			}
+			++i;
+		}
 		std::sort(initialRayResult.begin(), initialRayResult.end(), CompareDrawableDistances);
 
 		// Then perform actual per-node ray tests and early-out when possible
-		finalRayResult.clear();
 		float closestHit = M_INFINITY;
 		for (auto it = initialRayResult.begin(); it != initialRayResult.end(); ++it) {
 			if (it->second < std::min(closestHit, maxDistance)) {
@@ -316,6 +897,221 @@ namespace Turso3D
 		}
 	}
 
+	void Octree::RaycastBatch(std::vector<RaycastResult>& result, std::vector<unsigned>& resultStart, const Ray* rays, size_t numRays, RaycastScratch& scratch, RaycastMode mode, unsigned drawableFlags, unsigned viewMask, float maxDistance) const
+	{
+		TURSO3D_PROFILE("Octree::RaycastBatch");
+
+		UpdateFlatLayout();
+
+		result.clear();
+		resultStart.clear();
+		RaycastPackets(result, resultStart, rays, numRays, scratch, mode, drawableFlags, viewMask, maxDistance);
+		resultStart.push_back(static_cast<unsigned>(result.size()));
+	}
+
+	void Octree::RaycastBatchThreaded(std::vector<RaycastResult>& result, std::vector<unsigned>& resultStart, const Ray* rays, size_t numRays, RaycastMode mode, unsigned drawableFlags, unsigned viewMask, float maxDistance) const
+	{
+		TURSO3D_PROFILE("Octree::RaycastBatchThreaded");
+
+		UpdateFlatLayout();
+
+		result.clear();
+		resultStart.clear();
+
+		if (raycastTasks.empty()) {
+			raycastTasks.push_back(std::make_unique<RaycastBatchTask>(const_cast<Octree*>(this), &Octree::RaycastBatchWork));
+		}
+
+		// Split into smaller tasks to encourage work stealing in case some thread is slower. Keep the packets full
+		size_t raysPerTask = std::max(MIN_THREADED_RAYCAST, (numRays / workQueue->NumThreads() / 4 + 3) & ~static_cast<size_t>(3));
+
+		// Avoid overhead of threading if only a small number of rays
+		if (workQueue->NumThreads() <= 1 || numRays <= raysPerTask) {
+			RaycastPackets(result, resultStart, rays, numRays, raycastTasks[0]->scratch, mode, drawableFlags, viewMask, maxDistance);
+			resultStart.push_back(static_cast<unsigned>(result.size()));
+			return;
+		}
+
+		size_t taskIdx = 0;
+		for (size_t start = 0; start < numRays; start += raysPerTask) {
+			if (raycastTasks.size() <= taskIdx) {
+				raycastTasks.push_back(std::make_unique<RaycastBatchTask>(const_cast<Octree*>(this), &Octree::RaycastBatchWork));
+			}
+
+			RaycastBatchTask* task = raycastTasks[taskIdx].get();
+			task->rays = rays + start;
+			task->numRays = std::min(raysPerTask, numRays - start);
+			task->mode = mode;
+			task->drawableFlags = drawableFlags;
+			task->viewMask = viewMask;
+			task->maxDistance = maxDistance;
+			++taskIdx;
+		}
+
+		numPendingRaycastTasks.store((int)taskIdx);
+		workQueue->QueueTasks(taskIdx, reinterpret_cast<Task**>(&raycastTasks[0]));
+
+		// Complete tasks until the batch is done. There may other tasks going on at the same time
+		while (numPendingRaycastTasks.load() > 0) {
+			workQueue->TryComplete();
+		}
+
+		// Concatenate the task results in order
+		for (size_t i = 0; i < taskIdx; ++i) {
+			const RaycastBatchTask* task = raycastTasks[i].get();
+			unsigned offset = static_cast<unsigned>(result.size());
+			for (size_t j = 0; j < task->resultStart.size(); ++j) {
+				resultStart.push_back(task->resultStart[j] + offset);
+			}
+			result.insert(result.end(), task->result.begin(), task->result.end());
+		}
+		resultStart.push_back(static_cast<unsigned>(result.size()));
+	}
+
+	void Octree::FindDrawablesMasked(std::vector<Drawable*>& result, const Frustum& frustum, unsigned drawableFlags, unsigned viewMask) const
+	{
+		UpdateFlatLayout();
+
+		// Plane masks of the octants on the current path, indexed by depth
+		unsigned char planeMasks[MAX_OCTREE_LEVELS + 1];
+
+		for (size_t i = 0; i < flatOctants.size();) {
+			const FlatOctant& octant = flatOctants[i];
+			// The parent's plane mask is never zero, as fully inside subtrees are not descended into
+			unsigned char planeMask = frustum.IsInsideMasked(octant.cullingBox, octant.depth ? planeMasks[octant.depth - 1] : 0x3f);
+			// Skip the subtree if octant completely outside frustum
+			if (planeMask == 0xff) {
+				i = octant.skip;
+				continue;
+			}
+			// If completely inside the frustum, include the whole subtree without further tests
+			if (!planeMask) {
+				for (size_t j = octant.drawableStart; j < octant.subtreeDrawableEnd; ++j) {
+					const FlatDrawable& drawable = flatDrawables[j];
+					if ((drawable.flags & drawableFlags) == drawableFlags && (drawable.viewMask & viewMask)) {
+						result.push_back(drawable.drawable);
+					}
+				}
+				i = octant.skip;
+				continue;
+			}
+			planeMasks[octant.depth] = planeMask;
+
+			for (size_t j = octant.drawableStart; j < octant.drawableEnd; ++j) {
+				const FlatDrawable& drawable = flatDrawables[j];
+				if ((drawable.flags & drawableFlags) == drawableFlags && (drawable.viewMask & viewMask) && frustum.IsInsideMaskedFast(drawable.box, planeMask) != OUTSIDE) {
+					result.push_back(drawable.drawable);
+				}
+			}
+			++i;
+		}
+	}
+
+	void Octree::FindNearestDrawables(std::vector<std::pair<Drawable*, float>>& result, const Vector3& position, size_t count, unsigned drawableFlags, unsigned viewMask, float maxDistance) const
+	{
+		UpdateFlatLayout();
+
+		if (!count || flatOctants.empty()) {
+			return;
+		}
+
+		// Clamp the limit so that undefined bounding boxes, which have infinite distance, are never queued
+		float maxDistanceSquared = std::min(maxDistance * maxDistance, M_MAX_FLOAT);
+		size_t numFound = 0;
+		std::vector<NearestQueueEntry> queue;
+
+		float rootDistanceSquared = DistanceSquared(flatOctants[0].cullingBox, position);
+		if (rootDistanceSquared <= maxDistanceSquared) {
+			queue.push_back({rootDistanceSquared, 0, false});
+		}
+
+		// The entries come out in the order of distance. Drawables are found in order, and an octant is only opened when nothing nearer remains
+		while (!queue.empty()) {
+			NearestQueueEntry entry = queue.front();
+			std::pop_heap(queue.begin(), queue.end(), CompareNearestQueueEntries);
+			queue.pop_back();
+
+			if (entry.isDrawable) {
+				result.push_back(std::make_pair(flatDrawables[entry.index].drawable, sqrtf(entry.distanceSquared)));
+				if (++numFound >= count) {
+					break;
+				}
+				continue;
+			}
+
+			const FlatOctant& octant = flatOctants[entry.index];
+			for (unsigned j = octant.drawableStart; j < octant.drawableEnd; ++j) {
+				const FlatDrawable& drawable = flatDrawables[j];
+				if ((drawable.flags & drawableFlags) == drawableFlags && (drawable.viewMask & viewMask)) {
+					float distanceSquared = DistanceSquared(drawable.box, position);
+					if (distanceSquared <= maxDistanceSquared) {
+						queue.push_back({distanceSquared, j, true});
+						std::push_heap(queue.begin(), queue.end(), CompareNearestQueueEntries);
+					}
+				}
+			}
+
+			// The children follow the octant in depth-first order, each child's subtree ending where the next child starts
+			for (unsigned child = entry.index + 1; child < octant.skip; child = flatOctants[child].skip) {
+				float distanceSquared = DistanceSquared(flatOctants[child].cullingBox, position);
+				if (distanceSquared <= maxDistanceSquared) {
+					queue.push_back({distanceSquared, child, false});
+					std::push_heap(queue.begin(), queue.end(), CompareNearestQueueEntries);
+				}
+			}
+		}
+	}
+
+	Drawable* Octree::FindNearestDrawable(const Vector3& position, float radius, unsigned drawableFlags, unsigned viewMask, float* outDistance) const
+	{
+		std::vector<std::pair<Drawable*, float>> result;
+		FindNearestDrawables(result, position, 1, drawableFlags, viewMask, radius);
+
+		if (result.empty()) {
+			return nullptr;
+		}
+		if (outDistance) {
+			*outDistance = result.front().second;
+		}
+		return result.front().first;
+	}
+
+	void Octree::UpdateFlatLayout() const
+	{
+		// Do not update while worker threads may be querying
+		if (threadedUpdate || (!flatStructureDirty.load(std::memory_order_acquire) && !flatLayoutDirty.load(std::memory_order_acquire))) {
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(flatLayoutMutex);
+
+		if (flatStructureDirty.load(std::memory_order_relaxed)) {
+			// Octants or drawables were added or removed: rebuild
+			flatOctants.clear();
+			flatSourceOctants.clear();
+			flatDrawables.clear();
+			FlattenOctant(&root, 0);
+		} else if (flatLayoutDirty.load(std::memory_order_relaxed)) {
+			// Only culling data changed: refresh the marked octants, skipping the subtrees that are not marked
+			for (size_t i = 0; i < flatOctants.size();) {
+				FlatOctant& flatOctant = flatOctants[i];
+				const Octant* octant = flatSourceOctants[i];
+				if (!octant->flatLayoutDirty.load(std::memory_order_relaxed)) {
+					i = flatOctant.skip;
+					continue;
+				}
+
+				octant->flatLayoutDirty.store(false, std::memory_order_relaxed);
+				flatOctant.cullingBox = octant->CullingBox();
+				CopyFlatDrawables(octant, flatOctant.drawableStart);
+				++i;
+			}
+		}
+
+		flatStructureDirty.store(false, std::memory_order_release);
+		flatLayoutDirty.store(false, std::memory_order_release);
+	}
+
 	void Octree::QueueUpdate(Drawable* drawable)
 	{
 		assert(drawable);
@@ -323,6 +1119,7 @@ namespace Turso3D
 		if (drawable->octant) {
 			drawable->octant->MarkCullingBoxDirty();
 		}
+		flatLayoutDirty.store(true, std::memory_order_relaxed);
 
 		if (!threadedUpdate) {
 			updateQueue.push_back(drawable);
@@ -330,13 +1127,16 @@ namespace Turso3D
 		} else {
 			drawable->lastUpdateFrameNumber = frameNumber;
 
-			// Do nothing if still fits the current octant
-			const BoundingBox& box = drawable->WorldBoundingBox();
-			Octant* oldOctant = drawable->GetOctant();
-			if (!oldOctant || oldOctant->fittingBox.IsInside(box) != INSIDE) {
+			size_t keptInFatBounds = 0;
+			size_t keptInOctant = 0;
+			if (CheckReinsert(drawable, keptInFatBounds, keptInOctant)) {
 				reinsertQueues[WorkQueue::ThreadIndex()].push_back(drawable);
 				drawable->SetFlag(Drawable::FLAG_OCTREE_REINSERT_QUEUED, true);
 			}
+
+			numUpdatedDrawables.fetch_add(1, std::memory_order_relaxed);
+			numKeptInFatBounds.fetch_add(keptInFatBounds, std::memory_order_relaxed);
+			numKeptInOctant.fetch_add(keptInOctant, std::memory_order_relaxed);
 		}
 	}
 
@@ -361,21 +1161,41 @@ namespace Turso3D
 		drawable->octant = nullptr;
 	}
 
-	void Octree::ReinsertDrawables(std::vector<Drawable*>& drawables)
+	void Octree::SetFatBounds(float margin, float lookaheadFrames)
+	{
+		fatBoundsMargin = std::max(margin, 0.0f);
+		fatBoundsLookahead = std::max(lookaheadFrames, 0.0f);
+	}
+
+	void Octree::UpdateCullingData(Drawable* drawable)
 	{
+		Octant* octant = drawable->GetOctant();
+		if (octant) {
+			octant->SetCullingData(drawable->octantIndex, drawable);
+			flatLayoutDirty.store(true, std::memory_order_relaxed);
+		}
+	}
+
+	size_t Octree::ReinsertDrawables(std::vector<Drawable*>& drawables)
+	{
+		size_t numReinserted = 0;
+
 		for (size_t i = 0; i < drawables.size(); ++i) {
 			Drawable* drawable = drawables[i];
 
-			const BoundingBox& box = drawable->WorldBoundingBox();
+			// Choose the octant by the fattened bounds, so that the drawable can move within them without being reinserted
+			const BoundingBox& box = drawable->fatBoundingBox;
 			Octant* oldOctant = drawable->GetOctant();
 			Octant* newOctant = &root;
 			Vector3 boxSize = box.Size();
 
 			for (;;) {
-				// If drawable does not fit fully inside root octant, must remain in it
-				bool insertHere = (newOctant == &root) ?
-					(newOctant->fittingBox.IsInside(box) != INSIDE || newOctant->FitBoundingBox(box, boxSize)) :
-					newOctant->FitBoundingBox(box, boxSize);
+				// If drawable does not fit fully inside root octant, must remain in it. Expand later to fit it, unless it is too large to ever fit
+				bool outside = newOctant == &root && newOctant->fittingBox.IsInside(box) != INSIDE;
+				if (outside && autoExpand && boxSize.x <= autoExpandMaxSize && boxSize.y <= autoExpandMaxSize && boxSize.z <= autoExpandMaxSize) {
+					expandBounds.Merge(box);
+				}
+				bool insertHere = outside || newOctant->FitBoundingBox(box, boxSize);
 
 				if (insertHere) {
 					if (newOctant != oldOctant) {
@@ -384,6 +1204,12 @@ namespace Turso3D
 						if (oldOctant) {
 							RemoveDrawable(drawable, oldOctant);
 						}
+						++numReinserted;
+					}
+					// Keep the fattened bounds within the octant's fitting box, so that being inside them also means fitting the octant.
+					// A drawable outside the root keeps them whole, so that it can be found for reinsertion when the octree expands
+					if (!outside) {
+						drawable->fatBoundingBox.Clip(newOctant->fittingBox);
 					}
 					break;
 				} else {
@@ -395,6 +1221,158 @@ namespace Turso3D
 		}
 
 		drawables.clear();
+		return numReinserted;
+	}
+
+	bool Octree::CheckReinsert(Drawable* drawable, size_t& numKeptInFatBounds, size_t& numKeptInOctant)
+	{
+		const BoundingBox& box = drawable->WorldBoundingBox();
+		Octant* octant = drawable->GetOctant();
+		if (!octant) {
+			UpdateFatBoundingBox(drawable, box);
+			return true;
+		}
+
+		// Refresh the culling data. Different drawables write to different array elements, so this is safe to do from several threads
+		octant->SetCullingData(drawable->octantIndex, drawable);
+
+		// Do nothing further if still inside the fattened bounds, which are kept within the octant's fitting box
+		if (drawable->fatBoundingBox.IsInside(box) == INSIDE) {
+			++numKeptInFatBounds;
+			return false;
+		}
+
+		// Otherwise refresh the fattened bounds from the current movement, and stay if still fits the current octant
+		UpdateFatBoundingBox(drawable, box);
+		if (octant->fittingBox.IsInside(box) == INSIDE) {
+			drawable->fatBoundingBox.Clip(octant->fittingBox);
+			++numKeptInOctant;
+			return false;
+		}
+
+		return true;
+	}
+
+	void Octree::UpdateFatBoundingBox(Drawable* drawable, const BoundingBox& box)
+	{
+		Vector3 center = box.Center();
+
+		if (drawable->TestFlag(Drawable::FLAG_STATIC)) {
+			drawable->fatBoundingBox = box;
+		} else {
+			Vector3 margin = fatBoundsMargin * box.Size();
+			drawable->fatBoundingBox.Define(box.min - margin, box.max + margin);
+
+			// Extend in the direction of movement by the average velocity since the previous update
+			if (drawable->GetOctant() && fatBoundsLookahead > 0.0f) {
+				unsigned short frames = (unsigned short)(frameNumber - drawable->fatBoundsFrameNumber);
+				Vector3 movement = (center - drawable->fatBoundsCenter) * (fatBoundsLookahead / (float)std::max(frames, (unsigned short)1));
+				BoundingBox& fatBox = drawable->fatBoundingBox;
+				fatBox.Define(fatBox.min + Vector3(std::min(movement.x, 0.0f), std::min(movement.y, 0.0f), std::min(movement.z, 0.0f)),
+					fatBox.max + Vector3(std::max(movement.x, 0.0f), std::max(movement.y, 0.0f), std::max(movement.z, 0.0f)));
+			}
+		}
+
+		drawable->fatBoundsCenter = center;
+		drawable->fatBoundsFrameNumber = frameNumber;
+	}
+
+	size_t Octree::ExpandRoot()
+	{
+		BoundingBox bounds = expandBounds;
+		expandBounds = BoundingBox();
+
+		Octant* oldRoot = nullptr;
+		while (root.fittingBox.IsInside(bounds) != INSIDE && root.level < MAX_OCTREE_LEVELS) {
+			Vector3 size = 2.0f * root.halfSize;
+			if (2.0f * std::max(std::max(size.x, size.y), size.z) > autoExpandMaxSize) {
+				break;
+			}
+
+			// Double the root toward the drawables on each axis. The old root becomes a child octant
+			Vector3 boundsCenter = bounds.Center();
+			BoundingBox oldBox(root.center - root.halfSize, root.center + root.halfSize);
+			BoundingBox newBox = oldBox;
+			unsigned char index = 0;
+			if (boundsCenter.x < root.center.x) {
+				newBox.min.x -= size.x;
+				index |= 1;
+			} else {
+				newBox.max.x += size.x;
+			}
+			if (boundsCenter.y < root.center.y) {
+				newBox.min.y -= size.y;
+				index |= 2;
+			} else {
+				newBox.max.y += size.y;
+			}
+			if (boundsCenter.z < root.center.z) {
+				newBox.min.z -= size.z;
+				index |= 4;
+			} else {
+				newBox.max.z += size.z;
+			}
+
+			Octant* child = allocator.Allocate();
+			child->Initialize(&root, oldBox, root.level, index);
+			child->drawables.swap(root.drawables);
+			std::swap(child->culling, root.culling);
+			for (size_t i = 0; i < child->drawables.size(); ++i) {
+				child->drawables[i]->octant = child;
+			}
+			for (size_t i = 0; i < NUM_OCTANTS; ++i) {
+				child->children[i] = root.children[i];
+				if (child->children[i]) {
+					child->children[i]->parent = child;
+				}
+				root.children[i] = nullptr;
+			}
+			child->numChildren = root.numChildren;
+			if (root.TestFlag(Octant::FLAG_DRAWABLES_SORT_DIRTY)) {
+				child->SetFlag(Octant::FLAG_DRAWABLES_SORT_DIRTY, true);
+				std::replace(sortDirtyOctants.begin(), sortDirtyOctants.end(), &root, child);
+			}
+
+			root.Initialize(nullptr, newBox, root.level + 1, 0);
+			root.children[index] = child;
+			root.numChildren = 1;
+			flatStructureDirty.store(true, std::memory_order_relaxed);
+
+			if (!oldRoot) {
+				oldRoot = child;
+			}
+		}
+
+		if (!oldRoot) {
+			return 0;
+		}
+
+		LOG_DEBUG("Expanded octree to size {:f}", 2.0f * root.halfSize.x);
+
+		// Reinsert the drawables that were outside the old root. The others are in an octant of the same size as before.
+		// Take them out of the old root all at once, as there may be many
+		std::vector<Drawable*> outsideDrawables;
+		std::vector<Drawable*>& drawables = oldRoot->drawables;
+		size_t numKept = 0;
+		for (size_t i = 0; i < drawables.size(); ++i) {
+			Drawable* drawable = drawables[i];
+			if (oldRoot->fittingBox.IsInside(drawable->fatBoundingBox) != INSIDE) {
+				drawable->octant = nullptr;
+				outsideDrawables.push_back(drawable);
+			} else {
+				drawable->octantIndex = static_cast<unsigned>(numKept);
+				drawables[numKept++] = drawable;
+			}
+		}
+
+		drawables.resize(numKept);
+		oldRoot->ResizeCullingData();
+		for (size_t i = 0; i < numKept; ++i) {
+			oldRoot->SetCullingData(i, drawables[i]);
+		}
+		oldRoot->MarkCullingBoxDirty();
+
+		return ReinsertDrawables(outsideDrawables);
 	}
 
 	void Octree::RemoveDrawableFromQueue(Drawable* drawable, std::vector<Drawable*>& drawables)
@@ -410,8 +1388,12 @@ namespace Turso3D
 	void Octree::AddDrawable(Drawable* drawable, Octant* octant)
 	{
 		octant->drawables.push_back(drawable);
+		octant->ResizeCullingData();
+		octant->SetCullingData(octant->drawables.size() - 1, drawable);
 		drawable->octant = octant;
+		drawable->octantIndex = static_cast<unsigned>(octant->drawables.size() - 1);
 		octant->MarkCullingBoxDirty();
+		flatStructureDirty.store(true, std::memory_order_relaxed);
 
 		if (!octant->TestFlag(Octant::FLAG_DRAWABLES_SORT_DIRTY)) {
 			octant->SetFlag(Octant::FLAG_DRAWABLES_SORT_DIRTY, true);
@@ -426,12 +1408,18 @@ namespace Turso3D
 		}
 
 		octant->MarkCullingBoxDirty();
+		flatStructureDirty.store(true, std::memory_order_relaxed);
 
 		// Do not set the drawable's octant pointer to zero, as the drawable may already be added into another octant.
-		// Just remove from octant
-		for (auto it = octant->drawables.begin(); it != octant->drawables.end(); ++it) {
-			if ((*it) == drawable) {
-				octant->drawables.erase(it);
+		// Just remove from octant, and shift the following drawables and their culling data to keep the order
+		std::vector<Drawable*>& drawables = octant->drawables;
+		for (size_t i = 0; i < drawables.size(); ++i) {
+			if (drawables[i] == drawable) {
+				drawables.erase(drawables.begin() + i);
+				octant->EraseCullingData(i);
+				for (size_t j = i; j < drawables.size(); ++j) {
+					drawables[j]->octantIndex = static_cast<unsigned>(j);
+				}
 
 				// Erase empty octants as necessary, but never the root
 				while (!octant->drawables.size() && !octant->numChildren && octant->parent) {
@@ -502,6 +1490,8 @@ namespace Turso3D
 			}
 		}
 		drawables.clear();
+		octant->ResizeCullingData();
+		flatStructureDirty.store(true, std::memory_order_relaxed);
 
 		if (octant->numChildren) {
 			for (size_t i = 0; i < NUM_OCTANTS; ++i) {
@@ -528,71 +1518,133 @@ namespace Turso3D
 		}
 	}
 
-	void Octree::CollectDrawables(std::vector<Drawable*>& result, Octant* octant, unsigned drawableFlags, unsigned viewMask) const
+	void Octree::ShiftOctants(Octant* octant, const Vector3& offset)
 	{
-		std::vector<Drawable*>& drawables = octant->drawables;
-		for (size_t i = 0; i < drawables.size(); ++i) {
-			Drawable* drawable = drawables[i];
-			if ((drawable->Flags() & drawableFlags) == drawableFlags && (drawable->ViewMask() & viewMask)) {
-				result.push_back(drawable);
-			}
-		}
+		octant->OnOriginShift(offset);
 
 		if (octant->numChildren) {
 			for (size_t i = 0; i < NUM_OCTANTS; ++i) {
 				if (octant->children[i]) {
-					CollectDrawables(result, octant->children[i], drawableFlags, viewMask);
+					ShiftOctants(octant->children[i], offset);
 				}
 			}
 		}
 	}
 
-	void Octree::CollectDrawables(std::vector<RaycastResult>& result, Octant* octant, const Ray& ray, unsigned drawableFlags, unsigned viewMask, float maxDistance) const
+	void Octree::CopyFlatDrawables(const Octant* octant, size_t start) const
 	{
-		float octantDist = ray.HitDistance(octant->CullingBox());
-		if (octantDist >= maxDistance) {
-			return;
-		}
-
-		std::vector<Drawable*>& drawables = octant->drawables;
+		// Copy from the culling data, so that the drawables do not need to be accessed
+		const std::vector<Drawable*>& drawables = octant->drawables;
 		for (size_t i = 0; i < drawables.size(); ++i) {
-			Drawable* drawable = drawables[i];
-			if ((drawable->Flags() & drawableFlags) == drawableFlags && (drawable->ViewMask() & viewMask)) {
-				drawable->OnRaycast(result, ray, maxDistance);
-			}
+			FlatDrawable& flatDrawable = flatDrawables[start + i];
+			flatDrawable.box = BoundingBox(Vector3(octant->culling.minX[i], octant->culling.minY[i], octant->culling.minZ[i]), Vector3(octant->culling.maxX[i], octant->culling.maxY[i], octant->culling.maxZ[i]));
+			flatDrawable.flags = octant->culling.flags[i];
+			flatDrawable.viewMask = octant->culling.viewMask[i];
+			flatDrawable.drawable = drawables[i];
 		}
+	}
 
+	void Octree::FlattenOctant(const Octant* octant, unsigned char depth) const
+	{
+		size_t index = flatOctants.size();
+		FlatOctant& flatOctant = flatOctants.emplace_back();
+		flatOctant.cullingBox = octant->CullingBox();
+		flatOctant.drawableStart = static_cast<unsigned>(flatDrawables.size());
+		flatOctant.childMask = 0;
+		flatOctant.depth = depth;
+
+		flatSourceOctants.push_back(octant);
+		flatDrawables.resize(flatDrawables.size() + octant->drawables.size());
+		CopyFlatDrawables(octant, flatOctant.drawableStart);
+		octant->flatLayoutDirty.store(false, std::memory_order_relaxed);
+		flatOctant.drawableEnd = static_cast<unsigned>(flatDrawables.size());
+
+		unsigned char childMask = 0;
 		if (octant->numChildren) {
 			for (size_t i = 0; i < NUM_OCTANTS; ++i) {
 				if (octant->children[i]) {
-					CollectDrawables(result, octant->children[i], ray, drawableFlags, viewMask, maxDistance);
+					childMask |= 1 << i;
+					FlattenOctant(octant->children[i], depth + 1);
 				}
 			}
 		}
+
+		// The vector may have been reallocated by the children
+		FlatOctant& finishedOctant = flatOctants[index];
+		finishedOctant.childMask = childMask;
+		finishedOctant.skip = static_cast<unsigned>(flatOctants.size());
+		finishedOctant.subtreeDrawableEnd = static_cast<unsigned>(flatDrawables.size());
 	}
 
-	void Octree::CollectDrawables(std::vector<std::pair<Drawable*, float>>& result, Octant* octant, const Ray& ray, unsigned drawableFlags, unsigned viewMask, float maxDistance) const
+	void Octree::RaycastPackets(std::vector<RaycastResult>& result, std::vector<unsigned>& resultStart, const Ray* rays, size_t numRays, RaycastScratch& scratch, RaycastMode mode, unsigned drawableFlags, unsigned viewMask, float maxDistance) const
 	{
-		float octantDist = ray.HitDistance(octant->CullingBox());
-		if (octantDist >= maxDistance) {
-			return;
-		}
+		// Hit masks of the octants on the current path, indexed by depth
+		unsigned hitMasks[MAX_OCTREE_LEVELS + 1];
+		float distances[4];
+		RayPacket packet;
+
+		for (size_t start = 0; start < numRays; start += 4) {
+			size_t count = std::min(numRays - start, static_cast<size_t>(4));
+			unsigned activeMask = (1u << count) - 1;
+			packet.Define(rays + start, count);
+			for (size_t k = 0; k < count; ++k) {
+				scratch.candidates[k].clear();
+			}
 
-		std::vector<Drawable*>& drawables = octant->drawables;
-		for (size_t i = 0; i < drawables.size(); ++i) {
-			Drawable* drawable = drawables[i];
-			if ((drawable->Flags() & drawableFlags) == drawableFlags && (drawable->ViewMask() & viewMask)) {
-				float distance = ray.HitDistance(drawable->WorldBoundingBox());
-				if (distance < maxDistance) {
-					result.push_back(std::make_pair(drawable, distance));
+			// Get the potential hits of each ray first. Skip the subtrees that none of the rays hit
+			for (size_t i = 0; i < flatOctants.size();) {
+				const FlatOctant& octant = flatOctants[i];
+				unsigned parentMask = octant.depth ? hitMasks[octant.depth - 1] : activeMask;
+				unsigned octantMask = parentMask & HitDistances(packet, octant.cullingBox, maxDistance, distances);
+				if (!octantMask) {
+					i = octant.skip;
+					continue;
 				}
+
+				hitMasks[octant.depth] = octantMask;
+
+				for (size_t j = octant.drawableStart; j < octant.drawableEnd; ++j) {
+					const FlatDrawable& drawable = flatDrawables[j];
+					if ((drawable.flags & drawableFlags) == drawableFlags && (drawable.viewMask & viewMask)) {
+						unsigned drawableMask = octantMask & HitDistances(packet, drawable.box, maxDistance, distances);
+						for (size_t k = 0; drawableMask; ++k, drawableMask >>= 1) {
+							if (drawableMask & 1) {
+								scratch.candidates[k].push_back(std::make_pair(drawable.drawable, distances[k]));
+							}
+						}
+					}
+				}
+				++i;
 			}
-		}
 
-		if (octant->numChildren) {
-			for (size_t i = 0; i < NUM_OCTANTS; ++i) {
-				if (octant->children[i]) {
-					CollectDrawables(result, octant->children[i], ray, drawableFlags, viewMask, maxDistance);
+			// Then perform actual per-node ray tests for each ray
+			std::vector<RaycastResult>& hits = scratch.hits;
+			for (size_t k = 0; k < count; ++k) {
+				const Ray& ray = rays[start + k];
+				std::vector<std::pair<Drawable*, float>>& candidates = scratch.candidates[k];
+				resultStart.push_back(static_cast<unsigned>(result.size()));
+				hits.clear();
+
+				if (mode == RAYCAST_NEAREST) {
+					// Test in order of distance and early-out when possible
+					std::sort(candidates.begin(), candidates.end(), CompareDrawableDistances);
+					float closestHit = maxDistance;
+					for (auto it = candidates.begin(); it != candidates.end() && it->second < closestHit; ++it) {
+						size_t oldSize = hits.size();
+						it->first->OnRaycast(hits, ray, maxDistance);
+						for (size_t l = oldSize; l < hits.size(); ++l) {
+							closestHit = std::min(closestHit, hits[l].distance);
+						}
+					}
+					if (hits.size()) {
+						result.push_back(*std::min_element(hits.begin(), hits.end(), CompareRaycastResults));
+					}
+				} else {
+					for (auto it = candidates.begin(); it != candidates.end(); ++it) {
+						it->first->OnRaycast(hits, ray, maxDistance);
+					}
+					std::sort(hits.begin(), hits.end(), CompareRaycastResults);
+					result.insert(result.end(), hits.begin(), hits.end());
 				}
 			}
 		}
@@ -601,9 +1653,21 @@ namespace Turso3D
 	void Octree::CheckReinsertWork(Task* task_, unsigned threadIndex_)
 	{
 		ReinsertDrawablesTask* task = static_cast<ReinsertDrawablesTask*>(task_);
-		Drawable** start = task->start;
-		Drawable** end = task->end;
-		std::vector<Drawable*>& reinsertQueue = reinsertQueues[threadIndex_];
+		CheckReinsertDrawables(task->start, task->end, threadIndex_, false);
+	}
+
+	void Octree::AnimationUpdateWork(Task* task_, unsigned threadIndex_)
+	{
+		AnimationUpdateTask* task = static_cast<AnimationUpdateTask*>(task_);
+		CheckReinsertDrawables(task->start, task->end, threadIndex_, true);
+	}
+
+	void Octree::CheckReinsertDrawables(Drawable** start, Drawable** end, unsigned threadIndex, bool updateAnimation)
+	{
+		std::vector<Drawable*>& reinsertQueue = reinsertQueues[threadIndex];
+		size_t numUpdated = 0;
+		size_t keptInFatBounds = 0;
+		size_t keptInOctant = 0;
 
 		for (; start != end; ++start) {
 			// If drawable was removed before reinsertion could happen, a null pointer will be in its place
@@ -615,19 +1679,57 @@ namespace Turso3D
 			if (drawable->TestFlag(Drawable::FLAG_OCTREE_UPDATE_CALL)) {
 				drawable->OnOctreeUpdate(frameNumber);
 			}
+			// Animation also updates the bounding box, so that the reinsertion check below sees the animated bounds
+			if (updateAnimation) {
+				drawable->OnAnimationUpdate(frameNumber);
+			}
 
 			drawable->lastUpdateFrameNumber = frameNumber;
+			++numUpdated;
 
-			// Do nothing if still fits the current octant
-			const BoundingBox& box = drawable->WorldBoundingBox();
-			Octant* oldOctant = drawable->GetOctant();
-			if (!oldOctant || oldOctant->fittingBox.IsInside(box) != INSIDE) {
+			if (CheckReinsert(drawable, keptInFatBounds, keptInOctant)) {
 				reinsertQueue.push_back(drawable);
 			} else {
 				drawable->SetFlag(Drawable::FLAG_OCTREE_REINSERT_QUEUED, false);
 			}
 		}
 
+		numUpdatedDrawables.fetch_add(numUpdated, std::memory_order_relaxed);
+		numKeptInFatBounds.fetch_add(keptInFatBounds, std::memory_order_relaxed);
+		numKeptInOctant.fetch_add(keptInOctant, std::memory_order_relaxed);
 		numPendingReinsertionTasks.fetch_add(-1);
 	}
+
+	void Octree::RaycastBatchWork(Task* task_, unsigned)
+	{
+		RaycastBatchTask* task = static_cast<RaycastBatchTask*>(task_);
+		task->result.clear();
+		task->resultStart.clear();
+		RaycastPackets(task->result, task->resultStart, task->rays, task->numRays, task->scratch, task->mode, task->drawableFlags, task->viewMask, task->maxDistance);
+
+		numPendingRaycastTasks.fetch_add(-1);
+	}
+
+	void Octree::OriginShiftWork(Task* task_, unsigned)
+	{
+		OriginShiftTask* task = static_cast<OriginShiftTask*>(task_);
+		const Vector3& offset = task->offset;
+
+		std::pair<size_t, size_t> range = TaskRange(originShiftOctants.size(), task->taskIndex, task->numTasks);
+		for (size_t i = range.first; i < range.second; ++i) {
+			ShiftOctants(originShiftOctants[i], offset);
+		}
+
+		// Move the flattened layout by the same operations as the drawables' bounds, so that it stays identical to a rebuild
+		range = TaskRange(flatOctants.size(), task->taskIndex, task->numTasks);
+		for (size_t i = range.first; i < range.second; ++i) {
+			flatOctants[i].cullingBox.Translate(offset);
+		}
+		range = TaskRange(flatDrawables.size(), task->taskIndex, task->numTasks);
+		for (size_t i = range.first; i < range.second; ++i) {
+			flatDrawables[i].box.Translate(offset);
+		}
+
+		numPendingOriginShiftTasks.fetch_add(-1);
+	}
 }
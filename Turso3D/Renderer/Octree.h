@@ -5,10 +5,12 @@
 #include <Turso3D/Renderer/OctreeNode.h>
 #include <atomic>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 namespace Turso3D
 {
+	class AnimationPoseCache;
 	class Ray;
 	class WorkQueue;
 	struct Task;
@@ -41,6 +43,79 @@ namespace Turso3D
 		size_t subObject;
 	};
 
+	// Batched raycast query modes.
+	enum RaycastMode
+	{
+		RAYCAST_NEAREST = 0,
+		RAYCAST_ALL
+	};
+
+	// Caller-owned scratch buffers for batched raycast queries.
+	// Using a separate scratch per thread allows batches to be queried from several threads at once.
+	struct RaycastScratch
+	{
+		// Potential hits of each ray in the current packet: drawable and distance to its bounding box.
+		std::vector<std::pair<Drawable*, float>> candidates[4];
+		// Hits of the current ray.
+		std::vector<RaycastResult> hits;
+	};
+
+	// Octree update statistics.
+	struct OctreeStats
+	{
+		// Drawables whose bounds were checked for reinsertion.
+		size_t updatedDrawables;
+		// Drawables whose animation was updated before the reinsertion check.
+		size_t animatedDrawables;
+		// Combined animation update cost of the animated drawables.
+		size_t animationCost;
+		// Animation pose cache lookups that found a pose evaluated by another model.
+		size_t poseCacheHits;
+		// Animation pose cache lookups that evaluated the pose.
+		size_t poseCacheMisses;
+		// Drawables kept in their octant because their bounding box stayed inside the fattened bounds.
+		size_t keptInFatBounds;
+		// Drawables kept in their octant because their bounding box stayed inside the octant's fitting box.
+		size_t keptInOctant;
+		// Drawables inserted or moved to a different octant.
+		size_t reinsertedDrawables;
+		// Octants whose drawables were sorted.
+		size_t sortedOctants;
+	};
+
+	// Octant in the flattened octree layout.
+	struct FlatOctant
+	{
+		// Culling box.
+		BoundingBox cullingBox;
+		// Index of the first octant after this octant's subtree. Traversal continues from there when the octant is rejected.
+		unsigned skip;
+		// Start index of the octant's own drawables.
+		unsigned drawableStart;
+		// End index of the octant's own drawables.
+		unsigned drawableEnd;
+		// End index of the drawables in the octant's whole subtree, which are stored contiguously.
+		unsigned subtreeDrawableEnd;
+		// Bitmask of the child octants, which follow in depth-first order.
+		unsigned char childMask;
+		// Depth from the root octant.
+		unsigned char depth;
+	};
+
+	// Drawable in the flattened octree layout.
+	struct FlatDrawable
+	{
+		// World bounding box.
+		BoundingBox box;
+		// Drawable flags.
+		unsigned flags;
+		// View mask.
+		unsigned viewMask;
+		// The drawable.
+		Drawable* drawable;
+	};
+
+	// ==========================================================================================
 	// Octree cell, contains up to 8 child octants.
 	class Octant
 	{
@@ -73,6 +148,10 @@ namespace Turso3D
 
 		// Return the culling box. Update as necessary.
 		const BoundingBox& CullingBox() const;
+		// Cull the drawables matching flags and view mask against a frustum and against their max distance from a view position.
+		// Works 4 drawables at a time on the culling data arrays, and does not access the drawables themselves.
+		// Uses the plane mask like Frustum::IsInsideMaskedFast(). Return the indices of the drawables that pass.
+		void CullDrawables(std::vector<unsigned>& result, const Frustum& frustum, unsigned char planeMask, const Vector3& viewPosition, unsigned drawableFlags, unsigned viewMask) const;
 		// Return drawables in this octant.
 		const std::vector<Drawable*>& Drawables() const { return drawables; }
 		// Return whether has child octants.
@@ -184,6 +263,16 @@ namespace Turso3D
 			return false;
 		}
 
+	private:
+		// Copy a drawable's world bounding box, view mask, flags and max distance to the culling data arrays.
+		void SetCullingData(size_t index, const Drawable* drawable);
+		// Remove a drawable's entry from the culling data arrays. The drawable must already be removed.
+		void EraseCullingData(size_t index);
+		// Resize the culling data arrays to match the drawables, padding with entries that never pass culling.
+		void ResizeCullingData();
+		// Move the bounds and culling data by an offset when the world origin is rebased.
+		void OnOriginShift(const Vector3& offset);
+
 	private:
 		// Combined drawable and child octant bounding box. Used for culling tests.
 		mutable BoundingBox cullingBox;
@@ -192,6 +281,22 @@ namespace Turso3D
 
 		// Drawables contained in the octant.
 		std::vector<Drawable*> drawables;
+		// Set when the culling data of this octant or its children changes, cleared when copied to the octree's flattened layout.
+		mutable std::atomic<bool> flatLayoutDirty;
+		// Drawable culling data as separate arrays in the same order as the drawables, padded to a multiple of 4.
+		// Drawable flags are stored as of the last insert or reinsert, which is enough for flags that queue a reinsert when changed.
+		struct
+		{
+			std::vector<float> minX;
+			std::vector<float> minY;
+			std::vector<float> minZ;
+			std::vector<float> maxX;
+			std::vector<float> maxY;
+			std::vector<float> maxZ;
+			std::vector<float> maxDistance;
+			std::vector<unsigned> viewMask;
+			std::vector<unsigned> flags;
+		} culling;
 		// Expanded (loose) bounding box used for fitting drawables within the octant.
 		BoundingBox fittingBox;
 		// Bounding box center.
@@ -218,9 +323,13 @@ namespace Turso3D
 
 	// ==========================================================================================
 	// Acceleration structure for rendering.
+	// Queries traverse a flattened copy of the octant hierarchy, which is rebuilt when the octree has changed.
 	class Octree
 	{
 		struct ReinsertDrawablesTask;
+		struct AnimationUpdateTask;
+		struct RaycastBatchTask;
+		struct OriginShiftTask;
 
 	public:
 		// Construct.
@@ -232,12 +341,25 @@ namespace Turso3D
 		~Octree();
 
 		// Process the queue of nodes to be reinserted.
-		// This will utilize worker threads.
+		// This will utilize worker threads. Drawables that opted in to the animation update and were in view last frame are animated first in the same tasks.
 		void Update(unsigned short frameNumber);
 		// Finish the octree update.
 		void FinishUpdate();
 		// Resize the octree.
 		void Resize(const BoundingBox& boundingBox, int numLevels);
+		// Set whether to expand the octree automatically when drawables are inserted outside it, and the maximum size to expand to. Default enabled.
+		// The root octant is doubled toward the drawables at the end of the update, so that the existing octants are kept.
+		void SetAutoExpand(bool enable, float maxSize);
+		// Set the animation update cost budget per frame, roughly in bones sampled. 0 (default) is unlimited.
+		// When the animated drawables exceed the budget, the animation LOD bias is lowered so that they use lower LOD levels. It recovers gradually when within budget again.
+		void SetAnimationBudget(size_t cost);
+		// Move the octree by the negated new origin when the world origin is rebased. The drawables are not reinserted, as their bounds are moved by their scene nodes.
+		// Uses worker threads. To be called only from the main thread outside the update. Called by Scene::RebaseOrigin().
+		void RebaseOrigin(const Vector3& newOrigin);
+		// Set the fattened bounds used for inserting moving drawables.
+		// The bounding box is enlarged by a margin relative to its size, and by the estimated movement over a number of frames. Static drawables use their bounding box.
+		// Defaults are margin 1 and 30 frames lookahead. Larger values reduce reinsertions further, but place drawables in larger octants.
+		void SetFatBounds(float margin, float lookaheadFrames);
 		// Enable or disable threaded update mode.
 		// In threaded mode reinsertions go to per-thread queues, which are processed in FinishUpdate().
 		void SetThreadedUpdate(bool enable) { threadedUpdate = enable; }
@@ -245,6 +367,8 @@ namespace Turso3D
 		void QueueUpdate(Drawable* drawable);
 		// Remove a drawable from the octree.
 		void RemoveDrawable(Drawable* drawable);
+		// Refresh the culling data of a drawable after its view mask or max distance changed.
+		void UpdateCullingData(Drawable* drawable);
 		// Add debug geometry to be rendered.
 		// Visualizes the whole octree.
 		void OnRenderDebug(DebugRenderer* debug);
@@ -253,30 +377,102 @@ namespace Turso3D
 		void Raycast(std::vector<RaycastResult>& result, const Ray& ray, unsigned nodeFlags, unsigned viewMask, float maxDistance = M_INFINITY) const;
 		// Query for drawables with a raycast and return the closest result.
 		RaycastResult RaycastSingle(const Ray& ray, unsigned drawableFlags, unsigned viewMask, float maxDistance = M_INFINITY) const;
+		// Query for drawables with a batch of raycasts, testing 4 rays at a time against the octants and drawables' bounding boxes.
+		// Return the closest hit of each ray, or all hits sorted by distance. The hits of ray i are result[resultStart[i]] up to result[resultStart[i + 1]].
+		// Does not modify the octree, so can be called from several threads with separate scratch buffers while the octree is not being updated.
+		void RaycastBatch(std::vector<RaycastResult>& result, std::vector<unsigned>& resultStart, const Ray* rays, size_t numRays, RaycastScratch& scratch, RaycastMode mode, unsigned drawableFlags, unsigned viewMask, float maxDistance = M_INFINITY) const;
+		// Query for drawables with a batch of raycasts split into tasks for the worker threads. Small batches are queried directly.
+		// To be called only from the main thread.
+		void RaycastBatchThreaded(std::vector<RaycastResult>& result, std::vector<unsigned>& resultStart, const Ray* rays, size_t numRays, RaycastMode mode, unsigned drawableFlags, unsigned viewMask, float maxDistance = M_INFINITY) const;
 
 		// Query for drawables using a volume such as frustum or sphere.
 		template <class T>
 		void FindDrawables(std::vector<Drawable*>& result, const T& volume, unsigned drawableFlags, unsigned viewMask) const
 		{
-			CollectDrawables(result, const_cast<Octant*>(&root), volume, drawableFlags, viewMask);
+			UpdateFlatLayout();
+
+			for (size_t i = 0; i < flatOctants.size();) {
+				const FlatOctant& octant = flatOctants[i];
+				Intersection res = volume.IsInside(octant.cullingBox);
+				if (res == OUTSIDE) {
+					i = octant.skip;
+					continue;
+				}
+
+				// If this octant is completely inside the volume, can include all contained octants and their nodes without further tests
+				if (res == INSIDE) {
+					for (size_t j = octant.drawableStart; j < octant.subtreeDrawableEnd; ++j) {
+						const FlatDrawable& drawable = flatDrawables[j];
+						if ((drawable.flags & drawableFlags) == drawableFlags && (drawable.viewMask & viewMask)) {
+							result.push_back(drawable.drawable);
+						}
+					}
+					i = octant.skip;
+				} else {
+					for (size_t j = octant.drawableStart; j < octant.drawableEnd; ++j) {
+						const FlatDrawable& drawable = flatDrawables[j];
+						if ((drawable.flags & drawableFlags) == drawableFlags && (drawable.viewMask & viewMask) && volume.IsInsideFast(drawable.box) != OUTSIDE) {
+							result.push_back(drawable.drawable);
+						}
+					}
+					++i;
+				}
+			}
 		}
 		// Query for drawables using a frustum and masked testing.
-		void FindDrawablesMasked(std::vector<Drawable*>& result, const Frustum& frustum, unsigned drawableFlags, unsigned viewMask) const
-		{
-			CollectDrawablesMasked(result, const_cast<Octant*>(&root), frustum, drawableFlags, viewMask);
-		}
-
+		void FindDrawablesMasked(std::vector<Drawable*>& result, const Frustum& frustum, unsigned drawableFlags, unsigned viewMask) const;
+		// Query for the drawables nearest to a position, measured to their bounding boxes. Return at most count drawables within the max distance, sorted by distance.
+		// Visits octants and drawables best-first and stops once enough are found, so the cost depends on the count rather than the volume searched.
+		void FindNearestDrawables(std::vector<std::pair<Drawable*, float>>& result, const Vector3& position, size_t count, unsigned drawableFlags, unsigned viewMask, float maxDistance = M_INFINITY) const;
+		// Query for the drawable nearest to a position within a radius, measured to its bounding box. Return null if none.
+		Drawable* FindNearestDrawable(const Vector3& position, float radius, unsigned drawableFlags, unsigned viewMask, float* outDistance = nullptr) const;
+
+		// Return the fattened bounds margin.
+		float FatBoundsMargin() const { return fatBoundsMargin; }
+		// Return the fattened bounds movement lookahead in frames.
+		float FatBoundsLookahead() const { return fatBoundsLookahead; }
+		// Return whether automatic expansion is enabled.
+		bool AutoExpand() const { return autoExpand; }
+		// Return the maximum size for automatic expansion.
+		float AutoExpandMaxSize() const { return autoExpandMaxSize; }
+		// Return the animation update cost budget per frame.
+		size_t AnimationBudget() const { return animationBudget; }
+		// Return the animation LOD bias from the budget. Values lower than 1 use lower quality animation LOD (acts as if distance is larger.)
+		float AnimationLodBias() const { return animationLodBias; }
+		// Return the cache for sharing poses between identically animated models. Cleared at the start of each update.
+		AnimationPoseCache* GetAnimationPoseCache() const { return poseCache.get(); }
+		// Return the root level bounding box.
+		BoundingBox WorldBoundingBox() const { return BoundingBox(root.center - root.halfSize, root.center + root.halfSize); }
+		// Return statistics of the last update. Bounds checks queued after the update, during rendering, are counted in the next.
+		const OctreeStats& Stats() const { return stats; }
 		// Return whether threaded update is enabled.
 		bool ThreadedUpdate() const { return threadedUpdate; }
 		// Return the root octant.
 		Octant* Root() const { return const_cast<Octant*>(&root); }
+		// Return the flattened octants in depth-first order. Call UpdateFlatLayout() first.
+		const std::vector<FlatOctant>& FlatOctants() const { return flatOctants; }
+		// Return the flattened drawables in the order of the flattened octants.
+		const std::vector<FlatDrawable>& FlatDrawables() const { return flatDrawables; }
+
+		// Rebuild or refresh the flattened layout if the octree has changed since the last update.
+		// Called automatically by FinishUpdate() and queries. Queries in threaded update mode use the existing layout.
+		void UpdateFlatLayout() const;
 
 	private:
 		// Process a list of drawables to be reinserted.
 		// Clear the list afterward.
-		void ReinsertDrawables(std::vector<Drawable*>& drawables);
+		// Return the number of drawables inserted or moved to a different octant.
+		size_t ReinsertDrawables(std::vector<Drawable*>& drawables);
 		// Remove a drawable from a reinsert queue.
 		void RemoveDrawableFromQueue(Drawable* drawable, std::vector<Drawable*>& drawables);
+		// Check a drawable's bounds after it moved. Refresh its culling data and fattened bounds as necessary.
+		// Return true if the drawable should be reinserted.
+		bool CheckReinsert(Drawable* drawable, size_t& numKeptInFatBounds, size_t& numKeptInOctant);
+		// Update a drawable's fattened bounding box from its bounding box and movement since the last update.
+		void UpdateFatBoundingBox(Drawable* drawable, const BoundingBox& box);
+		// Double the root octant toward the drawables that were left in it for being outside, until they fit or the maximum size is reached.
+		// Then reinsert those drawables. Return the number of drawables moved to a different octant.
+		size_t ExpandRoot();
 
 		// Add drawable to a specific octant.
 		void AddDrawable(Drawable* drawable, Octant* octant);
@@ -293,74 +489,26 @@ namespace Turso3D
 
 		// Return all drawables from an octant recursively.
 		void CollectDrawables(std::vector<Drawable*>& result, Octant* octant) const;
-		// Return all drawables matching flags from an octant recursively.
-		void CollectDrawables(std::vector<Drawable*>& result, Octant* octant, unsigned drawableFlags, unsigned viewMask) const;
-		// Return all drawables matching flags along a ray.
-		void CollectDrawables(std::vector<RaycastResult>& result, Octant* octant, const Ray& ray, unsigned drawableFlags, unsigned viewMask, float maxDistance) const;
-		// Return all visible drawables matching flags that could be potential raycast hits.
-		void CollectDrawables(std::vector<std::pair<Drawable*, float>>& result, Octant* octant, const Ray& ray, unsigned drawableFlags, unsigned viewMask, float maxDistance) const;
+		// Move an octant and its child octants recursively when the world origin is rebased.
+		void ShiftOctants(Octant* octant, const Vector3& offset);
+		// Append an octant and its subtree to the flattened layout.
+		void FlattenOctant(const Octant* octant, unsigned char depth) const;
+		// Copy an octant's drawables and their culling data to the flattened layout.
+		void CopyFlatDrawables(const Octant* octant, size_t start) const;
+
+		// Query a batch of rays in packets of 4. Append the hits and each ray's start index.
+		void RaycastPackets(std::vector<RaycastResult>& result, std::vector<unsigned>& resultStart, const Ray* rays, size_t numRays, RaycastScratch& scratch, RaycastMode mode, unsigned drawableFlags, unsigned viewMask, float maxDistance) const;
 
 		// Work function to check reinsertion of nodes.
 		void CheckReinsertWork(Task* task, unsigned threadIndex);
-
-		// Collect nodes matching flags using a volume such as frustum or sphere.
-		template <class T>
-		void CollectDrawables(std::vector<Drawable*>& result, Octant* octant, const T& volume, unsigned drawableFlags, unsigned viewMask) const
-		{
-			Intersection res = volume.IsInside(octant->CullingBox());
-			if (res == OUTSIDE) {
-				return;
-			}
-
-			// If this octant is completely inside the volume, can include all contained octants and their nodes without further tests
-			if (res == INSIDE) {
-				CollectDrawables(result, octant, drawableFlags, viewMask);
-			} else {
-				std::vector<Drawable*>& drawables = octant->drawables;
-				for (size_t i = 0; i < drawables.size(); ++i) {
-					Drawable* drawable = drawables[i];
-					if ((drawable->Flags() & drawableFlags) == drawableFlags && (drawable->ViewMask() & viewMask) && volume.IsInsideFast(drawable->WorldBoundingBox()) != OUTSIDE) {
-						result.push_back(drawable);
-					}
-				}
-
-				if (octant->numChildren) {
-					for (size_t i = 0; i < NUM_OCTANTS; ++i) {
-						if (octant->children[i]) {
-							CollectDrawables(result, octant->children[i], volume, drawableFlags, viewMask);
-						}
-					}
-				}
-			}
-		}
-
-		// Collect nodes using a frustum and masked testing.
-		void CollectDrawablesMasked(std::vector<Drawable*>& result, Octant* octant, const Frustum& frustum, unsigned drawableFlags, unsigned viewMask, unsigned char planeMask = 0x3f) const
-		{
-			if (planeMask) {
-				planeMask = frustum.IsInsideMasked(octant->CullingBox(), planeMask);
-				// Terminate if octant completely outside frustum
-				if (planeMask == 0xff) {
-					return;
-				}
-			}
-
-			std::vector<Drawable*>& drawables = octant->drawables;
-			for (size_t i = 0; i < drawables.size(); ++i) {
-				Drawable* drawable = drawables[i];
-				if ((drawable->Flags() & drawableFlags) == drawableFlags && (drawable->ViewMask() & viewMask) && (!planeMask || frustum.IsInsideMaskedFast(drawable->WorldBoundingBox(), planeMask) != OUTSIDE)) {
-					result.push_back(drawable);
-				}
-			}
-
-			if (octant->numChildren) {
-				for (size_t i = 0; i < NUM_OCTANTS; ++i) {
-					if (octant->children[i]) {
-						CollectDrawablesMasked(result, octant->children[i], frustum, drawableFlags, viewMask, planeMask);
-					}
-				}
-			}
-		}
+		// Work function to update animation of drawables and check for their reinsertion.
+		void AnimationUpdateWork(Task* task, unsigned threadIndex);
+		// Call the update functions of drawables and check for their reinsertion. Optionally update also their animation.
+		void CheckReinsertDrawables(Drawable** start, Drawable** end, unsigned threadIndex, bool updateAnimation);
+		// Work function to query a part of a raycast batch.
+		void RaycastBatchWork(Task* task, unsigned threadIndex);
+		// Work function to move a part of the octants and the flattened layout when the world origin is rebased.
+		void OriginShiftWork(Task* task, unsigned threadIndex);
 
 	private:
 		// Threaded update flag.
@@ -372,12 +520,22 @@ namespace Turso3D
 
 		// Current framenumber.
 		unsigned short frameNumber;
+		// Fattened bounds margin relative to the bounding box size.
+		float fatBoundsMargin;
+		// Fattened bounds movement lookahead in frames.
+		float fatBoundsLookahead;
+		// Automatic expansion flag.
+		bool autoExpand;
+		// Maximum size for automatic expansion.
+		float autoExpandMaxSize;
+		// Combined bounds of the drawables left in the root octant for being outside it in the current update.
+		BoundingBox expandBounds;
+		// Statistics of the last update.
+		OctreeStats stats;
 		// Queue of nodes to be reinserted.
 		std::vector<Drawable*> updateQueue;
 		// Octants which need to have their drawables sorted.
 		std::vector<Octant*> sortDirtyOctants;
-		// Extents of the octree root level box.
-		BoundingBox worldBoundingBox;
 		// Root octant.
 		Octant root;
 
@@ -388,13 +546,51 @@ namespace Turso3D
 		std::vector<std::unique_ptr<ReinsertDrawablesTask>> reinsertTasks;
 		// Intermediate reinsert queues for threaded execution.
 		std::unique_ptr<std::vector<Drawable*>[]> reinsertQueues;
-
-		// RaycastSingle initial coarse result.
-		mutable std::vector<std::pair<Drawable*, float>> initialRayResult;
-		// RaycastSingle final result.
-		mutable std::vector<RaycastResult> finalRayResult;
+		// Tasks for threaded animation update, balanced by the drawables' animation update cost.
+		std::vector<std::unique_ptr<AnimationUpdateTask>> animationTasks;
+		// Drawables whose animation is updated in the current update.
+		size_t numAnimatedDrawables;
+		// Combined animation update cost of the current update.
+		size_t animationCost;
+		// Animation update cost budget per frame, or 0 if unlimited.
+		size_t animationBudget;
+		// Animation LOD bias from the budget.
+		float animationLodBias;
+		// Poses shared between animated drawables on the current frame.
+		std::unique_ptr<AnimationPoseCache> poseCache;
+
+		// Flattened octants in depth-first order.
+		mutable std::vector<FlatOctant> flatOctants;
+		// Source octants of the flattened octants.
+		mutable std::vector<const Octant*> flatSourceOctants;
+		// Flattened drawables.
+		mutable std::vector<FlatDrawable> flatDrawables;
+		// Mutex for updating the flattened layout.
+		mutable std::mutex flatLayoutMutex;
+		// Flag for octants or drawables having been added or removed, which requires rebuilding the flattened layout.
+		mutable std::atomic<bool> flatStructureDirty;
+		// Flag for drawables' culling data having changed, which requires refreshing the flattened layout.
+		mutable std::atomic<bool> flatLayoutDirty;
+
+		// Tasks for threaded raycast batches.
+		mutable std::vector<std::unique_ptr<RaycastBatchTask>> raycastTasks;
+
+		// Tasks for rebasing the world origin.
+		std::vector<std::unique_ptr<OriginShiftTask>> originShiftTasks;
+		// Octant subtrees to move when rebasing the world origin.
+		std::vector<Octant*> originShiftOctants;
 
 		// Remaining drawable reinsertion tasks.
 		std::atomic<int> numPendingReinsertionTasks;
+		// Remaining raycast batch tasks.
+		mutable std::atomic<int> numPendingRaycastTasks;
+		// Remaining origin rebase tasks.
+		std::atomic<int> numPendingOriginShiftTasks;
+		// Drawables whose bounds were checked since the last update.
+		std::atomic<size_t> numUpdatedDrawables;
+		// Drawables kept in their octant by the fattened bounds since the last update.
+		std::atomic<size_t> numKeptInFatBounds;
+		// Drawables kept in their octant by the octant's fitting box since the last update.
+		std::atomic<size_t> numKeptInOctant;
 	};
 }
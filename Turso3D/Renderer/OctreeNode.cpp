@@ -10,9 +10,11 @@ namespace Turso3D
 	Drawable::Drawable() :
 		owner(nullptr),
 		octant(nullptr),
+		octantIndex(0),
 		flags(0),
 		lastFrameNumber(0),
 		lastUpdateFrameNumber(0),
+		fatBoundsFrameNumber(0),
 		distance(0.0f),
 		maxDistance(0.0f),
 		viewMask(1),
@@ -35,6 +37,15 @@ namespace Turso3D
 	{
 	}
 
+	void Drawable::OnAnimationUpdate(unsigned short)
+	{
+	}
+
+	size_t Drawable::AnimationUpdateCost(unsigned short) const
+	{
+		return 1;
+	}
+
 	bool Drawable::OnPrepareRender(unsigned short frameNumber, Camera* camera)
 	{
 		distance = camera->Distance(WorldBoundingBox().Center());
@@ -66,6 +77,15 @@ namespace Turso3D
 		debug->AddBoundingBox(WorldBoundingBox(), Color::GREEN(), false);
 	}
 
+	void Drawable::OnOriginShift(const Vector3& offset)
+	{
+		if (!TestFlag(FLAG_BOUNDING_BOX_DIRTY)) {
+			worldBoundingBox.Translate(offset);
+		}
+		fatBoundingBox.Translate(offset);
+		fatBoundsCenter += offset;
+	}
+
 	void Drawable::SetOwner(OctreeNodeBase* owner_)
 	{
 		owner = owner_;
@@ -79,6 +99,14 @@ namespace Turso3D
 	{
 	}
 
+	void OctreeNodeBase::OnOriginShift(const Vector3& offset)
+	{
+		SpatialNode::OnOriginShift(offset);
+		if (drawable) {
+			drawable->OnOriginShift(offset);
+		}
+	}
+
 	// ==========================================================================================
 	void OctreeNode::SetStatic(bool enable)
 	{
@@ -106,12 +134,18 @@ namespace Turso3D
 	void OctreeNode::SetMaxDistance(float distance_)
 	{
 		drawable->maxDistance = std::max(distance_, 0.0f);
+		if (octree) {
+			octree->UpdateCullingData(drawable);
+		}
 	}
 
 	void OctreeNode::SetViewMask(unsigned mask)
 	{
 		unsigned old_mask = drawable->viewMask;
 		drawable->viewMask = mask;
+		if (octree) {
+			octree->UpdateCullingData(drawable);
+		}
 		OnViewMaskChanged(old_mask);
 	}
 
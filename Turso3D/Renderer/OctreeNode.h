@@ -23,6 +23,9 @@ namespace Turso3D
 		// Construct.
 		OctreeNodeBase();
 
+		// Move by a world space offset when the world origin is rebased, along with the drawable's world space data.
+		void OnOriginShift(const Vector3& offset) override;
+
 		// Return current octree this node resides in.
 		Octree* GetOctree() const { return octree; }
 		// Return the drawable for internal use.
@@ -64,7 +67,11 @@ namespace Turso3D
 
 			FLAG_WORLD_TRANSFORM_DIRTY = 0x200,
 			FLAG_BOUNDING_BOX_DIRTY = 0x400,
-			FLAG_OCTREE_REINSERT_QUEUED = 0x800
+			FLAG_OCTREE_REINSERT_QUEUED = 0x800,
+
+			FLAG_USE_IMPOSTER = 0x1000,
+			FLAG_ANIMATION_UPDATE_CALL = 0x2000,
+			FLAG_BAKED_ANIMATION = 0x4000
 		};
 
 	public:
@@ -79,6 +86,13 @@ namespace Turso3D
 		// Called by Octree in worker threads.
 		// Must be opted-in by setting FLAG_OCTREE_UPDATE_CALL flag.
 		virtual void OnOctreeUpdate(unsigned short frameNumber);
+		// Update animation, bone transforms and skinning before octree reinsertion.
+		// Called by Octree in worker threads, if was in view last frame or should update without regard to visibility.
+		// Must be opted-in by setting FLAG_ANIMATION_UPDATE_CALL flag.
+		virtual void OnAnimationUpdate(unsigned short frameNumber);
+		// Return the relative cost of the animation update in the current frame, used to balance the animation update between worker threads and to measure against the animation budget.
+		// Called by Octree in the main thread before the animation update.
+		virtual size_t AnimationUpdateCost(unsigned short frameNumber) const;
 		// Prepare object for rendering.
 		// Reset framenumber and calculate distance from camera.
 		// Called by Renderer in worker threads.
@@ -89,6 +103,9 @@ namespace Turso3D
 		// Add debug geometry to be rendered.
 		// Default implementation draws the bounding box.
 		virtual void OnRenderDebug(DebugRenderer* debug);
+		// Move cached world space data by an offset when the world origin is rebased. The owner node's world transform is moved by the node.
+		// Called by the owner node, possibly in worker threads.
+		virtual void OnOriginShift(const Vector3& offset);
 
 		// Set the owner node.
 		void SetOwner(OctreeNodeBase* owner);
@@ -150,6 +167,10 @@ namespace Turso3D
 			return worldBoundingBox;
 		}
 
+		// Return the fattened bounding box used for the last octree insertion.
+		// The drawable is not checked against its octant while its world bounding box stays inside.
+		const BoundingBox& FatBoundingBox() const { return fatBoundingBox; }
+
 		// Return world transform matrix.
 		// Update if necessary
 		const Matrix3x4& WorldTransform() const
@@ -183,16 +204,24 @@ namespace Turso3D
 		mutable unsigned flags;
 		// World space bounding box.
 		mutable BoundingBox worldBoundingBox;
+		// World space bounding box enlarged by a margin and the estimated movement, used for octree insertion.
+		BoundingBox fatBoundingBox;
+		// World space bounding box center when the fattened bounding box was last updated. Used to estimate velocity.
+		Vector3 fatBoundsCenter;
 
 		// Owner scene node's world transform matrix.
 		Matrix3x4* worldTransform;
 		// Current octree octant.
 		Octant* octant;
+		// Index in the current octant's drawables and culling data.
+		unsigned octantIndex;
 
 		// Last frame number when was visible.
 		unsigned short lastFrameNumber;
 		// Last frame number when was reinserted to octree or other change (LOD etc.) happened.
 		unsigned short lastUpdateFrameNumber;
+		// Frame number when the fattened bounding box was last updated.
+		unsigned short fatBoundsFrameNumber;
 		// Distance from camera in the current view.
 		float distance;
 		// Max distance for rendering.
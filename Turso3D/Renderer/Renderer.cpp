@@ -1,6 +1,8 @@
 #include <Turso3D/Renderer/Renderer.h>
+#include <Turso3D/Core/Profiler.h>
 #include <Turso3D/Core/WorkQueue.h>
 #include <Turso3D/Graphics/FrameBuffer.h>
+#include <Turso3D/Graphics/GpuProfiler.h>
 #include <Turso3D/Graphics/Graphics.h>
 #include <Turso3D/Graphics/IndexBuffer.h>
 #include <Turso3D/Graphics/RenderBuffer.h>
@@ -12,14 +14,18 @@
 #include <Turso3D/IO/Log.h>
 #include <Turso3D/Renderer/AnimatedModel.h>
 #include <Turso3D/Renderer/Animation.h>
+#include <Turso3D/Renderer/AnimationTexture.h>
+#include <Turso3D/Renderer/BakedAnimatedModel.h>
 #include <Turso3D/Renderer/Batch.h>
 #include <Turso3D/Renderer/Camera.h>
 #include <Turso3D/Renderer/DebugRenderer.h>
+#include <Turso3D/Renderer/Imposter.h>
 #include <Turso3D/Renderer/Light.h>
 #include <Turso3D/Renderer/LightEnvironment.h>
 #include <Turso3D/Renderer/Material.h>
 #include <Turso3D/Renderer/Model.h>
 #include <Turso3D/Renderer/Octree.h>
+#include <Turso3D/Renderer/SkinnedModel.h>
 #include <Turso3D/Renderer/StaticModel.h>
 #include <Turso3D/Resource/ResourceCache.h>
 #include <Turso3D/Scene/Scene.h>
@@ -31,6 +37,9 @@ namespace
 	using namespace Turso3D;
 
 	constexpr size_t INITIAL_INSTANCE_CAPACITY = 1000;
+	constexpr size_t INITIAL_SKIN_MATRIX_CAPACITY = 8192;
+	// Must match the skin matrix array size of the instanced skinning shaders.
+	constexpr size_t MAX_INSTANCED_SKIN_MATRICES = 1024;
 	constexpr size_t DRAWABLES_PER_BATCH_TASK = 128;
 	constexpr size_t NUM_BOX_INDICES = 36;
 	constexpr float OCCLUSION_MARGIN = 0.1f;
@@ -41,10 +50,60 @@ namespace
 		{ELEM_VECTOR4, ATTR_WORLDINSTANCE_M2}
 	};
 
+	const VertexElement BakedInstanceVertexElements[] = {
+		{ELEM_VECTOR4, ATTR_WORLDINSTANCE_M0},
+		{ELEM_VECTOR4, ATTR_WORLDINSTANCE_M1},
+		{ELEM_VECTOR4, ATTR_WORLDINSTANCE_M2},
+		{ELEM_VECTOR4, ATTR_INSTANCE_DATA0}
+	};
+
+	const VertexElement SkinInstanceVertexElements[] = {
+		{ELEM_FLOAT, ATTR_INSTANCE_DATA0}
+	};
+
 	static inline bool CompareDrawableDistances(Drawable* lhs, Drawable* rhs)
 	{
 		return lhs->Distance() < rhs->Distance();
 	}
+
+	// Lower a pass or geometry sort key to the distance if it was not yet set on the frame or was further.
+	static inline void UpdateSortKey(std::pair<unsigned, unsigned>& sortKey, unsigned frameNumber, unsigned distance)
+	{
+		if (sortKey.first != frameNumber || sortKey.second > distance) {
+			sortKey.first = frameNumber;
+			sortKey.second = distance;
+		}
+	}
+
+	static inline void BindGeometry(Geometry* geometry, VertexBuffer* instanceBuffer, size_t instanceStart)
+	{
+		const VertexBufferBinding bindings[] = {
+			{geometry->vertexBuffer.get()},
+			{instanceBuffer, instanceStart, 1, instanceBuffer != nullptr}
+		};
+		Graphics::BindVertexBuffers(bindings, 2);
+
+		if (IndexBuffer* ib = geometry->indexBuffer.get()) {
+			Graphics::BindIndexBuffer(ib);
+		}
+	}
+
+	static inline void DrawGeometry(Geometry* geometry, size_t instanceCount)
+	{
+		if (instanceCount) {
+			if (geometry->indexBuffer) {
+				Graphics::DrawIndexedInstanced(PT_TRIANGLE_LIST, geometry->drawStart, geometry->drawCount, instanceCount);
+			} else {
+				Graphics::DrawInstanced(PT_TRIANGLE_LIST, geometry->drawStart, geometry->drawCount, instanceCount);
+			}
+		} else {
+			if (geometry->indexBuffer) {
+				Graphics::DrawIndexed(PT_TRIANGLE_LIST, geometry->drawStart, geometry->drawCount);
+			} else {
+				Graphics::Draw(PT_TRIANGLE_LIST, geometry->drawStart, geometry->drawCount);
+			}
+		}
+	}
 }
 
 namespace Turso3D
@@ -56,6 +115,7 @@ namespace Turso3D
 		CollectOctantsTask(Renderer* object_, MemberWorkFunctionPtr function_) :
 			MemberFunctionTask<Renderer>(object_, function_)
 		{
+			name = "CollectOctants";
 		}
 
 		// Starting point octant.
@@ -71,6 +131,7 @@ namespace Turso3D
 		CollectBatchesTask(Renderer* object_, MemberWorkFunctionPtr function_) :
 			MemberFunctionTask<Renderer>(object_, function_)
 		{
+			name = "CollectBatches";
 		}
 
 		// Octant list with plane masks.
@@ -84,6 +145,7 @@ namespace Turso3D
 		CollectShadowCastersTask(Renderer* object_, MemberWorkFunctionPtr function_) :
 			MemberFunctionTask<Renderer>(object_, function_)
 		{
+			name = "CollectShadowCasters";
 		}
 
 		// Light.
@@ -97,6 +159,7 @@ namespace Turso3D
 		CollectShadowBatchesTask(Renderer* object_, MemberWorkFunctionPtr function_) :
 			MemberFunctionTask<Renderer>(object_, function_)
 		{
+			name = "CollectShadowBatches";
 		}
 
 		// Shadow map index.
@@ -112,6 +175,7 @@ namespace Turso3D
 		CullLightsTask(Renderer* object_, MemberWorkFunctionPtr function_) :
 			MemberFunctionTask<Renderer>(object_, function_)
 		{
+			name = "CullLightsToFrustum";
 		}
 
 		// Z-slice.
@@ -124,6 +188,9 @@ namespace Turso3D
 		drawableAcc = 0;
 		taskOctantIdx = 0;
 		batchTaskIdx = 0;
+		numOctants = 0;
+		numOccludedOctants = 0;
+		numCulledLights = 0;
 		lights.clear();
 		octants.clear();
 		occlusionQueries.clear();
@@ -134,7 +201,9 @@ namespace Turso3D
 		minZ = M_MAX_FLOAT;
 		maxZ = 0.0f;
 		geometryBounds.Undefine();
+		numDrawables = 0;
 		opaqueBatches.clear();
+		prePassOpaqueBatches.clear();
 		alphaBatches.clear();
 	}
 
@@ -169,9 +238,13 @@ namespace Turso3D
 	Renderer::Renderer(WorkQueue* workQueue) :
 		workQueue(workQueue),
 		frameNumber(0),
+		depthPrePass(false),
+		depthPrePassMinCoverage(0.01f),
 		clusterFrustumsDirty(true),
+		animationTime(0.0),
 		depthBiasMul(1.0f),
-		slopeScaleBiasMul(1.0f)
+		slopeScaleBiasMul(1.0f),
+		stats {}
 	{
 		assert(Graphics::IsInitialized());
 
@@ -179,6 +252,23 @@ namespace Turso3D
 		instanceVertexBuffer = std::make_unique<VertexBuffer>();
 		instanceVertexBuffer->Define(USAGE_DYNAMIC, INITIAL_INSTANCE_CAPACITY, InstanceVertexElements, 3);
 
+		bakedInstanceVertexBuffer = std::make_unique<VertexBuffer>();
+		bakedInstanceVertexBuffer->Define(USAGE_DYNAMIC, INITIAL_INSTANCE_CAPACITY, BakedInstanceVertexElements, 4);
+
+		skinInstanceVertexBuffer = std::make_unique<VertexBuffer>();
+		skinInstanceVertexBuffer->Define(USAGE_DYNAMIC, INITIAL_INSTANCE_CAPACITY, SkinInstanceVertexElements, 1);
+
+		// Skin matrix ranges must start at the uniform buffer offset alignment, which may not be a multiple of the matrix size
+		numUploadedSkinMatrices = 0;
+		skinMatrixAlignment = 1;
+		while ((skinMatrixAlignment * sizeof(Matrix3x4)) % Graphics::UniformBufferOffsetAlignment()) {
+			++skinMatrixAlignment;
+		}
+		maxInstancedSkinBones = MAX_INSTANCED_SKIN_MATRICES - skinMatrixAlignment;
+		skinMatrices.reserve(INITIAL_SKIN_MATRIX_CAPACITY);
+		skinMatrixBuffer = std::make_unique<UniformBuffer>();
+		skinMatrixBuffer->Define(USAGE_DYNAMIC, (INITIAL_SKIN_MATRIX_CAPACITY + MAX_INSTANCED_SKIN_MATRICES) * sizeof(Matrix3x4));
+
 		clusterTexture = std::make_unique<Texture>();
 		clusterTexture->Define(TARGET_3D, IntVector3 {NUM_CLUSTER_X, NUM_CLUSTER_Y, NUM_CLUSTER_Z}, FORMAT_RGBA32_UINT_PACK32);
 		clusterTexture->DefineSampler(FILTER_POINT, ADDRESS_CLAMP, ADDRESS_CLAMP, ADDRESS_CLAMP);
@@ -209,6 +299,9 @@ namespace Turso3D
 		processLightsTask = std::make_unique<MemberFunctionTask<Renderer>>(this, &Renderer::ProcessLightsWork);
 		batchesReadyTask = std::make_unique<MemberFunctionTask<Renderer>>(this, &Renderer::BatchesReadyWork);
 		processShadowCastersTask = std::make_unique<MemberFunctionTask<Renderer>>(this, &Renderer::ProcessShadowCastersWork);
+		processLightsTask->name = "ProcessLights";
+		batchesReadyTask->name = "BatchesReady";
+		processShadowCastersTask->name = "ProcessShadowCasters";
 
 		DefineBoundingBoxGeometry();
 	}
@@ -255,12 +348,24 @@ namespace Turso3D
 		shadowMapsDirty = true;
 	}
 
+	void Renderer::SetDepthPrePass(bool enable, float minScreenCoverage)
+	{
+		depthPrePass = enable;
+		depthPrePassMinCoverage = std::max(minScreenCoverage, 0.0f);
+	}
+
 	void Renderer::PrepareView(Scene* scene_, Camera* camera_, bool drawShadows_, bool useOcclusion_, float lastFrameTime_)
 	{
+		TURSO3D_PROFILE("Renderer::PrepareView");
+
+		stats = RendererStats {};
+
 		if (!scene_ || !camera_) {
 			return;
 		}
 
+		double startTime = Profiler::Now();
+
 		scene = scene_;
 		camera = camera_;
 		octree = scene->GetOctree();
@@ -285,8 +390,12 @@ namespace Turso3D
 		lastCamera = nullptr;
 		rootLevelOctants.clear();
 		opaqueBatches.Clear();
+		prePassOpaqueBatches.Clear();
+		depthPrePassBatches.Clear();
 		alphaBatches.Clear();
 		lights.clear();
+		skinMatrices.clear();
+		numUploadedSkinMatrices = 0;
 
 		minZ = M_MAX_FLOAT;
 		maxZ = 0.0f;
@@ -309,6 +418,7 @@ namespace Turso3D
 		}
 
 		// Process moved / animated objects' octree reinsertions
+		double stageTime = Profiler::Now();
 		octree->Update(frameNumber);
 
 		// Precalculate SAT test parameters for accurate frustum test (verify what octants to occlusion query)
@@ -320,6 +430,10 @@ namespace Turso3D
 		CheckOcclusionQueries();
 		octree->FinishUpdate();
 
+		double time = Profiler::Now();
+		stats.octreeUpdateTime = static_cast<float>((time - stageTime) * 0.001);
+		stageTime = time;
+
 		// Find the starting points for octree traversal. Include the root if it contains drawables that didn't fit elsewhere
 		Octant* rootOctant = octree->Root();
 		if (rootOctant->Drawables().size()) {
@@ -334,6 +448,7 @@ namespace Turso3D
 
 		// If no root level octants, must early-out the view preparation; there is nothing to render and task dependencies would not complete
 		if (rootLevelOctants.empty()) {
+			stats.prepareViewTime = static_cast<float>((Profiler::Now() - startTime) * 0.001);
 			return;
 		}
 
@@ -363,13 +478,27 @@ namespace Turso3D
 			workQueue->TryComplete();
 		}
 
+		time = Profiler::Now();
+		stats.collectTime = static_cast<float>((time - stageTime) * 0.001);
+		stageTime = time;
+
 		SortMainBatches();
 
+		time = Profiler::Now();
+		stats.sortTime = static_cast<float>((time - stageTime) * 0.001);
+		stageTime = time;
+
 		// Finish remaining view preparation tasks (shadowcaster batches, light culling to frustum grid)
 		workQueue->Complete();
 
 		// No more threaded reinsertion will take place
 		octree->SetThreadedUpdate(false);
+
+		CollectStats();
+
+		time = Profiler::Now();
+		stats.shadowTime = static_cast<float>((time - stageTime) * 0.001);
+		stats.prepareViewTime = static_cast<float>((time - startTime) * 0.001);
 	}
 
 	void Renderer::RenderShadowMaps()
@@ -378,6 +507,8 @@ namespace Turso3D
 			return;
 		}
 
+		TURSO3D_GPU_PROFILE("Shadow Maps");
+
 		// Unbind shadow textures before rendering to
 		Graphics::BindTexture(TU_DIRLIGHTSHADOW, nullptr);
 		Graphics::BindTexture(TU_SHADOWATLAS, nullptr);
@@ -402,6 +533,7 @@ namespace Turso3D
 					if (batchQueue.HasBatches()) {
 						Graphics::SetViewport(view->viewport);
 						Graphics::SetDepthBias(light->DepthBias() * depthBiasMul, light->SlopeScaleBias() * slopeScaleBiasMul);
+						TURSO3D_GPU_PROFILE("Static Shadow Casters");
 						RenderBatches(view->shadowCamera.get(), batchQueue);
 					}
 				}
@@ -440,6 +572,7 @@ namespace Turso3D
 					if (batchQueue.HasBatches()) {
 						Graphics::SetViewport(view->viewport);
 						Graphics::SetDepthBias(light->DepthBias() * depthBiasMul, light->SlopeScaleBias() * slopeScaleBiasMul);
+						TURSO3D_GPU_PROFILE("Dynamic Shadow Casters");
 						RenderBatches(view->shadowCamera.get(), batchQueue);
 					}
 				}
@@ -477,10 +610,26 @@ namespace Turso3D
 			Graphics::BindTexture(TU_IBL_BRDFLUT, tex);
 		}
 
-		RenderBatches(camera, opaqueBatches);
+		// Lay down depth of the large geometries first, so that the opaque pass shades each of their pixels only once
+		if (depthPrePassBatches.HasBatches()) {
+			{
+				TURSO3D_GPU_PROFILE("Depth Pre-Pass");
+				RenderBatches(camera, depthPrePassBatches);
+			}
+			{
+				TURSO3D_GPU_PROFILE("Pre-Pass Opaque Batches");
+				RenderBatches(camera, prePassOpaqueBatches, true);
+			}
+		}
+
+		{
+			TURSO3D_GPU_PROFILE("Opaque Batches");
+			RenderBatches(camera, opaqueBatches);
+		}
 
 		// Render occlusion now after opaques
 		if (useOcclusion) {
+			TURSO3D_GPU_PROFILE("Occlusion Queries");
 			RenderOcclusionQueries();
 		}
 	}
@@ -506,6 +655,7 @@ namespace Turso3D
 			Graphics::BindTexture(TU_IBL_BRDFLUT, tex);
 		}
 
+		TURSO3D_GPU_PROFILE("Alpha Batches");
 		RenderBatches(camera, alphaBatches);
 	}
 
@@ -570,11 +720,13 @@ namespace Turso3D
 				// If octant is occluded, issue query if not pending, and do not process further this frame
 				case VIS_OCCLUDED:
 					AddOcclusionQuery(octant, result, planeMask);
+					++result.numOccludedOctants;
 					return;
 
 					// If octant was occluded previously, but its parent came into view, issue tests along the hierarchy but do not render on this frame
 				case VIS_OCCLUDED_UNKNOWN:
 					AddOcclusionQuery(octant, result, planeMask);
+					++result.numOccludedOctants;
 					if (octant != octree->Root() && octant->HasChildren()) {
 						for (size_t i = 0; i < NUM_OCTANTS; ++i) {
 							if (octant->Child(i)) {
@@ -603,6 +755,8 @@ namespace Turso3D
 			octant->SetVisibility(VIS_VISIBLE_UNKNOWN, false);
 		}
 
+		++result.numOctants;
+
 		const std::vector<Drawable*>& drawables = octant->Drawables();
 		for (size_t i = 0; i < drawables.size(); ++i) {
 			Drawable* drawable = drawables[i];
@@ -611,6 +765,8 @@ namespace Turso3D
 				const BoundingBox& lightBox = drawable->WorldBoundingBox();
 				if ((drawable->ViewMask() & viewMask) && (!planeMask || frustum.IsInsideMaskedFast(lightBox, planeMask)) && drawable->OnPrepareRender(frameNumber, camera)) {
 					result.lights.push_back(static_cast<LightDrawable*>(drawable));
+				} else {
+					++result.numCulledLights;
 				}
 			} else {
 				// Lights are sorted first in octants, so break when first geometry encountered. Store the octant for batch collecting
@@ -693,6 +849,8 @@ namespace Turso3D
 
 	void Renderer::SortMainBatches()
 	{
+		TURSO3D_PROFILE("Renderer::SortMainBatches");
+
 		// Shadowcaster processing needs accurate scene min / max Z results, combine them from per-thread data
 		for (size_t i = 0; i < workQueue->NumThreads(); ++i) {
 			ThreadBatchResult& res = batchResults[i];
@@ -714,17 +872,33 @@ namespace Turso3D
 			if (res.opaqueBatches.size()) {
 				opaqueBatches.batches.insert(opaqueBatches.batches.end(), res.opaqueBatches.begin(), res.opaqueBatches.end());
 			}
+			if (res.prePassOpaqueBatches.size()) {
+				prePassOpaqueBatches.batches.insert(prePassOpaqueBatches.batches.end(), res.prePassOpaqueBatches.begin(), res.prePassOpaqueBatches.end());
+			}
 			if (res.alphaBatches.size()) {
 				alphaBatches.batches.insert(alphaBatches.batches.end(), res.alphaBatches.begin(), res.alphaBatches.end());
 			}
 		}
 
-		opaqueBatches.Sort(BatchSortMode::StateDistance, true);
-		alphaBatches.Sort(BatchSortMode::Distance, true);
+		// Depth pre-pass renders the same geometries with their materials' depth-only (shadow) pass
+		if (prePassOpaqueBatches.HasBatches()) {
+			depthPrePassBatches.batches = prePassOpaqueBatches.batches;
+			for (size_t i = 0; i < depthPrePassBatches.batches.size(); ++i) {
+				Batch& batch = depthPrePassBatches.batches[i];
+				batch.pass = batch.pass->Parent()->GetPass(PASS_SHADOW);
+			}
+			depthPrePassBatches.Sort(BatchSortMode::State, true, maxInstancedSkinBones);
+			prePassOpaqueBatches.Sort(BatchSortMode::StateDistance, true, maxInstancedSkinBones);
+		}
+
+		opaqueBatches.Sort(BatchSortMode::StateDistance, true, maxInstancedSkinBones);
+		alphaBatches.Sort(BatchSortMode::Distance, true, maxInstancedSkinBones);
 	}
 
 	void Renderer::SortShadowBatches(ShadowMap& shadowMap)
 	{
+		TURSO3D_PROFILE("Renderer::SortShadowBatches");
+
 		for (size_t i = 0; i < shadowMap.shadowViews.size(); ++i) {
 			ShadowView& view = *shadowMap.shadowViews[i];
 			LightDrawable* light = view.light;
@@ -738,11 +912,11 @@ namespace Turso3D
 			BatchQueue* destDynamic = &shadowMap.shadowBatches[view.dynamicQueueIdx];
 
 			if (destStatic && destStatic->HasBatches()) {
-				destStatic->Sort(BatchSortMode::State, true);
+				destStatic->Sort(BatchSortMode::State, true, maxInstancedSkinBones);
 			}
 
 			if (destDynamic->HasBatches()) {
-				destDynamic->Sort(BatchSortMode::State, true);
+				destDynamic->Sort(BatchSortMode::State, true, maxInstancedSkinBones);
 			}
 		}
 	}
@@ -760,8 +934,13 @@ namespace Turso3D
 		lightDataBuffer->SetData(0, (lights.size() + 1) * sizeof(LightData), lightData.get());
 	}
 
-	void Renderer::RenderBatches(Camera* camera_, const BatchQueue& queue)
+	void Renderer::RenderBatches(Camera* camera_, const BatchQueue& queue, bool depthEqual)
 	{
+		TURSO3D_PROFILE("Renderer::RenderBatches");
+		TURSO3D_PROFILE_COUNTER("Batches", queue.batches.size());
+
+		GraphicsStats startStats = Graphics::Stats();
+
 		lastMaterial = nullptr;
 		lastPass = nullptr;
 
@@ -774,6 +953,7 @@ namespace Turso3D
 			perViewData.viewProjMatrix = perViewData.projectionMatrix * perViewData.viewMatrix;
 			perViewData.depthParameters = Vector4(nearClip, farClip, camera_->IsOrthographic() ? 0.5f : 0.0f, camera_->IsOrthographic() ? 0.5f : 1.0f / farClip);
 			perViewData.cameraPosition = Vector4(camera_->WorldPosition(), 1.0f);
+			perViewData.timeParameters = Vector4(static_cast<float>(animationTime), 0.0f, 0.0f, 0.0f);
 
 			size_t dataSize = sizeof(PerViewUniforms);
 
@@ -820,18 +1000,53 @@ namespace Turso3D
 
 		const std::vector<Batch>& batches = queue.batches;
 
-		// Update batch instance transforms
+		// Update batch instance transforms, baked animation instances and skinned instance offsets
 		instanceTransforms.clear();
+		bakedInstances.clear();
+		skinInstanceOffsets.clear();
+		skinInstanceRanges.clear();
 		for (size_t i = 0; i < batches.size(); ++i) {
 			const Batch& batch = batches[i];
 			if (batch.type != BatchType::Instanced) {
 				continue;
 			}
-			batch.instanceStart = instanceTransforms.size();
 
-			instanceTransforms.push_back(batch.drawable->WorldTransform());
-			for (size_t j = 1; j < batch.instanceCount; ++j) {
-				instanceTransforms.push_back(*batches[i + j].worldTransform);
+			if (batch.drawable->Flags() & Drawable::FLAG_SKINNED_GEOMETRY) {
+				// Split the instances into ranges of the skin matrix buffer that fit the shader's skin matrix array
+				batch.instanceStart = skinInstanceRanges.size();
+				SkinInstanceRange* range = nullptr;
+
+				for (size_t j = 0; j < batch.instanceCount; ++j) {
+					SkinnedModelDrawable* drawable = static_cast<SkinnedModelDrawable*>(batches[i + j].drawable);
+					size_t offset = SkinMatrixOffset(drawable);
+					size_t numMatrices = drawable->SkinMatrices() ? drawable->Bones().size() : 0;
+					// Guaranteed by the batch sorting, which does not instance skinned geometry with more bones
+					assert(numMatrices + skinMatrixAlignment <= MAX_INSTANCED_SKIN_MATRICES);
+
+					if (!range || offset < range->matrixStart || offset + numMatrices > range->matrixStart + MAX_INSTANCED_SKIN_MATRICES) {
+						range = &skinInstanceRanges.emplace_back();
+						range->instanceStart = skinInstanceOffsets.size();
+						range->instanceCount = 0;
+						range->matrixStart = offset - offset % skinMatrixAlignment;
+					}
+
+					skinInstanceOffsets.push_back(static_cast<float>(offset - range->matrixStart));
+					++range->instanceCount;
+				}
+			} else if (batch.drawable->TestFlag(Drawable::FLAG_BAKED_ANIMATION)) {
+				batch.instanceStart = bakedInstances.size();
+
+				for (size_t j = 0; j < batch.instanceCount; ++j) {
+					BakedAnimatedModelDrawable* drawable = static_cast<BakedAnimatedModelDrawable*>(batches[i + j].drawable);
+					bakedInstances.push_back(BakedAnimationInstance {drawable->WorldTransform(), drawable->PlaybackData()});
+				}
+			} else {
+				batch.instanceStart = instanceTransforms.size();
+
+				instanceTransforms.push_back(batch.drawable->WorldTransform());
+				for (size_t j = 1; j < batch.instanceCount; ++j) {
+					instanceTransforms.push_back(*batches[i + j].worldTransform);
+				}
 			}
 
 			i += batch.instanceCount - 1;
@@ -841,6 +1056,21 @@ namespace Turso3D
 		} else {
 			instanceVertexBuffer->SetData(0, instanceTransforms.size(), instanceTransforms.data());
 		}
+		if (bakedInstances.size()) {
+			if (bakedInstances.size() > bakedInstanceVertexBuffer->NumVertices()) {
+				bakedInstanceVertexBuffer->Define(USAGE_DYNAMIC, bakedInstances.size(), BakedInstanceVertexElements, 4, bakedInstances.data());
+			} else {
+				bakedInstanceVertexBuffer->SetData(0, bakedInstances.size(), bakedInstances.data());
+			}
+		}
+		if (skinInstanceOffsets.size()) {
+			if (skinInstanceOffsets.size() > skinInstanceVertexBuffer->NumVertices()) {
+				skinInstanceVertexBuffer->Define(USAGE_DYNAMIC, skinInstanceOffsets.size(), SkinInstanceVertexElements, 1, skinInstanceOffsets.data());
+			} else {
+				skinInstanceVertexBuffer->SetData(0, skinInstanceOffsets.size(), skinInstanceOffsets.data());
+			}
+			UploadSkinMatrices();
+		}
 
 		// Render batches
 		for (size_t i = 0; i < batches.size(); ++i) {
@@ -853,7 +1083,11 @@ namespace Turso3D
 			{
 				Pass::GeometryPermutation gp = Pass::GeometryPermutation::None;
 				if (batch.type == BatchType::Instanced) {
-					gp = Pass::GeometryPermutation::Instanced;
+					if (batch.drawable->TestFlag(Drawable::FLAG_BAKED_ANIMATION)) {
+						gp = Pass::GeometryPermutation::BakedAnimation;
+					} else {
+						gp = (batch.drawable->Flags() & Drawable::FLAG_SKINNED_GEOMETRY) ? Pass::GeometryPermutation::SkinnedInstanced : Pass::GeometryPermutation::Instanced;
+					}
 				} else if (batch.drawable->Flags() & Drawable::FLAG_SKINNED_GEOMETRY) {
 					gp = Pass::GeometryPermutation::Skinned;
 				}
@@ -897,49 +1131,141 @@ namespace Turso3D
 					}
 				}
 
-				Graphics::SetRenderState(batch.pass->GetBlendMode(), cullMode, batch.pass->GetDepthTest(), batch.pass->GetColorWrite(), batch.pass->GetDepthWrite());
+				if (depthEqual) {
+					Graphics::SetRenderState(batch.pass->GetBlendMode(), cullMode, CMP_EQUAL, batch.pass->GetColorWrite(), false);
+				} else {
+					Graphics::SetRenderState(batch.pass->GetBlendMode(), cullMode, batch.pass->GetDepthTest(), batch.pass->GetColorWrite(), batch.pass->GetDepthWrite());
+				}
 				lastPass = batch.pass;
 			}
 
 			Geometry* geometry = batch.geometry;
-			bool instanced = (batch.type == BatchType::Instanced);
-
-			// Bind vertex buffers
-			const VertexBufferBinding bindings[] = {
-				{geometry->vertexBuffer.get()},
-				{instanceVertexBuffer.get(), batch.instanceStart, 1, instanced}
-			};
-			Graphics::BindVertexBuffers(bindings, 2);
-
-			// Bind index buffer
-			IndexBuffer* ib = geometry->indexBuffer.get();
-			if (ib) {
-				Graphics::BindIndexBuffer(ib);
-			}
 
 			if (light_mask) {
 				program->SetUniform(U_LIGHTMASK, light_mask);
 			}
 
-			if (instanced) {
-				if (ib) {
-					Graphics::DrawIndexedInstanced(PT_TRIANGLE_LIST, geometry->drawStart, geometry->drawCount, batch.instanceCount);
+			if (batch.type == BatchType::Instanced) {
+				if (batch.drawable->Flags() & Drawable::FLAG_SKINNED_GEOMETRY) {
+					const SkinInstanceRange* range = &skinInstanceRanges[batch.instanceStart];
+					for (size_t drawn = 0; drawn < batch.instanceCount; drawn += range->instanceCount, ++range) {
+						Graphics::BindUniformBuffer(UB_OBJECTDATA, skinMatrixBuffer.get(), range->matrixStart * sizeof(Matrix3x4), MAX_INSTANCED_SKIN_MATRICES * sizeof(Matrix3x4));
+						BindGeometry(geometry, skinInstanceVertexBuffer.get(), range->instanceStart);
+						DrawGeometry(geometry, range->instanceCount);
+					}
+				} else if (batch.drawable->TestFlag(Drawable::FLAG_BAKED_ANIMATION)) {
+					// Instances without a baked texture have no skin to render
+					AnimationTexture* animationTexture = static_cast<BakedAnimatedModelDrawable*>(batch.drawable)->GetAnimationTexture();
+					if (animationTexture && animationTexture->GetTexture()) {
+						Graphics::BindTexture(TU_ANIMATION, animationTexture->GetTexture());
+						BindGeometry(geometry, bakedInstanceVertexBuffer.get(), batch.instanceStart);
+						DrawGeometry(geometry, batch.instanceCount);
+					}
 				} else {
-					Graphics::DrawInstanced(PT_TRIANGLE_LIST, geometry->drawStart, geometry->drawCount, batch.instanceCount);
+					BindGeometry(geometry, instanceVertexBuffer.get(), batch.instanceStart);
+					DrawGeometry(geometry, batch.instanceCount);
 				}
 				i += batch.instanceCount - 1;
 
 			} else {
+				BindGeometry(geometry, nullptr, 0);
+
 				if (batch.type == BatchType::Static) {
 					program->SetUniform(U_WORLDMATRIX, *batch.worldTransform);
 				} else {
 					batch.drawable->OnRender(program, batch.geomIndex);
 				}
 
-				if (ib) {
-					Graphics::DrawIndexed(PT_TRIANGLE_LIST, geometry->drawStart, geometry->drawCount);
-				} else {
-					Graphics::Draw(PT_TRIANGLE_LIST, geometry->drawStart, geometry->drawCount);
+				DrawGeometry(geometry, 0);
+			}
+		}
+
+		AccumulateGraphicsStats(startStats);
+	}
+
+	void Renderer::AccumulateGraphicsStats(const GraphicsStats& start)
+	{
+		const GraphicsStats& current = Graphics::Stats();
+		stats.drawCalls += current.drawCalls - start.drawCalls;
+		stats.instances += current.instances - start.instances;
+		stats.triangles += current.primitives - start.primitives;
+		stats.programSwitches += current.programSwitches - start.programSwitches;
+		stats.textureSwitches += current.textureSwitches - start.textureSwitches;
+		stats.vaoSwitches += current.vaoSwitches - start.vaoSwitches;
+	}
+
+	size_t Renderer::SkinMatrixOffset(SkinnedModelDrawable* drawable)
+	{
+		size_t offset = drawable->SkinMatrixOffset(frameNumber);
+		if (offset == SkinnedModelDrawable::NO_SKIN_MATRIX_OFFSET) {
+			offset = skinMatrices.size();
+			if (const Matrix3x4* src = drawable->SkinMatrices()) {
+				skinMatrices.insert(skinMatrices.end(), src, src + drawable->Bones().size());
+			}
+			drawable->SetSkinMatrixOffset(offset, frameNumber);
+		}
+		return offset;
+	}
+
+	void Renderer::UploadSkinMatrices()
+	{
+		if (numUploadedSkinMatrices == skinMatrices.size()) {
+			return;
+		}
+
+		// Leave space for a full range after the last matrix, so that every bound range stays inside the buffer
+		size_t requiredSize = (skinMatrices.size() + MAX_INSTANCED_SKIN_MATRICES) * sizeof(Matrix3x4);
+		if (requiredSize > skinMatrixBuffer->Size()) {
+			skinMatrixBuffer->Define(USAGE_DYNAMIC, std::max(requiredSize, skinMatrixBuffer->Size() * 2));
+			numUploadedSkinMatrices = 0;
+		}
+
+		skinMatrixBuffer->SetData(numUploadedSkinMatrices * sizeof(Matrix3x4), (skinMatrices.size() - numUploadedSkinMatrices) * sizeof(Matrix3x4), &skinMatrices[numUploadedSkinMatrices]);
+		numUploadedSkinMatrices = skinMatrices.size();
+	}
+
+	void Renderer::CollectStats()
+	{
+		for (size_t i = 0; i < rootLevelOctants.size(); ++i) {
+			const ThreadOctantResult& result = octantResults[i];
+			stats.octants += result.numOctants;
+			stats.occludedOctants += result.numOccludedOctants;
+			stats.culledLights += result.numCulledLights;
+		}
+		for (size_t i = 0; i < workQueue->NumThreads(); ++i) {
+			stats.drawables += batchResults[i].numDrawables;
+		}
+
+		const OctreeStats& octreeStats = octree->Stats();
+		stats.updatedDrawables = octreeStats.updatedDrawables;
+		stats.keptDrawables = octreeStats.keptInFatBounds + octreeStats.keptInOctant;
+		stats.reinsertedDrawables = octreeStats.reinsertedDrawables;
+		stats.animatedDrawables = octreeStats.animatedDrawables;
+		stats.poseCacheHits = octreeStats.poseCacheHits;
+		stats.poseCacheMisses = octreeStats.poseCacheMisses;
+
+		stats.lights = lights.size() + (dirLight ? 1 : 0);
+		stats.opaqueBatches = opaqueBatches.batches.size() + prePassOpaqueBatches.batches.size();
+		stats.opaqueDrawBatches = opaqueBatches.NumDrawCalls() + prePassOpaqueBatches.NumDrawCalls();
+		stats.depthPrePassBatches = depthPrePassBatches.batches.size();
+		stats.depthPrePassDrawBatches = depthPrePassBatches.NumDrawCalls();
+		stats.alphaBatches = alphaBatches.batches.size();
+		stats.alphaDrawBatches = alphaBatches.NumDrawCalls();
+
+		if (shadowMaps) {
+			for (size_t i = 0; i < NUM_SHADOW_MAPS; ++i) {
+				const ShadowMap& shadowMap = shadowMaps[i];
+				for (size_t j = 0; j < shadowMap.shadowBatches.size(); ++j) {
+					stats.shadowBatches += shadowMap.shadowBatches[j].batches.size();
+					stats.shadowDrawBatches += shadowMap.shadowBatches[j].NumDrawCalls();
+				}
+				for (size_t j = 0; j < shadowMap.shadowViews.size(); ++j) {
+					const ShadowView* view = shadowMap.shadowViews[j];
+					if (view->light && view->renderMode != RENDER_STATIC_LIGHT_CACHED) {
+						++stats.shadowViewsRendered;
+					} else {
+						++stats.shadowViewsSkipped;
+					}
 				}
 			}
 		}
@@ -965,6 +1291,7 @@ namespace Turso3D
 		if (!boundingBoxShaderProgram) {
 			return;
 		}
+		GraphicsStats startStats = Graphics::Stats();
 		Graphics::BindProgram(boundingBoxShaderProgram.get());
 
 		Matrix3x4 boxMatrix {Matrix3x4::IDENTITY()};
@@ -1013,10 +1340,12 @@ namespace Turso3D
 
 				// Remember query in octant to not re-test it until result arrives
 				octant->OnOcclusionQuery(queryId);
+				++stats.occlusionQueries;
 			}
 		}
 
 		previousCameraPosition = cameraPosition;
+		AccumulateGraphicsStats(startStats);
 	}
 
 	void Renderer::DefineFaceSelectionTextures()
@@ -1205,6 +1534,7 @@ namespace Turso3D
 
 		// Clamp to maximum supported
 		if (lights.size() > MAX_LIGHTS) {
+			stats.culledLights += lights.size() - MAX_LIGHTS;
 			lights.resize(MAX_LIGHTS);
 		}
 
@@ -1337,6 +1667,7 @@ namespace Turso3D
 
 		std::vector<std::pair<Octant*, unsigned char>>& octants = task->octants;
 		std::vector<Batch>& opaqueQueue = threaded ? result.opaqueBatches : opaqueBatches.batches;
+		std::vector<Batch>& prePassQueue = threaded ? result.prePassOpaqueBatches : prePassOpaqueBatches.batches;
 		std::vector<Batch>& alphaQueue = threaded ? result.alphaBatches : alphaBatches.batches;
 
 		const Matrix3x4& viewMatrix = camera->ViewMatrix();
@@ -1344,71 +1675,104 @@ namespace Turso3D
 		Vector3 absViewZ = viewZ.Abs();
 		float farClipMul = 32767.0f / camera->FarClip();
 
+		// Screen coverage of a bounding sphere is approximated as its projected ellipse area relative to the NDC area (4)
+		Matrix4 projection = camera->ProjectionMatrix(false);
+		float coverageMul = 0.25f * M_PI * projection.m00 * projection.m11;
+		bool orthographic = camera->IsOrthographic();
+		Vector3 cameraPosition = camera->WorldPosition();
+
 		// Scan octants for geometries
 		for (size_t i = 0; i < octants.size(); ++i) {
 			Octant* octant = octants[i].first;
 			unsigned char planeMask = octants[i].second;
 
+			// Cull using the octant's culling data first, so that only the drawables which pass are accessed
+			octant->CullDrawables(result.visibleDrawables, frustum, planeMask, cameraPosition, Drawable::FLAG_GEOMETRY, viewMask);
+
 			const std::vector<Drawable*>& drawables = octant->Drawables();
-			for (size_t j = 0; j < drawables.size(); ++j) {
-				Drawable* drawable = drawables[j];
+			for (size_t k = 0; k < result.visibleDrawables.size(); ++k) {
+				Drawable* drawable = drawables[result.visibleDrawables[k]];
 
-				if (drawable->TestFlag(Drawable::FLAG_GEOMETRY) && (drawable->ViewMask() & viewMask)) {
+				// Note: to strike a balance between performance and occlusion accuracy, per-geometry occlusion tests are skipped for now,
+				// as octants are already tested with combined actual drawable bounds
+				if (drawable->OnPrepareRender(frameNumber, camera)) {
 					const BoundingBox& geometryBox = drawable->WorldBoundingBox();
 
-					// Note: to strike a balance between performance and occlusion accuracy, per-geometry occlusion tests are skipped for now,
-					// as octants are already tested with combined actual drawable bounds
-					if ((!planeMask || frustum.IsInsideMaskedFast(geometryBox, planeMask)) && drawable->OnPrepareRender(frameNumber, camera)) {
-						result.geometryBounds.Merge(geometryBox);
+					++result.numDrawables;
+					result.geometryBounds.Merge(geometryBox);
 
-						Vector3 center = geometryBox.Center();
-						Vector3 edge = geometryBox.Size() * 0.5f;
+					Vector3 center = geometryBox.Center();
+					Vector3 edge = geometryBox.Size() * 0.5f;
 
-						float viewCenterZ = viewZ.DotProduct(center) + viewMatrix.m23;
-						float viewEdgeZ = std::max(absViewZ.DotProduct(edge), 0.01f);
-						result.minZ = std::min(result.minZ, viewCenterZ - viewEdgeZ);
-						result.maxZ = std::max(result.maxZ, viewCenterZ + viewEdgeZ);
+					float viewCenterZ = viewZ.DotProduct(center) + viewMatrix.m23;
+					float viewEdgeZ = std::max(absViewZ.DotProduct(edge), 0.01f);
+					result.minZ = std::min(result.minZ, viewCenterZ - viewEdgeZ);
+					result.maxZ = std::max(result.maxZ, viewCenterZ + viewEdgeZ);
 
-						Batch newBatch;
+					bool largeOnScreen = false;
+					if (depthPrePass) {
+						float radius = edge.Length();
+						float z = orthographic ? 1.0f : std::max(viewCenterZ, M_EPSILON);
+						largeOnScreen = coverageMul * radius * radius / (z * z) >= depthPrePassMinCoverage;
+					}
 
-						unsigned distance = static_cast<unsigned>(drawable->Distance() * farClipMul);
-						const SourceBatches& batches = static_cast<GeometryDrawable*>(drawable)->Batches();
-						size_t numGeometries = batches.NumGeometries();
+					Batch newBatch;
 
-						for (size_t j = 0; j < numGeometries; ++j) {
-							Material* material = batches.GetMaterial(j).get();
+					unsigned distance = static_cast<unsigned>(drawable->Distance() * farClipMul);
 
-							// Assume opaque first
-							newBatch.pass = material->GetPass(PASS_OPAQUE);
-							newBatch.geometry = batches.GetGeometry(j);
-							newBatch.drawable = static_cast<GeometryDrawable*>(drawable);
-							newBatch.geomIndex = j;
+					// Distant static models may be replaced by a single imposter quad, which gets instanced with the others of the same imposter
+					if (drawable->TestFlag(Drawable::FLAG_USE_IMPOSTER)) {
+						Imposter* imposter = static_cast<StaticModelDrawable*>(drawable)->GetImposter();
 
-							newBatch.type = drawable->IsGeometryStatic() ? BatchType::Static : BatchType::Complex;
-							if (newBatch.type == BatchType::Static) {
-								newBatch.worldTransform = &drawable->WorldTransform();
-							}
+						newBatch.pass = imposter->GetMaterial()->GetPass(PASS_OPAQUE);
+						newBatch.geometry = imposter->GetGeometry().get();
+						newBatch.drawable = static_cast<GeometryDrawable*>(drawable);
+						newBatch.geomIndex = 0;
+						newBatch.type = BatchType::Static;
+						newBatch.worldTransform = &drawable->WorldTransform();
 
-							if (newBatch.pass) {
-								// Perform distance sort in addition to state sort
-								if (newBatch.pass->lastSortKey.first != frameNumber || newBatch.pass->lastSortKey.second > distance) {
-									newBatch.pass->lastSortKey.first = frameNumber;
-									newBatch.pass->lastSortKey.second = distance;
-								}
-								if (newBatch.geometry->lastSortKey.first != frameNumber || newBatch.geometry->lastSortKey.second > distance + static_cast<unsigned>(j)) {
-									newBatch.geometry->lastSortKey.first = frameNumber;
-									newBatch.geometry->lastSortKey.second = distance + static_cast<unsigned>(j);
-								}
-								opaqueQueue.push_back(newBatch);
+						UpdateSortKey(newBatch.pass->lastSortKey, frameNumber, distance);
+						UpdateSortKey(newBatch.geometry->lastSortKey, frameNumber, distance);
+						opaqueQueue.push_back(newBatch);
+						continue;
+					}
+
+					const SourceBatches& batches = static_cast<GeometryDrawable*>(drawable)->Batches();
+					size_t numGeometries = batches.NumGeometries();
+
+					for (size_t j = 0; j < numGeometries; ++j) {
+						Material* material = batches.GetMaterial(j).get();
+
+						// Assume opaque first
+						newBatch.pass = material->GetPass(PASS_OPAQUE);
+						newBatch.geometry = batches.GetGeometry(j);
+						newBatch.drawable = static_cast<GeometryDrawable*>(drawable);
+						newBatch.geomIndex = j;
+
+						newBatch.type = drawable->IsGeometryStatic() ? BatchType::Static : BatchType::Complex;
+						if (newBatch.type == BatchType::Static) {
+							newBatch.worldTransform = &drawable->WorldTransform();
+						}
+
+						if (newBatch.pass) {
+							// Perform distance sort in addition to state sort
+							UpdateSortKey(newBatch.pass->lastSortKey, frameNumber, distance);
+							UpdateSortKey(newBatch.geometry->lastSortKey, frameNumber, distance + static_cast<unsigned>(j));
+							// The depth pre-pass needs a depth-only pass to render with. Alpha masked passes are left out, as the depth-only pass may not discard
+							// the same fragments, which would fail the equal depth test of the opaque pass
+							if (largeOnScreen && !newBatch.pass->IsAlphaMasked() && material->GetPass(PASS_SHADOW)) {
+								prePassQueue.push_back(newBatch);
 							} else {
-								// If not opaque, try transparent
-								newBatch.pass = material->GetPass(PASS_ALPHA);
-								if (!newBatch.pass) {
-									continue;
-								}
-								newBatch.distance = drawable->Distance();
-								alphaQueue.push_back(newBatch);
+								opaqueQueue.push_back(newBatch);
+							}
+						} else {
+							// If not opaque, try transparent
+							newBatch.pass = material->GetPass(PASS_ALPHA);
+							if (!newBatch.pass) {
+								continue;
 							}
+							newBatch.distance = drawable->Distance();
+							alphaQueue.push_back(newBatch);
 						}
 					}
 				}
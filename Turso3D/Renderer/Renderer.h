@@ -23,11 +23,13 @@ namespace Turso3D
 	class RenderBuffer;
 	class Scene;
 	class ShaderProgram;
+	class SkinnedModelDrawable;
 	class Texture;
 	class UniformBuffer;
 	class VertexBuffer;
 	class IndexBuffer;
 	class WorkQueue;
+	struct GraphicsStats;
 	struct OcclusionQueryResult;
 	struct CollectOctantsTask;
 	struct CollectBatchesTask;
@@ -55,6 +57,7 @@ namespace Turso3D
 	constexpr size_t TU_IBL_IEM = 12;
 	constexpr size_t TU_IBL_PMREM = 13;
 	constexpr size_t TU_IBL_BRDFLUT = 14;
+	constexpr size_t TU_ANIMATION = 15;
 
 	// Per-thread results for octant collection.
 	struct ThreadOctantResult
@@ -69,6 +72,12 @@ namespace Turso3D
 		size_t taskOctantIdx;
 		// Batch collection task index.
 		size_t batchTaskIdx;
+		// Number of visible octants.
+		size_t numOctants;
+		// Number of octants skipped as occluded.
+		size_t numOccludedOctants;
+		// Number of lights rejected by the view mask, frustum or prepare test.
+		size_t numCulledLights;
 		// Intermediate octant list.
 		std::vector<std::pair<Octant*, unsigned char>> octants;
 		// Intermediate light drawable list.
@@ -91,10 +100,36 @@ namespace Turso3D
 		float maxZ;
 		// Combined bounding box of the visible geometries.
 		BoundingBox geometryBounds;
+		// Number of visible geometry drawables.
+		size_t numDrawables;
 		// Initial opaque batches.
 		std::vector<Batch> opaqueBatches;
+		// Initial opaque batches which are included in the depth pre-pass.
+		std::vector<Batch> prePassOpaqueBatches;
 		// Initial alpha batches.
 		std::vector<Batch> alphaBatches;
+		// Indices of the drawables that passed culling in the octant being processed.
+		std::vector<unsigned> visibleDrawables;
+	};
+
+	// Instances of a skinned batch drawn with one range of the shared skin matrix buffer.
+	struct SkinInstanceRange
+	{
+		// Start position in the skin instance vertex buffer.
+		size_t instanceStart;
+		// Number of instances.
+		size_t instanceCount;
+		// Index of the first skin matrix in the bound range.
+		size_t matrixStart;
+	};
+
+	// Instance data of a baked animation batch.
+	struct BakedAnimationInstance
+	{
+		// World transform.
+		Matrix3x4 worldTransform;
+		// Playback parameters.
+		Vector4 playback;
 	};
 
 	// Shadow map data structure.
@@ -142,6 +177,8 @@ namespace Turso3D
 		Color ambientColor;
 		// IBL parameters.
 		Vector4 iblParameters;
+		// Time parameters for GPU animation.
+		Vector4 timeParameters;
 		// Directional light direction.
 		Vector4 dirLightDirection;
 		// Directional light color.
@@ -184,6 +221,80 @@ namespace Turso3D
 		unsigned char numLights;
 	};
 
+	// Per-frame renderer statistics.
+	// View preparation counts and times are reset by PrepareView(). Rendering counts also include the following shadow map, opaque and alpha rendering.
+	struct RendererStats
+	{
+		// Visible octants.
+		size_t octants;
+		// Visible geometry drawables.
+		size_t drawables;
+		// Accepted lights, including the directional light.
+		size_t lights;
+		// Lights rejected by the view mask or frustum tests, or over the maximum light count.
+		size_t culledLights;
+		// Opaque batches before instancing conversion, including the depth pre-pass opaque batches.
+		size_t opaqueBatches;
+		// Opaque batches after instancing conversion.
+		size_t opaqueDrawBatches;
+		// Depth pre-pass batches before instancing conversion.
+		size_t depthPrePassBatches;
+		// Depth pre-pass batches after instancing conversion.
+		size_t depthPrePassDrawBatches;
+		// Alpha batches before instancing conversion.
+		size_t alphaBatches;
+		// Alpha batches after instancing conversion.
+		size_t alphaDrawBatches;
+		// Shadow batches before instancing conversion.
+		size_t shadowBatches;
+		// Shadow batches after instancing conversion.
+		size_t shadowDrawBatches;
+		// Shadow views rendered.
+		size_t shadowViewsRendered;
+		// Shadow views skipped, either cached or not in view.
+		size_t shadowViewsSkipped;
+		// Occlusion queries issued.
+		size_t occlusionQueries;
+		// Octants skipped as occluded.
+		size_t occludedOctants;
+		// Moved drawables checked by the octree update.
+		size_t updatedDrawables;
+		// Moved drawables kept in their octant, either by their fattened bounds or the octant's fitting box.
+		size_t keptDrawables;
+		// Drawables inserted or moved to a different octant by the octree update.
+		size_t reinsertedDrawables;
+		// Drawables whose animation and skinning were updated by the octree update.
+		size_t animatedDrawables;
+		// Animated drawables that took their pose from the pose cache in the octree update.
+		size_t poseCacheHits;
+		// Animated drawables with pose sharing that evaluated their pose in the octree update.
+		size_t poseCacheMisses;
+
+		// Draw calls, including occlusion queries.
+		size_t drawCalls;
+		// Rendered instances.
+		size_t instances;
+		// Rendered triangles.
+		size_t triangles;
+		// Shader program changes.
+		size_t programSwitches;
+		// Texture binding changes.
+		size_t textureSwitches;
+		// Vertex array object changes.
+		size_t vaoSwitches;
+
+		// CPU time in milliseconds of the octree update and occlusion query result check.
+		float octreeUpdateTime;
+		// CPU time in milliseconds of octant, light and batch collection until the main batches can be sorted.
+		float collectTime;
+		// CPU time in milliseconds of the main batch sorting.
+		float sortTime;
+		// CPU time in milliseconds of the remaining shadow and light culling tasks.
+		float shadowTime;
+		// Total CPU time in milliseconds of PrepareView().
+		float prepareViewTime;
+	};
+
 	// High-level rendering subsystem.
 	// Performs rendering of 3D scenes.
 	class Renderer
@@ -199,11 +310,16 @@ namespace Turso3D
 		void SetupShadowMaps(int dirLightSize, int lightAtlasSize, ImageFormat format);
 		// Set global depth bias multipiers for shadow maps.
 		void SetShadowDepthBiasMul(float depthBiasMul, float slopeScaleBiasMul);
+		// Set whether to render a depth pre-pass before opaque geometries.
+		// Only geometries with a shadow pass and an estimated screen coverage (0-1) of at least minScreenCoverage are included,
+		// these are then rendered with an equal depth test and no depth writes.
+		void SetDepthPrePass(bool enable, float minScreenCoverage = 0.01f);
 		// Prepare view for rendering. This will utilize worker threads.
 		void PrepareView(Scene* scene, Camera* camera, bool drawShadows, bool useOcclusion, float lastFrameTime);
 		// Render shadowmaps before rendering the view. Last shadow framebuffer will be left bound.
 		void RenderShadowMaps();
 		// Clear with fog color and far depth (optional), then render opaque objects into the currently set framebuffer and viewport.
+		// If the depth pre-pass is enabled, it is rendered first.
 		// If occlusion is used, occlusion queries will also be rendered.
 		void RenderOpaque(bool clear = true);
 		// Render transparent objects into the currently set framebuffer and viewport.
@@ -215,6 +331,18 @@ namespace Turso3D
 
 		// Return a shadow map texture by index for debugging.
 		Texture* ShadowMapTexture(size_t index) const;
+		// Return whether the depth pre-pass is enabled.
+		bool DepthPrePass() const { return depthPrePass; }
+		// Return the minimum screen coverage for geometries to be included in the depth pre-pass.
+		float DepthPrePassMinCoverage() const { return depthPrePassMinCoverage; }
+		// Return the statistics of the last prepared view.
+		const RendererStats& Stats() const { return stats; }
+		// Advance the animation time used by GPU animation. Call once per frame, also when preparing several views per frame.
+		void AdvanceAnimationTime(float timeStep) { animationTime += timeStep; }
+		// Set the animation time used by GPU animation, for example to restart it or to keep it small for float precision.
+		void SetAnimationTime(double time) { animationTime = time; }
+		// Return the animation time used by GPU animation.
+		double AnimationTime() const { return animationTime; }
 
 	private:
 		// Collect octants and lights from the octree recursively. Queue batch collection tasks while ongoing.
@@ -230,7 +358,16 @@ namespace Turso3D
 		// Upload light uniform buffer and cluster texture data.
 		void UpdateLightData();
 		// Render a batch queue.
-		void RenderBatches(Camera* camera, const BatchQueue& queue);
+		// With depthEqual the passes' depth state is overridden to an equal test without writes, for rendering after the depth pre-pass.
+		void RenderBatches(Camera* camera, const BatchQueue& queue, bool depthEqual = false);
+		// Add rendering counts since a Graphics statistics snapshot.
+		void AccumulateGraphicsStats(const GraphicsStats& start);
+		// Return the position of a drawable's skin matrices in the shared skin matrix buffer. Copies the matrices on the first call of the frame.
+		size_t SkinMatrixOffset(SkinnedModelDrawable* drawable);
+		// Upload the skin matrices added since the last upload to the shared skin matrix buffer.
+		void UploadSkinMatrices();
+		// Sum the per-thread and shadow map counts at the end of view preparation.
+		void CollectStats();
 		// Check occlusion query results and propagate visibility hierarchically.
 		void CheckOcclusionQueries();
 		// Render occlusion queries for octants.
@@ -280,6 +417,10 @@ namespace Turso3D
 		bool drawShadows;
 		// Occlusion use flag.
 		bool useOcclusion;
+		// Depth pre-pass use flag.
+		bool depthPrePass;
+		// Minimum estimated screen coverage for geometries to be included in the depth pre-pass.
+		float depthPrePassMinCoverage;
 		// Shadow maps globally dirty flag.
 		// All cached shadow content should be reset.
 		bool shadowMapsDirty;
@@ -289,6 +430,8 @@ namespace Turso3D
 		Vector3 previousCameraPosition;
 		// Last frame time for occlusion query staggering.
 		float lastFrameTime;
+		// Accumulated time for GPU animation.
+		double animationTime;
 		// Container for holding occlusion query results.
 		std::vector<OcclusionQueryResult> occlusionQueryResults;
 		// Root-level octants, used as a starting point for octant and batch collection.
@@ -318,6 +461,10 @@ namespace Turso3D
 		std::unique_ptr<ShadowMap[]> shadowMaps;
 		// Opaque batches.
 		BatchQueue opaqueBatches;
+		// Opaque batches rendered with an equal depth test after the depth pre-pass.
+		BatchQueue prePassOpaqueBatches;
+		// Depth-only batches of the depth pre-pass.
+		BatchQueue depthPrePassBatches;
 		// Transparent batches.
 		BatchQueue alphaBatches;
 		// Last camera used for rendering.
@@ -381,5 +528,28 @@ namespace Turso3D
 		std::unique_ptr<VertexBuffer> instanceVertexBuffer;
 		// Instance transforms for opaque and alpha batches.
 		std::vector<Matrix3x4> instanceTransforms;
+		// Baked animation instancing vertex buffer.
+		std::unique_ptr<VertexBuffer> bakedInstanceVertexBuffer;
+		// Instance data of baked animation batches.
+		std::vector<BakedAnimationInstance> bakedInstances;
+		// Skinned instancing vertex buffer.
+		std::unique_ptr<VertexBuffer> skinInstanceVertexBuffer;
+		// Skin matrix offsets of skinned instances, relative to the start of their skin matrix range.
+		std::vector<float> skinInstanceOffsets;
+		// Draw ranges of the skinned instanced batches.
+		std::vector<SkinInstanceRange> skinInstanceRanges;
+		// Skin matrices of all skinned drawables rendered on the frame, shared by all views.
+		std::unique_ptr<UniformBuffer> skinMatrixBuffer;
+		// Skin matrices for the shared buffer.
+		std::vector<Matrix3x4> skinMatrices;
+		// Number of skin matrices already uploaded on the frame.
+		size_t numUploadedSkinMatrices;
+		// Skin matrix range start alignment in matrices, derived from the uniform buffer offset alignment.
+		size_t skinMatrixAlignment;
+		// Maximum bone count of skinned geometry rendered instanced, so that its skin matrices fit an aligned range of the shader's skin matrix array.
+		size_t maxInstancedSkinBones;
+
+		// Statistics of the last prepared view.
+		RendererStats stats;
 	};
 }
@@ -18,9 +18,12 @@ namespace
 namespace Turso3D
 {
 	SkinnedModelDrawable::SkinnedModelDrawable() :
-		skinFlags(0)
+		skinFlags(0),
+		skinMatrixOffset(0),
+		skinMatrixFrameNumber(0),
+		skeletonSkinFrameNumber(0)
 	{
-		SetFlag(Drawable::FLAG_SKINNED_GEOMETRY | Drawable::FLAG_OCTREE_UPDATE_CALL, true);
+		SetFlag(Drawable::FLAG_SKINNED_GEOMETRY | Drawable::FLAG_ANIMATION_UPDATE_CALL, true);
 	}
 
 	SkinnedModelDrawable::~SkinnedModelDrawable()
@@ -72,13 +75,21 @@ namespace Turso3D
 		}
 	}
 
-	void SkinnedModelDrawable::OnOctreeUpdate(unsigned short frameNumber)
+	void SkinnedModelDrawable::OnAnimationUpdate(unsigned short frameNumber)
 	{
+		// Recalculating the bounding box from the bones also updates the bone world transforms for skinning
+		WorldBoundingBox();
+
 		if (skinFlags & FLAG_SKINNING_DIRTY) {
 			UpdateSkinning();
 		}
 	}
 
+	size_t SkinnedModelDrawable::AnimationUpdateCost(unsigned short frameNumber) const
+	{
+		return Bones().size() + 1;
+	}
+
 	bool SkinnedModelDrawable::OnPrepareRender(unsigned short frameNumber, Camera* camera)
 	{
 		if (!StaticModelDrawable::OnPrepareRender(frameNumber, camera)) {
@@ -91,10 +102,16 @@ namespace Turso3D
 	void SkinnedModelDrawable::OnRender(ShaderProgram* program, size_t geomIndex)
 	{
 		const std::vector<Bone*>& bones = Bones();
-		if (!skinMatrixBuffer || bones.empty()) {
+		if (!skinMatrices || bones.empty()) {
 			return;
 		}
 
+		if (!skinMatrixBuffer) {
+			skinMatrixBuffer = std::make_unique<UniformBuffer>();
+			skinMatrixBuffer->Define(USAGE_DYNAMIC, bones.size() * sizeof(Matrix3x4));
+			skinFlags |= FLAG_SKINNING_BUFFER_DIRTY;
+		}
+
 		if (skinFlags & FLAG_SKINNING_BUFFER_DIRTY) {
 			skinMatrixBuffer->SetData(0, bones.size() * sizeof(Matrix3x4), skinMatrices.get());
 			skinFlags &= ~FLAG_SKINNING_BUFFER_DIRTY;
@@ -207,6 +224,39 @@ namespace Turso3D
 		skinFlags |= FLAG_SKINNING_BUFFER_DIRTY;
 	}
 
+	bool SkinnedModelDrawable::UpdateSkinningFromSkeleton(const SkinnedModelDrawable* skeleton, unsigned short frameNumber)
+	{
+		if (skeletonBoneIndices.empty() || !skinMatrices || !skeleton->skinMatrices || (skeleton->skinFlags & FLAG_SKINNING_DIRTY)) {
+			return false;
+		}
+
+		// One transform from the skeleton owner's skin matrix space replaces walking the bones
+		const Matrix3x4& space = SkinningSpaceTransform() * skeleton->SkinningSpaceTransform().Inverse();
+		const Matrix3x4* source = skeleton->skinMatrices.get();
+
+		if (skeletonOffsetCorrections.empty()) {
+			for (size_t i = 0; i < skeletonBoneIndices.size(); ++i) {
+				skinMatrices[i] = space * source[skeletonBoneIndices[i]];
+			}
+		} else {
+			for (size_t i = 0; i < skeletonBoneIndices.size(); ++i) {
+				skinMatrices[i] = (space * source[skeletonBoneIndices[i]]) * skeletonOffsetCorrections[i];
+			}
+		}
+
+		// The flags are left for PrepareForRender(), as this is called from the skeleton owner's update task
+		skeletonSkinFrameNumber = frameNumber;
+		return true;
+	}
+
+	void SkinnedModelDrawable::OnOriginShift(const Vector3& offset)
+	{
+		StaticModelDrawable::OnOriginShift(offset);
+
+		// The skin matrices are in world space
+		skinFlags |= FLAG_SKINNING_DIRTY;
+	}
+
 	const std::vector<Bone*>& SkinnedModelDrawable::Bones() const
 	{
 		return static_cast<SkinnedModel*>(owner)->Bones();
@@ -220,15 +270,32 @@ namespace Turso3D
 	void SkinnedModelDrawable::PrepareForRender()
 	{
 		if (skinFlags & FLAG_SKINNING_DIRTY) {
-			UpdateSkinning();
+			// Skip if the skeleton owner already derived the skin matrices during this frame's octree update
+			if (!skeletonBoneIndices.empty() && skeletonSkinFrameNumber == lastFrameNumber) {
+				skinFlags &= ~FLAG_SKINNING_DIRTY;
+				skinFlags |= FLAG_SKINNING_BUFFER_DIRTY;
+			} else {
+				UpdateSkinning();
+			}
 		}
 	}
 
+	Matrix3x4 SkinnedModelDrawable::SkinningSpaceTransform() const
+	{
+		// Matches the additional transformations of UpdateSkinning()
+		const Bone* root_bone = RootBone();
+		if (owner->Parent() != root_bone->Parent()) {
+			return owner->WorldTransform() * root_bone->WorldTransform().Inverse();
+		}
+		return Matrix3x4::IDENTITY();
+	}
+
 	// ==========================================================================================
 	Bone::Bone() :
 		listener(nullptr),
 		animationEnabled(true),
-		numChildBones(0)
+		numChildBones(0),
+		index(0)
 	{
 		SetFlag(FLAG_BONE, true);
 	}
@@ -333,10 +400,9 @@ namespace Turso3D
 		const std::vector<ModelBone>& modelBones = drawable->model->Bones();
 		bones.resize(modelBones.size());
 
-		// Create matrices buffer
+		// Create matrices. The uniform buffer is created when first rendered without instancing
 		drawable->skinMatrices = std::make_unique<Matrix3x4[]>(bones.size());
-		drawable->skinMatrixBuffer = std::make_unique<UniformBuffer>();
-		drawable->skinMatrixBuffer->Define(USAGE_DYNAMIC, bones.size() * sizeof(Matrix3x4));
+		drawable->skinMatrixBuffer.reset();
 
 		for (size_t i = 0; i < modelBones.size(); ++i) {
 			const ModelBone& modelBone = modelBones[i];
@@ -346,6 +412,7 @@ namespace Turso3D
 				bones[i] = static_cast<Bone*>(existingBone);
 			} else {
 				bones[i] = new Bone();
+				bones[i]->SetIndex(i);
 				bones[i]->SetListener(root->Listener());
 				bones[i]->SetName(modelBone.name);
 				bones[i]->SetTransform(modelBone.position, modelBone.rotation, modelBone.scale);
@@ -407,6 +474,18 @@ namespace Turso3D
 		OnBoneTransformChanged(rootBone);
 	}
 
+	void SkinnedModel::SetSkeletonBoneMap(const std::vector<size_t>& boneIndices, const std::vector<Matrix3x4>& offsetCorrections)
+	{
+		SkinnedModelDrawable* drawable = GetDrawable();
+		drawable->skeletonBoneIndices = boneIndices;
+		drawable->skeletonOffsetCorrections = offsetCorrections;
+		drawable->skeletonSkinFrameNumber = 0;
+
+		// The skeleton owner updates the skin matrices in its animation update, so an own animation update is only needed without the bone remap
+		drawable->SetFlag(Drawable::FLAG_ANIMATION_UPDATE_CALL, boneIndices.empty());
+		SetSkinningDirty();
+	}
+
 	void SkinnedModel::OnTransformChanged()
 	{
 		SkinnedModelDrawable* drawable = GetDrawable();
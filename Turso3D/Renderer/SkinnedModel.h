@@ -23,31 +23,49 @@ namespace Turso3D
 			FLAG_BONE_BOUNDING_BOX_DIRTY = 0x4
 		};
 
+	public:
+		// Skin matrix offset value when not set on the frame.
+		static constexpr size_t NO_SKIN_MATRIX_OFFSET = ~static_cast<size_t>(0);
+
 	public:
 		SkinnedModelDrawable();
 		~SkinnedModelDrawable();
 
 		// Recalculate the world space bounding box.
 		void OnWorldBoundingBoxUpdate() const override;
-		// Do animation processing before octree reinsertion, if should update without regard to visibility.
-		// Called by Octree in worker threads. Must be opted-in by setting FLAG_OCTREE_UPDATE_CALL flag.
-		void OnOctreeUpdate(unsigned short frameNumber) override;
+		// Update bone world transforms, bone bounding box and skin matrices before octree reinsertion.
+		// Called by Octree in worker threads, if was in view last frame or should update without regard to visibility.
+		void OnAnimationUpdate(unsigned short frameNumber) override;
+		// Return the relative cost of the animation update.
+		size_t AnimationUpdateCost(unsigned short frameNumber) const override;
 		// Prepare object for rendering.
 		// Reset framenumber and calculate distance from camera, check for LOD level changes, and update skinning if necessary.
 		// Called by Renderer in worker threads.
 		// Return false if should not render.
 		bool OnPrepareRender(unsigned short frameNumber, Camera* camera) override;
 		// Update GPU resources and set uniforms for rendering.
-		// Called by Renderer when geometry type is not static.
+		// Called by Renderer when geometry type is not static and the batch was not instanced. Instanced batches use the renderer's shared skin matrix buffer instead.
 		void OnRender(ShaderProgram* program, size_t geomIndex) override;
 		// Perform ray test on self and add possible hit to the result vector.
 		void OnRaycast(std::vector<RaycastResult>& dest, const Ray& ray, float maxDistance) override;
 		// Add debug geometry to be rendered.
 		void OnRenderDebug(DebugRenderer* debug) override;
+		// Move cached world space data by an offset when the world origin is rebased. The skin matrices are recalculated before the next render.
+		void OnOriginShift(const Vector3& offset) override;
 
 		// Update skin matrices for rendering.
 		void UpdateSkinning();
-
+		// Derive the skin matrices from the up to date skin matrices of the drawable that owns the skeleton, through the bone remap set by SkinnedModel::SetSkeletonBoneMap().
+		// Called by AnimatedModel for its attachments in the octree update, after its own skinning. Return false if there is no bone remap or the skeleton's skinning is dirty.
+		bool UpdateSkinningFromSkeleton(const SkinnedModelDrawable* skeleton, unsigned short frameNumber);
+
+		// Set the position of the skin matrices in the renderer's shared skin matrix buffer on a frame.
+		// Called by Renderer.
+		void SetSkinMatrixOffset(size_t offset, unsigned short frameNumber) { skinMatrixOffset = offset; skinMatrixFrameNumber = frameNumber; }
+		// Return the position of the skin matrices in the renderer's shared skin matrix buffer, or NO_SKIN_MATRIX_OFFSET if not set on the frame.
+		size_t SkinMatrixOffset(unsigned short frameNumber) const { return skinMatrixFrameNumber == frameNumber ? skinMatrixOffset : NO_SKIN_MATRIX_OFFSET; }
+		// Return the skin matrices, or null if the bones have not been set up.
+		const Matrix3x4* SkinMatrices() const { return skinMatrices.get(); }
 		// Return the bone node references from the owner node.
 		const std::vector<Bone*>& Bones() const;
 		// Return the root bone from the owner node.
@@ -56,6 +74,8 @@ namespace Turso3D
 	protected:
 		// Called in OnPrepareRender() when the drawable must be rendered.
 		virtual void PrepareForRender();
+		// Return the transform from bone world space to the space of the skin matrices.
+		Matrix3x4 SkinningSpaceTransform() const;
 
 	protected:
 		// Combined bounding box of the bones in model space, used for quick updates when only the node moves without animation
@@ -63,10 +83,20 @@ namespace Turso3D
 		// Internal state flags.
 		mutable unsigned skinFlags;
 
-		// Skinning uniform buffer.
+		// Skinning uniform buffer for non-instanced rendering. Created on first use.
 		std::unique_ptr<UniformBuffer> skinMatrixBuffer;
 		// Skinning uniform buffer data.
 		std::unique_ptr<Matrix3x4[]> skinMatrices;
+		// Position of the skin matrices in the renderer's shared skin matrix buffer.
+		size_t skinMatrixOffset;
+		// Frame number the shared skin matrix buffer position was set on.
+		unsigned short skinMatrixFrameNumber;
+		// Skeleton owner's bone index for each bone, when attached to a compatible skeleton. Empty if not attached or has bones of its own.
+		std::vector<size_t> skeletonBoneIndices;
+		// Transforms from the skeleton owner's bind pose for each bone. Empty if the offset matrices are identical.
+		std::vector<Matrix3x4> skeletonOffsetCorrections;
+		// Frame number the skin matrices were derived from the skeleton owner's skin matrices on.
+		unsigned short skeletonSkinFrameNumber;
 	};
 
 	// ==========================================================================================
@@ -104,6 +134,12 @@ namespace Turso3D
 		// This is used to check whether bone has attached objects and its dirtying cannot be handled in an optimized way.
 		size_t NumChildBones() const { return numChildBones; }
 
+		// Set index of the bone in the model that created it.
+		// Called by SkinnedModel when creating the skeleton.
+		void SetIndex(size_t newIndex) { index = newIndex; }
+		// Return index of the bone in the model that created it.
+		size_t Index() const { return index; }
+
 		// Set bone parent space transform without dirtying the hierarchy.
 		void SetTransformSilent(const Vector3& position, const Quaternion& rotation, const Vector3& scale);
 		// Optimally set the world transform dirty.
@@ -118,6 +154,8 @@ namespace Turso3D
 		BoneListener* listener;
 		// Amount of child bones.
 		size_t numChildBones;
+		// Index of the bone in the model that created it.
+		size_t index;
 		// Animation enabled flag.
 		bool animationEnabled;
 	};
@@ -155,6 +193,10 @@ namespace Turso3D
 		// no-op if this skinned model doesn't own the root bone.
 		void SetBonesDirty();
 
+		// Set the skeleton owner's bone index for each bone and the transforms from the skeleton owner's bind pose, to derive the skin matrices from the skeleton owner's skin matrices.
+		// Empty indices disable. Called by AnimatedModel when attaching this model to its skeleton.
+		void SetSkeletonBoneMap(const std::vector<size_t>& boneIndices, const std::vector<Matrix3x4>& offsetCorrections);
+
 	protected:
 		// Handle the transform matrix changing.
 		void OnTransformChanged() override;
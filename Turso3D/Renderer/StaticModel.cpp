@@ -3,6 +3,7 @@
 #include <Turso3D/IO/Log.h>
 #include <Turso3D/Renderer/Camera.h>
 #include <Turso3D/Renderer/DebugRenderer.h>
+#include <Turso3D/Renderer/Imposter.h>
 #include <Turso3D/Renderer/Model.h>
 #include <Turso3D/Renderer/Octree.h>
 #include <Turso3D/Resource/ResourceCache.h>
@@ -19,7 +20,8 @@ namespace
 namespace Turso3D
 {
 	StaticModelDrawable::StaticModelDrawable() :
-		lodBias(1.0f)
+		lodBias(1.0f),
+		imposterDistance(0.0f)
 	{
 	}
 
@@ -47,9 +49,26 @@ namespace Turso3D
 			lastUpdateFrameNumber = 0;
 		}
 
+		if (!(Flags() & Drawable::FLAG_HAS_LOD_LEVELS) && !imposter) {
+			return true;
+		}
+
+		float lodDistance = camera->LodDistance(distance, WorldScale().DotProduct(DOT_SCALE), lodBias);
+
+		// Switch to the imposter when far enough; the source batches are left untouched
+		if (imposter) {
+			bool useImposter = lodDistance > imposterDistance;
+			if (useImposter != TestFlag(Drawable::FLAG_USE_IMPOSTER)) {
+				SetFlag(Drawable::FLAG_USE_IMPOSTER, useImposter);
+				lastUpdateFrameNumber = frameNumber;
+			}
+			if (useImposter) {
+				return true;
+			}
+		}
+
 		// Find out the new LOD level if model has LODs
 		if (Flags() & Drawable::FLAG_HAS_LOD_LEVELS) {
-			float lodDistance = camera->LodDistance(distance, WorldScale().DotProduct(DOT_SCALE), lodBias);
 			size_t numGeometries = batches.NumGeometries();
 
 			for (size_t i = 0; i < numGeometries; ++i) {
@@ -90,16 +109,14 @@ namespace Turso3D
 			}
 
 			float localDistance = M_INFINITY;
-			if (numHulls == 1) {
-				localDistance = localRay.HitDistance(hull.GetVertices(0), sizeof(Vector3), hull.GetIndices(0), sizeof(unsigned), 0, hull.GetIndexCount(0), &res.normal);
-			} else {
-				for (size_t i = 0; i < numHulls; ++i) {
-					Vector3 n;
-					float d = localRay.HitDistance(hull.GetVertices(i), sizeof(Vector3), hull.GetIndices(i), sizeof(unsigned), 0, hull.GetIndexCount(i), &n);
-					if (d < localDistance) {
-						localDistance = d;
-						res.normal = n;
-					}
+			size_t hullIndex = 0;
+			for (size_t i = 0; i < numHulls; ++i) {
+				Vector3 n;
+				float d = hull.GetBvh(i).HitDistance(localRay, &n, nullptr, localDistance);
+				if (d < localDistance) {
+					localDistance = d;
+					hullIndex = i;
+					res.normal = n;
 				}
 			}
 
@@ -113,7 +130,7 @@ namespace Turso3D
 					res.normal = (transform * Vector4(res.normal, 0.0f)).Normalized();
 					res.distance = hitDistance;
 					res.drawable = this;
-					res.subObject = 0; // TODO: Hull mesh index?
+					res.subObject = hullIndex;
 				}
 			}
 
@@ -191,4 +208,12 @@ namespace Turso3D
 		StaticModelDrawable* drawable = GetDrawable();
 		drawable->lodBias = std::max(bias, M_EPSILON);
 	}
+
+	void StaticModel::SetImposter(std::shared_ptr<Imposter> imposter, float distance)
+	{
+		StaticModelDrawable* drawable = GetDrawable();
+		drawable->imposter = imposter;
+		drawable->imposterDistance = std::max(distance, 0.0f);
+		drawable->SetFlag(Drawable::FLAG_USE_IMPOSTER, false);
+	}
 }
@@ -5,6 +5,7 @@
 
 namespace Turso3D
 {
+	class Imposter;
 	class Model;
 
 	// Static model drawable.
@@ -27,11 +28,18 @@ namespace Turso3D
 		// Add debug geometry to be rendered.
 		void OnRenderDebug(DebugRenderer* debug) override;
 
+		// Return the imposter, or null if not set.
+		Imposter* GetImposter() const { return imposter.get(); }
+
 	protected:
 		// Current model resource.
 		std::shared_ptr<Model> model;
+		// Imposter used beyond the imposter distance.
+		std::shared_ptr<Imposter> imposter;
 		// LOD bias value.
 		float lodBias;
+		// LOD distance beyond which the imposter is rendered.
+		float imposterDistance;
 	};
 
 	// ==========================================================================================
@@ -55,10 +63,16 @@ namespace Turso3D
 		void SetModel(std::shared_ptr<Model> model);
 		// Set LOD bias. Values higher than 1 use higher quality LOD (acts if distance is smaller.)
 		void SetLodBias(float bias);
+		// Set an imposter to render instead of the model beyond a LOD distance. Pass null to disable.
+		void SetImposter(std::shared_ptr<Imposter> imposter, float distance);
 
 		// Return the model resource.
 		const std::shared_ptr<Model>& GetModel() const { return GetDrawable()->model; }
 		// Return LOD bias.
 		float LodBias() const { return GetDrawable()->lodBias; }
+		// Return the imposter.
+		const std::shared_ptr<Imposter>& GetImposter() const { return GetDrawable()->imposter; }
+		// Return the imposter LOD distance.
+		float ImposterDistance() const { return GetDrawable()->imposterDistance; }
 	};
 }
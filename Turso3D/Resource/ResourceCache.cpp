@@ -1,26 +1,71 @@
 #include <Turso3D/Resource/ResourceCache.h>
 #include <Turso3D/Resource/Resource.h>
+#include <Turso3D/Core/WorkQueue.h>
 #include <Turso3D/Graphics/GraphicsDefs.h>
 #include <Turso3D/Graphics/Shader.h>
 #include <Turso3D/IO/FileStream.h>
 #include <Turso3D/IO/Log.h>
 #include <algorithm>
+#include <cassert>
+#include <chrono>
 #include <filesystem>
 
+namespace
+{
+	using namespace Turso3D;
+
+	// Load task whose BeginLoad is running in this thread, for collecting the dependencies it requests.
+	static thread_local Task* CurrentLoadTask = nullptr;
+}
+
 namespace Turso3D
 {
 	namespace fs = std::filesystem;
 
+	// Task for loading a resource asynchronously.
+	struct ResourceCache::LoadTask : public MemberFunctionTask<ResourceCache>
+	{
+		// Construct.
+		LoadTask(ResourceCache* object_, MemberWorkFunctionPtr function_) :
+			MemberFunctionTask<ResourceCache>(object_, function_),
+			numPendingDependencies(0),
+			success(false)
+		{
+			name = "LoadResource";
+		}
+
+		// Resource being loaded.
+		std::shared_ptr<Resource> resource;
+		// Completion callbacks.
+		std::vector<LoadCallback> callbacks;
+		// Dependencies requested by BeginLoad.
+		std::vector<std::shared_ptr<Resource>> dependencies;
+		// Loads waiting for this load to finish before their EndLoad.
+		std::vector<LoadTask*> dependents;
+		// Number of dependencies still loading.
+		size_t numPendingDependencies;
+		// BeginLoad success flag.
+		bool success;
+	};
+
 	// ==========================================================================================
-	ResourceCache::ResourceCache()
+	ResourceCache::ResourceCache() :
+		workQueue(nullptr)
 	{
 	}
 
 	ResourceCache::~ResourceCache()
 	{
+		// The worker threads would still refer to the loads. Call CompleteAsyncLoads() before the work queue is destroyed
+		assert(pendingLoads.empty());
 		resources.clear();
 	}
 
+	void ResourceCache::SetWorkQueue(WorkQueue* workQueue_)
+	{
+		workQueue = workQueue_;
+	}
+
 	bool ResourceCache::AddResourceDir(const std::string& pathName, unsigned priority)
 	{
 		std::error_code ec;
@@ -88,6 +133,219 @@ namespace Turso3D
 		return {};
 	}
 
+	bool ResourceCache::LoadDependencyAsync(const std::shared_ptr<Resource>& resource)
+	{
+		if (!CurrentLoadTask) {
+			return false;
+		}
+
+		// Started in the main thread once BeginLoad has finished, as the cache is not accessed from the worker threads
+		static_cast<LoadTask*>(CurrentLoadTask)->dependencies.push_back(resource);
+		return true;
+	}
+
+	bool ResourceCache::IsLoadingAsync() const
+	{
+		return CurrentLoadTask != nullptr;
+	}
+
+	void ResourceCache::UpdateAsyncLoads(double timeBudget)
+	{
+		if (pendingLoads.empty()) {
+			return;
+		}
+
+		TURSO3D_PROFILE("ResourceCache::UpdateAsyncLoads");
+
+		CollectLoadedTasks();
+
+		// EndLoad may upload to the GPU, so limit the time spent per frame
+		auto startTime = std::chrono::steady_clock::now();
+		while (!endLoadTasks.empty()) {
+			LoadTask* task = endLoadTasks.front();
+			endLoadTasks.pop();
+			FinishLoad(task);
+
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+			if (elapsed.count() >= timeBudget) {
+				break;
+			}
+		}
+	}
+
+	void ResourceCache::CompleteAsyncLoads()
+	{
+		TURSO3D_PROFILE("ResourceCache::CompleteAsyncLoads");
+
+		while (!pendingLoads.empty()) {
+			CollectLoadedTasks();
+
+			if (endLoadTasks.empty()) {
+				// Sleep until a worker thread finishes BeginLoad. The loads are background tasks, so the main thread can not help with them
+				std::unique_lock<std::mutex> lock(loadedTasksMutex);
+				loadedTasksSignal.wait(lock, [this]() { return !loadedTasks.empty(); });
+				continue;
+			}
+
+			while (!endLoadTasks.empty()) {
+				LoadTask* task = endLoadTasks.front();
+				endLoadTasks.pop();
+				FinishLoad(task);
+			}
+		}
+	}
+
+	bool ResourceCache::AddLoadCallback(StringHash nameHash, const LoadCallback& callback)
+	{
+		auto it = pendingLoads.find(nameHash);
+		if (it == pendingLoads.end()) {
+			return false;
+		}
+
+		if (callback) {
+			it->second->callbacks.push_back(callback);
+		}
+		return true;
+	}
+
+	void ResourceCache::QueueLoad(const std::shared_ptr<Resource>& resource, const LoadCallback& callback, LoadTask* dependent)
+	{
+		std::unique_ptr<LoadTask>& slot = pendingLoads[resource->NameHash()];
+		assert(!slot);
+
+		slot = std::make_unique<LoadTask>(this, &ResourceCache::LoadWork);
+		LoadTask* task = slot.get();
+		task->resource = resource;
+		if (callback) {
+			task->callbacks.push_back(callback);
+		}
+		if (dependent) {
+			task->dependents.push_back(dependent);
+			++dependent->numPendingDependencies;
+		}
+
+		if (workQueue) {
+			workQueue->QueueBackgroundTask(task);
+		} else {
+			LoadWork(task, 0);
+		}
+	}
+
+	void ResourceCache::LoadWork(Task* task_, unsigned)
+	{
+		LoadTask* task = static_cast<LoadTask*>(task_);
+		Resource* resource = task->resource.get();
+
+		TURSO3D_PROFILE_DETAIL("ResourceCache::LoadWork", resource->Name());
+
+		// Dependency loads may begin in this thread, so restore the previous task afterward
+		Task* previousTask = CurrentLoadTask;
+		CurrentLoadTask = task;
+
+		std::unique_ptr<Stream> stream = OpenData(resource->Name());
+		task->success = stream && resource->BeginLoad(*stream);
+
+		CurrentLoadTask = previousTask;
+
+		// The task is finished by the main thread and may be destroyed from here on
+		std::lock_guard<std::mutex> lock(loadedTasksMutex);
+		loadedTasks.push_back(task);
+		loadedTasksSignal.notify_one();
+	}
+
+	void ResourceCache::CollectLoadedTasks()
+	{
+		// Without a work queue the dependencies begin loading immediately, so repeat until none are left
+		for (;;) {
+			std::vector<LoadTask*> tasks;
+			{
+				std::lock_guard<std::mutex> lock(loadedTasksMutex);
+				tasks.swap(loadedTasks);
+			}
+			if (tasks.empty()) {
+				break;
+			}
+
+			for (LoadTask* task : tasks) {
+				for (const std::shared_ptr<Resource>& dependency : task->dependencies) {
+					StringHash nameHash = dependency->NameHash();
+					if (resources.find(nameHash) != resources.end()) {
+						continue;
+					}
+
+					if (auto it = pendingLoads.find(nameHash); it != pendingLoads.end()) {
+						// Waiting for a load that waits for this one would never finish, so fail this load instead
+						LoadTask* pending = it->second.get();
+						if (WaitsFor(pending, task)) {
+							LOG_ERROR("Cyclic dependency between \"{:s}\" and \"{:s}\".", task->resource->Name(), pending->resource->Name());
+							task->success = false;
+							continue;
+						}
+
+						pending->dependents.push_back(task);
+						++task->numPendingDependencies;
+					} else {
+						QueueLoad(dependency, {}, task);
+					}
+				}
+				task->dependencies.clear();
+
+				if (!task->numPendingDependencies) {
+					endLoadTasks.push(task);
+				}
+			}
+		}
+	}
+
+	void ResourceCache::FinishLoad(LoadTask* task)
+	{
+		std::shared_ptr<Resource> resource = task->resource;
+		StringHash nameHash = resource->NameHash();
+
+		{
+			TURSO3D_PROFILE_DETAIL("ResourceCache::FinishLoad", resource->Name());
+
+			// A synchronous load of the same resource may have finished first, in which case use it
+			if (auto it = resources.find(nameHash); it != resources.end()) {
+				resource = it->second;
+			} else if (task->success && resource->EndLoad()) {
+				StoreResource(resource);
+			} else {
+				resource.reset();
+			}
+		}
+
+		// Remove from the loads in progress before the callbacks, as they may start new loads
+		auto it = pendingLoads.find(nameHash);
+		assert(it != pendingLoads.end() && it->second.get() == task);
+		std::unique_ptr<LoadTask> finishedTask = std::move(it->second);
+		pendingLoads.erase(it);
+
+		for (LoadTask* dependent : finishedTask->dependents) {
+			if (--dependent->numPendingDependencies == 0) {
+				endLoadTasks.push(dependent);
+			}
+		}
+
+		for (const LoadCallback& callback : finishedTask->callbacks) {
+			callback(resource);
+		}
+	}
+
+	bool ResourceCache::WaitsFor(const LoadTask* task, const LoadTask* dependency) const
+	{
+		if (task == dependency) {
+			return true;
+		}
+
+		for (const LoadTask* dependent : dependency->dependents) {
+			if (WaitsFor(task, dependent)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
 	void ResourceCache::ClearUnused()
 	{
 		for (auto it = resources.begin(); it != resources.end(); ) {
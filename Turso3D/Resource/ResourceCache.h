@@ -1,8 +1,13 @@
 #pragma once
 
+#include <Turso3D/Core/Profiler.h>
 #include <Turso3D/IO/Stream.h>
 #include <Turso3D/Utils/StringHash.h>
 #include <limits.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
 #include <unordered_map>
 #include <memory>
 #include <vector>
@@ -11,17 +16,28 @@ namespace Turso3D
 {
 	class Resource;
 	class Shader;
+	class WorkQueue;
+	struct Task;
 
 	// Resource cache, an independent subsystem.
 	// Loads resources on demand and stores them for later access.
 	class ResourceCache
 	{
+		struct LoadTask;
+
 		ResourceCache();
 		ResourceCache(const ResourceCache&);
 
 	public:
+		// Completion callback of an asynchronous load, called in the main thread with the loaded resource, or null on failure.
+		typedef std::function<void(const std::shared_ptr<Resource>& resource)> LoadCallback;
+
 		~ResourceCache();
 
+		// Set the work queue whose worker threads run the asynchronous loads. Without one, the loads begin immediately in the calling thread.
+		// Call CompleteAsyncLoads() before the work queue is destroyed.
+		void SetWorkQueue(WorkQueue* workQueue);
+
 		// Add a resource directory.
 		// Return true on success.
 		bool AddResourceDir(const std::string& pathName, unsigned priority = UINT_MAX);
@@ -44,6 +60,8 @@ namespace Turso3D
 				return std::static_pointer_cast<T>(it->second);
 			}
 
+			TURSO3D_PROFILE_DETAIL("ResourceCache::LoadResource", name);
+
 			std::unique_ptr<Stream> stream = OpenData(name);
 			if (stream) {
 				std::shared_ptr<T> resource = std::make_shared<T>(std::forward<Args>(args)...);
@@ -58,6 +76,54 @@ namespace Turso3D
 			return {};
 		}
 
+		// Load a resource asynchronously and return immediately.
+		// BeginLoad runs in a worker thread, and the dependencies it requests with LoadDependencyAsync() load in parallel.
+		// EndLoad runs in the main thread in UpdateAsyncLoads() after the dependencies, then the resource is stored in the cache and the callback is called.
+		// If the resource is already in the cache, the callback is called immediately. If it is already loading, the callback is added to that load.
+		// To be called only from the main thread.
+		template <typename T, typename ...Args>
+		auto LoadResourceAsync(const std::string& name, const std::function<void(const std::shared_ptr<T>&)>& callback = {}, Args&&... args) -> std::enable_if_t<std::is_base_of_v<Resource, T>>
+		{
+			StringHash hash {name};
+			if (auto it = resources.find(hash); it != resources.end()) {
+				if (callback) {
+					callback(std::static_pointer_cast<T>(it->second));
+				}
+				return;
+			}
+
+			LoadCallback loadCallback;
+			if (callback) {
+				loadCallback = [callback](const std::shared_ptr<Resource>& resource)
+				{
+					callback(std::static_pointer_cast<T>(resource));
+				};
+			}
+
+			if (AddLoadCallback(hash, loadCallback)) {
+				return;
+			}
+
+			std::shared_ptr<T> resource = std::make_shared<T>(std::forward<Args>(args)...);
+			resource->SetName(name);
+			QueueLoad(resource, loadCallback, nullptr);
+		}
+
+		// Request a dependency to load in parallel, when called from BeginLoad of a resource that is loading asynchronously. The dependency should have its name and load settings set.
+		// EndLoad of the requesting resource is deferred until the dependency is in the cache, from where it can be taken.
+		// If the dependency in turn waits for the requesting resource, the requesting load fails instead.
+		// Return false if not called from an asynchronous load, in which case the caller should load the dependency itself.
+		bool LoadDependencyAsync(const std::shared_ptr<Resource>& resource);
+		// Return whether called from BeginLoad of a resource that is loading asynchronously, so that LoadDependencyAsync() can be used.
+		bool IsLoadingAsync() const;
+		// Finish the asynchronous loads that are ready, running EndLoad, storing the resources and calling the callbacks until the time budget in seconds is used.
+		// At least one load is finished per call. To be called once per frame from the main thread.
+		void UpdateAsyncLoads(double timeBudget = 0.002);
+		// Wait for all asynchronous loads and finish them. To be called only from the main thread.
+		void CompleteAsyncLoads();
+		// Return number of asynchronous loads in progress, including dependencies.
+		size_t NumAsyncLoads() const { return pendingLoads.size(); }
+
 		// Store a resource in the cache, it's name hash will be used as key.
 		// Returns true if the resource was stored, false otherwise.
 		template <typename T>
@@ -97,8 +163,35 @@ namespace Turso3D
 		// Get the ResourceCache instance.
 		static ResourceCache* Instance();
 
+	private:
+		// Add a callback to an asynchronous load in progress. Return false if the resource is not loading.
+		bool AddLoadCallback(StringHash nameHash, const LoadCallback& callback);
+		// Start an asynchronous load, optionally as a dependency of another load.
+		void QueueLoad(const std::shared_ptr<Resource>& resource, const LoadCallback& callback, LoadTask* dependent);
+		// Open the data and call BeginLoad. Called by the worker threads.
+		void LoadWork(Task* task, unsigned threadIndex);
+		// Start the dependencies of loads whose BeginLoad has finished, and queue them for EndLoad once the dependencies are done.
+		void CollectLoadedTasks();
+		// Call EndLoad, store the resource, call the callbacks and release the dependent loads.
+		void FinishLoad(LoadTask* task);
+		// Return whether a load waits for another load to finish, directly or through other loads.
+		bool WaitsFor(const LoadTask* task, const LoadTask* dependency) const;
+
 	private:
 		std::vector<std::string> resourceDirs;
 		std::unordered_map<StringHash, std::shared_ptr<Resource>> resources;
+
+		// Work queue for asynchronous loading.
+		WorkQueue* workQueue;
+		// Asynchronous loads in progress by resource name hash.
+		std::unordered_map<StringHash, std::unique_ptr<LoadTask>> pendingLoads;
+		// Loads whose BeginLoad has finished, added by the worker threads.
+		std::vector<LoadTask*> loadedTasks;
+		// Mutex for the finished loads.
+		std::mutex loadedTasksMutex;
+		// Condition variable signaled when a load's BeginLoad has finished.
+		std::condition_variable loadedTasksSignal;
+		// Loads with their dependencies done, waiting for EndLoad in order.
+		std::queue<LoadTask*> endLoadTasks;
 	};
 }
@@ -1,18 +1,112 @@
 #include <Turso3D/Scene/Scene.h>
+#include <Turso3D/Core/Profiler.h>
+#include <Turso3D/Core/WorkQueue.h>
 #include <Turso3D/IO/Log.h>
 #include <Turso3D/IO/Stream.h>
 #include <Turso3D/Scene/SpatialNode.h>
+#include <algorithm>
+
+namespace
+{
+	using namespace Turso3D;
+
+	// Minimum number of nodes to move per origin rebase task.
+	constexpr size_t MIN_ORIGIN_SHIFT_NODES = 1024;
+}
 
 namespace Turso3D
 {
-	Scene::Scene(WorkQueue* workQueue) :
-		octree(workQueue)
+	// Task for moving a part of the spatial nodes when the world origin is rebased.
+	struct Scene::OriginShiftTask : public MemberFunctionTask<Scene>
+	{
+		// Construct.
+		OriginShiftTask(Scene* object_, MemberWorkFunctionPtr function_) :
+			MemberFunctionTask<Scene>(object_, function_)
+		{
+			name = "OriginShift";
+		}
+
+		// Offset to move by.
+		Vector3 offset;
+		// Start index of the nodes.
+		size_t start;
+		// End index of the nodes.
+		size_t end;
+	};
+
+	Scene::Scene(WorkQueue* workQueue_) :
+		workQueue(workQueue_),
+		octree(workQueue_)
 	{
 		root.SetScene(this);
 	}
 
+	Scene::~Scene()
+	{
+	}
+
 	void Scene::Clear()
 	{
 		root.DestroyAllChildren();
 	}
+
+	void Scene::RebaseOrigin(const Vector3& newOrigin, SpatialNode* const* extraNodes, size_t numExtraNodes)
+	{
+		TURSO3D_PROFILE("Scene::RebaseOrigin");
+
+		originShiftNodes.clear();
+		CollectSpatialNodes(originShiftNodes, &root);
+		for (size_t i = 0; i < numExtraNodes; ++i) {
+			CollectSpatialNodes(originShiftNodes, extraNodes[i]);
+		}
+
+		// Queue the nodes first, then move the octree while worker threads move the nodes
+		size_t nodesPerTask = std::max(MIN_ORIGIN_SHIFT_NODES, originShiftNodes.size() / workQueue->NumThreads() / 4);
+		size_t taskIdx = 0;
+
+		for (size_t start = 0; start < originShiftNodes.size(); start += nodesPerTask) {
+			if (originShiftTasks.size() <= taskIdx) {
+				originShiftTasks.push_back(std::make_unique<OriginShiftTask>(this, &Scene::OriginShiftWork));
+			}
+			OriginShiftTask* task = originShiftTasks[taskIdx].get();
+			task->offset = -newOrigin;
+			task->start = start;
+			task->end = std::min(start + nodesPerTask, originShiftNodes.size());
+			++taskIdx;
+		}
+
+		numPendingOriginShiftTasks.store((int)taskIdx);
+		if (taskIdx) {
+			workQueue->QueueTasks(taskIdx, reinterpret_cast<Task**>(&originShiftTasks[0]));
+		}
+
+		octree.RebaseOrigin(newOrigin);
+
+		while (numPendingOriginShiftTasks.load() > 0) {
+			workQueue->TryComplete();
+		}
+	}
+
+	void Scene::CollectSpatialNodes(std::vector<SpatialNode*>& result, Node* node) const
+	{
+		if (node->TestFlag(Node::FLAG_SPATIAL)) {
+			result.push_back(static_cast<SpatialNode*>(node));
+		}
+
+		const std::vector<std::unique_ptr<Node>>& children = node->Children();
+		for (size_t i = 0; i < children.size(); ++i) {
+			CollectSpatialNodes(result, children[i].get());
+		}
+	}
+
+	void Scene::OriginShiftWork(Task* task_, unsigned)
+	{
+		OriginShiftTask* task = static_cast<OriginShiftTask*>(task_);
+
+		for (size_t i = task->start; i < task->end; ++i) {
+			originShiftNodes[i]->OnOriginShift(task->offset);
+		}
+
+		numPendingOriginShiftTasks.fetch_add(-1);
+	}
 }
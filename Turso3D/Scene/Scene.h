@@ -3,19 +3,32 @@
 #include <Turso3D/Renderer/LightEnvironment.h>
 #include <Turso3D/Renderer/Octree.h>
 #include <Turso3D/Scene/Node.h>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 namespace Turso3D
 {
+	class SpatialNode;
 	class WorkQueue;
+	struct Task;
 
 	class Scene
 	{
+		struct OriginShiftTask;
+
 	public:
 		// WorkQueue and Graphics subsystems must have been initialized, as it's required by Octree.
 		Scene(WorkQueue* workQueue);
+		// Destruct.
+		~Scene();
 
 		// Destroy child nodes recursively, leaving the scene empty.
 		void Clear();
+		// Move the world origin to a world position, to keep the coordinates small in large worlds. The position becomes zero.
+		// Moves the spatial nodes, drawables and octree in one pass using worker threads, without reinserting drawables. Nodes outside the scene, such as cameras, can be moved along with their children.
+		// To be called only from the main thread, outside the octree update.
+		void RebaseOrigin(const Vector3& newOrigin, SpatialNode* const* extraNodes = nullptr, size_t numExtraNodes = 0);
 
 		// Return the scene's root node.
 		Node* GetRoot() { return &root; }
@@ -26,6 +39,15 @@ namespace Turso3D
 		Octree* GetOctree() { return &octree; }
 
 	private:
+		// Append a node's spatial nodes, including itself, recursively.
+		void CollectSpatialNodes(std::vector<SpatialNode*>& result, Node* node) const;
+		// Work function to move a part of the spatial nodes when the world origin is rebased.
+		void OriginShiftWork(Task* task, unsigned threadIndex);
+
+	private:
+		// Cached WorkQueue subsystem.
+		WorkQueue* workQueue;
+
 		// The root node.
 		Node root;
 		// The scene environment lighting
@@ -33,5 +55,12 @@ namespace Turso3D
 
 		// The octree used for rendering drawables.
 		Octree octree;
+
+		// Tasks for rebasing the world origin.
+		std::vector<std::unique_ptr<OriginShiftTask>> originShiftTasks;
+		// Spatial nodes to move when rebasing the world origin.
+		std::vector<SpatialNode*> originShiftNodes;
+		// Remaining origin rebase tasks.
+		std::atomic<int> numPendingOriginShiftTasks;
 	};
 }
@@ -280,6 +280,18 @@ namespace Turso3D
 		OnTransformChanged();
 	}
 
+	void SpatialNode::OnOriginShift(const Vector3& offset)
+	{
+		if (!TestFlag(FLAG_SPATIALPARENT)) {
+			position += offset;
+		}
+
+		// A clean world transform means the parents are clean too, so translating it gives the same result as recalculating
+		if (!TestFlag(FLAG_WORLDTRANSFORMDIRTY)) {
+			worldTransform.SetTranslation(worldTransform.Translation() + offset);
+		}
+	}
+
 	void SpatialNode::OnParentSet(Node* newParent, Node* oldParent)
 	{
 		SetFlag(FLAG_SPATIALPARENT, newParent != nullptr && newParent->TestFlag(FLAG_SPATIAL));
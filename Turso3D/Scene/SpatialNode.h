@@ -74,6 +74,9 @@ namespace Turso3D
 		void ApplyScale(const Vector3& delta);
 		// Apply an uniform scale change.
 		void ApplyScale(float delta);
+		// Move by a world space offset when the world origin is rebased. Moves the position if there is no spatial parent, and the world transform if it is up to date, without dirtying the hierarchy.
+		// Does not access other nodes, so nodes can be shifted from several threads at once. Called by Scene::RebaseOrigin().
+		virtual void OnOriginShift(const Vector3& offset);
 
 		// Return the parent spatial node, or null if it is not spatial.
 		SpatialNode* SpatialParent() const { return TestFlag(FLAG_SPATIALPARENT) ? static_cast<SpatialNode*>(Parent()) : nullptr; }
@@ -14,9 +14,12 @@ namespace Turso3D
 
 	// Graphics
 
+	struct RenderTextureDesc;
+
 	class FrameBuffer;
 	class IndexBuffer;
 	class RenderBuffer;
+	class RenderGraph;
 	class Shader;
 	class ShaderProgram;
 	class Texture;
@@ -70,6 +73,7 @@ namespace Turso3D
 	class Drawable;
 	class GeometryDrawable;
 	class GeometryNode;
+	class Imposter;
 	class Light;
 	class LightDrawable;
 	class LightEnvironment;
@@ -0,0 +1,121 @@
+#version 330 core
+
+#include <uniforms.h>
+
+#pragma shader:VS //===============================================================================
+#include <transform.h>
+
+in vec3 position;
+
+out vec4 vWorldPos;
+out vec2 vTexCoord;
+flat out mat3 vNormalMatrix;
+noperspective out vec2 vScreenPos;
+
+layout(std140) uniform PerMaterialData3
+{
+	vec4 ImposterCenter; // xyz = local center, w = radius
+	vec4 ImposterParams; // x = frames per axis, y = 1 / frames per axis
+	vec4 AoRoughMetal;
+};
+
+// Octahedral mapping with Y as the octahedron axis. Must match Imposter::FrameDirection().
+vec2 OctEncode(vec3 n)
+{
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+	vec2 p = n.xz;
+	if (n.y < 0.0) {
+		p = (1.0 - abs(p.yx)) * vec2(p.x >= 0.0 ? 1.0 : -1.0, p.y >= 0.0 ? 1.0 : -1.0);
+	}
+	return p;
+}
+
+vec3 OctDecode(vec2 p)
+{
+	vec3 n = vec3(p.x, 1.0 - abs(p.x) - abs(p.y), p.y);
+	if (n.y < 0.0) {
+		n.xz = (1.0 - abs(n.zx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.z >= 0.0 ? 1.0 : -1.0);
+	}
+	return normalize(n);
+}
+
+void main()
+{
+	mat3x4 world = GetWorldMatrix();
+
+	// Model axes in world space. Their lengths are the model scale
+	vec3 axisX = vec4(1.0, 0.0, 0.0, 0.0) * world;
+	vec3 axisY = vec4(0.0, 1.0, 0.0, 0.0) * world;
+	vec3 axisZ = vec4(0.0, 0.0, 1.0, 0.0) * world;
+
+	// View direction in model local space. Projecting on the axes and dividing by their squared lengths inverts also a nonuniform scale
+	vec3 worldCenter = vec4(ImposterCenter.xyz, 1.0) * world;
+	vec3 toCamera = cameraPosition.xyz - worldCenter;
+	vec3 localView = normalize(vec3(
+		dot(axisX, toCamera) / dot(axisX, axisX),
+		dot(axisY, toCamera) / dot(axisY, axisY),
+		dot(axisZ, toCamera) / dot(axisZ, axisZ)
+	));
+
+	// Select the closest baked frame
+	vec2 grid = (OctEncode(localView) * 0.5 + 0.5) * ImposterParams.x;
+	vec2 frame = clamp(floor(grid), vec2(0.0), vec2(ImposterParams.x - 1.0));
+	vec3 frameDir = OctDecode((frame + 0.5) * ImposterParams.y * 2.0 - 1.0);
+
+	// Rebuild the bake camera basis for the frame
+	vec3 forward = -frameDir;
+	vec3 upRef = abs(forward.y) > 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(0.0, 1.0, 0.0);
+	vec3 right = normalize(cross(upRef, forward));
+	vec3 up = cross(forward, right);
+
+	vec3 localPos = ImposterCenter.xyz + (right * position.x + up * position.y) * ImposterCenter.w;
+
+	vWorldPos.xyz = vec4(localPos, 1.0) * world;
+	vTexCoord = (frame + position.xy * 0.5 + 0.5) * ImposterParams.y;
+	// Normals transform by the inverse transpose, which keeps them perpendicular to the surface also under nonuniform scale. The fragment shader normalizes the result
+	vNormalMatrix = transpose(inverse(mat3(axisX, axisY, axisZ)));
+
+	gl_Position = vec4(vWorldPos.xyz, 1.0) * viewProjMatrix;
+	vWorldPos.w = CalculateDepth(gl_Position);
+	vScreenPos = CalculateScreenPos(gl_Position);
+}
+
+#pragma shader:FS //===============================================================================
+#include <pbr.h>
+
+uniform sampler2D albedoTex0;
+uniform sampler2D normalTex1;
+
+in vec4 vWorldPos;
+in vec2 vTexCoord;
+flat in mat3 vNormalMatrix;
+noperspective in vec2 vScreenPos;
+
+layout(std140) uniform PerMaterialData3
+{
+	vec4 ImposterCenter;
+	vec4 ImposterParams;
+	vec4 AoRoughMetal;
+};
+
+layout (location = 0) out vec4 fragColor;
+layout (location = 1) out vec4 fragNormal;
+
+void main()
+{
+	vec4 sAlbedo = texture(albedoTex0, vTexCoord);
+	if (sAlbedo.a < 0.5) discard;
+
+	vec3 localNormal = texture(normalTex1, vTexCoord).xyz * 2.0 - 1.0;
+	vec3 normal = normalize(vNormalMatrix * localNormal);
+
+	float roughness = clamp(AoRoughMetal.g, 0.01, 0.99);
+	float metallic = AoRoughMetal.b;
+
+	// BRDF Shading
+	vec3 color = CalculateLighting(vWorldPos, vScreenPos, normal, sAlbedo.rgb, metallic, roughness);
+	color *= AoRoughMetal.r;
+
+	fragColor = vec4(color, 1.0);
+	fragNormal = vec4(vec4(normal, 0.0) * viewMatrix * 0.5 + 0.5, 0.0);
+}
@@ -0,0 +1,46 @@
+#version 330 core
+
+#pragma shader:VS //===============================================================================
+uniform mat4 bakeViewProjMatrix;
+
+in vec3 position;
+in vec3 normal;
+in vec2 texCoord;
+
+out vec3 vNormal;
+out vec2 vTexCoord;
+
+void main()
+{
+	vNormal = normal;
+	vTexCoord = texCoord;
+	gl_Position = vec4(position, 1.0) * bakeViewProjMatrix;
+}
+
+#pragma shader:FS //===============================================================================
+#ifndef NOTEXTURE
+	uniform sampler2D albedoTex0;
+#endif
+
+in vec3 vNormal;
+in vec2 vTexCoord;
+
+uniform vec4 bakeBaseColor;
+
+layout (location = 0) out vec4 fragColor;
+layout (location = 1) out vec4 fragNormal;
+
+void main()
+{
+#ifdef NOTEXTURE
+	vec4 albedo = bakeBaseColor;
+#else
+	vec4 albedo = texture(albedoTex0, vTexCoord) * bakeBaseColor;
+#endif
+
+	if (albedo.a < 0.5) discard;
+
+	// Alpha is coverage; normals are stored in model local space
+	fragColor = vec4(albedo.rgb, 1.0);
+	fragNormal = vec4(normalize(vNormal) * 0.5 + 0.5, 1.0);
+}
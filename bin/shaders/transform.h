@@ -1,4 +1,80 @@
-#if defined(INSTANCED)
+// Depth pre-pass and the equal-depth opaque pass must produce bit-identical positions
+invariant gl_Position;
+
+#if defined(BAKED_ANIMATION)
+	in vec4 blendWeights;
+	in vec4 blendIndices;
+	in vec4 texCoord3;
+	in vec4 texCoord4;
+	in vec4 texCoord5;
+	// Playback parameters: start row, signed frame count (negative if not looped), frame at zero time and frames per second
+	in vec4 instanceData0;
+
+	// Skin matrices of all baked frames, 3 texels per bone on each row
+	uniform sampler2D animationTex15;
+
+	mat3x4 FetchBakedSkinMatrix(int bone, int row0, int row1, float t)
+	{
+		int x = bone * 3;
+		return mat3x4(
+			mix(texelFetch(animationTex15, ivec2(x, row0), 0), texelFetch(animationTex15, ivec2(x, row1), 0), t),
+			mix(texelFetch(animationTex15, ivec2(x + 1, row0), 0), texelFetch(animationTex15, ivec2(x + 1, row1), 0), t),
+			mix(texelFetch(animationTex15, ivec2(x + 2, row0), 0), texelFetch(animationTex15, ivec2(x + 2, row1), 0), t)
+		);
+	}
+
+	// Multiply two affine 3x4 matrices stored as rows
+	mat3x4 MultiplyAffine(mat3x4 a, mat3x4 b)
+	{
+		return mat3x4(
+			a[0].x * b[0] + a[0].y * b[1] + a[0].z * b[2] + vec4(0.0, 0.0, 0.0, a[0].w),
+			a[1].x * b[0] + a[1].y * b[1] + a[1].z * b[2] + vec4(0.0, 0.0, 0.0, a[1].w),
+			a[2].x * b[0] + a[2].y * b[1] + a[2].z * b[2] + vec4(0.0, 0.0, 0.0, a[2].w)
+		);
+	}
+
+	mat3x4 GetWorldMatrix()
+	{
+		float lastFrame = abs(instanceData0.y) - 1.0;
+		float frame = instanceData0.z + timeParameters.x * instanceData0.w;
+		if (instanceData0.y > 0.0) {
+			frame = mod(frame, max(lastFrame, 1.0));
+		} else {
+			frame = clamp(frame, 0.0, lastFrame);
+		}
+
+		int row0 = int(instanceData0.x + floor(frame));
+		int row1 = int(instanceData0.x + min(floor(frame) + 1.0, lastFrame));
+		float t = fract(frame);
+
+		ivec4 indices = ivec4(blendIndices);
+		mat3x4 skin = (
+			FetchBakedSkinMatrix(indices.x, row0, row1, t) * blendWeights.x +
+			FetchBakedSkinMatrix(indices.y, row0, row1, t) * blendWeights.y +
+			FetchBakedSkinMatrix(indices.z, row0, row1, t) * blendWeights.z +
+			FetchBakedSkinMatrix(indices.w, row0, row1, t) * blendWeights.w
+		);
+		return MultiplyAffine(mat3x4(texCoord3, texCoord4, texCoord5), skin);
+	}
+
+#elif defined(SKINNED) && defined(INSTANCED)
+	in vec4 blendWeights;
+	in vec4 blendIndices;
+	// Offset of the instance's skin matrices within the bound skin matrix range
+	in float instanceData0;
+
+	mat3x4 GetWorldMatrix()
+	{
+		ivec4 indices = ivec4(blendIndices) + int(instanceData0);
+		return (
+			skinMatrices[indices.x] * blendWeights.x +
+			skinMatrices[indices.y] * blendWeights.y +
+			skinMatrices[indices.z] * blendWeights.z +
+			skinMatrices[indices.w] * blendWeights.w
+		);
+	}
+
+#elif defined(INSTANCED)
 	in vec4 texCoord3;
 	in vec4 texCoord4;
 	in vec4 texCoord5;
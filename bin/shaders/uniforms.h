@@ -7,6 +7,7 @@ layout(std140) uniform PerViewData0
 	vec4 cameraPosition;
 	vec4 ambientColor;
 	vec4 iblParameters; // x = max lod level of PMREM texture
+	vec4 timeParameters; // x = animation time in seconds
 	vec4 dirLightDirection;
 	vec4 dirLightColor;
 	vec4 dirLightShadowSplits;
@@ -33,7 +34,12 @@ layout(std140) uniform LightData1
 #ifdef SKINNED
 	layout(std140) uniform PerObjectData2
 	{
+	#ifdef INSTANCED
+		// Range of the frame's shared skin matrix buffer, must match MAX_INSTANCED_SKIN_MATRICES in Renderer
+		mat3x4 skinMatrices[1024];
+	#else
 		mat3x4 skinMatrices[96];
+	#endif
 	};
 #endif
 